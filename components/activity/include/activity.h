@@ -0,0 +1,78 @@
+/**
+ * @file activity.h
+ * @brief Daily activity metrics: step count, active and sedentary minutes.
+ *
+ * A low-priority task attaches its own reader to the fall logic sample
+ * ring and runs every frame through activity_counter.h, so the metrics
+ * cost no extra sensor traffic. The totals of the current day are kept in
+ * RAM, written to NVS every CONFIG_ACTIVITY_PERSIST_INTERVAL_MIN minutes
+ * and restored after a reboot on the same day.
+ *
+ * Days follow the system clock once it has been set. Until then a day is
+ * 24 hours of uptime and totals found in NVS are assumed to be today's.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _ACTIVITY_H_
+#define _ACTIVITY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "activity_counter.h"
+#include "esp_err.h"
+#include "sample_ring.h"
+#include "sdkconfig.h"
+
+/**
+ * @brief Totals of the current day and the cost of computing them.
+ */
+typedef struct {
+  activity_totals_t today;
+  uint32_t day;            ///< Date as YYYYMMDD, 0 while the clock is unset
+  uint32_t overrun_frames; ///< Frames lost because the task fell behind
+  float load_pct;          ///< Share of one core spent counting
+} activity_stats_t;
+
+#if CONFIG_ACTIVITY_ENABLE
+
+/**
+ * @brief Attaches to the sample ring and restores today's totals.
+ *
+ * @param ring Ring carrying every acquired frame, from
+ * fall_logic_get_sample_ring().
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if @p ring is NULL.
+ */
+esp_err_t activity_init(sample_ring_t *ring);
+
+/**
+ * @brief Starts the activity task.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before activity_init(),
+ * ESP_FAIL if the task could not be created.
+ */
+esp_err_t activity_start(void);
+
+/**
+ * @brief Returns today's totals.
+ *
+ * @param[out] stats Totals and counting cost.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before activity_init().
+ */
+esp_err_t activity_get_stats(activity_stats_t *stats);
+
+#else
+
+#define activity_init(ring) (ESP_OK)
+#define activity_start() (ESP_OK)
+#define activity_get_stats(stats) (ESP_ERR_NOT_SUPPORTED)
+
+#endif // CONFIG_ACTIVITY_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ACTIVITY_H_
@@ -0,0 +1,133 @@
+/**
+ * @file activity_counter.h
+ * @brief Incremental step and active-minute counting over raw IMU frames.
+ *
+ * Each frame costs one squared magnitude, one integer square root and two
+ * exponential filters; nothing is buffered.
+ *
+ *  - Steps: |a| is smoothed and compared with a slow baseline (gravity).
+ *    A step is a rise above the baseline by step_mg followed by a fall
+ *    back below it. Peaks closer than step_min_ms are bounces of the same
+ *    step. Steps only count once step_min_run of them follow each other at
+ *    most step_max_ms apart, so isolated bumps are ignored.
+ *  - Minutes: the time-weighted mean distance of the smoothed |a| from the
+ *    baseline is accumulated; activity_counter_end_minute() classifies the
+ *    minute as active when it reaches active_mg, sedentary otherwise.
+ *
+ * Both filters run on the frame timestamps, so the counter follows rate
+ * changes (adaptive sampling, FIFO bursts). The module has no FreeRTOS or
+ * driver dependency.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _ACTIVITY_COUNTER_H_
+#define _ACTIVITY_COUNTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mpu6050.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Thresholds.
+ */
+typedef struct {
+  uint32_t step_mg;         ///< Rise above the baseline that makes a step
+  uint32_t step_min_ms;     ///< Shortest time between two steps
+  uint32_t step_max_ms;     ///< Longest time between steps of one walk
+  uint32_t step_min_run;    ///< Steps in a row before any is counted
+  uint32_t active_mg;       ///< Mean dynamic acceleration of active minutes
+  uint32_t accel_lsb_per_g; ///< Sensitivity of the accel range
+} activity_counter_config_t;
+
+#ifdef CONFIG_ACTIVITY_STEP_THRESHOLD_MG
+/**
+ * @brief Counter configuration from Kconfig.
+ */
+#define ACTIVITY_COUNTER_DEFAULT_CONFIG()                                      \
+  {                                                                            \
+    .step_mg = CONFIG_ACTIVITY_STEP_THRESHOLD_MG,                              \
+    .step_min_ms = CONFIG_ACTIVITY_STEP_MIN_INTERVAL_MS,                       \
+    .step_max_ms = CONFIG_ACTIVITY_STEP_MAX_INTERVAL_MS,                       \
+    .step_min_run = CONFIG_ACTIVITY_STEP_MIN_RUN,                              \
+    .active_mg = CONFIG_ACTIVITY_ACTIVE_THRESHOLD_MG,                          \
+    .accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G,                                \
+  }
+#endif
+
+/**
+ * @brief Totals of one day.
+ */
+typedef struct {
+  uint32_t steps;
+  uint16_t active_min;
+  uint16_t sedentary_min;
+} activity_totals_t;
+
+/**
+ * @brief Counter instance. Treat the fields as private.
+ */
+typedef struct {
+  activity_counter_config_t config;
+  int32_t step_lsb;   ///< step_mg in LSB
+  bool started;       ///< Filters seeded, last_us valid
+  uint32_t last_us;   ///< Timestamp of the previous frame
+  int32_t smooth;     ///< Smoothed |a| (LSB << FILTER_SHIFT)
+  int32_t baseline;   ///< Baseline |a| (LSB << FILTER_SHIFT)
+  bool peak;          ///< Above the step threshold, waiting to come down
+  uint32_t peak_us;   ///< Time of the current peak
+  bool walking;       ///< A previous step is recent enough to chain
+  uint32_t step_us;   ///< Time of the previous step
+  uint32_t run;       ///< Steps in the current run
+  uint32_t pending;   ///< Steps of a run too short to count yet
+  uint64_t dev_sum;   ///< Sum of |smooth - baseline| * dt (LSB * ms)
+  uint32_t dev_ms;    ///< Time covered by dev_sum
+  activity_totals_t totals;
+} activity_counter_t;
+
+/**
+ * @brief Initializes a counter with zero totals.
+ */
+void activity_counter_init(activity_counter_t *c,
+                           const activity_counter_config_t *config);
+
+/**
+ * @brief Runs frames through the step detector and the minute accumulator.
+ *
+ * @param c Counter instance.
+ * @param frames Frames in chronological order.
+ * @param count Number of frames.
+ */
+void activity_counter_update(activity_counter_t *c, const sensor_raw_t *frames,
+                             size_t count);
+
+/**
+ * @brief Closes the current minute and adds it to the active or sedentary
+ * count. Time without frames (light sleep) counts as no movement.
+ *
+ * @return true if the minute was active.
+ */
+bool activity_counter_end_minute(activity_counter_t *c);
+
+/**
+ * @brief Returns the totals since init or the last reset.
+ */
+const activity_totals_t *activity_counter_totals(const activity_counter_t *c);
+
+/**
+ * @brief Replaces the totals, e.g. with the ones restored after a reboot.
+ */
+void activity_counter_set_totals(activity_counter_t *c,
+                                 const activity_totals_t *totals);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ACTIVITY_COUNTER_H_
@@ -0,0 +1,289 @@
+/**
+ * @file activity.c
+ * @brief Daily activity metrics: step count, active and sedentary minutes.
+ *
+ * The task owns the counter and publishes its totals after every wake-up;
+ * other tasks only copy the published values under s_mux. Minutes are
+ * closed on the esp_timer clock rather than on frame timestamps, so
+ * minutes spent in light sleep, with no frames at all, still count as
+ * sedentary.
+ */
+
+#include "activity.h"
+
+#if CONFIG_ACTIVITY_ENABLE
+
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "task_topology.h"
+#include <time.h>
+
+static const char *TAG = "ACTIVITY";
+
+#define ACTIVITY_PERIOD_MS CONFIG_ACTIVITY_PERIOD_MS
+#define PERSIST_INTERVAL_MIN CONFIG_ACTIVITY_PERSIST_INTERVAL_MIN
+#define TASK_STACK_SIZE CONFIG_ACTIVITY_TASK_STACK_SIZE
+
+#define MINUTE_US (60LL * 1000000LL)
+#define DAY_US (24LL * 60LL * MINUTE_US)
+
+#define ACTIVITY_NVS_NAMESPACE "activity"
+#define ACTIVITY_NVS_KEY "today"
+#define ACTIVITY_BLOB_VERSION 1
+
+// Clocks before this year have not been set
+#define CLOCK_VALID_YEAR 2024
+
+/**
+ * @brief Layout of the daily totals in NVS.
+ */
+typedef struct {
+  uint8_t version;
+  uint8_t reserved[3];
+  uint32_t day; ///< YYYYMMDD, 0 if the clock was unset
+  uint32_t steps;
+  uint16_t active_min;
+  uint16_t sedentary_min;
+} activity_blob_t;
+
+static activity_counter_t s_counter;
+static sample_ring_reader_t s_reader;
+static bool s_initialized = false;
+// CPU cycles spent in the counter, owned by the task
+static uint64_t s_cycles = 0;
+// Totals, date and cycles as seen by other tasks, guarded by s_mux
+static activity_totals_t s_totals;
+static uint32_t s_day = 0;
+static uint64_t s_cycles_published = 0;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+// Start of the current day when the clock is unset, and of the minute
+static int64_t s_day_start_us = 0;
+static int64_t s_minute_start_us = 0;
+static int64_t s_load_start_us = 0;
+static uint32_t s_minutes_unsaved = 0;
+
+/**
+ * @brief Current local date as YYYYMMDD, or 0 while the clock is unset.
+ */
+static uint32_t current_day(void) {
+  time_t now = time(NULL);
+  struct tm tm;
+  if (localtime_r(&now, &tm) == NULL ||
+      tm.tm_year + 1900 < CLOCK_VALID_YEAR) {
+    return 0;
+  }
+  return (uint32_t)((tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 +
+                    tm.tm_mday);
+}
+
+/**
+ * @brief Makes the counter totals and date visible to other tasks.
+ */
+static void publish_totals(uint32_t day) {
+  taskENTER_CRITICAL(&s_mux);
+  s_totals = *activity_counter_totals(&s_counter);
+  s_day = day;
+  s_cycles_published = s_cycles;
+  taskEXIT_CRITICAL(&s_mux);
+}
+
+/**
+ * @brief Restores today's totals from NVS.
+ */
+static void load_totals(void) {
+  nvs_handle_t handle;
+  if (nvs_open(ACTIVITY_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    return;
+  }
+
+  activity_blob_t blob;
+  size_t size = sizeof(blob);
+  esp_err_t err = nvs_get_blob(handle, ACTIVITY_NVS_KEY, &blob, &size);
+  nvs_close(handle);
+  if (err != ESP_OK || size != sizeof(blob) ||
+      blob.version != ACTIVITY_BLOB_VERSION) {
+    return;
+  }
+  // Without a clock a reboot is assumed to stay within the day
+  if (s_day != 0 && blob.day != s_day) {
+    ESP_LOGI(TAG, "Stored totals are from %lu, starting a new day",
+             (unsigned long)blob.day);
+    return;
+  }
+
+  activity_totals_t totals = {
+      .steps = blob.steps,
+      .active_min = blob.active_min,
+      .sedentary_min = blob.sedentary_min,
+  };
+  activity_counter_set_totals(&s_counter, &totals);
+  ESP_LOGI(TAG, "Restored %lu steps, %u active / %u sedentary min",
+           (unsigned long)totals.steps, totals.active_min,
+           totals.sedentary_min);
+}
+
+/**
+ * @brief Writes today's totals to NVS.
+ */
+static void save_totals(void) {
+  const activity_totals_t *totals = activity_counter_totals(&s_counter);
+  activity_blob_t blob = {
+      .version = ACTIVITY_BLOB_VERSION,
+      .day = s_day,
+      .steps = totals->steps,
+      .active_min = totals->active_min,
+      .sedentary_min = totals->sedentary_min,
+  };
+
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(ACTIVITY_NVS_NAMESPACE, NVS_READWRITE, &handle);
+  if (err == ESP_OK) {
+    err = nvs_set_blob(handle, ACTIVITY_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) {
+      err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to store activity totals: %s", esp_err_to_name(err));
+  }
+  s_minutes_unsaved = 0;
+}
+
+/**
+ * @brief Share of one core spent in the counter since the task started.
+ */
+static float load_pct(uint64_t cycles, int64_t now_us) {
+  int64_t elapsed_us = now_us - s_load_start_us;
+  if (elapsed_us <= 0) {
+    return 0.0f;
+  }
+  return (float)cycles * 100.0f /
+         ((float)elapsed_us * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+}
+
+/**
+ * @brief Starts a new day when the date changes, or after 24 hours of
+ * uptime while the clock is unset.
+ */
+static void check_day(int64_t now_us) {
+  uint32_t day = current_day();
+  bool new_day = day != 0 ? (s_day != 0 && day != s_day)
+                          : (now_us - s_day_start_us >= DAY_US);
+  if (!new_day) {
+    // Once the clock is set the running totals belong to that date
+    if (day != s_day) {
+      publish_totals(day);
+    }
+    return;
+  }
+
+  const activity_totals_t *totals = activity_counter_totals(&s_counter);
+  ESP_LOGI(TAG, "Day done: %lu steps, %u active / %u sedentary min",
+           (unsigned long)totals->steps, totals->active_min,
+           totals->sedentary_min);
+
+  activity_totals_t zero = {0};
+  activity_counter_set_totals(&s_counter, &zero);
+  publish_totals(day);
+  s_day_start_us = now_us;
+  save_totals();
+}
+
+/**
+ * @brief Closes every minute that has elapsed since the last call.
+ */
+static void close_minutes(int64_t now_us) {
+  while (now_us - s_minute_start_us >= MINUTE_US) {
+    s_minute_start_us += MINUTE_US;
+    activity_counter_end_minute(&s_counter);
+    s_minutes_unsaved++;
+  }
+  publish_totals(s_day);
+
+  check_day(now_us);
+  if (s_minutes_unsaved >= PERSIST_INTERVAL_MIN) {
+    ESP_LOGD(TAG, "Saving totals, counting load %.2f%%",
+             load_pct(s_cycles, now_us));
+    save_totals();
+  }
+}
+
+/**
+ * @brief FreeRTOS task draining the sample ring.
+ */
+static void activity_task(void *param) {
+  ESP_LOGI(TAG, "Activity task started");
+  TickType_t last_wake = xTaskGetTickCount();
+
+  while (1) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(ACTIVITY_PERIOD_MS));
+
+    const sensor_raw_t *frames;
+    size_t count;
+    while ((count = sample_ring_peek(&s_reader, &frames)) > 0) {
+      uint32_t start = esp_cpu_get_cycle_count();
+      activity_counter_update(&s_counter, frames, count);
+      s_cycles += esp_cpu_get_cycle_count() - start;
+      sample_ring_consume(&s_reader, count);
+    }
+
+    close_minutes(esp_timer_get_time());
+  }
+}
+
+esp_err_t activity_init(sample_ring_t *ring) {
+  if (ring == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  activity_counter_config_t config = ACTIVITY_COUNTER_DEFAULT_CONFIG();
+  config.accel_lsb_per_g = mpu6050_get_accel_lsb_per_g();
+  activity_counter_init(&s_counter, &config);
+  sample_ring_reader_init(&s_reader, ring, "activity");
+
+  s_day = current_day();
+  load_totals();
+  publish_totals(s_day);
+
+  int64_t now_us = esp_timer_get_time();
+  s_day_start_us = now_us;
+  s_minute_start_us = now_us;
+  s_initialized = true;
+  return ESP_OK;
+}
+
+esp_err_t activity_start(void) {
+  if (!s_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  s_load_start_us = esp_timer_get_time();
+
+  if (task_topology_create(TASK_TOPOLOGY_ACTIVITY, activity_task,
+                           TASK_STACK_SIZE, NULL, NULL) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create activity_task");
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t activity_get_stats(activity_stats_t *stats) {
+  if (!s_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  taskENTER_CRITICAL(&s_mux);
+  stats->today = s_totals;
+  stats->day = s_day;
+  uint64_t cycles = s_cycles_published;
+  taskEXIT_CRITICAL(&s_mux);
+  stats->overrun_frames = s_reader.overrun_frames;
+  stats->load_pct = load_pct(cycles, esp_timer_get_time());
+  return ESP_OK;
+}
+
+#endif // CONFIG_ACTIVITY_ENABLE
@@ -0,0 +1,145 @@
+/**
+ * @file activity_counter.c
+ * @brief Incremental step and active-minute counting over raw IMU frames.
+ */
+
+#include "activity_counter.h"
+#include "fall_dsp.h"
+#include <string.h>
+
+// Filter states keep 8 fractional bits
+#define FILTER_SHIFT 8
+// Time constants of the step filter and of the gravity baseline
+#define SMOOTH_TAU_MS 30
+#define BASELINE_TAU_MS 1500
+// Longer gaps (light sleep) restart the filters
+#define MAX_GAP_US 1000000u
+// Frames run through the batch magnitude kernel at a time
+#define CHUNK_FRAMES 32
+
+#define MS_TO_US(ms) ((uint32_t)(ms) * 1000u)
+
+static inline uint32_t mg_to_lsb(uint32_t mg, uint32_t lsb_per_g) {
+  return (uint32_t)(((uint64_t)mg * lsb_per_g + 500) / 1000);
+}
+
+/**
+ * @brief One step of a first-order low-pass filter with time constant
+ * @p tau_ms over @p dt_ms.
+ */
+static inline int32_t low_pass(int32_t state, int32_t target, uint32_t dt_ms,
+                               uint32_t tau_ms) {
+  return state + (int32_t)((int64_t)(target - state) * dt_ms /
+                           (int64_t)(tau_ms + dt_ms));
+}
+
+void activity_counter_init(activity_counter_t *c,
+                           const activity_counter_config_t *config) {
+  memset(c, 0, sizeof(*c));
+  c->config = *config;
+  c->step_lsb =
+      (int32_t)mg_to_lsb(config->step_mg, config->accel_lsb_per_g)
+      << FILTER_SHIFT;
+}
+
+/**
+ * @brief Accounts a step peak at @p peak_us.
+ */
+static void on_peak(activity_counter_t *c, uint32_t peak_us) {
+  const activity_counter_config_t *cfg = &c->config;
+  uint32_t interval_us = peak_us - c->step_us;
+
+  if (c->walking && interval_us < MS_TO_US(cfg->step_min_ms)) {
+    return;
+  }
+  if (!c->walking || interval_us > MS_TO_US(cfg->step_max_ms)) {
+    // A new walk; the steps of a run too short to count are dropped
+    c->run = 0;
+    c->pending = 0;
+  }
+  c->walking = true;
+  c->step_us = peak_us;
+  c->run++;
+  c->pending++;
+  if (c->run >= cfg->step_min_run) {
+    c->totals.steps += c->pending;
+    c->pending = 0;
+  }
+}
+
+/**
+ * @brief Feeds one frame with its magnitude.
+ */
+static void update_frame(activity_counter_t *c, uint32_t timestamp_us,
+                         uint32_t mag) {
+  int32_t m = (int32_t)mag << FILTER_SHIFT;
+  uint32_t dt_us = timestamp_us - c->last_us;
+
+  if (!c->started || dt_us > MAX_GAP_US) {
+    c->started = true;
+    c->last_us = timestamp_us;
+    c->smooth = m;
+    c->baseline = m;
+    c->peak = false;
+    return;
+  }
+  c->last_us = timestamp_us;
+
+  uint32_t dt_ms = (dt_us + 500) / 1000;
+  c->smooth = low_pass(c->smooth, m, dt_ms, SMOOTH_TAU_MS);
+  c->baseline = low_pass(c->baseline, m, dt_ms, BASELINE_TAU_MS);
+  int32_t dev = c->smooth - c->baseline;
+
+  if (!c->peak && dev > c->step_lsb) {
+    c->peak = true;
+    c->peak_us = timestamp_us;
+  } else if (c->peak && dev < 0) {
+    c->peak = false;
+    on_peak(c, c->peak_us);
+  }
+
+  uint32_t abs_dev = (uint32_t)(dev < 0 ? -dev : dev) >> FILTER_SHIFT;
+  c->dev_sum += (uint64_t)abs_dev * dt_ms;
+  c->dev_ms += dt_ms;
+}
+
+void activity_counter_update(activity_counter_t *c, const sensor_raw_t *frames,
+                             size_t count) {
+  uint32_t mag_sq[CHUNK_FRAMES];
+
+  while (count > 0) {
+    size_t n = count < CHUNK_FRAMES ? count : CHUNK_FRAMES;
+    fall_dsp_mag_sq_s16(frames, n, mag_sq);
+    for (size_t i = 0; i < n; i++) {
+      update_frame(c, frames[i].timestamp_us, fall_dsp_isqrt_u32(mag_sq[i]));
+    }
+    frames += n;
+    count -= n;
+  }
+}
+
+bool activity_counter_end_minute(activity_counter_t *c) {
+  const activity_counter_config_t *cfg = &c->config;
+  // Time without frames counts as no movement
+  uint32_t minute_ms = c->dev_ms > 60000u ? c->dev_ms : 60000u;
+  uint32_t mean = (uint32_t)(c->dev_sum / minute_ms);
+  bool active = mean >= mg_to_lsb(cfg->active_mg, cfg->accel_lsb_per_g);
+
+  if (active) {
+    c->totals.active_min++;
+  } else {
+    c->totals.sedentary_min++;
+  }
+  c->dev_sum = 0;
+  c->dev_ms = 0;
+  return active;
+}
+
+const activity_totals_t *activity_counter_totals(const activity_counter_t *c) {
+  return &c->totals;
+}
+
+void activity_counter_set_totals(activity_counter_t *c,
+                                 const activity_totals_t *totals) {
+  c->totals = *totals;
+}
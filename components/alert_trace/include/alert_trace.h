@@ -0,0 +1,102 @@
+/**
+ * @file alert_trace.h
+ * @brief End-to-end latency of fall alerts, from the sensor sample to the
+ * SMS and MQTT acknowledgements.
+ *
+ * fall_logic opens a trace when it raises EVENT_FALL_DETECTED and carries
+ * its ID in the event payload; the event handler and the sim4g_gps alert
+ * worker pass it on and mark each stage they reach with
+ * esp_timer_get_time(). The broker acknowledgement is taken from
+ * MQTT_EVENT_PUBLISHED by a handler registered on the user_mqtt client.
+ *
+ * A trace is done once every stage is reached or known to be skipped (no
+ * phone number, failed SMS, failed publish), or after
+ * CONFIG_ALERT_TRACE_TIMEOUT_S. It then adds its stage latencies to one
+ * histogram per stage, logs them and publishes the breakdown, with the
+ * histograms since boot, on CONFIG_ALERT_TRACE_TOPIC.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _ALERT_TRACE_H_
+#define _ALERT_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+
+/**
+ * @brief Points of the alert path, in the order they are reached.
+ */
+typedef enum {
+  ALERT_STAGE_TRIGGER,      ///< Sample that crossed the detection threshold
+  ALERT_STAGE_CONFIRMED,    ///< Sample on which the fall was confirmed
+  ALERT_STAGE_REPORTED,     ///< Fall task raised EVENT_FALL_DETECTED
+  ALERT_STAGE_DISPATCHED,   ///< Event handler ran the alert subscriber
+  ALERT_STAGE_WORKER,       ///< Alert worker took the request
+  ALERT_STAGE_SMS_ACCEPTED, ///< Modem answered +CMGS
+  ALERT_STAGE_MQTT_QUEUED,  ///< Alert handed to the MQTT client
+  ALERT_STAGE_MQTT_ACKED,   ///< Broker acknowledged the alert
+  ALERT_STAGE_COUNT
+} alert_stage_t;
+
+#if CONFIG_ALERT_TRACE_ENABLE
+
+/**
+ * @brief Publishes finished traces through the user_mqtt client and
+ * watches it for acknowledgements.
+ *
+ * Call after user_mqtt_init(). Traces opened before are kept and their
+ * broker acknowledgement is missed.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE without an MQTT client.
+ */
+esp_err_t alert_trace_init(void);
+
+/**
+ * @brief Opens a trace; the current time is ALERT_STAGE_REPORTED.
+ *
+ * @param trigger_us Time of the sample that crossed the threshold.
+ * @param confirmed_us Time of the confirming sample.
+ * @return ID to pass along the alert path, 0 if every trace slot is in use.
+ */
+uint32_t alert_trace_begin(int64_t trigger_us, int64_t confirmed_us);
+
+/**
+ * @brief Records that trace @p id reached @p stage now. ID 0 is ignored.
+ */
+void alert_trace_mark(uint32_t id, alert_stage_t stage);
+
+/**
+ * @brief Records that trace @p id will not reach @p stage.
+ */
+void alert_trace_skip(uint32_t id, alert_stage_t stage);
+
+/**
+ * @brief Marks ALERT_STAGE_MQTT_QUEUED and remembers the message whose
+ * acknowledgement ends the trace.
+ *
+ * @param id Trace ID.
+ * @param msg_id ID returned by esp_mqtt_client_publish().
+ */
+void alert_trace_mark_mqtt(uint32_t id, int msg_id);
+
+#else
+
+#define alert_trace_init() (ESP_OK)
+#define alert_trace_begin(trigger_us, confirmed_us) (0u)
+#define alert_trace_mark(id, stage) ((void)(id))
+#define alert_trace_skip(id, stage) ((void)(id))
+#define alert_trace_mark_mqtt(id, msg_id) ((void)(id))
+
+#endif // CONFIG_ALERT_TRACE_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ALERT_TRACE_H_
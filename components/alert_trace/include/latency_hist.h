@@ -0,0 +1,65 @@
+/**
+ * @file latency_hist.h
+ * @brief Latency distribution in power-of-two millisecond buckets.
+ *
+ * Bucket 0 counts latencies under 1 ms; bucket b >= 1 counts latencies
+ * from 2^(b-1) up to 2^b - 1 ms, and the last bucket everything above.
+ * Adding a value costs a bit count, so histograms can be updated inside a
+ * critical section. The module has no FreeRTOS dependency.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _LATENCY_HIST_H_
+#define _LATENCY_HIST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The last bucket starts at 2^16 ms, about 65 s
+#define LATENCY_HIST_BUCKETS 18
+
+/**
+ * @brief Latencies recorded since init.
+ */
+typedef struct {
+  uint32_t count;  ///< Latencies recorded
+  uint32_t max_ms; ///< Largest latency
+  uint64_t sum_ms; ///< Sum of all latencies, for the mean
+  uint32_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+/**
+ * @brief Initializes an empty histogram.
+ */
+void latency_hist_init(latency_hist_t *h);
+
+/**
+ * @brief Records one latency.
+ */
+void latency_hist_add(latency_hist_t *h, uint32_t ms);
+
+/**
+ * @brief Largest latency counted by @p bucket, UINT32_MAX for the last one.
+ */
+uint32_t latency_hist_bucket_max_ms(size_t bucket);
+
+/**
+ * @brief Upper bound of the given percentile.
+ *
+ * @param h Histogram.
+ * @param pct Percentile, 1 to 100.
+ * @return Upper end of the bucket holding the percentile, capped at the
+ * largest latency seen, or 0 for an empty histogram.
+ */
+uint32_t latency_hist_percentile_ms(const latency_hist_t *h, uint32_t pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LATENCY_HIST_H_
@@ -0,0 +1,443 @@
+/**
+ * @file alert_trace.c
+ * @brief End-to-end latency of fall alerts, from the sensor sample to the
+ * SMS and MQTT acknowledgements.
+ *
+ * Open traces live in a few static slots under s_mux; stages are marked
+ * from the fall, event, alert worker and MQTT tasks. The task that
+ * completes a trace, or the timeout timer, takes it out of its slot and
+ * publishes it under s_publish_lock, which also owns the histograms and
+ * the payload buffer, so finishing a trace needs no heap beyond the MQTT
+ * outbox.
+ */
+
+#include "alert_trace.h"
+
+#if CONFIG_ALERT_TRACE_ENABLE
+
+#include "debugs.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "latency_hist.h"
+#include "mqtt_client.h"
+#include "user_mqtt.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+static const char *TAG = "ALERT_TRACE";
+
+#define TIMEOUT_US ((int64_t)CONFIG_ALERT_TRACE_TIMEOUT_S * 1000000)
+#define SLO_MS CONFIG_ALERT_TRACE_SLO_MS
+// Alerts in flight at once; falls are latched until the alert is handled
+#define TRACE_SLOTS 4
+#define PAYLOAD_SIZE 2048
+
+/**
+ * @brief One alert on its way.
+ */
+typedef struct {
+  uint32_t id;                      ///< 0 while the slot is free
+  int64_t at_us[ALERT_STAGE_COUNT]; ///< esp_timer time, 0 until reached
+  uint32_t skipped;                 ///< One bit per skipped stage
+  int mqtt_msg_id;                  ///< -1 until the alert is queued
+} trace_t;
+
+static const char *const s_stage_names[ALERT_STAGE_COUNT] = {
+    [ALERT_STAGE_TRIGGER] = "trigger",
+    [ALERT_STAGE_CONFIRMED] = "confirmed",
+    [ALERT_STAGE_REPORTED] = "reported",
+    [ALERT_STAGE_DISPATCHED] = "dispatched",
+    [ALERT_STAGE_WORKER] = "worker",
+    [ALERT_STAGE_SMS_ACCEPTED] = "sms_accepted",
+    [ALERT_STAGE_MQTT_QUEUED] = "mqtt_queued",
+    [ALERT_STAGE_MQTT_ACKED] = "mqtt_acked",
+};
+
+// Open traces, guarded by s_mux
+static trace_t s_traces[TRACE_SLOTS];
+static uint32_t s_next_id = 1;
+// Acknowledgement that arrived before the worker recorded its message ID
+static int s_early_ack_msg_id = -1;
+static int64_t s_early_ack_us = 0;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Owned by the holder of s_publish_lock
+static SemaphoreHandle_t s_publish_lock = NULL;
+static StaticSemaphore_t s_publish_lock_buf;
+// Latency from the trigger to each stage, over every finished trace
+static latency_hist_t s_hist[ALERT_STAGE_COUNT];
+static uint32_t s_finished = 0;
+static uint32_t s_slo_missed = 0;
+static char s_payload[PAYLOAD_SIZE];
+
+static esp_timer_handle_t s_timeout_timer = NULL;
+static esp_mqtt_client_handle_t s_client = NULL;
+
+/**
+ * @brief Appends formatted text at @p *len, tracking overflow.
+ *
+ * @return false once the buffer is full; later calls do nothing.
+ */
+static bool append(char *buf, size_t size, int *len, const char *fmt, ...) {
+  if (*len < 0) {
+    return false;
+  }
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + *len, size - *len, fmt, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - *len) {
+    *len = -1;
+    return false;
+  }
+  *len += n;
+  return true;
+}
+
+/**
+ * @brief Open trace with the given ID, or NULL. Call under s_mux.
+ */
+static trace_t *find(uint32_t id) {
+  for (size_t i = 0; id != 0 && i < TRACE_SLOTS; i++) {
+    if (s_traces[i].id == id) {
+      return &s_traces[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Frees the slot of a trace that reached or skipped every stage,
+ * copying it to @p done. Call under s_mux.
+ */
+static bool take_if_done(trace_t *t, trace_t *done) {
+  for (int s = 0; s < ALERT_STAGE_COUNT; s++) {
+    if (t->at_us[s] == 0 && (t->skipped & (1u << s)) == 0) {
+      return false;
+    }
+  }
+  *done = *t;
+  t->id = 0;
+  return true;
+}
+
+/**
+ * @brief Milliseconds from the trigger to @p stage, -1 if not reached.
+ */
+static int32_t stage_ms(const trace_t *t, alert_stage_t stage) {
+  if (t->at_us[stage] == 0) {
+    return -1;
+  }
+  int64_t us = t->at_us[stage] - t->at_us[ALERT_STAGE_TRIGGER];
+  return us <= 0 ? 0 : (int32_t)(us / 1000);
+}
+
+/**
+ * @brief Writes the latency of each stage of @p t.
+ */
+static void write_breakdown(const trace_t *t, bool timed_out, int *len) {
+  append(s_payload, sizeof(s_payload), len,
+         "{\"alert_id\":%lu,\"timed_out\":%s,\"stages_ms\":{",
+         (unsigned long)t->id, timed_out ? "true" : "false");
+  for (int s = ALERT_STAGE_CONFIRMED; s < ALERT_STAGE_COUNT; s++) {
+    int32_t ms = stage_ms(t, s);
+    const char *sep = s == ALERT_STAGE_CONFIRMED ? "" : ",";
+    if (ms < 0) {
+      append(s_payload, sizeof(s_payload), len, "%s\"%s\":null", sep,
+             s_stage_names[s]);
+    } else {
+      append(s_payload, sizeof(s_payload), len, "%s\"%s\":%ld", sep,
+             s_stage_names[s], (long)ms);
+    }
+  }
+  append(s_payload, sizeof(s_payload), len, "}");
+}
+
+/**
+ * @brief Writes the histograms since boot, empty buckets at the end left
+ * out.
+ */
+static void write_histograms(int *len) {
+  append(s_payload, sizeof(s_payload), len,
+         ",\"alerts\":%lu,\"slo_ms\":%d,\"slo_missed\":%lu,\"hist\":{",
+         (unsigned long)s_finished, SLO_MS, (unsigned long)s_slo_missed);
+  for (int s = ALERT_STAGE_CONFIRMED; s < ALERT_STAGE_COUNT; s++) {
+    const latency_hist_t *h = &s_hist[s];
+    append(s_payload, sizeof(s_payload), len,
+           "%s\"%s\":{\"n\":%lu,\"mean_ms\":%lu,\"p95_ms\":%lu,"
+           "\"max_ms\":%lu,\"buckets\":[",
+           s == ALERT_STAGE_CONFIRMED ? "" : ",", s_stage_names[s],
+           (unsigned long)h->count,
+           (unsigned long)(h->count ? h->sum_ms / h->count : 0),
+           (unsigned long)latency_hist_percentile_ms(h, 95),
+           (unsigned long)h->max_ms);
+    int used = LATENCY_HIST_BUCKETS;
+    while (used > 0 && h->buckets[used - 1] == 0) {
+      used--;
+    }
+    for (int b = 0; b < used; b++) {
+      append(s_payload, sizeof(s_payload), len, "%s%lu", b == 0 ? "" : ",",
+             (unsigned long)h->buckets[b]);
+    }
+    append(s_payload, sizeof(s_payload), len, "]}");
+  }
+  append(s_payload, sizeof(s_payload), len, "}}");
+}
+
+/**
+ * @brief Accounts a trace taken out of its slot, logs and publishes it.
+ */
+static void finish(const trace_t *t, bool timed_out) {
+  // The wearer's contacts know once the first channel confirms delivery
+  int32_t delivered_ms = -1;
+  const alert_stage_t delivered[] = {ALERT_STAGE_SMS_ACCEPTED,
+                                     ALERT_STAGE_MQTT_ACKED};
+  for (size_t i = 0; i < sizeof(delivered) / sizeof(delivered[0]); i++) {
+    int32_t ms = stage_ms(t, delivered[i]);
+    if (ms >= 0 && (delivered_ms < 0 || ms < delivered_ms)) {
+      delivered_ms = ms;
+    }
+  }
+  bool slo_met = delivered_ms >= 0 && delivered_ms <= SLO_MS;
+
+  xSemaphoreTake(s_publish_lock, portMAX_DELAY);
+  for (int s = ALERT_STAGE_CONFIRMED; s < ALERT_STAGE_COUNT; s++) {
+    int32_t ms = stage_ms(t, s);
+    if (ms >= 0) {
+      latency_hist_add(&s_hist[s], (uint32_t)ms);
+    }
+  }
+  s_finished++;
+  if (!slo_met) {
+    s_slo_missed++;
+  }
+
+  int len = 0;
+  write_breakdown(t, timed_out, &len);
+  if (len > 0) {
+    ESP_LOGI(TAG, "Alert %lu: %.*s}", (unsigned long)t->id, len, s_payload);
+  }
+  if (delivered_ms < 0) {
+    ESP_LOGW(TAG, "Alert %lu: no delivery confirmed", (unsigned long)t->id);
+  } else if (!slo_met) {
+    ESP_LOGW(TAG, "Alert %lu: delivered after %ld ms, above the %d ms SLO",
+             (unsigned long)t->id, (long)delivered_ms, SLO_MS);
+  }
+  write_histograms(&len);
+
+  if (len < 0) {
+    ESP_LOGE(TAG, "Trace payload does not fit in %u bytes",
+             (unsigned)sizeof(s_payload));
+  } else if (s_client != NULL) {
+    // Diagnostics may go out later than the alert: keep it in the outbox
+    debugs_heap_watch_exempt(true);
+    int msg_id = esp_mqtt_client_enqueue(s_client, CONFIG_ALERT_TRACE_TOPIC,
+                                         s_payload, len, 1, 0, true);
+    debugs_heap_watch_exempt(false);
+    if (msg_id < 0) {
+      ESP_LOGW(TAG, "Failed to queue trace of alert %lu",
+               (unsigned long)t->id);
+    }
+  }
+  xSemaphoreGive(s_publish_lock);
+}
+
+/**
+ * @brief Finishes the traces that outlived the timeout and re-arms the
+ * timer for the oldest one left.
+ */
+static void on_timeout(void *arg) {
+  int64_t now_us = esp_timer_get_time();
+  int64_t next_due_us = 0;
+
+  for (size_t i = 0; i < TRACE_SLOTS; i++) {
+    trace_t done;
+    bool expired = false;
+    taskENTER_CRITICAL(&s_mux);
+    trace_t *t = &s_traces[i];
+    if (t->id != 0) {
+      int64_t due_us = t->at_us[ALERT_STAGE_REPORTED] + TIMEOUT_US;
+      if (due_us <= now_us) {
+        done = *t;
+        t->id = 0;
+        expired = true;
+      } else if (next_due_us == 0 || due_us < next_due_us) {
+        next_due_us = due_us;
+      }
+    }
+    taskEXIT_CRITICAL(&s_mux);
+    if (expired) {
+      finish(&done, true);
+    }
+  }
+
+  if (next_due_us != 0) {
+    // A trace opened meanwhile may have armed it for a later time
+    esp_timer_stop(s_timeout_timer);
+    esp_timer_start_once(s_timeout_timer, next_due_us - now_us);
+  }
+}
+
+/**
+ * @brief Marks the broker acknowledgement of a traced alert.
+ */
+static void on_published(void *arg, esp_event_base_t base, int32_t id,
+                         void *data) {
+  const esp_mqtt_event_t *event = data;
+  int64_t now_us = esp_timer_get_time();
+  trace_t done;
+  bool finished = false;
+
+  taskENTER_CRITICAL(&s_mux);
+  trace_t *t = NULL;
+  for (size_t i = 0; i < TRACE_SLOTS; i++) {
+    if (s_traces[i].id != 0 && s_traces[i].mqtt_msg_id == event->msg_id) {
+      t = &s_traces[i];
+      break;
+    }
+  }
+  if (t != NULL) {
+    t->at_us[ALERT_STAGE_MQTT_ACKED] = now_us;
+    finished = take_if_done(t, &done);
+  } else {
+    s_early_ack_msg_id = event->msg_id;
+    s_early_ack_us = now_us;
+  }
+  taskEXIT_CRITICAL(&s_mux);
+
+  if (finished) {
+    finish(&done, false);
+  }
+}
+
+esp_err_t alert_trace_init(void) {
+  if (s_publish_lock == NULL) {
+    s_publish_lock = xSemaphoreCreateMutexStatic(&s_publish_lock_buf);
+    for (int s = 0; s < ALERT_STAGE_COUNT; s++) {
+      latency_hist_init(&s_hist[s]);
+    }
+  }
+  if (s_timeout_timer == NULL) {
+    const esp_timer_create_args_t args = {
+        .callback = on_timeout,
+        .name = "alert_trace",
+    };
+    esp_err_t err = esp_timer_create(&args, &s_timeout_timer);
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to create the timeout timer");
+      return err;
+    }
+  }
+
+  esp_mqtt_client_handle_t client = user_mqtt_get_client();
+  if (client == NULL) {
+    ESP_LOGW(TAG, "No MQTT client, traces are only logged");
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (s_client != client) {
+    esp_mqtt_client_register_event(client, MQTT_EVENT_PUBLISHED, on_published,
+                                   NULL);
+    s_client = client;
+  }
+  return ESP_OK;
+}
+
+uint32_t alert_trace_begin(int64_t trigger_us, int64_t confirmed_us) {
+  if (s_publish_lock == NULL) {
+    return 0;
+  }
+  int64_t now_us = esp_timer_get_time();
+  uint32_t id = 0;
+
+  taskENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < TRACE_SLOTS; i++) {
+    trace_t *t = &s_traces[i];
+    if (t->id != 0) {
+      continue;
+    }
+    id = s_next_id++;
+    if (s_next_id == 0) {
+      s_next_id = 1;
+    }
+    *t = (trace_t){.id = id, .mqtt_msg_id = -1};
+    // The trigger is the time origin and must not read as unreached
+    t->at_us[ALERT_STAGE_TRIGGER] = trigger_us != 0 ? trigger_us : now_us;
+    t->at_us[ALERT_STAGE_CONFIRMED] = confirmed_us != 0 ? confirmed_us : now_us;
+    t->at_us[ALERT_STAGE_REPORTED] = now_us;
+    break;
+  }
+  taskEXIT_CRITICAL(&s_mux);
+
+  if (id == 0) {
+    ESP_LOGW(TAG, "All %d trace slots in use, alert not traced",
+             TRACE_SLOTS);
+    return 0;
+  }
+  // Fails while armed for an older trace, which re-arms it when it fires
+  esp_timer_start_once(s_timeout_timer, TIMEOUT_US);
+  return id;
+}
+
+/**
+ * @brief Records @p stage of trace @p id and finishes it when complete.
+ */
+static void update(uint32_t id, alert_stage_t stage, bool skip) {
+  if ((unsigned)stage >= ALERT_STAGE_COUNT) {
+    return;
+  }
+  int64_t now_us = esp_timer_get_time();
+  trace_t done;
+  bool finished = false;
+
+  taskENTER_CRITICAL(&s_mux);
+  trace_t *t = find(id);
+  if (t != NULL) {
+    if (skip) {
+      t->skipped |= 1u << stage;
+    } else {
+      t->at_us[stage] = now_us;
+    }
+    finished = take_if_done(t, &done);
+  }
+  taskEXIT_CRITICAL(&s_mux);
+
+  if (finished) {
+    finish(&done, false);
+  }
+}
+
+void alert_trace_mark(uint32_t id, alert_stage_t stage) {
+  update(id, stage, false);
+}
+
+void alert_trace_skip(uint32_t id, alert_stage_t stage) {
+  update(id, stage, true);
+}
+
+void alert_trace_mark_mqtt(uint32_t id, int msg_id) {
+  int64_t now_us = esp_timer_get_time();
+  trace_t done;
+  bool finished = false;
+
+  taskENTER_CRITICAL(&s_mux);
+  trace_t *t = find(id);
+  if (t != NULL) {
+    t->at_us[ALERT_STAGE_MQTT_QUEUED] = now_us;
+    t->mqtt_msg_id = msg_id;
+    if (msg_id == s_early_ack_msg_id) {
+      t->at_us[ALERT_STAGE_MQTT_ACKED] = s_early_ack_us;
+      s_early_ack_msg_id = -1;
+    }
+    finished = take_if_done(t, &done);
+  }
+  taskEXIT_CRITICAL(&s_mux);
+
+  if (finished) {
+    finish(&done, false);
+  }
+}
+
+#endif // CONFIG_ALERT_TRACE_ENABLE
@@ -0,0 +1,58 @@
+/**
+ * @file latency_hist.c
+ * @brief Latency distribution in power-of-two millisecond buckets.
+ */
+
+#include "latency_hist.h"
+#include <string.h>
+
+/**
+ * @brief Bucket of a latency: the number of significant bits of @p ms.
+ */
+static size_t bucket_of(uint32_t ms) {
+  size_t bits = 0;
+  while (ms != 0 && bits < LATENCY_HIST_BUCKETS - 1) {
+    ms >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+void latency_hist_init(latency_hist_t *h) { memset(h, 0, sizeof(*h)); }
+
+void latency_hist_add(latency_hist_t *h, uint32_t ms) {
+  h->buckets[bucket_of(ms)]++;
+  h->count++;
+  h->sum_ms += ms;
+  if (ms > h->max_ms) {
+    h->max_ms = ms;
+  }
+}
+
+uint32_t latency_hist_bucket_max_ms(size_t bucket) {
+  if (bucket >= LATENCY_HIST_BUCKETS - 1) {
+    return UINT32_MAX;
+  }
+  return (1u << bucket) - 1;
+}
+
+uint32_t latency_hist_percentile_ms(const latency_hist_t *h, uint32_t pct) {
+  if (h->count == 0) {
+    return 0;
+  }
+  // Rank of the percentile, rounded up so p100 is the largest latency
+  uint64_t rank = ((uint64_t)h->count * pct + 99) / 100;
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+    seen += h->buckets[b];
+    if (seen >= rank) {
+      uint32_t bound = latency_hist_bucket_max_ms(b);
+      return bound < h->max_ms ? bound : h->max_ms;
+    }
+  }
+  return h->max_ms;
+}
@@ -7,7 +7,7 @@
 #include <string.h>
 
 #include "data_manager.h"
-#include "event_handler.h" // Still needed for system_event_t
+#include "event_handler.h"
 #include "sim4g_gps.h"     // For gps_data_t
 
 static const char *TAG = "DATA_MANAGER";
@@ -153,6 +153,11 @@ esp_err_t data_manager_set_gps_data(const gps_data_t *data) {
 
     ESP_LOGI(TAG, "GPS data updated: has_fix=%s",
              data->has_gps_fix ? "true" : "false");
+
+    // The event handler keeps its own copy with the time it was taken
+    system_event_msg_t event = {.type = EVENT_GPS_UPDATED};
+    event.data.gps = *data;
+    event_handler_send_msg(&event);
     return ESP_OK;
   }
   return ESP_FAIL;
@@ -10,13 +10,19 @@
  * - CONFIG_DEBUGS_ENABLE_PERIODIC_LOG   Enable/disable periodic system log task.
  * - CONFIG_DEBUGS_LOG_INTERVAL_MS       Log task interval in milliseconds.
  * - CONFIG_DEBUGS_TASK_STACK_SIZE       Stack size of the debug task.
- * - CONFIG_DEBUGS_TASK_PRIORITY         Priority of the debug task.
+ * - CONFIG_TASK_TOPOLOGY_DEBUGS_PRIORITY Priority of the debug task.
+ * - CONFIG_DEBUGS_HEAP_WATCH            Count heap use of selected tasks.
  */
 
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 /// Default logging tag for the debug system
 #define DEBUGS_TAG "DEBUGS"
@@ -51,6 +57,50 @@ void debugs_init(void);
  */
 void debugs_set_periodic_log(bool enable);
 
+/**
+ * @brief Heap operations counted by the heap watch.
+ */
+typedef struct {
+    uint32_t allocs; ///< Allocations made by the watched tasks
+    uint32_t frees;  ///< Frees made by the watched tasks
+    uint32_t exempt; ///< Operations inside debugs_heap_watch_exempt()
+} debugs_heap_watch_stats_t;
+
+#if CONFIG_DEBUGS_HEAP_WATCH
+
+/**
+ * @brief Starts counting the heap operations of @p tasks.
+ *
+ * @param tasks Tasks to watch, copied.
+ * @param count Number of tasks, at most 8.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for too many tasks,
+ * ESP_ERR_INVALID_STATE if a watch is already running.
+ */
+esp_err_t debugs_heap_watch_start(const TaskHandle_t *tasks, size_t count);
+
+/**
+ * @brief Stops the watch and returns the counts.
+ *
+ * @param[out] stats Counts since debugs_heap_watch_start(), may be NULL.
+ */
+void debugs_heap_watch_stop(debugs_heap_watch_stats_t *stats);
+
+/**
+ * @brief Marks the heap operations of the calling task as expected.
+ *
+ * For calls into libraries that allocate by design, e.g. the MQTT outbox.
+ * They are counted as exempt instead of as allocations and frees.
+ */
+void debugs_heap_watch_exempt(bool exempt);
+
+#else
+
+#define debugs_heap_watch_start(tasks, count) (ESP_ERR_NOT_SUPPORTED)
+#define debugs_heap_watch_stop(stats) ((void)0)
+#define debugs_heap_watch_exempt(exempt) ((void)0)
+
+#endif // CONFIG_DEBUGS_HEAP_WATCH
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,7 +8,7 @@
  * - CONFIG_DEBUGS_ENABLE_PERIODIC_LOG
  * - CONFIG_DEBUGS_LOG_INTERVAL_MS
  * - CONFIG_DEBUGS_TASK_STACK_SIZE
- * - CONFIG_DEBUGS_TASK_PRIORITY
+ * - CONFIG_TASK_TOPOLOGY_DEBUGS_PRIORITY
  */
 
 #include "debugs.h"
@@ -17,6 +17,7 @@
 #include "esp_system.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "task_topology.h"
 #include <inttypes.h> // <== Đã thêm để dùng PRIu32
 
 #define INFO(...) DEBUGS_LOGI(__VA_ARGS__)
@@ -60,11 +61,11 @@ void debugs_init(void) {
 void debugs_set_periodic_log(bool enable) {
 #if CONFIG_DEBUGS_ENABLE_PERIODIC_LOG
   if (enable && s_debugs_task_handle == NULL) {
-    BaseType_t result = xTaskCreate(
-        debugs_periodic_task, "debugs_task", CONFIG_DEBUGS_TASK_STACK_SIZE,
-        NULL, CONFIG_DEBUGS_TASK_PRIORITY, &s_debugs_task_handle);
+    esp_err_t result = task_topology_create(
+        TASK_TOPOLOGY_DEBUGS, debugs_periodic_task,
+        CONFIG_DEBUGS_TASK_STACK_SIZE, NULL, &s_debugs_task_handle);
 
-    if (result == pdPASS) {
+    if (result == ESP_OK) {
       INFO("Periodic logging enabled.");
     } else {
       ERROR("Failed to create periodic logging task.");
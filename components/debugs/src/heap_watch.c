@@ -0,0 +1,118 @@
+/**
+ * @file heap_watch.c
+ * @brief Counts the heap operations made by a set of tasks.
+ *
+ * Uses the heap hooks of CONFIG_HEAP_USE_HOOKS. The hooks run for every
+ * allocation in the system, including from ISRs and with the flash cache
+ * disabled, so they live in IRAM, only compare task handles and update
+ * atomic counters.
+ */
+
+#include "debugs.h"
+
+#if CONFIG_DEBUGS_HEAP_WATCH
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+
+#define MAX_WATCHED_TASKS 8
+
+static TaskHandle_t s_tasks[MAX_WATCHED_TASKS];
+static size_t s_task_count = 0;
+// The task list is written only while disarmed
+static atomic_bool s_armed = false;
+static atomic_uint s_allocs = 0;
+static atomic_uint s_frees = 0;
+static atomic_uint s_exempt = 0;
+// Set by each watched task around calls that allocate by design
+static volatile bool s_exempt_flags[MAX_WATCHED_TASKS];
+
+/**
+ * @brief Index of the current task in the watch list, or -1.
+ */
+static IRAM_ATTR int watched_index(void) {
+  if (!atomic_load_explicit(&s_armed, memory_order_acquire) ||
+      xPortInIsrContext()) {
+    return -1;
+  }
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (size_t i = 0; i < s_task_count; i++) {
+    if (s_tasks[i] == self) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Adds one operation of the current task to @p counter.
+ */
+static IRAM_ATTR void count(atomic_uint *counter) {
+  int i = watched_index();
+  if (i < 0) {
+    return;
+  }
+  if (s_exempt_flags[i]) {
+    counter = &s_exempt;
+  }
+  atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+}
+
+IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size,
+                                         uint32_t caps) {
+  (void)size;
+  (void)caps;
+  if (ptr != NULL) {
+    count(&s_allocs);
+  }
+}
+
+IRAM_ATTR void esp_heap_trace_free_hook(void *ptr) {
+  if (ptr != NULL) {
+    count(&s_frees);
+  }
+}
+
+esp_err_t debugs_heap_watch_start(const TaskHandle_t *tasks, size_t count) {
+  if (count > MAX_WATCHED_TASKS || (count > 0 && tasks == NULL)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (atomic_load(&s_armed)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    s_tasks[i] = tasks[i];
+    s_exempt_flags[i] = false;
+  }
+  s_task_count = count;
+  atomic_store(&s_allocs, 0);
+  atomic_store(&s_frees, 0);
+  atomic_store(&s_exempt, 0);
+  atomic_store_explicit(&s_armed, true, memory_order_release);
+  return ESP_OK;
+}
+
+void debugs_heap_watch_stop(debugs_heap_watch_stats_t *stats) {
+  atomic_store_explicit(&s_armed, false, memory_order_release);
+  if (stats != NULL) {
+    stats->allocs = atomic_load(&s_allocs);
+    stats->frees = atomic_load(&s_frees);
+    stats->exempt = atomic_load(&s_exempt);
+  }
+}
+
+void debugs_heap_watch_exempt(bool exempt) {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (size_t i = 0; i < s_task_count; i++) {
+    if (s_tasks[i] == self) {
+      s_exempt_flags[i] = exempt;
+      return;
+    }
+  }
+}
+
+#endif // CONFIG_DEBUGS_HEAP_WATCH
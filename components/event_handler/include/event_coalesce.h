@@ -0,0 +1,66 @@
+/**
+ * @file event_coalesce.h
+ * @brief Background event lane that keeps one pending event per type.
+ *
+ * Background events report state (connected, new GPS reading, alert out),
+ * so only the latest of each type matters. A burst of reconnects takes one
+ * slot and never fills the lane. Pending events come out oldest first by
+ * sequence number. The module has no FreeRTOS dependency; callers
+ * serialize access.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _EVENT_COALESCE_H_
+#define _EVENT_COALESCE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "event_types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Lane instance. Treat the fields as private.
+ */
+typedef struct {
+  system_event_msg_t slots[EVENT_MAX]; ///< Latest pending event per type
+  uint32_t pending_mask;               ///< Bit per type with a slot in use
+} event_coalesce_t;
+
+/**
+ * @brief Initializes an empty lane.
+ */
+void event_coalesce_init(event_coalesce_t *lane);
+
+/**
+ * @brief Adds an event, replacing a pending one of the same type.
+ *
+ * @param lane Lane instance.
+ * @param event Event to add; its type must be below EVENT_MAX.
+ * @return true if a pending event was replaced (coalesced).
+ */
+bool event_coalesce_push(event_coalesce_t *lane,
+                         const system_event_msg_t *event);
+
+/**
+ * @brief Removes the pending event with the oldest sequence number.
+ *
+ * @param lane Lane instance.
+ * @param[out] event The removed event.
+ * @return false if the lane is empty.
+ */
+bool event_coalesce_pop(event_coalesce_t *lane, system_event_msg_t *event);
+
+/**
+ * @brief Number of pending events.
+ */
+uint32_t event_coalesce_pending(const event_coalesce_t *lane);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _EVENT_COALESCE_H_
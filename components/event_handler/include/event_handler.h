@@ -6,28 +6,61 @@ extern "C" {
 #endif
 
 #include "esp_err.h"
+#include "event_types.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include <stddef.h>
 
 /**
- * @brief Enum of system events to be handled.
+ * @brief Event counters since init, per lane.
  *
- * This provides a simple, structured way to pass different event types
- * through the event queue.
+ * Fall, long-lie and recovery events go through the urgent lane and are
+ * always handled before anything else; the rest go through the background
+ * lane, which keeps only the latest event of each type.
+ */
+typedef struct {
+    uint32_t urgent_sent;          ///< Queued in the urgent lane
+    uint32_t urgent_dropped;       ///< Lost, the urgent lane was full
+    uint32_t urgent_high_water;    ///< Most urgent events waiting at once
+    uint32_t background_sent;      ///< Accepted by the background lane
+    uint32_t background_coalesced; ///< Replaced by a newer one of the type
+} event_handler_stats_t;
+
+/**
+ * @brief Where a subscriber runs.
  */
 typedef enum {
-    EVENT_NONE = 0,
-    EVENT_FALL_DETECTED,
-    EVENT_WIFI_CONNECTED,
-    EVENT_MQTT_CONNECTED,
-    EVENT_MAX
-} system_event_t;
+    EVENT_CONTEXT_INLINE, ///< On the event handler task, must not block
+    EVENT_CONTEXT_WORKER, ///< On the event worker task, may block
+} event_context_t;
+
+/**
+ * @brief Subscriber callback.
+ *
+ * @param event The event, valid for the duration of the call.
+ * @param arg Argument given to event_handler_subscribe().
+ */
+typedef void (*event_subscriber_fn_t)(const system_event_msg_t *event,
+                                      void *arg);
+
+/**
+ * @brief Call statistics of one subscriber.
+ */
+typedef struct {
+    const char *name;
+    system_event_t type;
+    event_context_t context;
+    uint32_t calls;    ///< Completed calls
+    uint32_t dropped;  ///< Deliveries lost, the worker queue was full
+    uint32_t max_us;   ///< Longest call
+    uint64_t total_us; ///< Time spent in all calls
+} event_subscriber_stats_t;
 
 /**
  * @brief Initializes the event handler module.
  *
- * This function creates an internal FreeRTOS task and a queue to listen for
- * system events.
+ * This function creates an internal FreeRTOS task, a static queue for
+ * urgent events and a coalescing lane for the others.
  *
  * @return
  * - ESP_OK on success.
@@ -38,7 +71,9 @@ esp_err_t event_handler_init(void);
 /**
  * @brief Deinitializes the event handler module.
  *
- * This function stops the event handling task and frees resources.
+ * This function stops the event handling, worker and alarm tasks, frees
+ * their queues and power lock, and drops every subscription; callers of
+ * event_handler_subscribe() must register again after the next init.
  *
  * @return ESP_OK on success.
  */
@@ -50,13 +85,90 @@ esp_err_t event_handler_deinit(void);
  * This is the primary function for other modules to
  * notify the event handler of significant occurrences.
  *
- * @param event The event to be sent.
+ * @param event The event to be sent, without payload.
  * @return
  * - ESP_OK on success.
- * - ESP_FAIL if the queue is full or not initialized.
+ * - ESP_FAIL if the urgent lane is full or not initialized.
  */
 esp_err_t event_handler_send_event(system_event_t event);
 
+/**
+ * @brief Sends an event with its payload.
+ *
+ * The message is copied. Its sequence number is assigned here, and its
+ * timestamp too when left at 0.
+ *
+ * @param msg The event to be sent.
+ * @return
+ * - ESP_OK on success.
+ * - ESP_FAIL if the urgent lane is full or not initialized.
+ */
+esp_err_t event_handler_send_msg(const system_event_msg_t *msg);
+
+/**
+ * @brief Registers a callback for one event type.
+ *
+ * Subscribers of a type are called in registration order, each in its own
+ * context. A callback may subscribe to several types with several calls.
+ * There is no unsubscribe; register at startup. event_handler_deinit()
+ * drops every subscription.
+ *
+ * @param type Event type.
+ * @param name Name in statistics and logs, must stay valid.
+ * @param fn Callback.
+ * @param arg Passed to @p fn.
+ * @param context Inline for short, non-blocking reactions; worker for the
+ * rest.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad type or
+ * callback, ESP_ERR_NO_MEM when CONFIG_EVENT_HANDLER_MAX_SUBSCRIBERS are
+ * registered.
+ */
+esp_err_t event_handler_subscribe(system_event_t type, const char *name,
+                                  event_subscriber_fn_t fn, void *arg,
+                                  event_context_t context);
+
+/**
+ * @brief Copies the statistics of every subscriber.
+ *
+ * @param[out] stats Array for the statistics.
+ * @param max Capacity of @p stats.
+ * @return Number of subscribers, may exceed @p max.
+ */
+size_t event_handler_get_subscriber_stats(event_subscriber_stats_t *stats,
+                                          size_t max);
+
+/**
+ * @brief Returns the lane counters.
+ *
+ * @param[out] stats Counters since init.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if @p stats is NULL.
+ */
+esp_err_t event_handler_get_stats(event_handler_stats_t *stats);
+
+/**
+ * @brief ISR-safe event_handler_send_event().
+ *
+ * @param event The event to be sent, without payload.
+ * @param[out] higher_priority_task_woken Set to pdTRUE when a context
+ * switch should be requested before the ISR returns, may be NULL.
+ * @return ESP_OK on success, ESP_FAIL if the urgent lane is full or not
+ * initialized.
+ */
+esp_err_t event_handler_send_event_from_isr(
+    system_event_t event, BaseType_t *higher_priority_task_woken);
+
+/**
+ * @brief ISR-safe event_handler_send_msg().
+ *
+ * @param msg The event to be sent.
+ * @param[out] higher_priority_task_woken Set to pdTRUE when a context
+ * switch should be requested before the ISR returns, may be NULL.
+ * @return ESP_OK on success, ESP_FAIL if the urgent lane is full or not
+ * initialized.
+ */
+esp_err_t event_handler_send_msg_from_isr(
+    const system_event_msg_t *msg, BaseType_t *higher_priority_task_woken);
+
 #ifdef __cplusplus
 }
 #endif
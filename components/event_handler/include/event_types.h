@@ -0,0 +1,86 @@
+/**
+ * @file event_types.h
+ * @brief System events and their payloads.
+ *
+ * Kept apart from event_handler.h so code without FreeRTOS can use them.
+ */
+#ifndef _EVENT_TYPES_H_
+#define _EVENT_TYPES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "data_manager_types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Enum of system events to be handled.
+ *
+ * This provides a simple, structured way to pass different event types
+ * through the event queue.
+ */
+typedef enum {
+    EVENT_NONE = 0,
+    EVENT_FALL_DETECTED,
+    EVENT_WIFI_CONNECTED,
+    EVENT_MQTT_CONNECTED,
+    EVENT_FALL_ALERT_SENT, ///< SMS/MQTT alert for the last fall is out
+    EVENT_FALL_LONG_LIE,   ///< Wearer still motionless long after the fall
+    EVENT_FALL_RECOVERED,  ///< Wearer moving again after the fall
+    EVENT_GPS_UPDATED,     ///< New GPS reading from the modem
+    EVENT_MAX
+} system_event_t;
+
+/**
+ * @brief Impact that confirmed a fall, for EVENT_FALL_DETECTED.
+ */
+typedef struct {
+    uint32_t peak_mg;    ///< Largest |a| in the feature window
+    int16_t accel_mg[3]; ///< Acceleration of the confirming frame
+    uint32_t alert_id;   ///< alert_trace ID, 0 if untraced
+} event_impact_t;
+
+/**
+ * @brief Posture of the wearer after a fall, for EVENT_FALL_LONG_LIE and
+ * EVENT_FALL_RECOVERED.
+ */
+typedef struct {
+    int16_t accel_mg[3];    ///< Acceleration, mostly gravity while lying
+    uint32_t still_ms;      ///< Motionless time since the fall
+    uint32_t since_fall_ms; ///< Time since the fall
+} event_orientation_t;
+
+/**
+ * @brief Link details, for EVENT_WIFI_CONNECTED and EVENT_MQTT_CONNECTED.
+ */
+typedef struct {
+    uint32_t ip4_addr;    ///< Station address, network byte order (Wi-Fi)
+    int8_t rssi;          ///< Signal strength in dBm (Wi-Fi), 0 if unknown
+    bool session_present; ///< The broker kept the session (MQTT)
+} event_connection_t;
+
+/**
+ * @brief Event with its payload, copied by value through the queue.
+ *
+ * Fixed size, so sending never allocates. Which member of @c data is valid
+ * depends on @c type; events without a payload leave it zeroed.
+ */
+typedef struct {
+    system_event_t type;
+    uint32_t seq;         ///< Assigned on send, increments per event
+    int64_t timestamp_us; ///< When it happened (esp_timer), 0 = on send
+    union {
+        event_impact_t impact;           ///< EVENT_FALL_DETECTED
+        event_orientation_t orientation; ///< EVENT_FALL_LONG_LIE/RECOVERED
+        gps_data_t gps;                  ///< EVENT_GPS_UPDATED
+        event_connection_t connection;   ///< EVENT_WIFI/MQTT_CONNECTED
+    } data;
+} system_event_msg_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _EVENT_TYPES_H_
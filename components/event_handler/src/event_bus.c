@@ -0,0 +1,204 @@
+/**
+ * @file event_bus.c
+ * @brief Subscriber table and dispatch.
+ *
+ * The table is append-only while the bus runs: an entry is filled before
+ * the count that publishes it is incremented, so the dispatcher reads it
+ * without a lock. event_bus_deinit() empties it.
+ * The statistics of a subscriber are written only by the task it runs on
+ * and read under s_stats_mux.
+ */
+
+#include "event_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "task_topology.h"
+#include <stdatomic.h>
+
+static const char *TAG = "EVENT_BUS";
+
+#define MAX_SUBSCRIBERS CONFIG_EVENT_HANDLER_MAX_SUBSCRIBERS
+#define WORKER_QUEUE_LENGTH CONFIG_EVENT_HANDLER_WORKER_QUEUE_LENGTH
+#define SLOW_US CONFIG_EVENT_HANDLER_SLOW_US
+#define WORKER_TASK_STACK_SIZE 3072
+
+typedef struct {
+  system_event_t type;
+  const char *name;
+  event_subscriber_fn_t fn;
+  void *arg;
+  event_context_t context;
+  // Statistics, guarded by s_stats_mux
+  uint32_t calls;
+  uint32_t dropped;
+  uint32_t max_us;
+  uint64_t total_us;
+} subscriber_t;
+
+/**
+ * @brief Worker queue entry.
+ */
+typedef struct {
+  uint32_t subscriber;
+  system_event_msg_t event;
+} delivery_t;
+
+static subscriber_t s_subscribers[MAX_SUBSCRIBERS];
+static atomic_uint s_count = 0;
+static portMUX_TYPE s_subscribe_mux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static StaticQueue_t s_worker_queue_buf;
+static uint8_t s_worker_queue_storage[WORKER_QUEUE_LENGTH *
+                                      sizeof(delivery_t)];
+static QueueHandle_t s_worker_queue = NULL;
+static StackType_t s_worker_stack[WORKER_TASK_STACK_SIZE];
+static StaticTask_t s_worker_tcb;
+static TaskHandle_t s_worker_task = NULL;
+
+/**
+ * @brief Calls a subscriber and records how long it took.
+ */
+static void call(subscriber_t *sub, const system_event_msg_t *event) {
+  int64_t start_us = esp_timer_get_time();
+  sub->fn(event, sub->arg);
+  uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+  taskENTER_CRITICAL(&s_stats_mux);
+  sub->calls++;
+  sub->total_us += elapsed_us;
+  if (elapsed_us > sub->max_us) {
+    sub->max_us = elapsed_us;
+  }
+  taskEXIT_CRITICAL(&s_stats_mux);
+
+  if (elapsed_us > SLOW_US) {
+    ESP_LOGW(TAG, "Subscriber %s took %lu us for event %d", sub->name,
+             (unsigned long)elapsed_us, event->type);
+  }
+}
+
+static void event_worker_task(void *param) {
+  delivery_t delivery;
+  while (1) {
+    if (xQueueReceive(s_worker_queue, &delivery, portMAX_DELAY) == pdTRUE) {
+      call(&s_subscribers[delivery.subscriber], &delivery.event);
+    }
+  }
+}
+
+esp_err_t event_bus_init(void) {
+  if (s_worker_queue != NULL) {
+    return ESP_OK;
+  }
+
+  s_worker_queue =
+      xQueueCreateStatic(WORKER_QUEUE_LENGTH, sizeof(delivery_t),
+                         s_worker_queue_storage, &s_worker_queue_buf);
+  if (task_topology_create_static(TASK_TOPOLOGY_EVENT_WORKER,
+                                  event_worker_task, sizeof(s_worker_stack),
+                                  NULL, s_worker_stack, &s_worker_tcb,
+                                  &s_worker_task) != ESP_OK) {
+    vQueueDelete(s_worker_queue);
+    s_worker_queue = NULL;
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+void event_bus_deinit(void) {
+  if (s_worker_task != NULL) {
+    vTaskDelete(s_worker_task);
+    s_worker_task = NULL;
+  }
+  if (s_worker_queue != NULL) {
+    vQueueDelete(s_worker_queue);
+    s_worker_queue = NULL;
+  }
+
+  taskENTER_CRITICAL(&s_subscribe_mux);
+  atomic_store_explicit(&s_count, 0, memory_order_release);
+  taskEXIT_CRITICAL(&s_subscribe_mux);
+}
+
+void event_bus_dispatch(const system_event_msg_t *event) {
+  uint32_t count = atomic_load_explicit(&s_count, memory_order_acquire);
+  bool delivered = false;
+
+  for (uint32_t i = 0; i < count; i++) {
+    subscriber_t *sub = &s_subscribers[i];
+    if (sub->type != event->type) {
+      continue;
+    }
+    delivered = true;
+
+    if (sub->context == EVENT_CONTEXT_INLINE) {
+      call(sub, event);
+      continue;
+    }
+
+    delivery_t delivery = {.subscriber = i, .event = *event};
+    if (s_worker_queue == NULL ||
+        xQueueSend(s_worker_queue, &delivery, 0) != pdTRUE) {
+      taskENTER_CRITICAL(&s_stats_mux);
+      sub->dropped++;
+      taskEXIT_CRITICAL(&s_stats_mux);
+      ESP_LOGE(TAG, "Worker queue full, event %d to %s dropped", event->type,
+               sub->name);
+    }
+  }
+
+  if (!delivered) {
+    ESP_LOGD(TAG, "No subscriber for event %d", event->type);
+  }
+}
+
+esp_err_t event_handler_subscribe(system_event_t type, const char *name,
+                                  event_subscriber_fn_t fn, void *arg,
+                                  event_context_t context) {
+  if (type <= EVENT_NONE || type >= EVENT_MAX || fn == NULL ||
+      (context != EVENT_CONTEXT_INLINE && context != EVENT_CONTEXT_WORKER)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // Serializes writers only; the dispatcher sees the entry once counted
+  taskENTER_CRITICAL(&s_subscribe_mux);
+  uint32_t index = atomic_load_explicit(&s_count, memory_order_relaxed);
+  if (index >= MAX_SUBSCRIBERS) {
+    taskEXIT_CRITICAL(&s_subscribe_mux);
+    ESP_LOGE(TAG, "No room for subscriber %s", name ? name : "?");
+    return ESP_ERR_NO_MEM;
+  }
+  s_subscribers[index] = (subscriber_t){
+      .type = type,
+      .name = name ? name : "?",
+      .fn = fn,
+      .arg = arg,
+      .context = context,
+  };
+  atomic_store_explicit(&s_count, index + 1, memory_order_release);
+  taskEXIT_CRITICAL(&s_subscribe_mux);
+  return ESP_OK;
+}
+
+size_t event_handler_get_subscriber_stats(event_subscriber_stats_t *stats,
+                                          size_t max) {
+  uint32_t count = atomic_load_explicit(&s_count, memory_order_acquire);
+  for (uint32_t i = 0; i < count && i < max; i++) {
+    const subscriber_t *sub = &s_subscribers[i];
+    event_subscriber_stats_t *out = &stats[i];
+    out->name = sub->name;
+    out->type = sub->type;
+    out->context = sub->context;
+    taskENTER_CRITICAL(&s_stats_mux);
+    out->calls = sub->calls;
+    out->dropped = sub->dropped;
+    out->max_us = sub->max_us;
+    out->total_us = sub->total_us;
+    taskEXIT_CRITICAL(&s_stats_mux);
+  }
+  return count;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file event_bus.h
+ * @brief Subscriber table and dispatch, private to event_handler.
+ */
+#ifndef _EVENT_BUS_H_
+#define _EVENT_BUS_H_
+
+#include "event_handler.h"
+
+/**
+ * @brief Creates the worker task and its queue.
+ *
+ * @return ESP_OK on success, ESP_FAIL if the worker could not be created.
+ */
+esp_err_t event_bus_init(void);
+
+/**
+ * @brief Deletes the worker task and its queue and drops every
+ * subscription, so the next event_bus_init() starts from an empty table.
+ *
+ * Call only once nothing dispatches or subscribes any more.
+ */
+void event_bus_deinit(void);
+
+/**
+ * @brief Delivers an event to its subscribers: inline ones are called
+ * before returning, worker ones are queued.
+ */
+void event_bus_dispatch(const system_event_msg_t *event);
+
+#endif // _EVENT_BUS_H_
@@ -0,0 +1,47 @@
+/**
+ * @file event_coalesce.c
+ * @brief Background event lane that keeps one pending event per type.
+ */
+
+#include "event_coalesce.h"
+#include <string.h>
+
+_Static_assert(EVENT_MAX <= 32, "pending_mask has one bit per event type");
+
+void event_coalesce_init(event_coalesce_t *lane) {
+  memset(lane, 0, sizeof(*lane));
+}
+
+bool event_coalesce_push(event_coalesce_t *lane,
+                         const system_event_msg_t *event) {
+  uint32_t bit = 1u << event->type;
+  bool coalesced = (lane->pending_mask & bit) != 0;
+  lane->slots[event->type] = *event;
+  lane->pending_mask |= bit;
+  return coalesced;
+}
+
+bool event_coalesce_pop(event_coalesce_t *lane, system_event_msg_t *event) {
+  int oldest = -1;
+  for (int type = 0; type < EVENT_MAX; type++) {
+    if ((lane->pending_mask & (1u << type)) == 0) {
+      continue;
+    }
+    // Sequence numbers wrap, compare their distance
+    if (oldest < 0 ||
+        (int32_t)(lane->slots[type].seq - lane->slots[oldest].seq) < 0) {
+      oldest = type;
+    }
+  }
+  if (oldest < 0) {
+    return false;
+  }
+
+  *event = lane->slots[oldest];
+  lane->pending_mask &= ~(1u << oldest);
+  return true;
+}
+
+uint32_t event_coalesce_pending(const event_coalesce_t *lane) {
+  return (uint32_t)__builtin_popcount(lane->pending_mask);
+}
@@ -1,35 +1,101 @@
 #include "event_handler.h"
+#include "alert_trace.h"
 #include "buzzer.h"
-#include "data_manager.h"
+#include "event_bus.h"
+#include "event_coalesce.h"
+#include "fall_capture.h"
 #include "fall_logic.h"
 #include "led_indicator.h"
+#include "power_manager.h"
 #include "sim4g_gps.h"
+#include "task_topology.h"
 
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
+#include <stdatomic.h>
+#include <string.h>
 
 #define ALERT_DURATION_MS 8000
-#define EVENT_QUEUE_LENGTH 10
+#define LONG_LIE_ALARM_MS 15000
+#define URGENT_QUEUE_LENGTH 8
 #define EVENT_HANDLER_TASK_STACK_SIZE 4096
-#define EVENT_HANDLER_TASK_PRIORITY 5
+#define ALARM_TASK_STACK_SIZE 2048
+#define ALARM_QUEUE_LENGTH 4
 
 static const char *TAG = "EVENT_HANDLER";
 
-static QueueHandle_t s_event_queue_handle = NULL;
+// Urgent lane: fall, long-lie and recovery events, in order
+static StaticQueue_t s_urgent_queue_buf;
+static uint8_t s_urgent_queue_storage[URGENT_QUEUE_LENGTH *
+                                      sizeof(system_event_msg_t)];
+static QueueHandle_t s_urgent_queue = NULL;
 static TaskHandle_t s_event_handler_task_handle = NULL;
 
+// Background lane and the counters of both lanes, guarded by s_lane_mux
+static event_coalesce_t s_background;
+static event_handler_stats_t s_stats;
+static portMUX_TYPE s_lane_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Sequence number of the next event, shared with ISRs
+static atomic_uint s_next_seq = 0;
+
+// Latest GPS reading and when it was taken, owned by event_handler_task
+static gps_data_t s_gps = {0};
+static int64_t s_gps_us = 0;
+
+// LEDC stops in light sleep, so the buzzer needs the chip awake. Held
+// by the alarm worker during a sequence, guarded by s_alarm_mux so deinit
+// knows whether a deleted worker left it taken.
+static power_lock_t s_alert_lock = NULL;
+static bool s_alert_lock_held = false;
+static portMUX_TYPE s_alarm_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// A long-lie alert went out and its recovery notice has not
+static bool s_long_lie_alerted = false;
+
+/**
+ * @brief Buzzer and LED sequences run by the alarm worker.
+ */
+typedef enum {
+  ALARM_FALL,     ///< Beep, blink, then reset the fall status
+  ALARM_LONG_LIE, ///< Longer beep, LED left blinking
+} alarm_kind_t;
+
+// The alarm worker and its queue live in static memory, so a fall never
+// waits for the heap or for a task to be created
+static StaticQueue_t s_alarm_queue_buf;
+static uint8_t s_alarm_queue_storage[ALARM_QUEUE_LENGTH *
+                                     sizeof(alarm_kind_t)];
+static QueueHandle_t s_alarm_queue = NULL;
+static StackType_t s_alarm_stack[ALARM_TASK_STACK_SIZE];
+static StaticTask_t s_alarm_tcb;
+static TaskHandle_t s_alarm_task_handle = NULL;
+
+static void alert_lock_take(void) {
+  taskENTER_CRITICAL(&s_alarm_mux);
+  power_manager_lock_acquire(s_alert_lock);
+  s_alert_lock_held = true;
+  taskEXIT_CRITICAL(&s_alarm_mux);
+}
+
+static void alert_lock_give(void) {
+  taskENTER_CRITICAL(&s_alarm_mux);
+  power_manager_lock_release(s_alert_lock);
+  s_alert_lock_held = false;
+  taskEXIT_CRITICAL(&s_alarm_mux);
+}
+
 /**
- * @brief A short-lived task to handle the immediate, time-consuming alert
- * sequence.
- * * This task will run the buzzer and LED for the specified duration and then
- * clean up. This prevents the main event_handler_task from being blocked.
+ * @brief Runs the buzzer and LED after a fall, then resets the fall status.
  */
-static void alert_sequence_task(void *param) {
-  ESP_LOGI(TAG, "Alert sequence task started.");
+static void run_fall_alarm(void) {
+  ESP_LOGI(TAG, "Alert sequence started.");
 
+  alert_lock_take();
   buzzer_beep(ALERT_DURATION_MS);
   led_indicator_set_mode(LED_MODE_BLINK_ERROR);
 
@@ -41,73 +107,300 @@ static void alert_sequence_task(void *param) {
   // Once the alert sequence is complete, reset the fall status
   fall_logic_reset_fall_status();
   ESP_LOGI(TAG, "Alert sequence completed. Fall status has been reset.");
+  alert_lock_give();
+}
+
+/**
+ * @brief Sounds the long-lie alarm.
+ *
+ * The LED keeps blinking after the buzzer stops, until the wearer recovers.
+ */
+static void run_long_lie_alarm(void) {
+  alert_lock_take();
+  led_indicator_set_mode(LED_MODE_BLINK_ERROR);
+  buzzer_beep(LONG_LIE_ALARM_MS);
+  alert_lock_give();
+}
+
+/**
+ * @brief Persistent worker running the blocking buzzer and LED sequences,
+ * so event_handler_task is never blocked by them.
+ */
+static void alarm_task(void *param) {
+  alarm_kind_t alarm;
+  while (1) {
+    if (xQueueReceive(s_alarm_queue, &alarm, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    if (alarm == ALARM_LONG_LIE) {
+      run_long_lie_alarm();
+    } else {
+      run_fall_alarm();
+    }
+  }
+}
+
+/**
+ * @brief Queues an alarm for the alarm worker.
+ */
+static void start_alarm(alarm_kind_t alarm) {
+  if (xQueueSend(s_alarm_queue, &alarm, 0) != pdTRUE) {
+    ESP_LOGE(TAG, "Alarm queue full, alarm %d dropped", alarm);
+  }
+}
+
+/**
+ * @brief Latest GPS reading for an alert, with its age in the log.
+ */
+static void get_alert_location(const system_event_msg_t *event,
+                               gps_data_t *location) {
+  *location = s_gps;
+  if (s_gps_us == 0) {
+    ESP_LOGW(TAG, "No GPS reading yet");
+  } else {
+    ESP_LOGI(TAG, "GPS reading taken %ld s before the event (fix: %s)",
+             (long)((event->timestamp_us - s_gps_us) / 1000000),
+             s_gps.has_gps_fix ? "yes" : "no");
+  }
+}
+
+/**
+ * @brief Events that must not wait behind, or be merged with, others.
+ */
+static bool is_urgent(system_event_t type) {
+  return type == EVENT_FALL_DETECTED || type == EVENT_FALL_LONG_LIE ||
+         type == EVENT_FALL_RECOVERED;
+}
+
+/**
+ * @brief Called by sim4g_gps from its alert task once the alert is out.
+ */
+static void on_fall_alert_sent(void) {
+  event_handler_send_event(EVENT_FALL_ALERT_SENT);
+}
+
+static void on_fall_detected(const system_event_msg_t *event, void *arg) {
+  const event_impact_t *impact = &event->data.impact;
+  alert_trace_mark(impact->alert_id, ALERT_STAGE_DISPATCHED);
+  ESP_LOGI(TAG,
+           "Received EVENT_FALL_DETECTED #%lu (%ld us ago, peak %lu mg). "
+           "Triggering alert.",
+           (unsigned long)event->seq,
+           (long)(esp_timer_get_time() - event->timestamp_us),
+           (unsigned long)impact->peak_mg);
+
+  gps_data_t location;
+  get_alert_location(event, &location);
+
+  // Hand the SMS/MQTT alert to its worker (non-blocking). Without it no
+  // EVENT_FALL_ALERT_SENT would release the capture of this fall, and the
+  // next fall could not trigger its own.
+  if (sim4g_gps_start_fall_alert(&location, impact->alert_id) != ESP_OK) {
+    ESP_LOGE(TAG, "Fall alert not queued, releasing the capture");
+    fall_capture_upload();
+  }
+
+  // The blocking buzzer and LED sequence runs on the alarm worker
+  start_alarm(ALARM_FALL);
+}
+
+static void on_long_lie(const system_event_msg_t *event, void *arg) {
+  ESP_LOGW(TAG, "Received EVENT_FALL_LONG_LIE. Escalating alert.");
+
+  gps_data_t location;
+  get_alert_location(event, &location);
+  sim4g_gps_start_alert(SIM4G_ALERT_LONG_LIE, &location,
+                        event->data.orientation.still_ms / 1000);
+  s_long_lie_alerted = true;
+
+  start_alarm(ALARM_LONG_LIE);
+}
+
+static void on_recovered(const system_event_msg_t *event, void *arg) {
+  ESP_LOGI(TAG, "Received EVENT_FALL_RECOVERED. Wearer is moving.");
+  buzzer_stop();
+  led_indicator_set_mode(LED_MODE_OFF);
+
+  // Only a long-lie alert needs to be called off
+  if (s_long_lie_alerted) {
+    gps_data_t location;
+    get_alert_location(event, &location);
+    sim4g_gps_start_alert(SIM4G_ALERT_RECOVERED, &location,
+                          event->data.orientation.still_ms / 1000);
+    s_long_lie_alerted = false;
+  }
+}
+
+static void on_alert_out(const system_event_msg_t *event, void *arg) {
+  ESP_LOGI(TAG, "Received EVENT_FALL_ALERT_SENT. Uploading capture.");
+  // Bulk data only after the urgent alert
+  fall_capture_upload();
+}
 
-  vTaskDelete(NULL);
+static void on_wifi_connected(const system_event_msg_t *event, void *arg) {
+  const event_connection_t *conn = &event->data.connection;
+  // Network byte order, first octet in the low byte
+  uint32_t ip = conn->ip4_addr;
+  ESP_LOGI(TAG, "Received EVENT_WIFI_CONNECTED (%u.%u.%u.%u, %d dBm).",
+           (unsigned)(ip & 0xff), (unsigned)((ip >> 8) & 0xff),
+           (unsigned)((ip >> 16) & 0xff), (unsigned)(ip >> 24), conn->rssi);
+}
+
+static void on_mqtt_connected(const system_event_msg_t *event, void *arg) {
+  ESP_LOGI(TAG, "Received EVENT_MQTT_CONNECTED (session %s).",
+           event->data.connection.session_present ? "kept" : "new");
+}
+
+static void on_gps_updated(const system_event_msg_t *event, void *arg) {
+  s_gps = event->data.gps;
+  s_gps_us = event->timestamp_us;
+}
+
+/**
+ * @brief Reactions of the event handler itself. All are short and run
+ * inline, on the task that also owns s_gps and s_long_lie_alerted.
+ */
+static const struct {
+  system_event_t type;
+  const char *name;
+  event_subscriber_fn_t fn;
+} s_builtin[] = {
+    {EVENT_GPS_UPDATED, "gps_cache", on_gps_updated},
+    {EVENT_FALL_DETECTED, "fall_alert", on_fall_detected},
+    {EVENT_FALL_LONG_LIE, "long_lie_alert", on_long_lie},
+    {EVENT_FALL_RECOVERED, "recovery", on_recovered},
+    {EVENT_FALL_ALERT_SENT, "capture_upload", on_alert_out},
+    {EVENT_WIFI_CONNECTED, "wifi_log", on_wifi_connected},
+    {EVENT_MQTT_CONNECTED, "mqtt_log", on_mqtt_connected},
+};
+
+#define BUILTIN_COUNT (sizeof(s_builtin) / sizeof(s_builtin[0]))
+
+/**
+ * @brief Takes the next event: any urgent one first, then the oldest
+ * background one.
+ */
+static bool next_event(system_event_msg_t *event) {
+  if (xQueueReceive(s_urgent_queue, event, 0) == pdTRUE) {
+    return true;
+  }
+  taskENTER_CRITICAL(&s_lane_mux);
+  bool found = event_coalesce_pop(&s_background, event);
+  taskEXIT_CRITICAL(&s_lane_mux);
+  return found;
 }
 
 static void event_handler_task(void *param) {
-  system_event_t event;
+  system_event_msg_t event;
+  uint32_t urgent_dropped = 0;
 
   ESP_LOGI(TAG, "Event handler task started");
 
   while (1) {
-    if (xQueueReceive(s_event_queue_handle, &event, portMAX_DELAY)) {
-      switch (event) {
-      case EVENT_FALL_DETECTED: {
-        ESP_LOGI(TAG, "Received EVENT_FALL_DETECTED. Triggering alert.");
+    // Every send notifies; drain both lanes after each wake-up
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (next_event(&event)) {
+      event_bus_dispatch(&event);
+    }
 
-        // Get the latest GPS data from the data_manager
-        gps_data_t location = {0};
-        data_manager_get_gps_data(&location);
+    // Senders may be ISRs, so drops are logged here
+    taskENTER_CRITICAL(&s_lane_mux);
+    uint32_t dropped = s_stats.urgent_dropped;
+    taskEXIT_CRITICAL(&s_lane_mux);
+    if (dropped != urgent_dropped) {
+      ESP_LOGE(TAG, "%lu urgent events dropped so far",
+               (unsigned long)dropped);
+      urgent_dropped = dropped;
+    }
+  }
+}
 
-        // Start the SMS/MQTT task (non-blocking)
-        sim4g_gps_start_fall_alert(&location);
+/**
+ * @brief Stops the tasks and frees what event_handler_init() created, as
+ * far as it got. Leaves every handle NULL so init can run again on the
+ * same static buffers.
+ */
+static void teardown(void) {
+  if (s_event_handler_task_handle != NULL) {
+    vTaskDelete(s_event_handler_task_handle);
+    s_event_handler_task_handle = NULL;
+  }
+  event_bus_deinit();
 
-        // Start the blocking alert sequence in a separate task
-        xTaskCreate(alert_sequence_task, "alert_seq_task", 2048, NULL, 4, NULL);
+  if (s_alarm_task_handle != NULL) {
+    vTaskDelete(s_alarm_task_handle);
+    s_alarm_task_handle = NULL;
+  }
+  // A sequence cut short leaves the buzzer on and the lock taken
+  if (s_alert_lock_held) {
+    buzzer_stop();
+    led_indicator_set_mode(LED_MODE_OFF);
+    alert_lock_give();
+  }
+  power_manager_lock_delete(s_alert_lock);
+  s_alert_lock = NULL;
 
-        break;
-      }
-      case EVENT_WIFI_CONNECTED:
-        ESP_LOGI(TAG, "Received EVENT_WIFI_CONNECTED.");
-        // Your non-blocking logic for WiFi connected, e.g., MQTT reconnect.
-        break;
-
-      case EVENT_MQTT_CONNECTED:
-        ESP_LOGI(TAG, "Received EVENT_MQTT_CONNECTED.");
-        // Your non-blocking logic for MQTT connected.
-        break;
-
-      default:
-        ESP_LOGI(TAG, "Received unknown event: %d. Ignored.", event);
-        break;
-      }
-    }
+  if (s_alarm_queue != NULL) {
+    vQueueDelete(s_alarm_queue);
+    s_alarm_queue = NULL;
+  }
+  if (s_urgent_queue != NULL) {
+    vQueueDelete(s_urgent_queue);
+    s_urgent_queue = NULL;
   }
+  s_long_lie_alerted = false;
 }
 
 // (event_handler_init, event_handler_deinit, event_handler_send_event)
 esp_err_t event_handler_init(void) {
-  if (s_event_queue_handle != NULL || s_event_handler_task_handle != NULL) {
+  if (s_urgent_queue != NULL || s_event_handler_task_handle != NULL) {
     ESP_LOGW(TAG, "Event handler already initialized");
     return ESP_ERR_INVALID_STATE;
   }
 
-  s_event_queue_handle =
-      xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(system_event_t));
-  if (s_event_queue_handle == NULL) {
+  s_urgent_queue =
+      xQueueCreateStatic(URGENT_QUEUE_LENGTH, sizeof(system_event_msg_t),
+                         s_urgent_queue_storage, &s_urgent_queue_buf);
+  if (s_urgent_queue == NULL) {
     ESP_LOGE(TAG, "Failed to create event queue");
     return ESP_FAIL;
   }
+  event_coalesce_init(&s_background);
+  memset(&s_stats, 0, sizeof(s_stats));
+
+  if (power_manager_lock_create("alert", &s_alert_lock) != ESP_OK) {
+    ESP_LOGW(TAG, "No power lock, buzzer may stop during light sleep");
+  }
+
+  sim4g_gps_set_alert_sent_cb(on_fall_alert_sent);
+
+  // Deinit drops every subscription, so the builtins are made on each init
+  for (size_t i = 0; i < BUILTIN_COUNT; i++) {
+    event_handler_subscribe(s_builtin[i].type, s_builtin[i].name,
+                            s_builtin[i].fn, NULL, EVENT_CONTEXT_INLINE);
+  }
+  if (event_bus_init() != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create event worker task");
+    teardown();
+    return ESP_FAIL;
+  }
 
-  BaseType_t result = xTaskCreate(
-      event_handler_task, "event_handler_task", EVENT_HANDLER_TASK_STACK_SIZE,
-      NULL, EVENT_HANDLER_TASK_PRIORITY, &s_event_handler_task_handle);
+  s_alarm_queue = xQueueCreateStatic(ALARM_QUEUE_LENGTH, sizeof(alarm_kind_t),
+                                     s_alarm_queue_storage, &s_alarm_queue_buf);
+  if (task_topology_create_static(TASK_TOPOLOGY_ALARM, alarm_task,
+                                  sizeof(s_alarm_stack), NULL, s_alarm_stack,
+                                  &s_alarm_tcb,
+                                  &s_alarm_task_handle) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create alarm task");
+    teardown();
+    return ESP_FAIL;
+  }
 
-  if (result != pdPASS) {
+  if (task_topology_create(TASK_TOPOLOGY_EVENT, event_handler_task,
+                           EVENT_HANDLER_TASK_STACK_SIZE, NULL,
+                           &s_event_handler_task_handle) != ESP_OK) {
     ESP_LOGE(TAG, "Failed to create event handler task");
-    vQueueDelete(s_event_queue_handle);
-    s_event_queue_handle = NULL;
+    teardown();
     return ESP_FAIL;
   }
 
@@ -116,30 +409,134 @@ esp_err_t event_handler_init(void) {
 }
 
 esp_err_t event_handler_deinit(void) {
-  if (s_event_handler_task_handle != NULL) {
-    vTaskDelete(s_event_handler_task_handle);
-    s_event_handler_task_handle = NULL;
+  teardown();
+  ESP_LOGI(TAG, "Event handler deinitialized");
+  return ESP_OK;
+}
+
+/**
+ * @brief Copies @p msg and assigns its sequence number and timestamp.
+ *
+ * Safe from ISRs: esp_timer_get_time() and the atomic are.
+ */
+static void stamp(const system_event_msg_t *msg, system_event_msg_t *out) {
+  *out = *msg;
+  out->seq = atomic_fetch_add_explicit(&s_next_seq, 1, memory_order_relaxed);
+  if (out->timestamp_us == 0) {
+    out->timestamp_us = esp_timer_get_time();
   }
+}
 
-  if (s_event_queue_handle != NULL) {
-    vQueueDelete(s_event_queue_handle);
-    s_event_queue_handle = NULL;
+static void lane_lock(bool from_isr) {
+  if (from_isr) {
+    taskENTER_CRITICAL_ISR(&s_lane_mux);
+  } else {
+    taskENTER_CRITICAL(&s_lane_mux);
   }
+}
 
-  ESP_LOGI(TAG, "Event handler deinitialized");
-  return ESP_OK;
+static void lane_unlock(bool from_isr) {
+  if (from_isr) {
+    taskEXIT_CRITICAL_ISR(&s_lane_mux);
+  } else {
+    taskEXIT_CRITICAL(&s_lane_mux);
+  }
 }
 
-esp_err_t event_handler_send_event(system_event_t event) {
-  if (s_event_queue_handle == NULL) {
-    ESP_LOGE(TAG, "Event handler not initialized");
+/**
+ * @brief Puts an event in its lane and wakes the handler task.
+ *
+ * @param msg Event to send.
+ * @param from_isr Called from an ISR.
+ * @param[out] woken Context switch request, ISR only, may be NULL.
+ */
+static esp_err_t post(const system_event_msg_t *msg, bool from_isr,
+                      BaseType_t *woken) {
+  TaskHandle_t task = s_event_handler_task_handle;
+  if (task == NULL) {
     return ESP_ERR_INVALID_STATE;
   }
+  if (msg->type <= EVENT_NONE || msg->type >= EVENT_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
 
-  BaseType_t ret = xQueueSend(s_event_queue_handle, &event, pdMS_TO_TICKS(10));
-  if (ret != pdPASS) {
-    ESP_LOGE(TAG, "Failed to send event to queue. Queue full?");
-    return ESP_FAIL;
+  system_event_msg_t event;
+  stamp(msg, &event);
+
+  esp_err_t err = ESP_OK;
+  if (is_urgent(event.type)) {
+    BaseType_t sent;
+    UBaseType_t waiting;
+    if (from_isr) {
+      sent = xQueueSendFromISR(s_urgent_queue, &event, woken);
+      waiting = uxQueueMessagesWaitingFromISR(s_urgent_queue);
+    } else {
+      sent = xQueueSend(s_urgent_queue, &event, pdMS_TO_TICKS(10));
+      waiting = uxQueueMessagesWaiting(s_urgent_queue);
+    }
+
+    lane_lock(from_isr);
+    if (sent == pdPASS) {
+      s_stats.urgent_sent++;
+      if (waiting > s_stats.urgent_high_water) {
+        s_stats.urgent_high_water = waiting;
+      }
+    } else {
+      s_stats.urgent_dropped++;
+      err = ESP_FAIL;
+    }
+    lane_unlock(from_isr);
+  } else {
+    lane_lock(from_isr);
+    s_stats.background_sent++;
+    if (event_coalesce_push(&s_background, &event)) {
+      s_stats.background_coalesced++;
+    }
+    lane_unlock(from_isr);
+  }
+
+  // Also on a drop, so the handler task reports it
+  if (from_isr) {
+    vTaskNotifyGiveFromISR(task, woken);
+  } else {
+    xTaskNotifyGive(task);
+  }
+  return err;
+}
+
+esp_err_t event_handler_send_msg(const system_event_msg_t *msg) {
+  esp_err_t err = post(msg, false, NULL);
+  if (err == ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(TAG, "Event handler not initialized");
+  } else if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to send event %d: %s", msg->type,
+             esp_err_to_name(err));
+  }
+  return err;
+}
+
+esp_err_t event_handler_send_event(system_event_t event) {
+  system_event_msg_t msg = {.type = event};
+  return event_handler_send_msg(&msg);
+}
+
+esp_err_t event_handler_send_msg_from_isr(
+    const system_event_msg_t *msg, BaseType_t *higher_priority_task_woken) {
+  return post(msg, true, higher_priority_task_woken);
+}
+
+esp_err_t event_handler_send_event_from_isr(
+    system_event_t event, BaseType_t *higher_priority_task_woken) {
+  system_event_msg_t msg = {.type = event};
+  return event_handler_send_msg_from_isr(&msg, higher_priority_task_woken);
+}
+
+esp_err_t event_handler_get_stats(event_handler_stats_t *stats) {
+  if (stats == NULL) {
+    return ESP_ERR_INVALID_ARG;
   }
+  taskENTER_CRITICAL(&s_lane_mux);
+  *stats = s_stats;
+  taskEXIT_CRITICAL(&s_lane_mux);
   return ESP_OK;
 }
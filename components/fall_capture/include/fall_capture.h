@@ -0,0 +1,110 @@
+/**
+ * @file fall_capture.h
+ * @brief Raw IMU capture around a fall, uploaded after the alert.
+ *
+ * The fall task feeds every frame it processes into a rolling pre-trigger
+ * buffer. On detection the buffer is frozen and the following frames fill
+ * a post-trigger window. Once the alert has gone out, a low-priority task
+ * publishes the capture as one binary MQTT message and re-arms.
+ *
+ * All storage is reserved statically; feeding and triggering only copy
+ * frames and never block.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_CAPTURE_H_
+#define _FALL_CAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include "sdkconfig.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define FALL_CAPTURE_MAGIC 0x50414346u ///< "FCAP" in little-endian order
+#define FALL_CAPTURE_VERSION 1
+
+/**
+ * @brief Header of the published blob.
+ *
+ * The blob is little-endian: this header followed by
+ * pre_frames + post_frames sensor_raw_t records (16 bytes each) in
+ * chronological order. The last pre-trigger frame is the one on which the
+ * fall was detected.
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t magic;                ///< FALL_CAPTURE_MAGIC
+  uint8_t version;               ///< FALL_CAPTURE_VERSION
+  uint8_t frame_size;            ///< sizeof(sensor_raw_t)
+  uint16_t sample_rate_hz;       ///< Nominal sample rate
+  uint16_t accel_lsb_per_g;      ///< Accelerometer scale
+  uint16_t gyro_lsb_per_dps_x10; ///< Gyroscope scale, 0.1 LSB per deg/s
+  uint16_t pre_frames;           ///< Frames up to and including the trigger
+  uint16_t post_frames;          ///< Frames after the trigger
+  uint32_t trigger_us;           ///< Timestamp of the trigger frame
+} fall_capture_header_t;
+
+#if CONFIG_FALL_CAPTURE_ENABLE
+
+/**
+ * @brief Sizes the windows for @p sample_rate_hz and starts the upload task.
+ *
+ * @param sample_rate_hz Rate at which frames will be fed.
+ * @return ESP_OK on success, ESP_FAIL if the task could not be created.
+ */
+esp_err_t fall_capture_init(uint16_t sample_rate_hz);
+
+/**
+ * @brief Appends frames to the pre- or post-trigger window.
+ *
+ * Must be called from a single task. Frames are dropped while a capture
+ * waits for upload.
+ */
+void fall_capture_feed(const sensor_raw_t *frames, size_t count);
+
+/**
+ * @brief Freezes the pre-trigger window and starts the post-trigger one.
+ *
+ * Call from the feeding task right after feeding the frame on which the
+ * fall was detected. Ignored while a previous capture is still pending.
+ *
+ * @param timestamp_us Timestamp of the trigger frame.
+ */
+void fall_capture_trigger(uint32_t timestamp_us);
+
+/**
+ * @brief Allows the pending capture to be published.
+ *
+ * Called once the urgent alert is out, or once it is known that it will
+ * not go out: a capture never released blocks every later trigger.
+ * Publishing starts as soon as the post-trigger window is complete.
+ */
+void fall_capture_upload(void);
+
+#else
+// No-op fallbacks when fall capture is disabled
+static inline esp_err_t fall_capture_init(uint16_t sample_rate_hz) {
+  (void)sample_rate_hz;
+  return ESP_OK;
+}
+static inline void fall_capture_feed(const sensor_raw_t *frames,
+                                     size_t count) {
+  (void)frames;
+  (void)count;
+}
+static inline void fall_capture_trigger(uint32_t timestamp_us) {
+  (void)timestamp_us;
+}
+static inline void fall_capture_upload(void) {}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_CAPTURE_H_
@@ -0,0 +1,278 @@
+/**
+ * @file fall_capture.c
+ * @brief Raw IMU capture around a fall, uploaded after the alert.
+ *
+ * The header and the frames share one static block so the blob can be
+ * published in place. Frames [0, pre_len) form the pre-trigger ring and
+ * frames [pre_len, pre_len + post_len) the post-trigger window. Ordering
+ * the ring chronologically is left to the upload task.
+ *
+ * The feeding task owns the ARMED -> POST -> READY transitions and the
+ * upload task owns READY -> ARMED, so the state only needs acquire/release
+ * ordering, no lock.
+ */
+
+#include "fall_capture.h"
+
+#if CONFIG_FALL_CAPTURE_ENABLE
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "mqtt_client.h"
+#include "task_topology.h"
+#include "user_mqtt.h"
+#include <stdatomic.h>
+#include <string.h>
+
+static const char *TAG = "FALL_CAPTURE";
+
+#define MAX_FRAMES CONFIG_FALL_CAPTURE_MAX_FRAMES
+
+#define CAPTURE_READY_BIT BIT0    // Post-trigger window complete
+#define UPLOAD_ALLOWED_BIT BIT1   // Alert has gone out
+
+typedef enum {
+  CAPTURE_ARMED, // Filling the pre-trigger ring
+  CAPTURE_POST,  // Filling the post-trigger window
+  CAPTURE_READY, // Waiting for or being uploaded
+} capture_state_t;
+
+// Published as is: header immediately followed by the frames
+static struct {
+  fall_capture_header_t header;
+  sensor_raw_t frames[MAX_FRAMES];
+} s_blob;
+
+_Static_assert(sizeof(fall_capture_header_t) % 4 == 0,
+               "frames must stay aligned after the header");
+
+static uint16_t s_sample_rate_hz = 0;
+static uint32_t s_pre_len = 0;
+static uint32_t s_post_len = 0;
+// Pre-trigger ring: next slot to write and number of valid frames
+static uint32_t s_pre_head = 0;
+static uint32_t s_pre_count = 0;
+static uint32_t s_post_count = 0;
+static uint32_t s_trigger_us = 0;
+static _Atomic capture_state_t s_state = CAPTURE_ARMED;
+static EventGroupHandle_t s_events = NULL;
+
+/**
+ * @brief Reverses @p count frames in place.
+ */
+static void reverse_frames(sensor_raw_t *frames, uint32_t count) {
+  for (uint32_t i = 0, j = count - 1; i < j; i++, j--) {
+    sensor_raw_t tmp = frames[i];
+    frames[i] = frames[j];
+    frames[j] = tmp;
+  }
+}
+
+/**
+ * @brief Lays the capture out chronologically and without gaps.
+ * @return Total number of frames in the blob.
+ */
+static uint32_t linearize(void) {
+  sensor_raw_t *frames = s_blob.frames;
+
+  if (s_pre_count == s_pre_len) {
+    // Full ring: rotate left so the oldest frame (at head) comes first
+    if (s_pre_head != 0) {
+      reverse_frames(frames, s_pre_head);
+      reverse_frames(frames + s_pre_head, s_pre_len - s_pre_head);
+      reverse_frames(frames, s_pre_len);
+    }
+  } else {
+    // Ring never wrapped: only close the gap before the post window
+    memmove(&frames[s_pre_count], &frames[s_pre_len],
+            s_post_count * sizeof(sensor_raw_t));
+  }
+  return s_pre_count + s_post_count;
+}
+
+/**
+ * @brief Publishes the completed capture as one binary message.
+ */
+static void publish_capture(void) {
+  uint32_t frame_count = linearize();
+
+  s_blob.header = (fall_capture_header_t){
+      .magic = FALL_CAPTURE_MAGIC,
+      .version = FALL_CAPTURE_VERSION,
+      .frame_size = sizeof(sensor_raw_t),
+      .sample_rate_hz = s_sample_rate_hz,
+      .accel_lsb_per_g = mpu6050_get_accel_lsb_per_g(),
+      .gyro_lsb_per_dps_x10 =
+          (uint16_t)(mpu6050_get_gyro_lsb_per_dps() * 10.0f + 0.5f),
+      .pre_frames = (uint16_t)s_pre_count,
+      .post_frames = (uint16_t)s_post_count,
+      .trigger_us = s_trigger_us,
+  };
+
+  int len = (int)(sizeof(fall_capture_header_t) +
+                  frame_count * sizeof(sensor_raw_t));
+  int msg_id = esp_mqtt_client_publish(user_mqtt_get_client(),
+                                       CONFIG_FALL_CAPTURE_MQTT_TOPIC,
+                                       (const char *)&s_blob, len, 1, 0);
+  if (msg_id == -1) {
+    ESP_LOGE(TAG, "Capture publish failed (%d bytes)", len);
+  } else {
+    ESP_LOGI(TAG, "Capture published: %lu + %lu frames, %d bytes",
+             (unsigned long)s_pre_count, (unsigned long)s_post_count, len);
+  }
+}
+
+/**
+ * @brief Publishes each capture once it is complete and the alert is out.
+ */
+static void upload_task(void *param) {
+  while (1) {
+    xEventGroupWaitBits(s_events, CAPTURE_READY_BIT | UPLOAD_ALLOWED_BIT,
+                        pdTRUE, pdTRUE, portMAX_DELAY);
+
+    publish_capture();
+
+    // Re-arm with an empty ring; the state store publishes the reset
+    s_pre_head = 0;
+    s_pre_count = 0;
+    s_post_count = 0;
+    atomic_store_explicit(&s_state, CAPTURE_ARMED, memory_order_release);
+  }
+}
+
+/**
+ * @brief Appends frames to the pre-trigger ring, overwriting the oldest.
+ */
+static void feed_pre(const sensor_raw_t *frames, size_t count) {
+  if (s_pre_len == 0) {
+    return;
+  }
+  // Only the newest pre_len frames can survive
+  if (count > s_pre_len) {
+    frames += count - s_pre_len;
+    count = s_pre_len;
+  }
+
+  size_t first = s_pre_len - s_pre_head;
+  if (first > count) {
+    first = count;
+  }
+  memcpy(&s_blob.frames[s_pre_head], frames, first * sizeof(sensor_raw_t));
+  memcpy(&s_blob.frames[0], frames + first,
+         (count - first) * sizeof(sensor_raw_t));
+
+  s_pre_head = (s_pre_head + count) % s_pre_len;
+  s_pre_count += count;
+  if (s_pre_count > s_pre_len) {
+    s_pre_count = s_pre_len;
+  }
+}
+
+/**
+ * @brief Hands the capture over to the upload task.
+ */
+static void finish_capture(void) {
+  atomic_store_explicit(&s_state, CAPTURE_READY, memory_order_release);
+  xEventGroupSetBits(s_events, CAPTURE_READY_BIT);
+}
+
+/**
+ * @brief Appends frames to the post-trigger window.
+ */
+static void feed_post(const sensor_raw_t *frames, size_t count) {
+  size_t room = s_post_len - s_post_count;
+  if (count > room) {
+    count = room;
+  }
+  memcpy(&s_blob.frames[s_pre_len + s_post_count], frames,
+         count * sizeof(sensor_raw_t));
+  s_post_count += count;
+
+  if (s_post_count == s_post_len) {
+    finish_capture();
+  }
+}
+
+void fall_capture_feed(const sensor_raw_t *frames, size_t count) {
+  if (s_events == NULL || count == 0) {
+    return;
+  }
+
+  switch (atomic_load_explicit(&s_state, memory_order_acquire)) {
+  case CAPTURE_ARMED:
+    feed_pre(frames, count);
+    break;
+  case CAPTURE_POST:
+    feed_post(frames, count);
+    break;
+  default:
+    break;
+  }
+}
+
+void fall_capture_trigger(uint32_t timestamp_us) {
+  if (s_events == NULL) {
+    return;
+  }
+  if (atomic_load_explicit(&s_state, memory_order_acquire) != CAPTURE_ARMED) {
+    ESP_LOGW(TAG, "Previous capture still pending, trigger ignored");
+    return;
+  }
+
+  // A stale upload request must not release this capture early
+  xEventGroupClearBits(s_events, UPLOAD_ALLOWED_BIT);
+  s_trigger_us = timestamp_us;
+  s_post_count = 0;
+  atomic_store_explicit(&s_state, CAPTURE_POST, memory_order_release);
+
+  if (s_post_len == 0) {
+    finish_capture();
+  }
+}
+
+void fall_capture_upload(void) {
+  if (s_events != NULL) {
+    xEventGroupSetBits(s_events, UPLOAD_ALLOWED_BIT);
+  }
+}
+
+esp_err_t fall_capture_init(uint16_t sample_rate_hz) {
+  if (s_events != NULL) {
+    return ESP_OK;
+  }
+
+  s_sample_rate_hz = sample_rate_hz;
+  s_post_len = (uint32_t)CONFIG_FALL_CAPTURE_POST_MS * sample_rate_hz / 1000;
+  s_pre_len = (uint32_t)CONFIG_FALL_CAPTURE_PRE_MS * sample_rate_hz / 1000;
+  if (s_post_len > MAX_FRAMES) {
+    s_post_len = MAX_FRAMES;
+  }
+  if (s_pre_len > MAX_FRAMES - s_post_len) {
+    s_pre_len = MAX_FRAMES - s_post_len;
+    ESP_LOGW(TAG, "Pre-trigger window cut to %lu frames",
+             (unsigned long)s_pre_len);
+  }
+
+  s_events = xEventGroupCreate();
+  if (s_events == NULL) {
+    ESP_LOGE(TAG, "Failed to create event group");
+    return ESP_FAIL;
+  }
+
+  if (task_topology_create(TASK_TOPOLOGY_CAPTURE, upload_task,
+                           CONFIG_FALL_CAPTURE_TASK_STACK_SIZE, NULL,
+                           NULL) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create capture_task");
+    vEventGroupDelete(s_events);
+    s_events = NULL;
+    return ESP_FAIL;
+  }
+
+  ESP_LOGI(TAG, "Capturing %lu frames before and %lu after a fall",
+           (unsigned long)s_pre_len, (unsigned long)s_post_len);
+  return ESP_OK;
+}
+
+#endif // CONFIG_FALL_CAPTURE_ENABLE
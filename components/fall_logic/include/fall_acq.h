@@ -0,0 +1,67 @@
+/**
+ * @file fall_acq.h
+ * @brief Data-ready acquisition step: notification count, loss accounting
+ * and ring publication.
+ *
+ * In data-ready mode the MPU6050 ISR gives the fall task one notification
+ * per sample and the task takes them all at once. A count of n means n
+ * samples were latched since the previous read; the data registers only
+ * hold the newest, so n - 1 were overwritten before they could be read.
+ * A count of 0 means the wait timed out and the sensor is polled.
+ *
+ * The module has no FreeRTOS dependency: the caller waits for the
+ * notification and passes the count and the register read, so the host
+ * build runs the same step against a fake sensor.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_ACQ_H_
+#define _FALL_ACQ_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include "sample_ring.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Reads the newest sample from the sensor (mpu6050_read_raw() on
+ * the target).
+ */
+typedef esp_err_t (*fall_acq_read_fn_t)(sensor_raw_t *raw);
+
+/**
+ * @brief Acquisition counters since init.
+ */
+typedef struct {
+  uint32_t wakeups;     ///< Steps with at least one notification
+  uint32_t timeouts;    ///< Steps whose wait timed out
+  uint32_t missed;      ///< Samples overwritten before they were read
+  uint32_t read_errors; ///< Register reads that failed
+  uint32_t pushed;      ///< Frames published to the ring
+} fall_acq_stats_t;
+
+/**
+ * @brief Accounts one wake-up, reads the sensor and publishes the sample.
+ *
+ * Must be called from the ring's producer task.
+ *
+ * @param stats Counters to update.
+ * @param pending Notification count taken by the wait, 0 on timeout.
+ * @param read Sensor read.
+ * @param ring Ring the sample is pushed into.
+ * @return Number of frames pushed, 0 or 1.
+ */
+size_t fall_acq_data_ready(fall_acq_stats_t *stats, uint32_t pending,
+                           fall_acq_read_fn_t read, sample_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_ACQ_H_
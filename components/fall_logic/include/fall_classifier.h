@@ -0,0 +1,84 @@
+/**
+ * @file fall_classifier.h
+ * @brief Quantized tree-ensemble second stage for fall candidates.
+ *
+ * When the detector reports a candidate, a small boosted tree ensemble
+ * scores features of the impact window and of the window at confirmation.
+ * The model is compiled in as const tables (fall_classifier_model.h)
+ * generated by tools/fall_replay/train_classifier.py. Inference uses
+ * integer compares and int16 leaf sums only, so it is bit-exact with the
+ * training script and takes a fixed number of steps: every tree is a
+ * complete tree of the same depth.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_CLASSIFIER_H_
+#define _FALL_CLASSIFIER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fall_features.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Model inputs, in the order of the model tables.
+ */
+typedef enum {
+  FALL_INPUT_IMPACT_MIN_MG = 0, ///< Lowest |a| up to the impact
+  FALL_INPUT_IMPACT_MAX_MG,     ///< Impact peak
+  FALL_INPUT_IMPACT_STD_MG,     ///< Spread of |a| around the impact
+  FALL_INPUT_IMPACT_SMA_MG,     ///< Signal magnitude area around the impact
+  FALL_INPUT_IMPACT_JERK_MG_S,  ///< Mean jerk around the impact (mg/s)
+  FALL_INPUT_IMPACT_GYRO_DPS,   ///< RMS angular rate around the impact
+  FALL_INPUT_POST_STD_MG,       ///< Spread of |a| at confirmation
+  FALL_INPUT_POST_GYRO_DPS,     ///< RMS angular rate at confirmation
+  FALL_INPUT_TILT_DEG,          ///< Tilt from standing at confirmation
+  FALL_CLASSIFIER_INPUTS
+} fall_classifier_input_t;
+
+/**
+ * @brief Outcome of the latest candidate.
+ */
+typedef struct {
+  int32_t inputs[FALL_CLASSIFIER_INPUTS];
+  int32_t score;   ///< Log-odds of a fall, scaled by 256
+  bool accepted;   ///< score >= 0
+  uint32_t cycles; ///< CPU cycles of the evaluation (0 off target)
+  uint32_t count;  ///< Candidates evaluated since init
+} fall_classifier_result_t;
+
+/**
+ * @brief Input names, as used in feature dumps and by the training script.
+ */
+extern const char *const fall_classifier_input_names[FALL_CLASSIFIER_INPUTS];
+
+/**
+ * @brief Builds the integer model inputs of a candidate.
+ *
+ * @param impact Features when the impact was detected.
+ * @param now Features on the confirming sample.
+ * @param tilt_deg Tilt from standing, 0 when not tracked.
+ * @param accel_lsb_per_g Accelerometer sensitivity.
+ * @param gyro_lsb_per_dps Gyroscope sensitivity.
+ * @param[out] inputs FALL_CLASSIFIER_INPUTS values.
+ */
+void fall_classifier_inputs(const fall_features_t *impact,
+                            const fall_features_t *now, uint32_t tilt_deg,
+                            uint32_t accel_lsb_per_g, float gyro_lsb_per_dps,
+                            int32_t *inputs);
+
+/**
+ * @brief Runs the compiled-in model.
+ * @return Log-odds of a fall, scaled by 256.
+ */
+int32_t fall_classifier_score(const int32_t *inputs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_CLASSIFIER_H_
@@ -0,0 +1,161 @@
+/**
+ * @file fall_detector.h
+ * @brief Multi-stage fall detector: free-fall, impact, then inactivity.
+ *
+ * The detector is a small state machine that is fed one sample at a time
+ * and runs in constant time per sample:
+ *
+ *  1. Free-fall:   |a| stays below the low-g threshold for a minimum time.
+ *  2. Impact:      |a| peaks above the impact threshold within a window
+ *                  after the free-fall (or exceeds the impact-only
+ *                  threshold with no free-fall at all, if enabled).
+ *  3. Settle:      samples right after the impact are ignored.
+ *  4. Post-impact: over the observation window the wearer stays still,
+ *                  or the gravity direction has rotated compared with the
+ *                  posture before the fall.
+ *  5. Posture:     optionally, the orientation filter must report the
+ *                  wearer tilted towards horizontal at the end of the
+ *                  window.
+ *
+ * The detector reads the feature snapshot produced by fall_features rather
+ * than raw samples. Thresholds are converted to squared sensor LSB once at
+ * init, so each sample costs only integer compares; floating point is
+ * used once per post-impact window for the orientation check, plus per
+ * sample by the float orientation filter when the posture check is on. The
+ * module has no FreeRTOS dependency.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_DETECTOR_H_
+#define _FALL_DETECTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fall_features.h"
+#include "orientation.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Detector stages.
+ */
+typedef enum {
+  FALL_STAGE_IDLE = 0,    ///< Waiting for a low-g phase
+  FALL_STAGE_FREEFALL,    ///< Low-g phase in progress
+  FALL_STAGE_IMPACT_WAIT, ///< Free-fall seen, waiting for the impact peak
+  FALL_STAGE_SETTLE,      ///< Impact seen, ignoring rebound samples
+  FALL_STAGE_POST_IMPACT, ///< Observing inactivity / orientation
+} fall_stage_t;
+
+/**
+ * @brief Detector thresholds and windows.
+ */
+typedef struct {
+  uint32_t freefall_threshold_mg;  ///< |a| below this is free-fall
+  uint32_t freefall_min_ms;        ///< Minimum free-fall duration
+  uint32_t impact_threshold_mg;    ///< |a| above this after free-fall
+  uint32_t impact_window_ms;       ///< Max delay from free-fall to impact
+  uint32_t impact_only_mg;         ///< Impact without free-fall (0 = off)
+  uint32_t settle_ms;              ///< Samples ignored after the impact
+  uint32_t inactivity_ms;          ///< Post-impact observation window
+  uint32_t inactivity_tolerance_mg; ///< Max ||a| - 1 g| while still
+  uint32_t orientation_change_deg; ///< Posture change that confirms (0 = off)
+  uint32_t horizontal_min_deg;     ///< Tilt required at the end (0 = off)
+  uint32_t accel_lsb_per_g;        ///< Sensitivity of the accel range
+  float gyro_lsb_per_dps;          ///< Sensitivity of the gyro range
+} fall_detector_config_t;
+
+/**
+ * @brief Detector configuration from Kconfig.
+ */
+#define FALL_DETECTOR_DEFAULT_CONFIG()                                         \
+  {                                                                            \
+    .freefall_threshold_mg = CONFIG_FALL_LOGIC_THRESHOLD_G,                    \
+    .freefall_min_ms = CONFIG_FALL_LOGIC_FREEFALL_MIN_MS,                      \
+    .impact_threshold_mg = CONFIG_FALL_LOGIC_IMPACT_THRESHOLD_MG,              \
+    .impact_window_ms = CONFIG_FALL_LOGIC_IMPACT_WINDOW_MS,                    \
+    .impact_only_mg = CONFIG_FALL_LOGIC_IMPACT_ONLY_THRESHOLD_MG,              \
+    .settle_ms = CONFIG_FALL_LOGIC_SETTLE_MS,                                  \
+    .inactivity_ms = CONFIG_FALL_LOGIC_INACTIVITY_MS,                          \
+    .inactivity_tolerance_mg = CONFIG_FALL_LOGIC_INACTIVITY_TOLERANCE_MG,      \
+    .orientation_change_deg = CONFIG_FALL_LOGIC_ORIENTATION_CHANGE_DEG,        \
+    .horizontal_min_deg = CONFIG_FALL_LOGIC_HORIZONTAL_MIN_DEG,                \
+    .accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G,                                \
+    .gyro_lsb_per_dps = MPU6050_GYRO_LSB_PER_DPS,                              \
+  }
+
+/**
+ * @brief Detector instance. Treat the fields as private.
+ */
+typedef struct {
+  fall_detector_config_t config;
+
+  // Thresholds pre-computed as squared magnitudes (LSB^2)
+  uint32_t freefall_sq;
+  uint32_t impact_sq;
+  uint32_t impact_only_sq;
+  uint32_t still_min_sq;
+  uint32_t still_max_sq;
+  float orientation_cos_sq;
+
+  fall_stage_t stage;
+  uint32_t stage_start_us; ///< Timestamp when the current stage began
+
+  int32_t gravity_ref[3]; ///< Posture before the fall (LSB, scaled by 32)
+  int32_t post_sum[3];    ///< Accel sum over the post-impact window (LSB)
+  bool post_still;        ///< No motion seen in the post-impact window
+
+  orientation_t orientation; ///< Tilt tracked through the fall
+  fall_features_t impact;    ///< Features when the impact was seen
+} fall_detector_t;
+
+/**
+ * @brief Initializes a detector with the given configuration.
+ *
+ * @param det Detector instance.
+ * @param config Thresholds and windows; copied into the instance.
+ */
+void fall_detector_init(fall_detector_t *det,
+                        const fall_detector_config_t *config);
+
+/**
+ * @brief Returns the detector to the idle stage.
+ */
+void fall_detector_reset(fall_detector_t *det);
+
+/**
+ * @brief Feeds the features after one new sample to the detector.
+ *
+ * @param det Detector instance.
+ * @param features Snapshot returned by fall_features_update().
+ * @return true when a fall is confirmed on this sample.
+ */
+bool fall_detector_update(fall_detector_t *det,
+                          const fall_features_t *features);
+
+/**
+ * @brief Returns the current detector stage.
+ */
+fall_stage_t fall_detector_get_stage(const fall_detector_t *det);
+
+/**
+ * @brief Returns the features of the window that ended at the latest
+ * impact.
+ */
+const fall_features_t *fall_detector_impact(const fall_detector_t *det);
+
+/**
+ * @brief Returns the tracked tilt from standing in degrees, or 0 when the
+ * posture check (and with it the orientation filter) is off.
+ */
+float fall_detector_tilt_deg(const fall_detector_t *det);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_DETECTOR_H_
@@ -0,0 +1,59 @@
+/**
+ * @file fall_dsp.h
+ * @brief Batch kernels over arrays of IMU frames.
+ *
+ * Magnitudes are produced squared so thresholds can be compared against a
+ * squared limit and no square root is taken. The hot path works on raw
+ * int16 frames only; the kernels are plain C, which the compiler turns
+ * into single-cycle 16x16 multiplies on Xtensa. esp-dsp has no int16
+ * kernel with a 32-bit result, so there is no target-specific backend.
+ * dsp_check in tools/fall_replay checks them against naive references and
+ * times them.
+ *
+ * There is no window-sum kernel: fall_features keeps running sums that
+ * are updated per sample, so a window is never summed over again.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_DSP_H_
+#define _FALL_DSP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mpu6050.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Squared accel magnitude of each raw frame, in LSB^2.
+ *
+ * The result of three int16 squares always fits in uint32_t.
+ */
+void fall_dsp_mag_sq_s16(const sensor_raw_t *frames, size_t n,
+                         uint32_t *out);
+
+/**
+ * @brief Index of the first value below @p threshold, or @p n if none.
+ */
+size_t fall_dsp_find_below_u32(const uint32_t *values, size_t n,
+                               uint32_t threshold);
+
+/**
+ * @brief Index of the first value above @p threshold, or @p n if none.
+ */
+size_t fall_dsp_find_above_u32(const uint32_t *values, size_t n,
+                               uint32_t threshold);
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+uint32_t fall_dsp_isqrt_u32(uint32_t x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_DSP_H_
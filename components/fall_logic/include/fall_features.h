@@ -0,0 +1,146 @@
+/**
+ * @file fall_features.h
+ * @brief Incremental sliding-window features over an IMU sample stream.
+ *
+ * A feature window keeps the per-sample contributions of the last N samples
+ * in a ring buffer together with running sums. Adding a sample subtracts the
+ * contribution that leaves the window and adds the new one, so every
+ * statistic is updated in O(1) without rescanning the window. Minimum and
+ * maximum magnitude use monotonic deques (amortized O(1)).
+ *
+ * The window works on raw sensor_raw_t frames in integer LSB units, so the
+ * per-sample path uses no floating point and the running sums are exact.
+ * fall_features_scale() converts a snapshot to g and deg/s on demand.
+ *
+ * Detectors and classifiers read fall_features_t instead of raw samples.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_FEATURES_H_
+#define _FALL_FEATURES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mpu6050.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Largest window supported by a feature window instance, in samples
+#define FALL_FEATURES_MAX_WINDOW CONFIG_FALL_LOGIC_FEATURE_MAX_SAMPLES
+
+/**
+ * @brief Snapshot of the features after the latest sample, in sensor LSB.
+ */
+typedef struct {
+  sensor_raw_t last;     ///< Most recent frame
+  uint32_t last_mag_sq;  ///< |a|^2 of the most recent frame (LSB^2)
+
+  uint32_t count;        ///< Samples currently in the window
+  uint32_t mag_mean;     ///< Mean |a| over the window (LSB)
+  uint32_t mag_var;      ///< Variance of |a| over the window (LSB^2)
+  uint32_t mag_min;      ///< Minimum |a| over the window (LSB)
+  uint32_t mag_max;      ///< Maximum |a| over the window (LSB)
+  uint32_t sma;          ///< Signal magnitude area, mean |ax|+|ay|+|az| (LSB)
+  uint32_t jerk;         ///< Mean |da/dt| over the window, L1 norm (LSB/s)
+  uint32_t gyro_energy;  ///< Mean gx^2+gy^2+gz^2 over the window (LSB^2)
+} fall_features_t;
+
+/**
+ * @brief Feature snapshot converted to physical units.
+ */
+typedef struct {
+  sensor_data_t last; ///< Most recent sample (g, deg/s)
+  uint32_t count;     ///< Samples in the window
+  float mag_mean;     ///< g
+  float mag_var;      ///< g^2
+  float mag_min;      ///< g
+  float mag_max;      ///< g
+  float sma;          ///< g
+  float jerk;         ///< g/s
+  float gyro_energy;  ///< (deg/s)^2
+} fall_features_scaled_t;
+
+/**
+ * @brief Per-sample contributions kept for removal when they leave.
+ */
+typedef struct {
+  uint16_t mag;         ///< |a| (LSB)
+  uint32_t dt_us;       ///< Time since the previous sample (µs)
+  uint32_t sma;         ///< |ax|+|ay|+|az| (LSB)
+  uint32_t jerk;        ///< |ax-ax'|+|ay-ay'|+|az-az'| (LSB)
+  uint32_t gyro_energy; ///< gx^2+gy^2+gz^2 (LSB^2)
+} fall_feature_entry_t;
+
+/**
+ * @brief Sliding feature window. Treat the fields as private.
+ */
+typedef struct {
+  uint32_t window;  ///< Window length in samples
+  uint32_t count;   ///< Samples currently held (<= window)
+  uint32_t seq;     ///< Sequence number of the next sample
+  fall_feature_entry_t entries[FALL_FEATURES_MAX_WINDOW];
+
+  uint32_t sum_mag;
+  uint64_t sum_mag_sq;
+  uint32_t sum_sma;
+  uint32_t sum_jerk;
+  uint64_t sum_dt_us;
+  uint64_t sum_gyro_energy;
+
+  // Monotonic deques of sequence numbers for min/max magnitude
+  uint32_t min_q[FALL_FEATURES_MAX_WINDOW];
+  uint32_t max_q[FALL_FEATURES_MAX_WINDOW];
+  uint32_t min_head, min_len;
+  uint32_t max_head, max_len;
+
+  sensor_raw_t prev;      ///< Previous frame, for jerk
+  fall_features_t latest; ///< Features after the latest update
+} fall_feature_window_t;
+
+/**
+ * @brief Initializes a feature window.
+ *
+ * @param fw Window instance.
+ * @param window_samples Window length; clamped to 1..FALL_FEATURES_MAX_WINDOW.
+ */
+void fall_features_init(fall_feature_window_t *fw, uint32_t window_samples);
+
+/**
+ * @brief Empties the window, keeping its length.
+ */
+void fall_features_reset(fall_feature_window_t *fw);
+
+/**
+ * @brief Adds one frame and updates all features in O(1).
+ *
+ * @param fw Window instance.
+ * @param frame Raw sensor frame with timestamp.
+ * @param mag_sq Squared accel magnitude of @p frame (LSB^2), usually from
+ * fall_dsp_mag_sq_s16().
+ * @return Pointer to the updated feature snapshot, valid until the next
+ * update.
+ */
+const fall_features_t *fall_features_update(fall_feature_window_t *fw,
+                                            const sensor_raw_t *frame,
+                                            uint32_t mag_sq);
+
+/**
+ * @brief Returns the features after the latest update.
+ */
+const fall_features_t *fall_features_get(const fall_feature_window_t *fw);
+
+/**
+ * @brief Converts a snapshot to g and deg/s, for logging or payloads.
+ */
+void fall_features_scale(const fall_features_t *features,
+                         fall_features_scaled_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_FEATURES_H_
@@ -17,8 +17,13 @@ extern "C" {
 #endif
 
 #include "esp_err.h"
+#include "fall_monitor.h"
+#include "fall_rate.h"
+#include "sample_ring.h"
 #include "sdkconfig.h"
+#include "task_jitter.h"
 #include "stdbool.h"
+#include "stdint.h"
 
 #if CONFIG_FALL_LOGIC_ENABLE
 
@@ -68,11 +73,84 @@ esp_err_t fall_logic_disable(void);
  */
 bool fall_logic_is_enabled(void);
 
+/**
+ * @brief Returns the number of sensor samples that were lost.
+ *
+ * In data-ready mode every MPU6050 sample raises one task notification. If
+ * the task finds more than one pending notification, the extra samples were
+ * overwritten in the sensor before they could be read and are counted here.
+ * In FIFO mode each overflow adds one full FIFO worth of samples.
+ *
+ * @return Total number of missed samples since boot.
+ */
+uint32_t fall_logic_get_missed_samples(void);
+
+/**
+ * @brief Returns the ring that carries every acquired IMU frame.
+ *
+ * Consumers attach their own reader with sample_ring_reader_init() and read
+ * frames in place. The ring is ready once fall_logic_init() has returned.
+ *
+ * @return Pointer to the sample ring.
+ */
+sample_ring_t *fall_logic_get_sample_ring(void);
+
+/**
+ * @brief Returns the wake-up period statistics of the fall task.
+ *
+ * The nominal period is one sample in data-ready mode (following the
+ * adaptive rate), one FIFO drain in FIFO mode and the check interval when
+ * polling. Light sleep is not counted as a late wake-up.
+ *
+ * @param[out] stats Deviations from the nominal period since boot or the
+ * last fall_logic_reset_jitter_stats().
+ * @return ESP_OK on success.
+ */
+esp_err_t fall_logic_get_jitter_stats(task_jitter_stats_t *stats);
+
+/**
+ * @brief Clears the wake-up period statistics.
+ *
+ * @return ESP_OK on success.
+ */
+esp_err_t fall_logic_reset_jitter_stats(void);
+
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+/**
+ * @brief Returns the time spent at each sample rate since boot.
+ *
+ * Light sleep and other gaps longer than a second are not counted, so the
+ * tier times sum to the time the sensor was actually sampled.
+ *
+ * @param[out] stats Time per tier and number of rate changes.
+ * @return ESP_OK on success.
+ */
+esp_err_t fall_logic_get_rate_stats(fall_rate_stats_t *stats);
+#else
+#define fall_logic_get_rate_stats(stats) (ESP_ERR_NOT_SUPPORTED)
+#endif
+
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+/**
+ * @brief Returns the post-fall monitoring progress.
+ *
+ * Read it when handling EVENT_FALL_LONG_LIE or EVENT_FALL_RECOVERED to
+ * report how long the wearer stayed down.
+ *
+ * @param[out] status State and times of the current or last fall.
+ * @return ESP_OK on success.
+ */
+esp_err_t fall_logic_get_monitor_status(fall_monitor_status_t *status);
+#else
+#define fall_logic_get_monitor_status(status) (ESP_ERR_NOT_SUPPORTED)
+#endif
+
 /**
  * @brief Resets the fall detection status.
  *
  * This function should be called after a fall event has been processed and an
  * alert has been sent, allowing the module to be ready for new fall events.
+ * Post-fall monitoring carries on until the wearer recovers.
  *
  * @return ESP_OK on success.
  */
@@ -86,6 +164,12 @@ esp_err_t fall_logic_reset_fall_status(void);
 #define fall_logic_enable() (ESP_OK)
 #define fall_logic_disable() (ESP_OK)
 #define fall_logic_is_enabled() (false)
+#define fall_logic_get_missed_samples() (0)
+#define fall_logic_get_sample_ring() ((sample_ring_t *)NULL)
+#define fall_logic_get_jitter_stats(stats) (ESP_ERR_NOT_SUPPORTED)
+#define fall_logic_reset_jitter_stats() (ESP_ERR_NOT_SUPPORTED)
+#define fall_logic_get_rate_stats(stats) (ESP_ERR_NOT_SUPPORTED)
+#define fall_logic_get_monitor_status(status) (ESP_ERR_NOT_SUPPORTED)
 #define fall_logic_reset_fall_status() (ESP_OK)
 
 #endif // CONFIG_FALL_LOGIC_ENABLE
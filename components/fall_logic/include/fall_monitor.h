@@ -0,0 +1,149 @@
+/**
+ * @file fall_monitor.h
+ * @brief Post-fall monitoring: long-lie escalation and recovery.
+ *
+ * After a reported fall the monitor keeps reading the feature snapshots the
+ * detector already produces, so it costs no extra sensor traffic. Each
+ * sample counts as moving when the spread of |a| over the window or the
+ * gyro energy is above its threshold:
+ *
+ *  - Long lie: once the motionless time since the fall adds up to
+ *    long_lie_ms, the monitor reports FALL_MONITOR_LONG_LIE once.
+ *  - Recovery: movement lasting recovery_ms without a pause (the wearer
+ *    getting up and walking) ends the monitoring with
+ *    FALL_MONITOR_RECOVERED, whether the long lie was reported or not.
+ *
+ * Short movements while lying (turning over, reaching out) neither reset
+ * the motionless time nor count as recovery.
+ *
+ * The module has no FreeRTOS or driver dependency; the caller raises the
+ * events.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_MONITOR_H_
+#define _FALL_MONITOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fall_features.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Monitoring state.
+ */
+typedef enum {
+  FALL_MONITOR_IDLE = 0, ///< No fall being followed
+  FALL_MONITOR_WATCHING, ///< Fall reported, waiting for recovery
+  FALL_MONITOR_ESCALATED ///< Long lie reported, waiting for recovery
+} fall_monitor_state_t;
+
+/**
+ * @brief Result of one update.
+ */
+typedef enum {
+  FALL_MONITOR_NONE = 0,  ///< Nothing to report
+  FALL_MONITOR_LONG_LIE,  ///< Motionless for long_lie_ms since the fall
+  FALL_MONITOR_RECOVERED, ///< Wearer moving again, monitoring ended
+} fall_monitor_event_t;
+
+/**
+ * @brief Thresholds and times.
+ */
+typedef struct {
+  uint32_t still_mg;        ///< Std of |a| below this counts as still
+  uint32_t still_dps;       ///< RMS rotation rate below this is still
+  uint32_t long_lie_ms;     ///< Motionless time that escalates
+  uint32_t recovery_ms;     ///< Continuous movement that de-escalates
+  uint32_t accel_lsb_per_g; ///< Sensitivity of the accel range
+  float gyro_lsb_per_dps;   ///< Sensitivity of the gyro range
+} fall_monitor_config_t;
+
+#ifdef CONFIG_FALL_LOGIC_LONG_LIE_MS
+/**
+ * @brief Monitor configuration from Kconfig.
+ */
+#define FALL_MONITOR_DEFAULT_CONFIG()                                          \
+  {                                                                            \
+    .still_mg = CONFIG_FALL_LOGIC_LONG_LIE_STILL_MG,                           \
+    .still_dps = CONFIG_FALL_LOGIC_LONG_LIE_STILL_DPS,                         \
+    .long_lie_ms = CONFIG_FALL_LOGIC_LONG_LIE_MS,                              \
+    .recovery_ms = CONFIG_FALL_LOGIC_RECOVERY_MS,                              \
+    .accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G,                                \
+    .gyro_lsb_per_dps = MPU6050_GYRO_LSB_PER_DPS,                              \
+  }
+#endif
+
+/**
+ * @brief Progress of the current (or last) monitored fall.
+ */
+typedef struct {
+  fall_monitor_state_t state;
+  uint32_t since_fall_ms; ///< Time since the fall was reported
+  uint32_t still_ms;      ///< Motionless time since the fall
+} fall_monitor_status_t;
+
+/**
+ * @brief Monitor instance. Treat the fields as private.
+ */
+typedef struct {
+  fall_monitor_config_t config;
+  uint32_t still_var;   ///< LSB^2
+  uint32_t still_gyro;  ///< LSB^2
+  fall_monitor_state_t state;
+  uint32_t last_us;     ///< Timestamp of the previous sample
+  uint64_t elapsed_us;  ///< Since the fall
+  uint64_t still_us;    ///< Motionless, since the fall
+  bool moving;
+  uint32_t moving_since_us;
+} fall_monitor_t;
+
+/**
+ * @brief Initializes an idle monitor.
+ */
+void fall_monitor_init(fall_monitor_t *m, const fall_monitor_config_t *config);
+
+/**
+ * @brief Starts following a fall reported at @p timestamp_us. A fall
+ * reported while one is followed restarts the count but keeps an
+ * escalation.
+ */
+void fall_monitor_start(fall_monitor_t *m, uint32_t timestamp_us);
+
+/**
+ * @brief Stops following the fall without reporting anything.
+ */
+void fall_monitor_stop(fall_monitor_t *m);
+
+/**
+ * @brief Accounts the time since the previous update while a fall is
+ * followed. Call it once per sample or once per batch.
+ *
+ * @param m Monitor instance.
+ * @param features Snapshot after the latest sample.
+ * @return Event to raise, if any.
+ */
+fall_monitor_event_t fall_monitor_update(fall_monitor_t *m,
+                                         const fall_features_t *features);
+
+/**
+ * @brief Returns true while a fall is followed.
+ */
+bool fall_monitor_is_active(const fall_monitor_t *m);
+
+/**
+ * @brief Returns the progress of the current or last monitored fall.
+ */
+void fall_monitor_get_status(const fall_monitor_t *m,
+                             fall_monitor_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_MONITOR_H_
@@ -0,0 +1,143 @@
+/**
+ * @file fall_pipeline.h
+ * @brief Frame-to-decision path shared by the firmware and host tools.
+ *
+ * A pipeline owns the feature window and the configured detector and turns
+ * a span of raw frames into fall decisions: batch squared magnitudes, then
+ * feature and detector updates sample by sample. Each detector candidate
+ * is scored by the fall classifier, which can veto it
+ * (CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE).
+ *
+ * With CONFIG_FALL_LOGIC_SHADOW_ENABLE every detector variant runs on each
+ * sample (see fall_shadow.h): the threshold test, the multi-stage detector
+ * and the classifier on its candidates. The configured algorithm, or the
+ * classifier when it is enabled on top of the multi-stage detector, stays
+ * authoritative; the other verdicts and the cost of each variant are only
+ * accounted.
+ *
+ * The pipeline has no FreeRTOS or driver dependency, so tools/fall_replay
+ * builds the exact same code on a Linux host.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_PIPELINE_H_
+#define _FALL_PIPELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fall_classifier.h"
+#include "fall_detector.h"
+#include "fall_features.h"
+#include "fall_shadow.h"
+#include "mpu6050.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Frames run through the batch magnitude kernel at a time
+#define FALL_PIPELINE_CHUNK_FRAMES 32
+
+/**
+ * @brief Pipeline instance. Treat the fields as private.
+ */
+typedef struct {
+  fall_feature_window_t features;
+  uint32_t chunk_mag_sq[FALL_PIPELINE_CHUNK_FRAMES]; ///< Scratch (LSB^2)
+#if CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE || CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  fall_detector_t detector;
+#endif
+#if !CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE || CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  uint32_t threshold_sq; ///< Free-fall threshold (LSB^2)
+#endif
+  uint32_t accel_lsb_per_g;
+  float gyro_lsb_per_dps;
+  bool classifier_enabled;            ///< Candidates need the model's vote
+  fall_classifier_result_t candidate; ///< Latest candidate
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  fall_shadow_t shadow;
+#endif
+} fall_pipeline_t;
+
+/**
+ * @brief Initializes the feature window and detector.
+ *
+ * @param p Pipeline instance.
+ * @param window_samples Feature window length in samples.
+ * @param config Detector thresholds; the single-threshold algorithm only
+ * uses freefall_threshold_mg and the sensor scales.
+ */
+void fall_pipeline_init(fall_pipeline_t *p, uint32_t window_samples,
+                        const fall_detector_config_t *config);
+
+/**
+ * @brief Clears the feature window and returns the detector to idle.
+ */
+void fall_pipeline_reset(fall_pipeline_t *p);
+
+/**
+ * @brief Overrides CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE. Candidates are
+ * scored either way. In shadow mode with the multi-stage algorithm this
+ * moves authority between the detector and the classifier and clears the
+ * shadow counters.
+ */
+void fall_pipeline_set_classifier(fall_pipeline_t *p, bool enabled);
+
+/**
+ * @brief Runs frames through the pipeline until a fall is confirmed.
+ *
+ * @param p Pipeline instance.
+ * @param frames Frames in chronological order.
+ * @param count Number of frames.
+ * @return Index of the frame on which a fall was confirmed, or @p count if
+ * none was. Frames after that index are not consumed; pass them in again.
+ */
+size_t fall_pipeline_process(fall_pipeline_t *p, const sensor_raw_t *frames,
+                             size_t count);
+
+/**
+ * @brief Returns the features after the last processed frame.
+ */
+const fall_features_t *fall_pipeline_features(const fall_pipeline_t *p);
+
+/**
+ * @brief Returns the latest candidate reported by the detector, with its
+ * classifier inputs and score.
+ */
+const fall_classifier_result_t *
+fall_pipeline_candidate(const fall_pipeline_t *p);
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+/**
+ * @brief Returns the shadow verdict and cost counters.
+ */
+const fall_shadow_t *fall_pipeline_shadow(const fall_pipeline_t *p);
+
+/**
+ * @brief Resolves pending shadow matches, at the end of a recording.
+ */
+void fall_pipeline_shadow_flush(fall_pipeline_t *p);
+#endif
+
+/**
+ * @brief Returns true when the authoritative detector has no detection in
+ * progress.
+ */
+bool fall_pipeline_is_idle(const fall_pipeline_t *p);
+
+/**
+ * @brief Returns the timestamp of the sample that started the detection
+ * confirmed on @p confirm: the impact for the multi-stage detector, the
+ * confirming sample itself for the threshold algorithm.
+ */
+uint32_t fall_pipeline_trigger_us(const fall_pipeline_t *p,
+                                  const sensor_raw_t *confirm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_PIPELINE_H_
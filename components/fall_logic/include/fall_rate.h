@@ -0,0 +1,144 @@
+/**
+ * @file fall_rate.h
+ * @brief Sampling rate tier selection from the activity level.
+ *
+ * The policy looks at every feature snapshot and picks one of three
+ * acquisition tiers:
+ *
+ *  - Low:    accelerometer-only cycle mode while the wearer is still.
+ *  - Medium: reduced output data rate during normal activity.
+ *  - High:   full rate as soon as the spread of |a| over the window, or any
+ *            sample of the window below the free-fall threshold, suggests
+ *            a fall, and for as long as a detection is in progress.
+ *
+ * Moving up is immediate, on the sample that crosses a threshold: that
+ * sample already reaches the detector, so a free-fall onset seen at a low
+ * rate is not lost, only the following samples arrive faster. Checking the
+ * window minimum rather than the newest sample keeps this true when the
+ * policy only runs once per batch of samples. Moving down needs the calm or
+ * still state to last for a hold time.
+ *
+ * The time spent in each tier is summed from the sample timestamps. The
+ * module has no FreeRTOS or driver dependency; the caller applies the tier
+ * to the sensor.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_RATE_H_
+#define _FALL_RATE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fall_features.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Acquisition tiers, slowest first.
+ */
+typedef enum {
+  FALL_RATE_LOW = 0, ///< Cycle mode, wearer still
+  FALL_RATE_MEDIUM,  ///< Normal activity
+  FALL_RATE_HIGH,    ///< Possible fall, full rate
+  FALL_RATE_TIERS
+} fall_rate_tier_t;
+
+/**
+ * @brief Tier names, as used in logs and reports.
+ */
+extern const char *const fall_rate_tier_names[FALL_RATE_TIERS];
+
+/**
+ * @brief Thresholds and hold times.
+ */
+typedef struct {
+  uint32_t freefall_mg;     ///< A sample below this selects the high tier
+  uint32_t active_std_mg;   ///< Spread of |a| that selects the high tier
+  uint32_t still_band_mg;   ///< Max - min |a| below this counts as still
+  uint32_t high_hold_ms;    ///< Calm time before leaving the high tier
+  uint32_t still_ms;        ///< Still time before entering the low tier
+  uint32_t accel_lsb_per_g; ///< Sensitivity of the accel range
+} fall_rate_config_t;
+
+#ifdef CONFIG_FALL_LOGIC_RATE_ACTIVE_STD_MG
+/**
+ * @brief Policy configuration from Kconfig.
+ */
+#define FALL_RATE_DEFAULT_CONFIG()                                             \
+  {                                                                            \
+    .freefall_mg = CONFIG_FALL_LOGIC_THRESHOLD_G,                              \
+    .active_std_mg = CONFIG_FALL_LOGIC_RATE_ACTIVE_STD_MG,                     \
+    .still_band_mg = CONFIG_FALL_LOGIC_RATE_STILL_BAND_MG,                     \
+    .high_hold_ms = CONFIG_FALL_LOGIC_RATE_HIGH_HOLD_MS,                       \
+    .still_ms = CONFIG_FALL_LOGIC_RATE_STILL_MS,                               \
+    .accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G,                                \
+  }
+#endif
+
+/**
+ * @brief Time accounting since init.
+ */
+typedef struct {
+  uint64_t time_us[FALL_RATE_TIERS]; ///< Time spent in each tier
+  uint32_t switches;                 ///< Tier changes
+} fall_rate_stats_t;
+
+/**
+ * @brief Policy instance. Treat the fields as private.
+ */
+typedef struct {
+  fall_rate_config_t config;
+  uint32_t freefall;     ///< LSB
+  uint32_t active_var;   ///< LSB^2
+  uint32_t still_band;   ///< LSB
+  fall_rate_tier_t tier;
+  bool started;          ///< last_us is valid
+  uint32_t last_us;      ///< Timestamp of the previous sample
+  uint32_t calm_since_us;
+  bool still;
+  uint32_t still_since_us;
+  fall_rate_stats_t stats;
+} fall_rate_t;
+
+/**
+ * @brief Initializes the policy in the high tier.
+ */
+void fall_rate_init(fall_rate_t *r, const fall_rate_config_t *config);
+
+/**
+ * @brief Forces a tier, e.g. after a motion wake-up. Not counted as a
+ * switch.
+ */
+void fall_rate_set_tier(fall_rate_t *r, fall_rate_tier_t tier);
+
+/**
+ * @brief Accounts one sample and returns the tier for the next ones.
+ *
+ * @param r Policy instance.
+ * @param features Snapshot after the sample.
+ * @param detector_idle false while a detection is in progress.
+ * @return Tier to apply.
+ */
+fall_rate_tier_t fall_rate_update(fall_rate_t *r,
+                                  const fall_features_t *features,
+                                  bool detector_idle);
+
+/**
+ * @brief Returns the current tier.
+ */
+fall_rate_tier_t fall_rate_get_tier(const fall_rate_t *r);
+
+/**
+ * @brief Returns the time accounting since init.
+ */
+const fall_rate_stats_t *fall_rate_get_stats(const fall_rate_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_RATE_H_
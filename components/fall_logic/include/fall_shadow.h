@@ -0,0 +1,148 @@
+/**
+ * @file fall_shadow.h
+ * @brief A/B bookkeeping for detectors running in shadow mode.
+ *
+ * With CONFIG_FALL_LOGIC_SHADOW_ENABLE the pipeline runs every detector
+ * variant on the same samples. One variant is authoritative and decides
+ * what is reported; the verdicts of the others are only compared with it.
+ *
+ * Detections of one variant closer together than the match window count as
+ * one event. A shadow event agrees with an authoritative event when the two
+ * are at most the match window apart, in either order: the threshold
+ * variant fires at the free-fall, the multi-stage detector only at the end
+ * of the post-impact window. An event still unmatched once the window has
+ * passed is a disagreement.
+ *
+ * The module only counts; it has no FreeRTOS dependency and is shared with
+ * the host tools.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _FALL_SHADOW_H_
+#define _FALL_SHADOW_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Detector variants the pipeline can run.
+ */
+typedef enum {
+  FALL_VARIANT_THRESHOLD = 0, ///< Single low-g sample
+  FALL_VARIANT_MULTI_STAGE,   ///< Multi-stage detector
+  FALL_VARIANT_CLASSIFIER,    ///< Multi-stage candidates the model accepts
+  FALL_VARIANTS
+} fall_variant_t;
+
+/**
+ * @brief Variant names, as used in logs and reports.
+ */
+extern const char *const fall_variant_names[FALL_VARIANTS];
+
+/**
+ * @brief Counters of one variant since init.
+ *
+ * The agreement counters stay 0 for the authoritative variant.
+ */
+typedef struct {
+  uint32_t events;      ///< Detections, merged within the match window
+  uint32_t agreed;      ///< Events matched by an authoritative event
+  uint32_t shadow_only; ///< Events the authoritative variant did not have
+  uint32_t missed;      ///< Authoritative events this variant did not have
+  uint64_t cycles;      ///< CPU cycles spent in the variant (0 off target)
+} fall_shadow_stats_t;
+
+/**
+ * @brief Verdicts and costs of all variants on one sample.
+ */
+typedef struct {
+  bool verdict[FALL_VARIANTS];   ///< Variant reports a fall on this sample
+  uint32_t cycles[FALL_VARIANTS]; ///< CPU cycles spent per variant
+  uint32_t feature_cycles;        ///< Shared feature window update
+} fall_shadow_sample_t;
+
+/**
+ * @brief Shadow bookkeeping. Treat the fields as private.
+ */
+typedef struct {
+  fall_variant_t authoritative;
+  uint32_t match_us;
+  uint32_t samples;        ///< Samples seen since init
+  uint64_t feature_cycles; ///< Shared cost, sum over samples
+  fall_shadow_stats_t stats[FALL_VARIANTS];
+
+  // Matching state per variant
+  bool has_event[FALL_VARIANTS];
+  uint32_t event_us[FALL_VARIANTS]; ///< Latest event
+  bool shadow_pending[FALL_VARIANTS];
+  uint32_t shadow_us[FALL_VARIANTS]; ///< Unmatched shadow event
+  bool authority_pending[FALL_VARIANTS];
+  uint32_t authority_us[FALL_VARIANTS]; ///< Unmatched authoritative event
+} fall_shadow_t;
+
+/**
+ * @brief Clears all counters.
+ *
+ * @param s Instance.
+ * @param authoritative Variant whose verdict is reported.
+ * @param match_ms Match window.
+ */
+void fall_shadow_init(fall_shadow_t *s, fall_variant_t authoritative,
+                      uint32_t match_ms);
+
+/**
+ * @brief Hands authority to another variant. Clears all counters, as they
+ * are only meaningful against one authoritative variant.
+ */
+void fall_shadow_set_authoritative(fall_shadow_t *s,
+                                   fall_variant_t authoritative);
+
+/**
+ * @brief Returns the variant whose verdict is reported.
+ */
+fall_variant_t fall_shadow_get_authoritative(const fall_shadow_t *s);
+
+/**
+ * @brief Accounts one sample.
+ *
+ * @param s Instance.
+ * @param timestamp_us Timestamp of the sample.
+ * @param sample Verdicts and costs of every variant.
+ */
+void fall_shadow_update(fall_shadow_t *s, uint32_t timestamp_us,
+                        const fall_shadow_sample_t *sample);
+
+/**
+ * @brief Counts every event still waiting for a match as a disagreement.
+ *
+ * For the end of a recording; on the device events resolve on their own
+ * once the match window has passed.
+ */
+void fall_shadow_flush(fall_shadow_t *s);
+
+/**
+ * @brief Returns the counters of one variant.
+ */
+const fall_shadow_stats_t *fall_shadow_get_stats(const fall_shadow_t *s,
+                                                 fall_variant_t variant);
+
+/**
+ * @brief Returns the number of samples accounted since init.
+ */
+uint32_t fall_shadow_get_samples(const fall_shadow_t *s);
+
+/**
+ * @brief Returns the cycles spent in the shared feature window update.
+ */
+uint64_t fall_shadow_get_feature_cycles(const fall_shadow_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FALL_SHADOW_H_
@@ -0,0 +1,25 @@
+/**
+ * @file fall_acq.c
+ * @brief Data-ready acquisition step.
+ */
+
+#include "fall_acq.h"
+
+size_t fall_acq_data_ready(fall_acq_stats_t *stats, uint32_t pending,
+                           fall_acq_read_fn_t read, sample_ring_t *ring) {
+  if (pending == 0) {
+    stats->timeouts++;
+  } else {
+    stats->wakeups++;
+    stats->missed += pending - 1;
+  }
+
+  sensor_raw_t frame;
+  if (read(&frame) != ESP_OK) {
+    stats->read_errors++;
+    return 0;
+  }
+  sample_ring_push(ring, &frame);
+  stats->pushed++;
+  return 1;
+}
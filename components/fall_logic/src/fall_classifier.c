@@ -0,0 +1,78 @@
+/**
+ * @file fall_classifier.c
+ * @brief Quantized tree-ensemble second stage for fall candidates.
+ */
+
+#include "fall_classifier.h"
+#include "esp_attr.h"
+#include "fall_dsp.h"
+#include "sdkconfig.h"
+
+// Model tables, kept in DRAM so inference never waits on the flash cache
+#include "fall_classifier_model.h"
+
+_Static_assert(FALL_MODEL_INPUTS == FALL_CLASSIFIER_INPUTS,
+               "model was trained on a different input set");
+
+#if CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE
+// Upper bound for one tree level on the ESP32 (two DRAM loads, an input
+// load, compare and index update), in CPU cycles
+#define LEVEL_CYCLES 16
+// Upper bound for building the inputs, dominated by two square roots
+#define INPUT_CYCLES 2000
+_Static_assert(FALL_MODEL_TREES * FALL_MODEL_DEPTH * LEVEL_CYCLES +
+                       INPUT_CYCLES <=
+                   CONFIG_FALL_LOGIC_CLASSIFIER_CYCLE_BUDGET,
+               "model too large for FALL_LOGIC_CLASSIFIER_CYCLE_BUDGET");
+#endif
+
+#define INTERNAL_NODES ((1 << FALL_MODEL_DEPTH) - 1)
+
+const char *const fall_classifier_input_names[FALL_CLASSIFIER_INPUTS] = {
+    "impact_min_mg",  "impact_max_mg",   "impact_std_mg",
+    "impact_sma_mg",  "impact_jerk_mg_s", "impact_gyro_dps",
+    "post_std_mg",    "post_gyro_dps",   "tilt_deg",
+};
+
+static inline int32_t lsb_to_mg(uint32_t lsb, uint32_t lsb_per_g) {
+  return (int32_t)(((uint64_t)lsb * 1000u + lsb_per_g / 2) / lsb_per_g);
+}
+
+static inline int32_t gyro_rms_dps(uint32_t energy, float lsb_per_dps) {
+  return (int32_t)((float)fall_dsp_isqrt_u32(energy) / lsb_per_dps + 0.5f);
+}
+
+void fall_classifier_inputs(const fall_features_t *impact,
+                            const fall_features_t *now, uint32_t tilt_deg,
+                            uint32_t accel_lsb_per_g, float gyro_lsb_per_dps,
+                            int32_t *inputs) {
+  uint32_t g = accel_lsb_per_g;
+  inputs[FALL_INPUT_IMPACT_MIN_MG] = lsb_to_mg(impact->mag_min, g);
+  inputs[FALL_INPUT_IMPACT_MAX_MG] = lsb_to_mg(impact->mag_max, g);
+  inputs[FALL_INPUT_IMPACT_STD_MG] =
+      lsb_to_mg(fall_dsp_isqrt_u32(impact->mag_var), g);
+  inputs[FALL_INPUT_IMPACT_SMA_MG] = lsb_to_mg(impact->sma, g);
+  inputs[FALL_INPUT_IMPACT_JERK_MG_S] = lsb_to_mg(impact->jerk, g);
+  inputs[FALL_INPUT_IMPACT_GYRO_DPS] =
+      gyro_rms_dps(impact->gyro_energy, gyro_lsb_per_dps);
+  inputs[FALL_INPUT_POST_STD_MG] =
+      lsb_to_mg(fall_dsp_isqrt_u32(now->mag_var), g);
+  inputs[FALL_INPUT_POST_GYRO_DPS] =
+      gyro_rms_dps(now->gyro_energy, gyro_lsb_per_dps);
+  inputs[FALL_INPUT_TILT_DEG] = (int32_t)tilt_deg;
+}
+
+int32_t fall_classifier_score(const int32_t *inputs) {
+  int32_t score = FALL_MODEL_BASE_SCORE;
+  for (int t = 0; t < FALL_MODEL_TREES; t++) {
+    const uint8_t *feature = s_model_feature[t];
+    const int32_t *threshold = s_model_threshold[t];
+    // Heap layout: children of node n are 2n+1 (x <= t) and 2n+2 (x > t)
+    int node = 0;
+    for (int level = 0; level < FALL_MODEL_DEPTH; level++) {
+      node = 2 * node + 1 + (inputs[feature[node]] > threshold[node]);
+    }
+    score += s_model_leaf[t][node - INTERNAL_NODES];
+  }
+  return score;
+}
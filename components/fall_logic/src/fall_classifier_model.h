@@ -0,0 +1,77 @@
+/**
+ * @file fall_classifier_model.h
+ * @brief Fall classifier tables. Generated by
+ * tools/fall_replay/train_classifier.py, do not edit.
+ *
+ * Training data: synthetic placeholder corpus of falls, device drops and
+ * flops onto a bed; retrain on recorded candidates before enabling (68
+ * candidates). 16 trees of depth 3, learning rate 0.3, fall weight 2.0.
+ */
+#ifndef _FALL_CLASSIFIER_MODEL_H_
+#define _FALL_CLASSIFIER_MODEL_H_
+
+#define FALL_MODEL_INPUTS 9
+#define FALL_MODEL_TREES 16
+#define FALL_MODEL_DEPTH 3
+#define FALL_MODEL_BASE_SCORE (253)
+
+// Inputs: impact_min_mg, impact_max_mg, impact_std_mg, impact_sma_mg,
+//   impact_jerk_mg_s, impact_gyro_dps, post_std_mg, post_gyro_dps, tilt_deg
+DRAM_ATTR static const uint8_t
+    s_model_feature[FALL_MODEL_TREES][7] = {
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {5, 0, 8, 0, 0, 0, 0},
+    {5, 0, 2, 0, 0, 0, 0},
+    {5, 0, 5, 0, 0, 0, 0},
+    {5, 0, 1, 0, 0, 0, 0},
+    {8, 0, 0, 0, 0, 0, 0},
+    {5, 0, 0, 0, 0, 0, 0},
+    {8, 0, 0, 0, 0, 0, 0}};
+
+DRAM_ATTR static const int32_t
+    s_model_threshold[FALL_MODEL_TREES][7] = {
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3990, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3687, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 3630, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 91, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 540, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {79, INT32_MAX, 241, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {107, INT32_MAX, 3292, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {91, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {137, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX},
+    {91, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX}};
+
+DRAM_ATTR static const int16_t
+    s_model_leaf[FALL_MODEL_TREES][8] = {
+    {-232, -232, -232, -232, 99, 99, -154, -154},
+    {-136, -136, -136, -136, 89, 89, -112, -112},
+    {-106, -106, -106, -106, 82, 82, -90, -90},
+    {-90, -90, -90, -90, 77, 77, -76, -76},
+    {-80, -80, -80, -80, 73, 73, -66, -66},
+    {-72, -72, -72, -72, 68, 68, -58, -58},
+    {-66, -66, -66, -66, 64, 64, -52, -52},
+    {-60, -60, -60, -60, 60, 60, -42, -42},
+    {-55, -55, -55, -55, 56, 56, -34, -34},
+    {-51, -51, -51, -51, 52, 52, -28, -28},
+    {-47, -47, -47, -47, 47, 47, -22, -22},
+    {-43, -43, -43, -43, 44, 44, -18, -18},
+    {-38, -38, -38, -38, 39, 39, -15, -15},
+    {15, 15, 15, 15, -30, -30, -30, -30},
+    {-27, -27, -27, -27, 13, 13, 13, 13},
+    {14, 14, 14, 14, -26, -26, -26, -26}};
+
+#endif // _FALL_CLASSIFIER_MODEL_H_
@@ -0,0 +1,207 @@
+/**
+ * @file fall_detector.c
+ * @brief Multi-stage fall detector: free-fall, impact, then inactivity.
+ */
+
+#include "fall_detector.h"
+#include <math.h>
+#include <string.h>
+
+#define MS_TO_US(ms) ((uint32_t)(ms) * 1000u)
+
+// Weight of each new sample in the pre-fall posture average (1/32)
+#define GRAVITY_REF_SHIFT 5
+
+// Squares a threshold, saturating beyond what the sensor can report
+static inline uint32_t lsb_sq(uint32_t lsb) {
+  return lsb > UINT16_MAX ? UINT32_MAX : lsb * lsb;
+}
+
+static inline float square(float x) { return x * x; }
+
+static inline uint32_t mg_to_lsb(uint32_t mg, uint32_t lsb_per_g) {
+  return (uint32_t)(((uint64_t)mg * lsb_per_g + 500) / 1000);
+}
+
+static void enter_stage(fall_detector_t *det, fall_stage_t stage,
+                        uint32_t timestamp_us) {
+  det->stage = stage;
+  det->stage_start_us = timestamp_us;
+}
+
+/**
+ * @brief Enters the settle stage, keeping the impact window's features.
+ */
+static void enter_settle(fall_detector_t *det,
+                         const fall_features_t *features) {
+  det->impact = *features;
+  enter_stage(det, FALL_STAGE_SETTLE, features->last.timestamp_us);
+}
+
+/**
+ * @brief Checks whether the mean post-impact vector has rotated away from
+ * the pre-fall posture by at least the configured angle.
+ *
+ * Runs once per post-impact window, so float is fine here; the squared dot
+ * product would overflow 64-bit integers.
+ */
+static bool orientation_changed(const fall_detector_t *det) {
+  if (det->config.orientation_change_deg == 0) {
+    return false;
+  }
+
+  float ref[3], sum[3];
+  for (int i = 0; i < 3; i++) {
+    ref[i] = (float)det->gravity_ref[i];
+    sum[i] = (float)det->post_sum[i];
+  }
+  float dot = ref[0] * sum[0] + ref[1] * sum[1] + ref[2] * sum[2];
+  if (dot <= 0.0f) {
+    return true; // 90 degrees or more
+  }
+
+  // cos(angle) < cos(limit)  <=>  dot^2 < cos^2(limit) * |ref|^2 * |sum|^2
+  float ref_sq = square(ref[0]) + square(ref[1]) + square(ref[2]);
+  float sum_sq = square(sum[0]) + square(sum[1]) + square(sum[2]);
+  return square(dot) < det->orientation_cos_sq * ref_sq * sum_sq;
+}
+
+/**
+ * @brief Checks that the wearer ended up tilted towards horizontal.
+ */
+static bool posture_horizontal(const fall_detector_t *det) {
+  if (det->config.horizontal_min_deg == 0) {
+    return true;
+  }
+  return orientation_tilt_deg(&det->orientation) >=
+         (float)det->config.horizontal_min_deg;
+}
+
+void fall_detector_init(fall_detector_t *det,
+                        const fall_detector_config_t *config) {
+  memset(det, 0, sizeof(*det));
+  det->config = *config;
+
+  uint32_t lsb_per_g = config->accel_lsb_per_g;
+  det->freefall_sq =
+      lsb_sq(mg_to_lsb(config->freefall_threshold_mg, lsb_per_g));
+  det->impact_sq = lsb_sq(mg_to_lsb(config->impact_threshold_mg, lsb_per_g));
+  det->impact_only_sq = lsb_sq(mg_to_lsb(config->impact_only_mg, lsb_per_g));
+
+  uint32_t one_g = lsb_per_g;
+  uint32_t tol = mg_to_lsb(config->inactivity_tolerance_mg, lsb_per_g);
+  det->still_min_sq = tol < one_g ? lsb_sq(one_g - tol) : 0;
+  det->still_max_sq = lsb_sq(one_g + tol);
+
+  float cos_limit = cosf((float)config->orientation_change_deg *
+                         (float)M_PI / 180.0f);
+  det->orientation_cos_sq = square(cos_limit);
+
+  // Assume upright until the first samples refine the posture
+  det->gravity_ref[2] = (int32_t)one_g << GRAVITY_REF_SHIFT;
+
+  orientation_config_t orientation_config = ORIENTATION_DEFAULT_CONFIG();
+  orientation_config.accel_lsb_per_g = lsb_per_g;
+  orientation_config.gyro_lsb_per_dps = config->gyro_lsb_per_dps;
+  orientation_init(&det->orientation, &orientation_config);
+  det->stage = FALL_STAGE_IDLE;
+}
+
+void fall_detector_reset(fall_detector_t *det) {
+  det->stage = FALL_STAGE_IDLE;
+  det->stage_start_us = 0;
+}
+
+bool fall_detector_update(fall_detector_t *det,
+                          const fall_features_t *features) {
+  const fall_detector_config_t *cfg = &det->config;
+  const sensor_raw_t *frame = &features->last;
+  uint32_t timestamp_us = frame->timestamp_us;
+  uint32_t mag_sq = features->last_mag_sq;
+  uint32_t elapsed_us = timestamp_us - det->stage_start_us;
+
+  if (cfg->horizontal_min_deg > 0) {
+    orientation_update(&det->orientation, frame);
+  }
+
+  switch (det->stage) {
+  case FALL_STAGE_IDLE:
+    if (mag_sq < det->freefall_sq) {
+      enter_stage(det, FALL_STAGE_FREEFALL, timestamp_us);
+    } else if (cfg->impact_only_mg > 0 && mag_sq > det->impact_only_sq) {
+      enter_settle(det, features);
+    } else {
+      // Exponential average kept scaled by 2^GRAVITY_REF_SHIFT
+      int32_t *ref = det->gravity_ref;
+      ref[0] += frame->accel_x - (ref[0] >> GRAVITY_REF_SHIFT);
+      ref[1] += frame->accel_y - (ref[1] >> GRAVITY_REF_SHIFT);
+      ref[2] += frame->accel_z - (ref[2] >> GRAVITY_REF_SHIFT);
+    }
+    break;
+
+  case FALL_STAGE_FREEFALL:
+    if (mag_sq >= det->freefall_sq) {
+      // Low-g phase ended: long enough to be a fall?
+      if (elapsed_us >= MS_TO_US(cfg->freefall_min_ms)) {
+        enter_stage(det, FALL_STAGE_IMPACT_WAIT, timestamp_us);
+        if (mag_sq > det->impact_sq) {
+          enter_settle(det, features);
+        }
+      } else {
+        enter_stage(det, FALL_STAGE_IDLE, timestamp_us);
+      }
+    }
+    break;
+
+  case FALL_STAGE_IMPACT_WAIT:
+    if (mag_sq > det->impact_sq) {
+      enter_settle(det, features);
+    } else if (elapsed_us > MS_TO_US(cfg->impact_window_ms)) {
+      enter_stage(det, FALL_STAGE_IDLE, timestamp_us);
+    }
+    break;
+
+  case FALL_STAGE_SETTLE:
+    if (elapsed_us >= MS_TO_US(cfg->settle_ms)) {
+      det->post_sum[0] = 0;
+      det->post_sum[1] = 0;
+      det->post_sum[2] = 0;
+      det->post_still = true;
+      enter_stage(det, FALL_STAGE_POST_IMPACT, timestamp_us);
+    }
+    break;
+
+  case FALL_STAGE_POST_IMPACT:
+    det->post_sum[0] += frame->accel_x;
+    det->post_sum[1] += frame->accel_y;
+    det->post_sum[2] += frame->accel_z;
+    if (mag_sq < det->still_min_sq || mag_sq > det->still_max_sq) {
+      det->post_still = false;
+    }
+
+    if (elapsed_us >= MS_TO_US(cfg->inactivity_ms)) {
+      bool confirmed = (det->post_still || orientation_changed(det)) &&
+                       posture_horizontal(det);
+      enter_stage(det, FALL_STAGE_IDLE, timestamp_us);
+      return confirmed;
+    }
+    break;
+  }
+
+  return false;
+}
+
+fall_stage_t fall_detector_get_stage(const fall_detector_t *det) {
+  return det->stage;
+}
+
+const fall_features_t *fall_detector_impact(const fall_detector_t *det) {
+  return &det->impact;
+}
+
+float fall_detector_tilt_deg(const fall_detector_t *det) {
+  if (det->config.horizontal_min_deg == 0) {
+    return 0.0f;
+  }
+  return orientation_tilt_deg(&det->orientation);
+}
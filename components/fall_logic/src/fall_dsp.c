@@ -0,0 +1,57 @@
+/**
+ * @file fall_dsp.c
+ * @brief Batch kernels over arrays of IMU frames.
+ */
+
+#include "fall_dsp.h"
+
+void fall_dsp_mag_sq_s16(const sensor_raw_t *frames, size_t n,
+                         uint32_t *out) {
+  // esp-dsp has no int16 kernel with a 32-bit result; the Xtensa core
+  // does a 16x16 multiply in one cycle, so plain C is already tight here.
+  for (size_t i = 0; i < n; i++) {
+    int32_t x = frames[i].accel_x;
+    int32_t y = frames[i].accel_y;
+    int32_t z = frames[i].accel_z;
+    out[i] = (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z);
+  }
+}
+
+size_t fall_dsp_find_below_u32(const uint32_t *values, size_t n,
+                               uint32_t threshold) {
+  for (size_t i = 0; i < n; i++) {
+    if (values[i] < threshold) {
+      return i;
+    }
+  }
+  return n;
+}
+
+size_t fall_dsp_find_above_u32(const uint32_t *values, size_t n,
+                               uint32_t threshold) {
+  for (size_t i = 0; i < n; i++) {
+    if (values[i] > threshold) {
+      return i;
+    }
+  }
+  return n;
+}
+
+uint32_t fall_dsp_isqrt_u32(uint32_t x) {
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+
+  while (bit > x) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
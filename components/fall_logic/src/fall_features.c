@@ -0,0 +1,161 @@
+/**
+ * @file fall_features.c
+ * @brief Incremental sliding-window features over an IMU sample stream.
+ */
+
+#include "fall_features.h"
+#include "fall_dsp.h"
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint32_t deque_slot(uint32_t head, uint32_t offset) {
+  return (head + offset) % FALL_FEATURES_MAX_WINDOW;
+}
+
+void fall_features_init(fall_feature_window_t *fw, uint32_t window_samples) {
+  if (window_samples == 0) {
+    window_samples = 1;
+  } else if (window_samples > FALL_FEATURES_MAX_WINDOW) {
+    window_samples = FALL_FEATURES_MAX_WINDOW;
+  }
+
+  memset(fw, 0, sizeof(*fw));
+  fw->window = window_samples;
+}
+
+void fall_features_reset(fall_feature_window_t *fw) {
+  fall_features_init(fw, fw->window);
+}
+
+/**
+ * @brief Drops deque entries that left the window from the front.
+ */
+static void deque_expire(const uint32_t *q, uint32_t *head, uint32_t *len,
+                         uint32_t oldest_seq) {
+  while (*len > 0 && (int32_t)(q[*head] - oldest_seq) < 0) {
+    *head = deque_slot(*head, 1);
+    (*len)--;
+  }
+}
+
+/**
+ * @brief Pushes a sequence number on the back of a monotonic deque.
+ *
+ * Entries at the back that can never again be the extreme are popped first.
+ * With @p keep_smaller the deque tracks the minimum, otherwise the maximum.
+ */
+static void deque_push(const fall_feature_window_t *fw, uint32_t *q,
+                       uint32_t head, uint32_t *len, uint32_t seq,
+                       uint32_t value, bool keep_smaller) {
+  while (*len > 0) {
+    uint32_t back = q[deque_slot(head, *len - 1)];
+    uint32_t back_value = fw->entries[back % fw->window].mag;
+    if (keep_smaller ? back_value < value : back_value > value) {
+      break;
+    }
+    (*len)--;
+  }
+  q[deque_slot(head, *len)] = seq;
+  (*len)++;
+}
+
+const fall_features_t *fall_features_update(fall_feature_window_t *fw,
+                                            const sensor_raw_t *frame,
+                                            uint32_t mag_sq) {
+  int32_t gx = frame->gyro_x;
+  int32_t gy = frame->gyro_y;
+  int32_t gz = frame->gyro_z;
+
+  fall_feature_entry_t in;
+  in.mag = (uint16_t)fall_dsp_isqrt_u32(mag_sq);
+  in.sma = (uint32_t)(abs(frame->accel_x) + abs(frame->accel_y) +
+                      abs(frame->accel_z));
+  in.gyro_energy = (uint32_t)(gx * gx) + (uint32_t)(gy * gy) +
+                   (uint32_t)(gz * gz);
+
+  // Kept in µs: at 333 or 500 Hz a jittered period truncated to whole
+  // milliseconds is off by up to half, and the error does not average out
+  in.jerk = 0;
+  in.dt_us = 0;
+  if (fw->seq > 0) {
+    in.dt_us = frame->timestamp_us - fw->prev.timestamp_us;
+    in.jerk = (uint32_t)(abs(frame->accel_x - fw->prev.accel_x) +
+                         abs(frame->accel_y - fw->prev.accel_y) +
+                         abs(frame->accel_z - fw->prev.accel_z));
+  }
+  fw->prev = *frame;
+
+  // Remove the contribution of the sample that leaves the window
+  uint32_t slot = fw->seq % fw->window;
+  if (fw->count == fw->window) {
+    const fall_feature_entry_t *out = &fw->entries[slot];
+    fw->sum_mag -= out->mag;
+    fw->sum_mag_sq -= (uint32_t)out->mag * out->mag;
+    fw->sum_sma -= out->sma;
+    fw->sum_jerk -= out->jerk;
+    fw->sum_dt_us -= out->dt_us;
+    fw->sum_gyro_energy -= out->gyro_energy;
+  } else {
+    fw->count++;
+  }
+
+  fw->entries[slot] = in;
+  fw->sum_mag += in.mag;
+  fw->sum_mag_sq += (uint32_t)in.mag * in.mag;
+  fw->sum_sma += in.sma;
+  fw->sum_jerk += in.jerk;
+  fw->sum_dt_us += in.dt_us;
+  fw->sum_gyro_energy += in.gyro_energy;
+
+  uint32_t oldest_seq = fw->seq + 1 - fw->count;
+  deque_expire(fw->min_q, &fw->min_head, &fw->min_len, oldest_seq);
+  deque_expire(fw->max_q, &fw->max_head, &fw->max_len, oldest_seq);
+  deque_push(fw, fw->min_q, fw->min_head, &fw->min_len, fw->seq, in.mag,
+             true);
+  deque_push(fw, fw->max_q, fw->max_head, &fw->max_len, fw->seq, in.mag,
+             false);
+  fw->seq++;
+
+  // Derive the snapshot from the running sums
+  fall_features_t *f = &fw->latest;
+  uint32_t n = fw->count;
+  uint32_t mean = fw->sum_mag / n;
+  uint64_t mean_sq = fw->sum_mag_sq / n;
+
+  f->last = *frame;
+  f->last_mag_sq = mag_sq;
+  f->count = n;
+  f->mag_mean = mean;
+  f->mag_var = mean_sq > (uint64_t)mean * mean
+                   ? (uint32_t)(mean_sq - (uint64_t)mean * mean)
+                   : 0;
+  f->mag_min = fw->entries[fw->min_q[fw->min_head] % fw->window].mag;
+  f->mag_max = fw->entries[fw->max_q[fw->max_head] % fw->window].mag;
+  f->sma = fw->sum_sma / n;
+  f->jerk = fw->sum_dt_us > 0
+                ? (uint32_t)((uint64_t)fw->sum_jerk * 1000000u / fw->sum_dt_us)
+                : 0;
+  f->gyro_energy = (uint32_t)(fw->sum_gyro_energy / n);
+
+  return f;
+}
+
+const fall_features_t *fall_features_get(const fall_feature_window_t *fw) {
+  return &fw->latest;
+}
+
+void fall_features_scale(const fall_features_t *features,
+                         fall_features_scaled_t *out) {
+  const float accel_lsb = (float)mpu6050_get_accel_lsb_per_g();
+  const float gyro_lsb = mpu6050_get_gyro_lsb_per_dps();
+
+  mpu6050_raw_to_data(&features->last, &out->last);
+  out->count = features->count;
+  out->mag_mean = features->mag_mean / accel_lsb;
+  out->mag_var = features->mag_var / (accel_lsb * accel_lsb);
+  out->mag_min = features->mag_min / accel_lsb;
+  out->mag_max = features->mag_max / accel_lsb;
+  out->sma = features->sma / accel_lsb;
+  out->jerk = features->jerk / accel_lsb;
+  out->gyro_energy = features->gyro_energy / (gyro_lsb * gyro_lsb);
+}
@@ -1,37 +1,720 @@
 #include "fall_logic.h"
+#include "alert_trace.h"
 #include "data_manager.h"
+#include "fall_acq.h"
+#include "fall_pipeline.h"
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+#include "fall_rate.h"
+#endif
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+#include "fall_monitor.h"
+#endif
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "event_handler.h"
+#include "fall_capture.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
-#include "math.h"
 #include "mpu6050.h"
+#include "power_manager.h"
+#include "task_topology.h"
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+#include "mqtt_client.h"
+#include "user_mqtt.h"
+#include <stdio.h>
+#include <string.h>
+#endif
+#include <stdlib.h>
 
 static const char *TAG = "FALL_LOGIC";
 
-#define FALL_THRESHOLD ((float)CONFIG_FALL_LOGIC_THRESHOLD_G / 1000.0f)
-#define CHECK_INTERVAL_MS CONFIG_FALL_LOGIC_CHECK_INTERVAL_MS
 #define FALL_TASK_STACK_SIZE CONFIG_FALL_LOGIC_TASK_STACK_SIZE
-#define FALL_TASK_PRIORITY CONFIG_FALL_LOGIC_TASK_PRIORITY
+#define SAMPLE_RING_SIZE CONFIG_FALL_LOGIC_SAMPLE_RING_SIZE
+
+#if CONFIG_FALL_LOGIC_ACQ_DATA_READY
+#define SAMPLE_RATE_HZ CONFIG_FALL_LOGIC_SAMPLE_RATE_HZ
+#define DATA_READY_TIMEOUT_MS CONFIG_FALL_LOGIC_DATA_READY_TIMEOUT_MS
+#define MPU6050_INT_GPIO CONFIG_MPU6050_INT_GPIO
+#define BATCH_MAX_FRAMES 1
+#define WAKE_PERIOD_US (1000000u / SAMPLE_RATE_HZ)
+#elif CONFIG_FALL_LOGIC_ACQ_FIFO
+#define SAMPLE_RATE_HZ CONFIG_FALL_LOGIC_SAMPLE_RATE_HZ
+#define FIFO_BATCH_MS CONFIG_FALL_LOGIC_FIFO_BATCH_MS
+#define BATCH_MAX_FRAMES MPU6050_FIFO_MAX_FRAMES
+#define WAKE_PERIOD_US (FIFO_BATCH_MS * 1000u)
+#else
+#define CHECK_INTERVAL_MS CONFIG_FALL_LOGIC_CHECK_INTERVAL_MS
+#define SAMPLE_RATE_HZ (1000 / CHECK_INTERVAL_MS)
+#define BATCH_MAX_FRAMES 1
+#define WAKE_PERIOD_US (CHECK_INTERVAL_MS * 1000u)
+#endif
+
+// Motion-interrupt low-power mode needs the data-ready INT wiring
+#define LOW_POWER_MODE                                                         \
+  (CONFIG_POWER_MANAGER_ENABLE && CONFIG_FALL_LOGIC_ACQ_DATA_READY)
+#if LOW_POWER_MODE
+#define STILL_TIMEOUT_US                                                       \
+  ((uint32_t)CONFIG_POWER_MANAGER_STILL_TIMEOUT_MS * 1000u)
+#define MOTION_THRESHOLD_MG CONFIG_POWER_MANAGER_MOTION_THRESHOLD_MG
+#define MOTION_DURATION_MS CONFIG_POWER_MANAGER_MOTION_DURATION_MS
+#define MOTION_CHECK_MS CONFIG_POWER_MANAGER_MOTION_CHECK_MS
+#endif
+
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+#define RATE_MEDIUM_HZ CONFIG_FALL_LOGIC_RATE_MEDIUM_HZ
+#define RATE_LOW_HZ CONFIG_FALL_LOGIC_RATE_LOW_HZ
+#if RATE_LOW_HZ == 5
+#define RATE_LOW_WAKE MPU6050_LP_WAKE_5HZ
+#elif RATE_LOW_HZ == 20
+#define RATE_LOW_WAKE MPU6050_LP_WAKE_20HZ
+#else
+#define RATE_LOW_WAKE MPU6050_LP_WAKE_40HZ
+#endif
+// Cycle mode samples slower than the regular data-ready timeout allows
+#define RATE_LOW_TIMEOUT_MS (3 * 1000 / RATE_LOW_HZ)
+_Static_assert(1000 / RATE_LOW_HZ < CONFIG_FALL_LOGIC_FREEFALL_MIN_MS,
+               "a free-fall must span more than one cycle-mode period");
+#endif
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+#define SHADOW_REPORT_TICKS                                                    \
+  ((TickType_t)CONFIG_FALL_LOGIC_SHADOW_REPORT_S * configTICK_RATE_HZ)
+#define SHADOW_REPORT_SIZE 640
+#endif
+
+// Feature window length in samples at the configured (full) rate
+#define FEATURE_WINDOW_SAMPLES                                                 \
+  (CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS * SAMPLE_RATE_HZ / 1000)
 
 // Internal state variables
 static bool s_fall_logic_enabled = true;
+#if CONFIG_FALL_LOGIC_ACQ_DATA_READY
+// True while samples are paced by the MPU6050 data-ready interrupt
+static bool s_data_ready_active = false;
+#endif
+// Acquisition counters; missed counts samples overwritten before a read
+static fall_acq_stats_t s_acq;
 // Flag to manage if a fall has been detected and is being processed
 static bool s_fall_detected = false;
 // Mutex to protect the s_fall_detected flag from race conditions
 static portMUX_TYPE s_fall_detected_mux = portMUX_INITIALIZER_UNLOCKED;
+#if CONFIG_FALL_LOGIC_ACQ_FIFO
+// Samples drained from the FIFO in the current wake-up
+static sensor_raw_t s_batch[BATCH_MAX_FRAMES];
+#endif
+// Every acquired frame is published here for fall logic and other consumers
+static sensor_raw_t s_ring_storage[SAMPLE_RING_SIZE];
+static sample_ring_t s_sample_ring;
+static sample_ring_reader_t s_fall_reader;
+// Feature window and detector
+static fall_pipeline_t s_pipeline;
+// Classifier candidates already logged
+static uint32_t s_candidates_logged = 0;
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+// Shadow counters already logged, and when they were last published
+static fall_shadow_stats_t s_shadow_logged[FALL_VARIANTS];
+static TickType_t s_shadow_reported = 0;
+static char s_shadow_report[SHADOW_REPORT_SIZE];
+#endif
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+// Rate policy and the tier currently programmed into the sensor
+static fall_rate_t s_rate;
+static fall_rate_tier_t s_rate_applied = FALL_RATE_HIGH;
+// Guards s_rate against readers in other tasks
+static portMUX_TYPE s_rate_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+// Follows the wearer after a reported fall
+static fall_monitor_t s_monitor;
+// Guards s_monitor against readers in other tasks
+static portMUX_TYPE s_monitor_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+// Wake-up period of fall_task, guarded by s_jitter_mux
+static task_jitter_t s_jitter;
+static portMUX_TYPE s_jitter_mux = portMUX_INITIALIZER_UNLOCKED;
+// Held while the CPU must stay awake for data-ready edge interrupts
+static power_lock_t s_power_lock = NULL;
+#if LOW_POWER_MODE
+// Start of the current still period, valid while s_still is true
+static bool s_still = false;
+static uint32_t s_still_since_us = 0;
+#endif
+
+/**
+ * @brief esp_timer time of a frame, from its wrapping 32-bit timestamp.
+ */
+static int64_t frame_time_us(uint32_t timestamp_us) {
+  int64_t now_us = esp_timer_get_time();
+  return now_us - (uint32_t)((uint32_t)now_us - timestamp_us);
+}
+
+/**
+ * @brief Acceleration of a frame in mg, for event payloads.
+ */
+static void accel_mg(const sensor_raw_t *frame, int16_t mg[3]) {
+  sensor_data_t data;
+  mpu6050_raw_to_data(frame, &data);
+  mg[0] = (int16_t)(data.accel_x * 1000.0f);
+  mg[1] = (int16_t)(data.accel_y * 1000.0f);
+  mg[2] = (int16_t)(data.accel_z * 1000.0f);
+}
+
+/**
+ * @brief Latches the fall flag and raises the fall event once.
+ *
+ * The first detection also freezes the fall capture, which the alert it
+ * raises releases for upload. Detections while the flag is latched raise
+ * no alert, so they must not trigger a capture nothing would release.
+ *
+ * @return true if this detection raised the event.
+ */
+static bool report_fall(const sensor_raw_t *frame) {
+  // Use a critical section to safely check and set the flag
+  taskENTER_CRITICAL(&s_fall_detected_mux);
+  bool first_detection = !s_fall_detected;
+  // Set the flag to prevent repeated events until the alert is handled
+  s_fall_detected = true;
+  taskEXIT_CRITICAL(&s_fall_detected_mux);
+
+  if (first_detection) {
+    // The capture must be frozen before the alert can release it
+    fall_capture_trigger(frame->timestamp_us);
+
+    sensor_data_t data;
+    mpu6050_raw_to_data(frame, &data);
+    ESP_LOGW(TAG, "FALL DETECTED! Accel=(%.2f, %.2f, %.2f)", data.accel_x,
+             data.accel_y, data.accel_z);
+
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+    taskENTER_CRITICAL(&s_monitor_mux);
+    fall_monitor_start(&s_monitor, frame->timestamp_us);
+    taskEXIT_CRITICAL(&s_monitor_mux);
+#endif
+
+    // Send event to the event handler, stamped with the confirming frame
+    const fall_features_t *features = fall_pipeline_features(&s_pipeline);
+    system_event_msg_t event = {
+        .type = EVENT_FALL_DETECTED,
+        .timestamp_us = frame_time_us(frame->timestamp_us),
+    };
+    event.data.impact.peak_mg = (uint32_t)((uint64_t)features->mag_max *
+                                           1000 /
+                                           mpu6050_get_accel_lsb_per_g());
+    accel_mg(frame, event.data.impact.accel_mg);
+    event.data.impact.alert_id = alert_trace_begin(
+        frame_time_us(fall_pipeline_trigger_us(&s_pipeline, frame)),
+        event.timestamp_us);
+    if (event_handler_send_msg(&event) != ESP_OK) {
+      ESP_LOGE(TAG, "Fall event not sent, releasing the capture");
+      fall_capture_upload();
+    }
+  }
+  return first_detection;
+}
+
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+/**
+ * @brief Follows the wearer after a fall and raises the long-lie and
+ * recovery events.
+ */
+static void update_monitor(void) {
+  const fall_features_t *features = fall_pipeline_features(&s_pipeline);
+
+  taskENTER_CRITICAL(&s_monitor_mux);
+  fall_monitor_event_t event = fall_monitor_update(&s_monitor, features);
+  fall_monitor_status_t status;
+  fall_monitor_get_status(&s_monitor, &status);
+  taskEXIT_CRITICAL(&s_monitor_mux);
+
+  if (event == FALL_MONITOR_NONE) {
+    return;
+  }
+
+  system_event_msg_t msg = {
+      .timestamp_us = frame_time_us(features->last.timestamp_us),
+      .data.orientation =
+          {
+              .still_ms = status.still_ms,
+              .since_fall_ms = status.since_fall_ms,
+          },
+  };
+  accel_mg(&features->last, msg.data.orientation.accel_mg);
+
+  if (event == FALL_MONITOR_LONG_LIE) {
+    ESP_LOGW(TAG, "LONG LIE! Motionless for %lu s since the fall",
+             (unsigned long)(status.still_ms / 1000));
+    msg.type = EVENT_FALL_LONG_LIE;
+  } else {
+    ESP_LOGI(TAG, "Wearer moving again %lu s after the fall",
+             (unsigned long)(status.since_fall_ms / 1000));
+    msg.type = EVENT_FALL_RECOVERED;
+  }
+  event_handler_send_msg(&msg);
+}
+#endif
+
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+/**
+ * @brief Programs the sensor for a rate tier.
+ *
+ * On failure the previous tier is kept and the next batch retries.
+ */
+static void apply_rate(fall_rate_tier_t tier) {
+  if (tier == s_rate_applied) {
+    return;
+  }
+
+  esp_err_t err = ESP_OK;
+  if (tier == FALL_RATE_LOW) {
+    err = mpu6050_enable_cycle_mode(RATE_LOW_WAKE);
+  } else {
+    if (s_rate_applied == FALL_RATE_LOW) {
+      err = mpu6050_disable_cycle_mode();
+    }
+    if (err == ESP_OK) {
+      err = mpu6050_set_sample_rate(tier == FALL_RATE_HIGH ? SAMPLE_RATE_HZ
+                                                           : RATE_MEDIUM_HZ);
+    }
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to switch to the %s rate: %s",
+             fall_rate_tier_names[tier], esp_err_to_name(err));
+    return;
+  }
+
+  ESP_LOGD(TAG, "Sample rate %s -> %s", fall_rate_tier_names[s_rate_applied],
+           fall_rate_tier_names[tier]);
+  s_rate_applied = tier;
+
+  uint32_t rate_hz = tier == FALL_RATE_HIGH     ? SAMPLE_RATE_HZ
+                     : tier == FALL_RATE_MEDIUM ? RATE_MEDIUM_HZ
+                                                : RATE_LOW_HZ;
+  taskENTER_CRITICAL(&s_jitter_mux);
+  task_jitter_set_period(&s_jitter, 1000000u / rate_hz);
+  taskEXIT_CRITICAL(&s_jitter_mux);
+}
+
+/**
+ * @brief Picks the rate tier from the latest features and applies it.
+ */
+static void update_rate(void) {
+  const fall_features_t *features = fall_pipeline_features(&s_pipeline);
+  bool idle = fall_pipeline_is_idle(&s_pipeline);
+
+  taskENTER_CRITICAL(&s_rate_mux);
+  fall_rate_tier_t tier = fall_rate_update(&s_rate, features, idle);
+  taskEXIT_CRITICAL(&s_rate_mux);
+
+  apply_rate(tier);
+}
+#endif
+
+#if LOW_POWER_MODE
+/**
+ * @brief Tracks how long the magnitude has stayed within the motion band.
+ */
+static void update_stillness(const fall_features_t *features) {
+  bool still = features->count > 1 &&
+               features->mag_max - features->mag_min <
+                   MPU6050_MG_TO_LSB(MOTION_THRESHOLD_MG);
+  // Never sleep in the middle of a detection
+  still = still && fall_pipeline_is_idle(&s_pipeline);
+
+  if (!still) {
+    s_still = false;
+  } else if (!s_still) {
+    s_still = true;
+    s_still_since_us = features->last.timestamp_us;
+  }
+}
+
+/**
+ * @brief Checks whether the wearer has been still long enough to sleep.
+ */
+static bool low_power_due(void) {
+  if (!s_still || !s_data_ready_active || s_fall_detected) {
+    return false;
+  }
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+  // Lying still after a fall is what the monitor is waiting for
+  if (fall_monitor_is_active(&s_monitor)) {
+    return false;
+  }
+#endif
+  const fall_features_t *features = fall_pipeline_features(&s_pipeline);
+  return features->last.timestamp_us - s_still_since_us >= STILL_TIMEOUT_US;
+}
+
+/**
+ * @brief Checks a low-power wait that timed out against the sensor.
+ *
+ * The wearer may simply not have moved; otherwise the motion interrupt was
+ * lost or the sensor stopped answering, and sampling must resume.
+ * @return true when the wait can go on.
+ */
+static bool still_asleep(const sensor_raw_t *reference) {
+  sensor_raw_t now;
+  if (mpu6050_read_raw(&now) != ESP_OK) {
+    ESP_LOGW(TAG, "MPU6050 not answering in low-power mode");
+    return false;
+  }
+  const int32_t limit = (int32_t)MPU6050_MG_TO_LSB(MOTION_THRESHOLD_MG);
+  if (abs(now.accel_x - reference->accel_x) > limit ||
+      abs(now.accel_y - reference->accel_y) > limit ||
+      abs(now.accel_z - reference->accel_z) > limit) {
+    ESP_LOGW(TAG, "Moved without a motion interrupt");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Waits in light sleep until the MPU6050 reports motion.
+ *
+ * Full-rate sampling resumes as soon as the motion interrupt wakes the
+ * task: restoring data-ready takes a few I2C writes, well within one
+ * sample period. The wait is bounded by MOTION_CHECK_MS so a lost
+ * interrupt or a sensor that stopped answering cannot keep the task
+ * asleep for good.
+ */
+static void enter_low_power(void) {
+  sensor_raw_t reference;
+  if (mpu6050_enable_motion_wakeup(MOTION_THRESHOLD_MG, MOTION_DURATION_MS) !=
+      ESP_OK) {
+    s_still = false;
+    return;
+  }
+  if (mpu6050_read_raw(&reference) != ESP_OK) {
+    mpu6050_disable_motion_wakeup();
+    s_still = false;
+    return;
+  }
+  ESP_LOGI(TAG, "Wearer still, waiting for motion in light sleep");
+
+  // Drop data-ready notifications that arrived before the switch
+  ulTaskNotifyTake(pdTRUE, 0);
+  power_manager_lock_release(s_power_lock);
+  bool woken = true;
+  while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MOTION_CHECK_MS)) == 0) {
+    if (!still_asleep(&reference)) {
+      woken = false;
+      break;
+    }
+  }
+  power_manager_lock_acquire(s_power_lock);
+
+  mpu6050_disable_motion_wakeup();
+  ulTaskNotifyTake(pdTRUE, 0);
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+  // The wake-up may be the start of a fall
+  taskENTER_CRITICAL(&s_rate_mux);
+  fall_rate_set_tier(&s_rate, FALL_RATE_HIGH);
+  taskEXIT_CRITICAL(&s_rate_mux);
+  apply_rate(FALL_RATE_HIGH);
+#endif
+
+  // The window and the wake-up period would otherwise span the gap
+  fall_pipeline_reset(&s_pipeline);
+  taskENTER_CRITICAL(&s_jitter_mux);
+  task_jitter_restart(&s_jitter);
+  taskEXIT_CRITICAL(&s_jitter_mux);
+  s_still = false;
+  if (woken) {
+    ESP_LOGI(TAG, "Motion detected, full-rate sampling resumed");
+  } else {
+    ESP_LOGW(TAG, "No motion interrupt, full-rate sampling resumed");
+  }
+}
+#endif
 
 /**
- * @brief Simple algorithm to detect a fall based on acceleration magnitude.
- * @param data Sensor data from MPU6050.
- * @return true if a fall condition is detected, false otherwise.
+ * @brief Logs the classifier's verdict on the latest detector candidate.
  */
-static bool detect_fall(sensor_data_t data) {
-  float total_accel =
-      sqrtf(data.accel_x * data.accel_x + data.accel_y * data.accel_y +
-            data.accel_z * data.accel_z);
-  return total_accel < FALL_THRESHOLD;
+static void log_candidate(void) {
+  const fall_classifier_result_t *c = fall_pipeline_candidate(&s_pipeline);
+  if (c->count == s_candidates_logged) {
+    return;
+  }
+  s_candidates_logged = c->count;
+
+#if CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE
+  if (!c->accepted) {
+    ESP_LOGI(TAG, "Fall candidate rejected by classifier (score %ld)",
+             (long)c->score);
+  }
+  if (c->cycles > CONFIG_FALL_LOGIC_CLASSIFIER_CYCLE_BUDGET) {
+    ESP_LOGW(TAG, "Classifier took %lu cycles, budget %d",
+             (unsigned long)c->cycles,
+             CONFIG_FALL_LOGIC_CLASSIFIER_CYCLE_BUDGET);
+  }
+#endif
+  ESP_LOGD(TAG, "Fall candidate: score %ld, %lu cycles", (long)c->score,
+           (unsigned long)c->cycles);
+}
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+/**
+ * @brief Logs shadow verdicts resolved since the last call.
+ */
+static void log_shadow(void) {
+  const fall_shadow_t *shadow = fall_pipeline_shadow(&s_pipeline);
+  const char *authority =
+      fall_variant_names[fall_shadow_get_authoritative(shadow)];
+
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    const fall_shadow_stats_t *stats = fall_shadow_get_stats(shadow, v);
+    fall_shadow_stats_t *logged = &s_shadow_logged[v];
+    const char *name = fall_variant_names[v];
+
+    if (stats->agreed != logged->agreed) {
+      ESP_LOGI(TAG, "Shadow %s agrees with %s", name, authority);
+    }
+    if (stats->shadow_only != logged->shadow_only) {
+      ESP_LOGI(TAG, "Shadow %s detected a fall %s did not", name,
+               authority);
+    }
+    if (stats->missed != logged->missed) {
+      ESP_LOGI(TAG, "Shadow %s missed the fall detected by %s", name,
+               authority);
+    }
+    *logged = *stats;
+  }
+}
+
+/**
+ * @brief Mean cycles per sample over @p samples.
+ */
+static float cycles_per_sample(uint64_t cycles, uint32_t samples) {
+  return samples ? (float)cycles / (float)samples : 0.0f;
+}
+
+/**
+ * @brief Publishes the shadow counters since boot as JSON.
+ *
+ * The message is only queued in the MQTT outbox, so the fall task never
+ * waits on the network.
+ */
+static void publish_shadow_report(void) {
+  const fall_shadow_t *shadow = fall_pipeline_shadow(&s_pipeline);
+  uint32_t samples = fall_shadow_get_samples(shadow);
+  char *buf = s_shadow_report;
+  size_t size = sizeof(s_shadow_report);
+
+  int len = snprintf(
+      buf, size,
+      "{\"authoritative\":\"%s\",\"samples\":%lu,"
+      "\"feature_cycles_per_sample\":%.1f,\"detectors\":[",
+      fall_variant_names[fall_shadow_get_authoritative(shadow)],
+      (unsigned long)samples,
+      cycles_per_sample(fall_shadow_get_feature_cycles(shadow), samples));
+
+  for (int v = 0; v < FALL_VARIANTS && len > 0 && (size_t)len < size; v++) {
+    const fall_shadow_stats_t *stats = fall_shadow_get_stats(shadow, v);
+    float cycles = cycles_per_sample(stats->cycles, samples);
+    len += snprintf(buf + len, size - len,
+                    "%s{\"name\":\"%s\",\"events\":%lu,\"agreed\":%lu,"
+                    "\"shadow_only\":%lu,\"missed\":%lu,"
+                    "\"cycles_per_sample\":%.1f}",
+                    v ? "," : "", fall_variant_names[v],
+                    (unsigned long)stats->events, (unsigned long)stats->agreed,
+                    (unsigned long)stats->shadow_only,
+                    (unsigned long)stats->missed, cycles);
+    ESP_LOGI(TAG, "Shadow %s: %lu events, %lu agreed, %lu extra, %lu missed, "
+                  "%.1f cycles/sample",
+             fall_variant_names[v], (unsigned long)stats->events,
+             (unsigned long)stats->agreed, (unsigned long)stats->shadow_only,
+             (unsigned long)stats->missed, cycles);
+  }
+  if (len > 0 && (size_t)len < size) {
+    len += snprintf(buf + len, size - len, "]}");
+  }
+  if (len <= 0 || (size_t)len >= size) {
+    ESP_LOGE(TAG, "Shadow report does not fit in %u bytes", (unsigned)size);
+    return;
+  }
+
+  esp_mqtt_client_handle_t client = user_mqtt_get_client();
+  if (client == NULL ||
+      esp_mqtt_client_enqueue(client, CONFIG_FALL_LOGIC_SHADOW_MQTT_TOPIC, buf,
+                              len, 0, 0, true) < 0) {
+    ESP_LOGW(TAG, "Shadow report not queued");
+  }
+}
+
+/**
+ * @brief Logs new shadow verdicts and publishes the counters when due.
+ */
+static void update_shadow(void) {
+  log_shadow();
+
+  TickType_t now = xTaskGetTickCount();
+  if (now - s_shadow_reported >= SHADOW_REPORT_TICKS) {
+    s_shadow_reported = now;
+    publish_shadow_report();
+  }
+}
+#endif
+
+/**
+ * @brief Runs the detector over frames read from the sample ring.
+ *
+ * The pipeline stops at each confirmed fall so the frames can be handed to
+ * the fall capture split at the detection: the trigger frame is the last
+ * one of the pre-trigger window.
+ */
+static void process_frames(const sensor_raw_t *frames, size_t count) {
+  while (count > 0) {
+    size_t fall_index = fall_pipeline_process(&s_pipeline, frames, count);
+    size_t used = fall_index < count ? fall_index + 1 : count;
+
+    fall_capture_feed(frames, used);
+    if (fall_index < count && !report_fall(&frames[fall_index])) {
+      ESP_LOGD(TAG, "Fall already latched, detection ignored");
+    }
+    frames += used;
+    count -= used;
+  }
+  log_candidate();
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  update_shadow();
+#endif
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+  update_monitor();
+#endif
+
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+  update_rate();
+#endif
+#if LOW_POWER_MODE
+  update_stillness(fall_pipeline_features(&s_pipeline));
+#endif
+}
+
+/**
+ * @brief Blocks until the next sample (or FIFO burst) is due.
+ *
+ * In data-ready mode the task sleeps on its notification value, which the
+ * MPU6050 ISR increments once per sample.
+ *
+ * @return Samples latched since the last wake-up, 0 if the data-ready wait
+ * timed out. Always 1 in the other modes.
+ */
+static uint32_t wait_for_samples(void) {
+#if CONFIG_FALL_LOGIC_ACQ_DATA_READY
+  if (s_data_ready_active) {
+    uint32_t timeout_ms = DATA_READY_TIMEOUT_MS;
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+    if (s_rate_applied == FALL_RATE_LOW && timeout_ms < RATE_LOW_TIMEOUT_MS) {
+      timeout_ms = RATE_LOW_TIMEOUT_MS;
+    }
+#endif
+    uint32_t pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    if (pending == 0) {
+      ESP_LOGW(TAG, "No data-ready interrupt within %lu ms, polling sensor",
+               (unsigned long)timeout_ms);
+    }
+    return pending;
+  }
+  // Interrupt setup failed: poll as fast as the tick allows
+  vTaskDelay(1);
+#elif CONFIG_FALL_LOGIC_ACQ_FIFO
+  static TickType_t last_wake = 0;
+  if (last_wake == 0) {
+    last_wake = xTaskGetTickCount();
+  }
+  vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(FIFO_BATCH_MS));
+#else
+  static TickType_t last_wake = 0;
+  if (last_wake == 0) {
+    last_wake = xTaskGetTickCount();
+  }
+  vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CHECK_INTERVAL_MS));
+#endif
+  return 1;
+}
+
+/**
+ * @brief Records the wake-up time for the sampling jitter statistics.
+ */
+static void record_wakeup(void) {
+  uint32_t now_us = (uint32_t)esp_timer_get_time();
+  taskENTER_CRITICAL(&s_jitter_mux);
+  task_jitter_tick(&s_jitter, now_us);
+  taskEXIT_CRITICAL(&s_jitter_mux);
+}
+
+/**
+ * @brief Reads the samples that became available since the last wake-up
+ * and publishes them to the sample ring.
+ *
+ * @param pending Value returned by wait_for_samples().
+ * @return Number of frames pushed.
+ */
+static size_t acquire_samples(uint32_t pending) {
+#if CONFIG_FALL_LOGIC_ACQ_FIFO
+  (void)pending;
+  static uint32_t lost_seen = 0;
+  size_t count = 0;
+  esp_err_t err = mpu6050_fifo_read(s_batch, BATCH_MAX_FRAMES, &count);
+  if (err == ESP_ERR_INVALID_STATE) {
+    uint32_t lost = mpu6050_fifo_get_lost_frames();
+    s_acq.missed += lost - lost_seen;
+    ESP_LOGW(TAG, "MPU6050 FIFO overflowed, %lu samples lost",
+             (unsigned long)(lost - lost_seen));
+    lost_seen = lost;
+  } else if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to drain MPU6050 FIFO");
+  }
+  sample_ring_push_batch(&s_sample_ring, s_batch, count);
+  return count;
+#else
+  size_t count =
+      fall_acq_data_ready(&s_acq, pending, mpu6050_read_raw, &s_sample_ring);
+  if (count == 0) {
+    ESP_LOGE(TAG, "Failed to read MPU6050 data");
+  }
+  return count;
+#endif
+}
+
+/**
+ * @brief Configures the sensor for the selected acquisition mode.
+ */
+static void start_acquisition(void) {
+#if CONFIG_FALL_LOGIC_ACQ_DATA_READY
+  esp_err_t err = mpu6050_set_sample_rate(SAMPLE_RATE_HZ);
+  if (err == ESP_OK) {
+    err = mpu6050_enable_data_ready(MPU6050_INT_GPIO,
+                                    xTaskGetCurrentTaskHandle());
+  }
+
+  if (err == ESP_OK) {
+    s_data_ready_active = true;
+    // Edge interrupts do not wake the chip from light sleep
+    power_manager_lock_acquire(s_power_lock);
+    ESP_LOGI(TAG, "Data-ready sampling at %d Hz on GPIO %d", SAMPLE_RATE_HZ,
+             MPU6050_INT_GPIO);
+  } else {
+    ESP_LOGE(TAG, "Data-ready setup failed (%s), falling back to polling",
+             esp_err_to_name(err));
+    taskENTER_CRITICAL(&s_jitter_mux);
+    task_jitter_set_period(&s_jitter, portTICK_PERIOD_MS * 1000u);
+    taskEXIT_CRITICAL(&s_jitter_mux);
+  }
+#elif CONFIG_FALL_LOGIC_ACQ_FIFO
+  esp_err_t err = mpu6050_set_sample_rate(SAMPLE_RATE_HZ);
+  if (err == ESP_OK) {
+    err = mpu6050_fifo_enable();
+  }
+
+  if (err == ESP_OK) {
+    ESP_LOGI(TAG, "FIFO sampling at %d Hz, draining every %d ms",
+             SAMPLE_RATE_HZ, FIFO_BATCH_MS);
+  } else {
+    ESP_LOGE(TAG, "FIFO setup failed: %s", esp_err_to_name(err));
+  }
+#endif
 }
 
 /**
@@ -40,50 +723,108 @@ static bool detect_fall(sensor_data_t data) {
 static void fall_task(void *param) {
   ESP_LOGI(TAG, "Fall detection task started");
 
+  start_acquisition();
+
   while (1) {
-    if (!s_fall_logic_enabled) {
-      vTaskDelay(pdMS_TO_TICKS(CHECK_INTERVAL_MS));
-      continue;
-    }
+    uint32_t pending = wait_for_samples();
+    record_wakeup();
 
-    sensor_data_t data;
+    // Always drain the sensor so the FIFO cannot overflow while disabled
+    size_t count = acquire_samples(pending);
 
-    if (mpu6050_read_data(&data) == ESP_OK) {
-      if (detect_fall(data)) {
-        // Use a critical section to safely check and set the flag
-        taskENTER_CRITICAL(&s_fall_detected_mux);
-        if (!s_fall_detected) {
-          ESP_LOGW(TAG, "FALL DETECTED! Accel=(%.2f, %.2f, %.2f)", data.accel_x,
-                   data.accel_y, data.accel_z);
-
-          // Send event to the event handler
-          event_handler_send_event(EVENT_FALL_DETECTED);
-
-          // Set the flag to prevent repeated events until the alert is handled
-          s_fall_detected = true;
-        }
-        taskEXIT_CRITICAL(&s_fall_detected_mux);
+    const sensor_raw_t *frames;
+    while ((count = sample_ring_peek(&s_fall_reader, &frames)) > 0) {
+      if (s_fall_logic_enabled) {
+        process_frames(frames, count);
       }
-    } else {
-      ESP_LOGE(TAG, "Failed to read MPU6050 data");
+      sample_ring_consume(&s_fall_reader, count);
     }
 
-    vTaskDelay(pdMS_TO_TICKS(CHECK_INTERVAL_MS));
+#if LOW_POWER_MODE
+    if (low_power_due()) {
+      enter_low_power();
+    }
+#endif
   }
 }
 
+/**
+ * @brief Applies the stored sensor offsets, calibrating on first boot.
+ *
+ * A failed calibration (device moved, I2C error) is not fatal: detection
+ * runs uncalibrated and the next boot tries again.
+ */
+static void load_calibration(void) {
+  if (mpu6050_bias_load() == ESP_OK) {
+    return;
+  }
+
+#if CONFIG_FALL_LOGIC_CALIBRATE_ON_FIRST_BOOT
+  esp_err_t err = mpu6050_calibrate(CONFIG_MPU6050_CALIB_SAMPLES, NULL);
+  if (err == ESP_OK) {
+    mpu6050_bias_save();
+  } else {
+    ESP_LOGW(TAG, "Sensor calibration failed (%s), running uncalibrated",
+             esp_err_to_name(err));
+  }
+#else
+  ESP_LOGW(TAG, "No sensor calibration stored, running uncalibrated");
+#endif
+}
+
 // Module initialization function
 esp_err_t fall_logic_init(void) {
+  esp_err_t err = mpu6050_init();
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "MPU6050 initialization failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  load_calibration();
+
+  err = sample_ring_init(&s_sample_ring, s_ring_storage, SAMPLE_RING_SIZE);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Sample ring initialization failed: %s",
+             esp_err_to_name(err));
+    return err;
+  }
+  sample_ring_reader_init(&s_fall_reader, &s_sample_ring, "fall_logic");
+  if (fall_capture_init(SAMPLE_RATE_HZ) != ESP_OK) {
+    ESP_LOGW(TAG, "Fall capture unavailable, alerts are sent without it");
+  }
+  power_manager_lock_create("fall_task", &s_power_lock);
+
+  fall_detector_config_t detector_config = FALL_DETECTOR_DEFAULT_CONFIG();
+  detector_config.accel_lsb_per_g = mpu6050_get_accel_lsb_per_g();
+  detector_config.gyro_lsb_per_dps = mpu6050_get_gyro_lsb_per_dps();
+  fall_pipeline_init(&s_pipeline, FEATURE_WINDOW_SAMPLES, &detector_config);
+  s_candidates_logged = 0;
+  task_jitter_init(&s_jitter, WAKE_PERIOD_US);
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+  fall_rate_config_t rate_config = FALL_RATE_DEFAULT_CONFIG();
+  rate_config.accel_lsb_per_g = detector_config.accel_lsb_per_g;
+  fall_rate_init(&s_rate, &rate_config);
+  s_rate_applied = FALL_RATE_HIGH;
+#endif
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+  fall_monitor_config_t monitor_config = FALL_MONITOR_DEFAULT_CONFIG();
+  monitor_config.accel_lsb_per_g = detector_config.accel_lsb_per_g;
+  monitor_config.gyro_lsb_per_dps = detector_config.gyro_lsb_per_dps;
+  fall_monitor_init(&s_monitor, &monitor_config);
+#endif
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  memset(s_shadow_logged, 0, sizeof(s_shadow_logged));
+  s_shadow_reported = xTaskGetTickCount();
+#endif
+
   ESP_LOGI(TAG, "Fall logic initialized");
   return ESP_OK;
 }
 
 // Starts the fall detection task
 esp_err_t fall_logic_start(void) {
-  BaseType_t result = xTaskCreate(fall_task, "fall_task", FALL_TASK_STACK_SIZE,
-                                  NULL, FALL_TASK_PRIORITY, NULL);
-
-  if (result != pdPASS) {
+  if (task_topology_create(TASK_TOPOLOGY_FALL, fall_task,
+                           FALL_TASK_STACK_SIZE, NULL, NULL) != ESP_OK) {
     ESP_LOGE(TAG, "Failed to create fall_task");
     return ESP_FAIL;
   }
@@ -107,6 +848,42 @@ esp_err_t fall_logic_disable(void) {
 
 bool fall_logic_is_enabled(void) { return s_fall_logic_enabled; }
 
+uint32_t fall_logic_get_missed_samples(void) { return s_acq.missed; }
+
+sample_ring_t *fall_logic_get_sample_ring(void) { return &s_sample_ring; }
+
+esp_err_t fall_logic_get_jitter_stats(task_jitter_stats_t *stats) {
+  taskENTER_CRITICAL(&s_jitter_mux);
+  *stats = *task_jitter_get_stats(&s_jitter);
+  taskEXIT_CRITICAL(&s_jitter_mux);
+  return ESP_OK;
+}
+
+esp_err_t fall_logic_reset_jitter_stats(void) {
+  taskENTER_CRITICAL(&s_jitter_mux);
+  task_jitter_reset(&s_jitter);
+  taskEXIT_CRITICAL(&s_jitter_mux);
+  return ESP_OK;
+}
+
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+esp_err_t fall_logic_get_rate_stats(fall_rate_stats_t *stats) {
+  taskENTER_CRITICAL(&s_rate_mux);
+  *stats = *fall_rate_get_stats(&s_rate);
+  taskEXIT_CRITICAL(&s_rate_mux);
+  return ESP_OK;
+}
+#endif
+
+#if CONFIG_FALL_LOGIC_LONG_LIE_ENABLE
+esp_err_t fall_logic_get_monitor_status(fall_monitor_status_t *status) {
+  taskENTER_CRITICAL(&s_monitor_mux);
+  fall_monitor_get_status(&s_monitor, status);
+  taskEXIT_CRITICAL(&s_monitor_mux);
+  return ESP_OK;
+}
+#endif
+
 // New function to reset the fall status, to be called from event_handler
 esp_err_t fall_logic_reset_fall_status(void) {
   // Use a critical section to safely reset the flag
@@ -0,0 +1,93 @@
+/**
+ * @file fall_monitor.c
+ * @brief Post-fall monitoring: long-lie escalation and recovery.
+ */
+
+#include "fall_monitor.h"
+#include <string.h>
+
+// Longer gaps (detection disabled) are not counted as lying still
+#define MAX_GAP_US 1000000u
+
+#define MS_TO_US(ms) ((uint64_t)(ms) * 1000u)
+
+static inline uint32_t square_sat(uint32_t v) {
+  return v > UINT16_MAX ? UINT32_MAX : v * v;
+}
+
+void fall_monitor_init(fall_monitor_t *m, const fall_monitor_config_t *config) {
+  memset(m, 0, sizeof(*m));
+  m->config = *config;
+  uint32_t still_lsb = (uint32_t)(((uint64_t)config->still_mg *
+                                       config->accel_lsb_per_g +
+                                   500) /
+                                  1000);
+  m->still_var = square_sat(still_lsb);
+  // gyro_energy is the mean of gx^2+gy^2+gz^2
+  float still_gyro = (float)config->still_dps * config->gyro_lsb_per_dps;
+  float still_gyro_sq = still_gyro * still_gyro;
+  m->still_gyro = still_gyro_sq >= (float)UINT32_MAX
+                      ? UINT32_MAX
+                      : (uint32_t)still_gyro_sq;
+  m->state = FALL_MONITOR_IDLE;
+}
+
+void fall_monitor_start(fall_monitor_t *m, uint32_t timestamp_us) {
+  if (m->state == FALL_MONITOR_IDLE) {
+    m->state = FALL_MONITOR_WATCHING;
+  }
+  m->last_us = timestamp_us;
+  m->elapsed_us = 0;
+  m->still_us = 0;
+  m->moving = false;
+}
+
+void fall_monitor_stop(fall_monitor_t *m) { m->state = FALL_MONITOR_IDLE; }
+
+fall_monitor_event_t fall_monitor_update(fall_monitor_t *m,
+                                         const fall_features_t *features) {
+  if (m->state == FALL_MONITOR_IDLE) {
+    return FALL_MONITOR_NONE;
+  }
+
+  const fall_monitor_config_t *cfg = &m->config;
+  uint32_t now_us = features->last.timestamp_us;
+  uint32_t dt_us = now_us - m->last_us;
+  m->last_us = now_us;
+  if (dt_us > MAX_GAP_US) {
+    dt_us = 0;
+  }
+
+  bool moving = features->mag_var > m->still_var ||
+                features->gyro_energy > m->still_gyro;
+  m->elapsed_us += dt_us;
+
+  if (!moving) {
+    m->moving = false;
+    m->still_us += dt_us;
+  } else if (!m->moving) {
+    m->moving = true;
+    m->moving_since_us = now_us;
+  } else if (now_us - m->moving_since_us >= MS_TO_US(cfg->recovery_ms)) {
+    m->state = FALL_MONITOR_IDLE;
+    return FALL_MONITOR_RECOVERED;
+  }
+
+  if (m->state == FALL_MONITOR_WATCHING &&
+      m->still_us >= MS_TO_US(cfg->long_lie_ms)) {
+    m->state = FALL_MONITOR_ESCALATED;
+    return FALL_MONITOR_LONG_LIE;
+  }
+  return FALL_MONITOR_NONE;
+}
+
+bool fall_monitor_is_active(const fall_monitor_t *m) {
+  return m->state != FALL_MONITOR_IDLE;
+}
+
+void fall_monitor_get_status(const fall_monitor_t *m,
+                             fall_monitor_status_t *status) {
+  status->state = m->state;
+  status->since_fall_ms = (uint32_t)(m->elapsed_us / 1000u);
+  status->still_ms = (uint32_t)(m->still_us / 1000u);
+}
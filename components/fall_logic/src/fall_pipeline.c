@@ -0,0 +1,240 @@
+/**
+ * @file fall_pipeline.c
+ * @brief Frame-to-decision path shared by the firmware and host tools.
+ */
+
+#include "fall_pipeline.h"
+#include "fall_dsp.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#define CYCLE_COUNT() ((uint32_t)esp_cpu_get_cycle_count())
+#else
+#define CYCLE_COUNT() 0u
+#endif
+
+#if CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE
+#define CLASSIFIER_DEFAULT true
+#else
+#define CLASSIFIER_DEFAULT false
+#endif
+
+// Which detectors are compiled in; shadow mode runs all of them
+#define HAS_DETECTOR                                                           \
+  (CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE || CONFIG_FALL_LOGIC_SHADOW_ENABLE)
+#define HAS_THRESHOLD                                                          \
+  (!CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE || CONFIG_FALL_LOGIC_SHADOW_ENABLE)
+
+#if HAS_THRESHOLD
+static inline uint32_t mg_to_lsb(uint32_t mg, uint32_t lsb_per_g) {
+  return (uint32_t)(((uint64_t)mg * lsb_per_g + 500) / 1000);
+}
+#endif
+
+/**
+ * @brief Scores a detector candidate.
+ *
+ * @param impact Features when the impact was detected.
+ * @param tilt_deg Tilt from standing, 0 when not tracked.
+ * @param features Features on the confirming sample.
+ * @return true when the classifier accepts the candidate.
+ */
+static bool classify(fall_pipeline_t *p, const fall_features_t *impact,
+                     uint32_t tilt_deg, const fall_features_t *features) {
+  fall_classifier_result_t *c = &p->candidate;
+  uint32_t start = CYCLE_COUNT();
+
+  fall_classifier_inputs(impact, features, tilt_deg, p->accel_lsb_per_g,
+                         p->gyro_lsb_per_dps, c->inputs);
+  c->score = fall_classifier_score(c->inputs);
+  c->accepted = c->score >= 0;
+
+  c->cycles = CYCLE_COUNT() - start;
+  c->count++;
+  return c->accepted;
+}
+
+#if HAS_DETECTOR
+/**
+ * @brief Scores a candidate of the multi-stage detector.
+ */
+static bool classify_detector(fall_pipeline_t *p,
+                              const fall_features_t *features) {
+  uint32_t tilt_deg = (uint32_t)(fall_detector_tilt_deg(&p->detector) + 0.5f);
+  return classify(p, fall_detector_impact(&p->detector), tilt_deg, features);
+}
+#endif
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+/**
+ * @brief Variant whose verdict the pipeline reports.
+ */
+static fall_variant_t authoritative_variant(const fall_pipeline_t *p) {
+#if CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE
+  return p->classifier_enabled ? FALL_VARIANT_CLASSIFIER
+                               : FALL_VARIANT_MULTI_STAGE;
+#else
+  // The model is trained on multi-stage candidates: it only runs as shadow
+  (void)p;
+  return FALL_VARIANT_THRESHOLD;
+#endif
+}
+
+/**
+ * @brief Runs every variant on one sample and accounts the verdicts.
+ * @return Verdict of the authoritative variant.
+ */
+static bool run_variants(fall_pipeline_t *p, const fall_features_t *features,
+                         uint32_t feature_cycles) {
+  fall_shadow_sample_t sample = {.feature_cycles = feature_cycles};
+  uint32_t start = CYCLE_COUNT();
+
+  sample.verdict[FALL_VARIANT_THRESHOLD] =
+      features->last_mag_sq < p->threshold_sq;
+  uint32_t now = CYCLE_COUNT();
+  sample.cycles[FALL_VARIANT_THRESHOLD] = now - start;
+  start = now;
+
+  bool candidate = fall_detector_update(&p->detector, features);
+  sample.verdict[FALL_VARIANT_MULTI_STAGE] = candidate;
+  now = CYCLE_COUNT();
+  sample.cycles[FALL_VARIANT_MULTI_STAGE] = now - start;
+
+  // Scores the detector's candidates, its cost is on top of the detector's
+  if (candidate) {
+    sample.verdict[FALL_VARIANT_CLASSIFIER] = classify_detector(p, features);
+    sample.cycles[FALL_VARIANT_CLASSIFIER] = p->candidate.cycles;
+  }
+
+  fall_shadow_update(&p->shadow, features->last.timestamp_us, &sample);
+  return sample.verdict[fall_shadow_get_authoritative(&p->shadow)];
+}
+#endif
+
+void fall_pipeline_init(fall_pipeline_t *p, uint32_t window_samples,
+                        const fall_detector_config_t *config) {
+  fall_features_init(&p->features, window_samples);
+  p->accel_lsb_per_g = config->accel_lsb_per_g;
+  p->gyro_lsb_per_dps = config->gyro_lsb_per_dps;
+  p->classifier_enabled = CLASSIFIER_DEFAULT;
+  memset(&p->candidate, 0, sizeof(p->candidate));
+#if HAS_DETECTOR
+  fall_detector_init(&p->detector, config);
+#endif
+#if HAS_THRESHOLD
+  uint32_t lsb =
+      mg_to_lsb(config->freefall_threshold_mg, config->accel_lsb_per_g);
+  // Squared, saturating beyond what the sensor can report
+  p->threshold_sq = lsb > UINT16_MAX ? UINT32_MAX : lsb * lsb;
+#endif
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  fall_shadow_init(&p->shadow, authoritative_variant(p),
+                   CONFIG_FALL_LOGIC_SHADOW_MATCH_MS);
+#endif
+}
+
+void fall_pipeline_set_classifier(fall_pipeline_t *p, bool enabled) {
+  p->classifier_enabled = enabled;
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  fall_variant_t authoritative = authoritative_variant(p);
+  if (authoritative != fall_shadow_get_authoritative(&p->shadow)) {
+    fall_shadow_set_authoritative(&p->shadow, authoritative);
+  }
+#endif
+}
+
+void fall_pipeline_reset(fall_pipeline_t *p) {
+  fall_features_reset(&p->features);
+#if HAS_DETECTOR
+  fall_detector_reset(&p->detector);
+#endif
+}
+
+size_t fall_pipeline_process(fall_pipeline_t *p, const sensor_raw_t *frames,
+                             size_t count) {
+  for (size_t done = 0; done < count; done += FALL_PIPELINE_CHUNK_FRAMES) {
+    size_t n = count - done;
+    if (n > FALL_PIPELINE_CHUNK_FRAMES) {
+      n = FALL_PIPELINE_CHUNK_FRAMES;
+    }
+    fall_dsp_mag_sq_s16(&frames[done], n, p->chunk_mag_sq);
+
+#if !CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE && !CONFIG_FALL_LOGIC_SHADOW_ENABLE
+    // Simple algorithm: any sample below the free-fall threshold is a fall
+    size_t fall_index =
+        fall_dsp_find_below_u32(p->chunk_mag_sq, n, p->threshold_sq);
+#endif
+
+    for (size_t i = 0; i < n; i++) {
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+      uint32_t start = CYCLE_COUNT();
+#endif
+      const fall_features_t *features = fall_features_update(
+          &p->features, &frames[done + i], p->chunk_mag_sq[i]);
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+      bool fall = run_variants(p, features, CYCLE_COUNT() - start);
+#elif CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE
+      bool fall = fall_detector_update(&p->detector, features) &&
+                  (classify_detector(p, features) || !p->classifier_enabled);
+#else
+      // The trigger sample is the impact window as well
+      bool fall = i == fall_index &&
+                  (classify(p, features, 0, features) ||
+                   !p->classifier_enabled);
+#endif
+      if (fall) {
+        return done + i;
+      }
+#if !CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE && !CONFIG_FALL_LOGIC_SHADOW_ENABLE
+      if (i == fall_index) {
+        // Vetoed: look for the next low sample of this chunk
+        fall_index = i + 1 + fall_dsp_find_below_u32(&p->chunk_mag_sq[i + 1],
+                                                      n - i - 1,
+                                                      p->threshold_sq);
+      }
+#endif
+    }
+  }
+  return count;
+}
+
+const fall_features_t *fall_pipeline_features(const fall_pipeline_t *p) {
+  return fall_features_get(&p->features);
+}
+
+const fall_classifier_result_t *
+fall_pipeline_candidate(const fall_pipeline_t *p) {
+  return &p->candidate;
+}
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+const fall_shadow_t *fall_pipeline_shadow(const fall_pipeline_t *p) {
+  return &p->shadow;
+}
+
+void fall_pipeline_shadow_flush(fall_pipeline_t *p) {
+  fall_shadow_flush(&p->shadow);
+}
+#endif
+
+bool fall_pipeline_is_idle(const fall_pipeline_t *p) {
+#if CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE
+  return fall_detector_get_stage(&p->detector) == FALL_STAGE_IDLE;
+#else
+  (void)p;
+  return true;
+#endif
+}
+
+uint32_t fall_pipeline_trigger_us(const fall_pipeline_t *p,
+                                  const sensor_raw_t *confirm) {
+#if CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE
+  (void)confirm;
+  return fall_detector_impact(&p->detector)->last.timestamp_us;
+#else
+  (void)p;
+  return confirm->timestamp_us;
+#endif
+}
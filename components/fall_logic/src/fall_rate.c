@@ -0,0 +1,94 @@
+/**
+ * @file fall_rate.c
+ * @brief Sampling rate tier selection from the activity level.
+ */
+
+#include "fall_rate.h"
+#include <string.h>
+
+// Longer gaps (light sleep, detection disabled) are not counted to a tier
+#define MAX_GAP_US 1000000u
+
+#define MS_TO_US(ms) ((uint32_t)(ms) * 1000u)
+
+const char *const fall_rate_tier_names[FALL_RATE_TIERS] = {
+    "low",
+    "medium",
+    "high",
+};
+
+static inline uint32_t mg_to_lsb(uint32_t mg, uint32_t lsb_per_g) {
+  return (uint32_t)(((uint64_t)mg * lsb_per_g + 500) / 1000);
+}
+
+static inline uint32_t square_sat(uint32_t v) {
+  return v > UINT16_MAX ? UINT32_MAX : v * v;
+}
+
+void fall_rate_init(fall_rate_t *r, const fall_rate_config_t *config) {
+  memset(r, 0, sizeof(*r));
+  r->config = *config;
+  uint32_t g = config->accel_lsb_per_g;
+  r->freefall = mg_to_lsb(config->freefall_mg, g);
+  r->active_var = square_sat(mg_to_lsb(config->active_std_mg, g));
+  r->still_band = mg_to_lsb(config->still_band_mg, g);
+  r->tier = FALL_RATE_HIGH;
+}
+
+void fall_rate_set_tier(fall_rate_t *r, fall_rate_tier_t tier) {
+  r->tier = tier;
+  r->still = false;
+  r->started = false;
+}
+
+fall_rate_tier_t fall_rate_update(fall_rate_t *r,
+                                  const fall_features_t *features,
+                                  bool detector_idle) {
+  const fall_rate_config_t *cfg = &r->config;
+  uint32_t now_us = features->last.timestamp_us;
+
+  if (r->started && now_us - r->last_us <= MAX_GAP_US) {
+    r->stats.time_us[r->tier] += now_us - r->last_us;
+  }
+  r->started = true;
+  r->last_us = now_us;
+
+  fall_rate_tier_t tier = r->tier;
+  bool urgent = (features->count > 0 && features->mag_min < r->freefall) ||
+                features->mag_var > r->active_var || !detector_idle;
+  bool still = features->count > 1 &&
+               features->mag_max - features->mag_min < r->still_band;
+
+  if (!still) {
+    r->still = false;
+  } else if (!r->still) {
+    r->still = true;
+    r->still_since_us = now_us;
+  }
+
+  if (urgent) {
+    tier = FALL_RATE_HIGH;
+    r->calm_since_us = now_us;
+  } else if (tier == FALL_RATE_HIGH) {
+    if (now_us - r->calm_since_us >= MS_TO_US(cfg->high_hold_ms)) {
+      tier = FALL_RATE_MEDIUM;
+    }
+  } else if (tier == FALL_RATE_LOW && !still) {
+    tier = FALL_RATE_MEDIUM;
+  } else if (tier == FALL_RATE_MEDIUM && r->still &&
+             now_us - r->still_since_us >= MS_TO_US(cfg->still_ms)) {
+    tier = FALL_RATE_LOW;
+  }
+
+  if (tier != r->tier) {
+    r->tier = tier;
+    r->stats.switches++;
+  }
+  return tier;
+}
+
+fall_rate_tier_t fall_rate_get_tier(const fall_rate_t *r) { return r->tier; }
+
+const fall_rate_stats_t *fall_rate_get_stats(const fall_rate_t *r) {
+  return &r->stats;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file fall_shadow.c
+ * @brief A/B bookkeeping for detectors running in shadow mode.
+ */
+
+#include "fall_shadow.h"
+#include <string.h>
+
+const char *const fall_variant_names[FALL_VARIANTS] = {
+    "threshold",
+    "multi_stage",
+    "classifier",
+};
+
+static void clear(fall_shadow_t *s) {
+  fall_variant_t authoritative = s->authoritative;
+  uint32_t match_us = s->match_us;
+  memset(s, 0, sizeof(*s));
+  s->authoritative = authoritative;
+  s->match_us = match_us;
+}
+
+void fall_shadow_init(fall_shadow_t *s, fall_variant_t authoritative,
+                      uint32_t match_ms) {
+  s->authoritative = authoritative;
+  s->match_us = match_ms * 1000u;
+  clear(s);
+}
+
+void fall_shadow_set_authoritative(fall_shadow_t *s,
+                                   fall_variant_t authoritative) {
+  s->authoritative = authoritative;
+  clear(s);
+}
+
+fall_variant_t fall_shadow_get_authoritative(const fall_shadow_t *s) {
+  return s->authoritative;
+}
+
+/**
+ * @brief Turns a verdict into an event unless the variant already had one
+ * within the match window.
+ */
+static bool take_event(fall_shadow_t *s, fall_variant_t v, bool verdict,
+                       uint32_t now_us) {
+  if (!verdict ||
+      (s->has_event[v] && now_us - s->event_us[v] < s->match_us)) {
+    return false;
+  }
+  s->has_event[v] = true;
+  s->event_us[v] = now_us;
+  s->stats[v].events++;
+  return true;
+}
+
+void fall_shadow_update(fall_shadow_t *s, uint32_t timestamp_us,
+                        const fall_shadow_sample_t *sample) {
+  fall_variant_t a = s->authoritative;
+
+  s->samples++;
+  s->feature_cycles += sample->feature_cycles;
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    s->stats[v].cycles += sample->cycles[v];
+  }
+
+  bool authority_event =
+      take_event(s, a, sample->verdict[a], timestamp_us);
+
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    if (v == (int)a) {
+      continue;
+    }
+    fall_shadow_stats_t *st = &s->stats[v];
+
+    // Unmatched events older than the window are disagreements
+    if (s->shadow_pending[v] &&
+        timestamp_us - s->shadow_us[v] > s->match_us) {
+      s->shadow_pending[v] = false;
+      st->shadow_only++;
+    }
+    if (s->authority_pending[v] &&
+        timestamp_us - s->authority_us[v] > s->match_us) {
+      s->authority_pending[v] = false;
+      st->missed++;
+    }
+
+    if (authority_event) {
+      if (s->shadow_pending[v]) {
+        s->shadow_pending[v] = false;
+        st->agreed++;
+      } else {
+        s->authority_pending[v] = true;
+        s->authority_us[v] = timestamp_us;
+      }
+    }
+    if (take_event(s, v, sample->verdict[v], timestamp_us)) {
+      if (s->authority_pending[v]) {
+        s->authority_pending[v] = false;
+        st->agreed++;
+      } else {
+        s->shadow_pending[v] = true;
+        s->shadow_us[v] = timestamp_us;
+      }
+    }
+  }
+}
+
+void fall_shadow_flush(fall_shadow_t *s) {
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    if (s->shadow_pending[v]) {
+      s->shadow_pending[v] = false;
+      s->stats[v].shadow_only++;
+    }
+    if (s->authority_pending[v]) {
+      s->authority_pending[v] = false;
+      s->stats[v].missed++;
+    }
+  }
+}
+
+const fall_shadow_stats_t *fall_shadow_get_stats(const fall_shadow_t *s,
+                                                 fall_variant_t variant) {
+  return &s->stats[variant];
+}
+
+uint32_t fall_shadow_get_samples(const fall_shadow_t *s) {
+  return s->samples;
+}
+
+uint64_t fall_shadow_get_feature_cycles(const fall_shadow_t *s) {
+  return s->feature_cycles;
+}
@@ -17,6 +17,8 @@ extern "C" {
 #endif
 
 #include "data_manager_types.h"
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Creates a JSON payload representing the current device status.
@@ -33,18 +35,45 @@ extern "C" {
 char *json_wrapper_create_status_payload(void);
 
 /**
- * @brief Creates a JSON payload for a fall alert event.
+ * @brief Writes the JSON payload of a fall alert into @p buf.
  *
- * This function generates a specific JSON string to signal that a fall has
- * been detected, including relevant information such as the device ID and
- * timestamp.
+ * Alert payloads are formatted in place rather than built with cJSON, so an
+ * alert can be sent while the heap is exhausted. The payload carries the
+ * device ID, the timestamp and the GPS position, or a message when there is
+ * no fix.
  *
- * @warning The returned string must be freed by the caller to prevent memory
- * leaks.
+ * @param buf Output buffer.
+ * @param size Size of @p buf.
+ * @return Length of the payload, or -1 if it does not fit or the device
+ * state is unavailable.
+ */
+int json_wrapper_write_alert_payload(char *buf, size_t size);
+
+/**
+ * @brief Writes the JSON payload of a long-lie alert into @p buf.
  *
- * @return A pointer to a dynamically allocated JSON string.
+ * Sent when the wearer has stayed motionless after a fall. Carries a
+ * critical severity so the backend can escalate it over the first alert.
+ *
+ * @param buf Output buffer.
+ * @param size Size of @p buf.
+ * @param lying_s Motionless time since the fall, in seconds.
+ * @return Length of the payload, or -1 on failure.
+ */
+int json_wrapper_write_long_lie_payload(char *buf, size_t size,
+                                        uint32_t lying_s);
+
+/**
+ * @brief Writes the JSON payload sent when the wearer got up after a
+ * long-lie alert into @p buf.
+ *
+ * @param buf Output buffer.
+ * @param size Size of @p buf.
+ * @param lying_s Motionless time since the fall, in seconds.
+ * @return Length of the payload, or -1 on failure.
  */
-char *json_wrapper_create_alert_payload(void);
+int json_wrapper_write_recovery_payload(char *buf, size_t size,
+                                        uint32_t lying_s);
 
 #ifdef __cplusplus
 }
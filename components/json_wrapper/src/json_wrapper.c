@@ -1,11 +1,15 @@
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "activity.h"
 #include "cJSON.h"
 #include "data_manager.h"
 #include "esp_log.h"
 #include "json_wrapper.h"
+#include "power_manager.h"
 
 static const char *TAG = "JSON_WRAPPER";
 
@@ -44,6 +48,29 @@ char *json_wrapper_create_status_payload(void) {
   cJSON_AddNumberToObject(root, "longitude", data.gps_data.longitude);
   cJSON_AddBoolToObject(root, "has_gps_fix", data.gps_data.has_gps_fix);
 
+#if CONFIG_POWER_MANAGER_ENABLE
+  // Light sleep share, lets the backend track battery behaviour
+  power_manager_stats_t pm;
+  power_manager_get_stats(&pm);
+  cJSON_AddNumberToObject(root, "uptime_ms", (double)(pm.uptime_us / 1000));
+  cJSON_AddNumberToObject(root, "sleep_ms", (double)(pm.sleep_us / 1000));
+#endif
+
+#if CONFIG_ACTIVITY_ENABLE
+  // Today's activity totals
+  activity_stats_t act;
+  if (activity_get_stats(&act) == ESP_OK) {
+    cJSON *activity = cJSON_AddObjectToObject(root, "activity");
+    if (activity) {
+      cJSON_AddNumberToObject(activity, "day", act.day);
+      cJSON_AddNumberToObject(activity, "steps", act.today.steps);
+      cJSON_AddNumberToObject(activity, "active_min", act.today.active_min);
+      cJSON_AddNumberToObject(activity, "sedentary_min",
+                              act.today.sedentary_min);
+    }
+  }
+#endif
+
   // 4. Print the JSON object to a string
   char *json_str = cJSON_PrintUnformatted(root);
   if (!json_str) {
@@ -58,53 +85,128 @@ char *json_wrapper_create_status_payload(void) {
 }
 
 /**
- * @brief Creates a JSON payload string for a fall alert.
+ * @brief Appends formatted text at @p *len, tracking overflow.
  *
- * This function retrieves the current device state and creates a specific
- * alert payload.
- *
- * @return A pointer to the dynamically allocated JSON string on success, or
- * NULL.
+ * @return false once the buffer is full; later calls do nothing.
  */
-char *json_wrapper_create_alert_payload(void) {
-  // 1. Get data from the Data Manager
+static bool append(char *buf, size_t size, int *len, const char *fmt, ...) {
+  if (*len < 0) {
+    return false;
+  }
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + *len, size - *len, fmt, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - *len) {
+    *len = -1;
+    return false;
+  }
+  *len += n;
+  return true;
+}
+
+/**
+ * @brief Appends @p str as a JSON string, escaping quotes, backslashes and
+ * control characters.
+ */
+static void append_string(char *buf, size_t size, int *len, const char *str) {
+  append(buf, size, len, "\"");
+  for (const char *c = str; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      append(buf, size, len, "\\%c", *c);
+    } else if ((unsigned char)*c < 0x20) {
+      append(buf, size, len, "\\u%04x", (unsigned)*c);
+    } else {
+      append(buf, size, len, "%c", *c);
+    }
+  }
+  append(buf, size, len, "\"");
+}
+
+/**
+ * @brief Writes the fields shared by every alert payload, without the
+ * closing brace.
+ */
+static int write_alert_head(char *buf, size_t size,
+                            const device_state_t *data) {
+  int len = 0;
+  append(buf, size, &len, "{\"timestamp\":%llu,\"device_id\":",
+         (unsigned long long)data->timestamp_ms);
+  append_string(buf, size, &len, data->device_id);
+  return len;
+}
+
+int json_wrapper_write_alert_payload(char *buf, size_t size) {
   device_state_t data;
   esp_err_t err = data_manager_get_device_state(&data);
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "Failed to get device data from Data Manager: %d", err);
-    return NULL;
+    return -1;
   }
 
-  // 2. Create the JSON object
-  cJSON *root = cJSON_CreateObject();
-  if (!root) {
-    ESP_LOGE(TAG, "Failed to create JSON object");
-    return NULL;
+  // Only the essential data for an alert
+  int len = write_alert_head(buf, size, &data);
+  append(buf, size, &len, ",\"fall_detected\":%s",
+         data.fall_detected ? "true" : "false");
+  if (data.gps_data.has_gps_fix) {
+    append(buf, size, &len, ",\"latitude\":%.6f,\"longitude\":%.6f",
+           data.gps_data.latitude, data.gps_data.longitude);
+  } else {
+    append(buf, size, &len,
+           ",\"message\":\"Fall detected, GPS data unavailable.\"");
   }
+  append(buf, size, &len, "}");
 
-  // Add only the essential data for an alert
-  cJSON_AddNumberToObject(root, "timestamp", (double)data.timestamp_ms);
-  cJSON_AddStringToObject(root, "device_id", data.device_id);
-  cJSON_AddBoolToObject(root, "fall_detected", data.fall_detected);
+  if (len < 0) {
+    ESP_LOGE(TAG, "Alert payload does not fit in %u bytes", (unsigned)size);
+    return -1;
+  }
+  ESP_LOGI(TAG, "Created alert payload: %s", buf);
+  return len;
+}
+
+/**
+ * @brief Writes the payload of a post-fall monitoring event.
+ *
+ * @param event Event name ("long_lie" or "recovered").
+ * @param severity Severity the backend should give it.
+ * @param lying_s Motionless time since the fall, in seconds.
+ * @return Length of the payload, or -1 on failure.
+ */
+static int write_monitor_payload(char *buf, size_t size, const char *event,
+                                 const char *severity, uint32_t lying_s) {
+  device_state_t data;
+  esp_err_t err = data_manager_get_device_state(&data);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to get device data from Data Manager: %d", err);
+    return -1;
+  }
 
-  // Add GPS data if a fix exists, otherwise add a message
+  int len = write_alert_head(buf, size, &data);
+  append(buf, size, &len,
+         ",\"event\":\"%s\",\"severity\":\"%s\",\"lying_s\":%lu", event,
+         severity, (unsigned long)lying_s);
   if (data.gps_data.has_gps_fix) {
-    cJSON_AddNumberToObject(root, "latitude", data.gps_data.latitude);
-    cJSON_AddNumberToObject(root, "longitude", data.gps_data.longitude);
-  } else {
-    cJSON_AddStringToObject(root, "message",
-                            "Fall detected, GPS data unavailable.");
+    append(buf, size, &len, ",\"latitude\":%.6f,\"longitude\":%.6f",
+           data.gps_data.latitude, data.gps_data.longitude);
   }
+  append(buf, size, &len, "}");
 
-  // 3. Print the JSON object to a string
-  char *json_str = cJSON_PrintUnformatted(root);
-  if (!json_str) {
-    ESP_LOGE(TAG, "Failed to print JSON string");
+  if (len < 0) {
+    ESP_LOGE(TAG, "%s payload does not fit in %u bytes", event,
+             (unsigned)size);
+    return -1;
   }
+  ESP_LOGI(TAG, "Created %s payload: %s", event, buf);
+  return len;
+}
 
-  // 4. Free the memory used by cJSON
-  cJSON_Delete(root);
+int json_wrapper_write_long_lie_payload(char *buf, size_t size,
+                                        uint32_t lying_s) {
+  return write_monitor_payload(buf, size, "long_lie", "critical", lying_s);
+}
 
-  ESP_LOGI(TAG, "Created alert payload: %s", json_str);
-  return json_str;
+int json_wrapper_write_recovery_payload(char *buf, size_t size,
+                                        uint32_t lying_s) {
+  return write_monitor_payload(buf, size, "recovered", "info", lying_s);
 }
@@ -9,9 +9,9 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "sdkconfig.h"
+#include "task_topology.h"
 
 #define LED_TASK_STACK_SIZE CONFIG_LED_INDICATOR_TASK_STACK_SIZE
-#define LED_TASK_PRIORITY CONFIG_LED_INDICATOR_TASK_PRIORITY
 
 #define FAST_BLINK_PERIOD_MS 200
 #define SLOW_BLINK_PERIOD_MS 1000
@@ -44,11 +44,21 @@ static inline void led_set(bool on) {
   gpio_set_level(led_gpio, led_active_high ? on : !on);
 }
 
+/**
+ * @brief Internal: waits for up to @p ticks or until the mode changes.
+ *
+ * led_indicator_set_mode() notifies the task, so static modes can block
+ * indefinitely and let the CPU sleep instead of polling every tick.
+ */
+static inline void led_wait(TickType_t ticks) {
+  ulTaskNotifyTake(pdTRUE, ticks);
+}
+
 /**
  * @brief Internal: main LED control task.
  *
  * This task controls the LED's state based on the current mode.
- * It remains responsive by yielding or delaying as needed.
+ * It blocks until the next blink edge or a mode change.
  *
  * @param arg Task parameter (unused).
  */
@@ -63,28 +73,27 @@ static void led_task(void *arg) {
     switch (mode) {
     case LED_MODE_OFF:
       led_set(false);
-      // No need for a continuous delay, just yield to other tasks.
-      vTaskDelay(1);
+      // Nothing to do until the mode changes.
+      led_wait(portMAX_DELAY);
       break;
 
     case LED_MODE_ON:
       led_set(true);
-      // No need for a continuous delay, just yield to other tasks.
-      vTaskDelay(1);
+      led_wait(portMAX_DELAY);
       break;
 
     case LED_MODE_BLINK_FAST:
       led_set(true);
-      vTaskDelay(pdMS_TO_TICKS(FAST_BLINK_PERIOD_MS / 2));
+      led_wait(pdMS_TO_TICKS(FAST_BLINK_PERIOD_MS / 2));
       led_set(false);
-      vTaskDelay(pdMS_TO_TICKS(FAST_BLINK_PERIOD_MS / 2));
+      led_wait(pdMS_TO_TICKS(FAST_BLINK_PERIOD_MS / 2));
       break;
 
     case LED_MODE_BLINK_SLOW:
       led_set(true);
-      vTaskDelay(pdMS_TO_TICKS(SLOW_BLINK_PERIOD_MS / 2));
+      led_wait(pdMS_TO_TICKS(SLOW_BLINK_PERIOD_MS / 2));
       led_set(false);
-      vTaskDelay(pdMS_TO_TICKS(SLOW_BLINK_PERIOD_MS / 2));
+      led_wait(pdMS_TO_TICKS(SLOW_BLINK_PERIOD_MS / 2));
       break;
 
     case LED_MODE_BLINK_ERROR:
@@ -94,12 +103,12 @@ static void led_task(void *arg) {
         led_set(false);
         vTaskDelay(pdMS_TO_TICKS(ERROR_BLINK_OFF_MS));
       }
-      vTaskDelay(pdMS_TO_TICKS(ERROR_BLINK_PAUSE_MS));
+      led_wait(pdMS_TO_TICKS(ERROR_BLINK_PAUSE_MS));
       break;
 
     default:
       led_set(false);
-      vTaskDelay(pdMS_TO_TICKS(500));
+      led_wait(pdMS_TO_TICKS(500));
       break;
     }
   }
@@ -130,11 +139,8 @@ esp_err_t led_indicator_init(void) {
   // New: Ensure LED starts in the OFF state
   led_set(false);
 
-  BaseType_t ret =
-      xTaskCreate(led_task, "led_indicator_task", LED_TASK_STACK_SIZE, NULL,
-                  LED_TASK_PRIORITY, &led_task_handle);
-
-  if (ret != pdPASS) {
+  if (task_topology_create(TASK_TOPOLOGY_LED, led_task, LED_TASK_STACK_SIZE,
+                           NULL, &led_task_handle) != ESP_OK) {
     ESP_LOGE(TAG, "Failed to create LED task");
     return ESP_FAIL;
   }
@@ -157,6 +163,9 @@ esp_err_t led_indicator_set_mode(led_mode_t mode) {
   current_mode = mode;
   LED_EXIT_CRITICAL();
 
+  // Wake the task so the new mode takes effect immediately
+  xTaskNotifyGive(led_task_handle);
+
   return ESP_OK;
 }
 
@@ -10,13 +10,39 @@ extern "C" {
 #endif
 
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Default I2C address and MPU6050 register map
 #define MPU6050_ADDR 0x68         ///< Default I2C address of MPU6050
+#define MPU6050_SMPLRT_DIV 0x19   ///< Sample rate divider register
+#define MPU6050_CONFIG 0x1A       ///< DLPF configuration register
+#define MPU6050_GYRO_CONFIG 0x1B  ///< Gyroscope full-scale range register
+#define MPU6050_ACCEL_CONFIG 0x1C ///< Accelerometer full-scale range register
+#define MPU6050_MOT_THR 0x1F      ///< Motion detection threshold register
+#define MPU6050_MOT_DUR 0x20      ///< Motion detection duration register
+#define MPU6050_INT_PIN_CFG 0x37  ///< INT pin behaviour register
+#define MPU6050_INT_ENABLE 0x38   ///< Interrupt enable register
+#define MPU6050_FIFO_EN 0x23      ///< FIFO source enable register
+#define MPU6050_INT_STATUS 0x3A   ///< Interrupt status register
+#define MPU6050_USER_CTRL 0x6A    ///< FIFO enable/reset control register
 #define MPU6050_PWR_MGMT_1 0x6B   ///< Power management register
+#define MPU6050_PWR_MGMT_2 0x6C   ///< Low-power wake-up and standby register
+#define MPU6050_FIFO_COUNTH 0x72  ///< FIFO byte count (high byte first)
+#define MPU6050_FIFO_R_W 0x74     ///< FIFO data register
 #define MPU6050_ACCEL_XOUT_H 0x3B ///< Starting register for accel/gyro data
 
+#define MPU6050_SAMPLE_RATE_MIN_HZ 4    ///< Slowest rate with DLPF enabled
+#define MPU6050_SAMPLE_RATE_MAX_HZ 1000 ///< Accelerometer output rate
+
+#define MPU6050_FIFO_SIZE 1024      ///< Hardware FIFO size in bytes
+#define MPU6050_FIFO_FRAME_SIZE 12  ///< Accel XYZ + gyro XYZ, big-endian int16
+#define MPU6050_FIFO_MAX_FRAMES (MPU6050_FIFO_SIZE / MPU6050_FIFO_FRAME_SIZE)
+
 /**
  * @brief Struct representing raw sensor data from MPU6050.
  *
@@ -33,10 +59,119 @@ typedef struct {
   float gyro_z;  ///< Rotation rate around Z-axis (deg/s)
 } sensor_data_t;
 
+/**
+ * @brief Unscaled sample as produced by the sensor.
+ *
+ * Axes are in sensor LSB. The timestamp holds the low 32 bits of
+ * esp_timer_get_time(); compute differences with unsigned subtraction so
+ * that the wrap-around every ~71 minutes is harmless.
+ */
+typedef struct {
+  uint32_t timestamp_us; ///< Capture time (µs, wraps)
+  int16_t accel_x;       ///< Acceleration along X-axis (LSB)
+  int16_t accel_y;       ///< Acceleration along Y-axis (LSB)
+  int16_t accel_z;       ///< Acceleration along Z-axis (LSB)
+  int16_t gyro_x;        ///< Rotation rate around X-axis (LSB)
+  int16_t gyro_y;        ///< Rotation rate around Y-axis (LSB)
+  int16_t gyro_z;        ///< Rotation rate around Z-axis (LSB)
+} sensor_raw_t;
+
+/**
+ * @brief Accelerometer full-scale range (ACCEL_CONFIG.AFS_SEL).
+ */
+typedef enum {
+  MPU6050_ACCEL_RANGE_2G = 0, ///< ±2 g, 16384 LSB/g
+  MPU6050_ACCEL_RANGE_4G,     ///< ±4 g, 8192 LSB/g
+  MPU6050_ACCEL_RANGE_8G,     ///< ±8 g, 4096 LSB/g
+  MPU6050_ACCEL_RANGE_16G,    ///< ±16 g, 2048 LSB/g
+} mpu6050_accel_range_t;
+
+/**
+ * @brief Gyroscope full-scale range (GYRO_CONFIG.FS_SEL).
+ */
+typedef enum {
+  MPU6050_GYRO_RANGE_250DPS = 0, ///< ±250 °/s
+  MPU6050_GYRO_RANGE_500DPS,     ///< ±500 °/s
+  MPU6050_GYRO_RANGE_1000DPS,    ///< ±1000 °/s
+  MPU6050_GYRO_RANGE_2000DPS,    ///< ±2000 °/s
+} mpu6050_gyro_range_t;
+
+/**
+ * @brief Digital low-pass filter setting (CONFIG.DLPF_CFG).
+ *
+ * Values are the accelerometer bandwidth. With MPU6050_DLPF_260HZ the
+ * filter is off and the gyro runs at 8 kHz internally, otherwise at 1 kHz.
+ */
+typedef enum {
+  MPU6050_DLPF_260HZ = 0,
+  MPU6050_DLPF_184HZ,
+  MPU6050_DLPF_94HZ,
+  MPU6050_DLPF_44HZ,
+  MPU6050_DLPF_21HZ,
+  MPU6050_DLPF_10HZ,
+  MPU6050_DLPF_5HZ,
+} mpu6050_dlpf_t;
+
+/**
+ * @brief Accelerometer wake-up rate in cycle mode (PWR_MGMT_2.LP_WAKE_CTRL).
+ */
+typedef enum {
+  MPU6050_LP_WAKE_1_25HZ = 0,
+  MPU6050_LP_WAKE_5HZ,
+  MPU6050_LP_WAKE_20HZ,
+  MPU6050_LP_WAKE_40HZ,
+} mpu6050_lp_wake_t;
+
+/**
+ * @brief Measurement configuration applied by mpu6050_configure().
+ */
+typedef struct {
+  mpu6050_accel_range_t accel_range; ///< Accelerometer full-scale range
+  mpu6050_gyro_range_t gyro_range;   ///< Gyroscope full-scale range
+  mpu6050_dlpf_t dlpf;               ///< Digital low-pass filter
+  uint16_t sample_rate_hz;           ///< Output data rate (Hz)
+} mpu6050_config_t;
+
+/**
+ * @brief Measurement configuration from Kconfig.
+ */
+#define MPU6050_DEFAULT_CONFIG()                                               \
+  {                                                                            \
+    .accel_range = (mpu6050_accel_range_t)CONFIG_MPU6050_ACCEL_FS_SEL,         \
+    .gyro_range = (mpu6050_gyro_range_t)CONFIG_MPU6050_GYRO_FS_SEL,            \
+    .dlpf = (mpu6050_dlpf_t)CONFIG_MPU6050_DLPF_CFG,                           \
+    .sample_rate_hz = CONFIG_MPU6050_SAMPLE_RATE_HZ,                           \
+  }
+
+/// Accelerometer sensitivity of the Kconfig range (LSB/g)
+#define MPU6050_ACCEL_LSB_PER_G (16384 >> CONFIG_MPU6050_ACCEL_FS_SEL)
+/// Gyroscope sensitivity of the Kconfig range (LSB/(°/s))
+#define MPU6050_GYRO_LSB_PER_DPS                                               \
+  (32768.0f / (float)(250 << CONFIG_MPU6050_GYRO_FS_SEL))
+
+/// Converts milli-g to accelerometer LSB at the Kconfig range; constant-folds
+/// for constant input
+#define MPU6050_MG_TO_LSB(mg)                                                  \
+  ((uint32_t)(((uint64_t)(mg) * MPU6050_ACCEL_LSB_PER_G + 500) / 1000))
+
+/**
+ * @brief Per-axis zero offsets subtracted from every sample.
+ *
+ * Offsets are in LSB at the ranges they were measured with; they are
+ * rescaled when the ranges change.
+ */
+typedef struct {
+  int16_t accel[3];                  ///< Accelerometer X/Y/Z offset (LSB)
+  int16_t gyro[3];                   ///< Gyroscope X/Y/Z offset (LSB)
+  mpu6050_accel_range_t accel_range; ///< Range the accel offsets refer to
+  mpu6050_gyro_range_t gyro_range;   ///< Range the gyro offsets refer to
+} mpu6050_bias_t;
+
 /**
  * @brief Initialize MPU6050 by waking it from sleep and setting default config.
  *
  * This function assumes the device is connected via I2C to the default address.
+ * The measurement configuration from MPU6050_DEFAULT_CONFIG() is applied.
  *
  * @return
  *      - ESP_OK on success
@@ -62,6 +197,246 @@ esp_err_t mpu6050_deinit(void);
  */
 esp_err_t mpu6050_read_data(sensor_data_t *data);
 
+/**
+ * @brief Read one unscaled accelerometer and gyroscope sample.
+ *
+ * @param[out] raw Pointer to struct to store the sample and its timestamp
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if raw is NULL
+ *      - ESP_FAIL on communication error
+ */
+esp_err_t mpu6050_read_raw(sensor_raw_t *raw);
+
+/**
+ * @brief Convert an unscaled sample to g and deg/s.
+ *
+ * @param raw Sample in sensor LSB
+ * @param[out] data Scaled sample
+ */
+void mpu6050_raw_to_data(const sensor_raw_t *raw, sensor_data_t *data);
+
+/**
+ * @brief Apply full-scale ranges, low-pass filter and output data rate.
+ *
+ * Writes CONFIG, GYRO_CONFIG, ACCEL_CONFIG and SMPLRT_DIV. The scale factors
+ * used by mpu6050_raw_to_data() follow the new ranges.
+ *
+ * @param config Configuration to apply.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if a field is out of range
+ *      - ESP_FAIL or other esp_err_t codes on communication error
+ */
+esp_err_t mpu6050_configure(const mpu6050_config_t *config);
+
+/**
+ * @brief Returns the configuration currently applied to the sensor.
+ */
+void mpu6050_get_config(mpu6050_config_t *config);
+
+/**
+ * @brief Accelerometer sensitivity of the current range (LSB/g).
+ */
+uint16_t mpu6050_get_accel_lsb_per_g(void);
+
+/**
+ * @brief Gyroscope sensitivity of the current range (LSB/(°/s)).
+ */
+float mpu6050_get_gyro_lsb_per_dps(void);
+
+/**
+ * @brief Set the offsets subtracted from every raw sample.
+ *
+ * Pass NULL to clear them. Applied in mpu6050_read_raw() and
+ * mpu6050_fifo_read(), so all consumers see corrected samples.
+ */
+void mpu6050_set_bias(const mpu6050_bias_t *bias);
+
+/**
+ * @brief Returns the offsets currently applied, at the current ranges.
+ */
+void mpu6050_get_bias(mpu6050_bias_t *bias);
+
+/**
+ * @brief Measure zero offsets while the device lies still and flat.
+ *
+ * Averages @p sample_count samples with no offsets applied. The axis that
+ * carries gravity keeps its 1 g, the others are expected to read zero and
+ * the gyro is expected to read zero on all axes. The run is rejected if
+ * any axis moves by more than the Kconfig tolerance, or if the device is
+ * not flat: an off-axis mean or the gravity axis' distance from ±1 g
+ * beyond CONFIG_MPU6050_CALIB_FLAT_TOLERANCE_MG. A tilt would otherwise
+ * be stored as offset. On success the new offsets are applied; on
+ * failure the previous ones are restored.
+ *
+ * @param sample_count Number of samples to average (>= 16).
+ * @param[out] bias Measured offsets, may be NULL.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if sample_count is too small
+ *      - ESP_ERR_INVALID_STATE if motion or a tilt was detected
+ *      - Other esp_err_t codes on communication error
+ */
+esp_err_t mpu6050_calibrate(uint16_t sample_count, mpu6050_bias_t *bias);
+
+/**
+ * @brief Load offsets from NVS and apply them.
+ *
+ * NVS flash must be initialized.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NVS_NOT_FOUND if no calibration is stored
+ *      - Other esp_err_t codes on NVS error
+ */
+esp_err_t mpu6050_bias_load(void);
+
+/**
+ * @brief Store the offsets currently applied in NVS.
+ */
+esp_err_t mpu6050_bias_save(void);
+
+/**
+ * @brief Set the sensor output data rate.
+ *
+ * Programs SMPLRT_DIV for the current low-pass filter setting so that new
+ * samples are produced at @p rate_hz. The rate must be reachable with an
+ * 8-bit divider of the internal rate (1 kHz, or 8 kHz with the filter off).
+ *
+ * @param rate_hz Output data rate in Hz (4..1000).
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the rate is out of range
+ *      - ESP_FAIL or other esp_err_t codes on communication error
+ */
+esp_err_t mpu6050_set_sample_rate(uint16_t rate_hz);
+
+/**
+ * @brief Route the MPU6050 data-ready interrupt to a task notification.
+ *
+ * Configures the INT pin as an active-high pulse, enables DATA_RDY_EN and
+ * installs a GPIO ISR on @p int_gpio. Each rising edge gives one notification
+ * to @p notify_task, so the notification count tells the task how many
+ * samples were produced since it last took it.
+ *
+ * @param int_gpio GPIO connected to the MPU6050 INT pin.
+ * @param notify_task Task to notify on every new sample.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if notify_task is NULL
+ *      - Other esp_err_t codes on GPIO or I2C error
+ */
+esp_err_t mpu6050_enable_data_ready(int int_gpio, TaskHandle_t notify_task);
+
+/**
+ * @brief Disable the data-ready interrupt and remove the GPIO ISR.
+ */
+esp_err_t mpu6050_disable_data_ready(void);
+
+/**
+ * @brief Switch the INT pin from data-ready to a latched motion interrupt.
+ *
+ * Requires mpu6050_enable_data_ready(). The sensor keeps sampling, but the
+ * INT pin is only raised when the high-pass filtered acceleration exceeds
+ * @p threshold_mg for @p duration_ms. The pin is latched high and armed as
+ * a light sleep wake-up source, so the notified task is woken even while
+ * the chip sleeps. Call mpu6050_disable_motion_wakeup() once woken.
+ *
+ * @param threshold_mg Motion threshold (2..510 mg, 2 mg resolution).
+ * @param duration_ms Time above the threshold (1..255 ms).
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the data-ready interrupt is not set up
+ *      - Other esp_err_t codes on GPIO or I2C error
+ */
+esp_err_t mpu6050_enable_motion_wakeup(uint16_t threshold_mg,
+                                       uint8_t duration_ms);
+
+/**
+ * @brief Return the INT pin to data-ready pulses after a motion wake-up.
+ */
+esp_err_t mpu6050_disable_motion_wakeup(void);
+
+/**
+ * @brief Switch to accelerometer-only cycle mode.
+ *
+ * The gyroscope and temperature sensor are put in standby and the chip
+ * sleeps between single accelerometer samples taken at @p rate. Interrupt
+ * and data-ready settings are kept; gyroscope readings are zero until
+ * mpu6050_disable_cycle_mode().
+ *
+ * @param rate Accelerometer wake-up rate.
+ * @return ESP_OK on success, esp_err_t code on communication error.
+ */
+esp_err_t mpu6050_enable_cycle_mode(mpu6050_lp_wake_t rate);
+
+/**
+ * @brief Leave cycle mode and sample at the programmed output data rate.
+ *
+ * The gyroscope needs about 30 ms to start up; its first readings after
+ * this call are not settled.
+ */
+esp_err_t mpu6050_disable_cycle_mode(void);
+
+/**
+ * @brief Enable the hardware FIFO for accelerometer and gyroscope samples.
+ *
+ * The FIFO is reset first, then every sample at the configured output data
+ * rate is queued as a 12-byte frame. Call mpu6050_set_sample_rate() before
+ * this so the burst timestamps match the real sample period.
+ *
+ * @return ESP_OK on success, esp_err_t code on communication error.
+ */
+esp_err_t mpu6050_fifo_enable(void);
+
+/**
+ * @brief Stop queueing samples into the FIFO and disable it.
+ */
+esp_err_t mpu6050_fifo_disable(void);
+
+/**
+ * @brief Discard the FIFO contents and keep it enabled.
+ */
+esp_err_t mpu6050_fifo_reset(void);
+
+/**
+ * @brief Drain complete frames from the FIFO in a single burst read.
+ *
+ * Reads FIFO_COUNT, then fetches up to @p max_frames frames in one I2C
+ * transaction. Frames are returned oldest first; timestamps are derived
+ * backwards from the time of the burst using the sample period.
+ *
+ * If the FIFO overflowed (or holds a partial frame, which means the frame
+ * boundary has been lost), it is reset and the overflow counter is bumped.
+ * The samples discarded are added to mpu6050_fifo_get_lost_frames().
+ *
+ * @param[out] frames Caller-provided array for the drained samples
+ * @param max_frames Capacity of @p frames
+ * @param[out] out_count Number of frames written to @p frames
+ * @return
+ *      - ESP_OK on success (out_count may be 0)
+ *      - ESP_ERR_INVALID_ARG on NULL pointers or zero capacity
+ *      - ESP_ERR_INVALID_STATE if the FIFO overflowed and was reset
+ *      - ESP_FAIL or other esp_err_t codes on communication error
+ */
+esp_err_t mpu6050_fifo_read(sensor_raw_t *frames, size_t max_frames,
+                            size_t *out_count);
+
+/**
+ * @brief Number of FIFO overflows recovered since boot.
+ */
+uint32_t mpu6050_fifo_get_overflow_count(void);
+
+/**
+ * @brief Number of samples discarded by FIFO overflow recoveries since boot.
+ *
+ * Each recovery counts the sample periods elapsed between the newest frame
+ * handed out (or the last reset) and the overflowing read, and at least
+ * MPU6050_FIFO_MAX_FRAMES when the FIFO was full.
+ */
+uint32_t mpu6050_fifo_get_lost_frames(void);
+
 #ifdef __cplusplus
 }
 #endif
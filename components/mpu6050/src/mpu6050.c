@@ -7,15 +7,112 @@
 #include "mpu6050.h"
 #include "comm.h"
 #include "debugs.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include <math.h>
 #include <string.h>
 
-// Scale factors from datasheet
-static const float ACCEL_SCALE_FACTOR = 16384.0f; // LSB/g
-static const float GYRO_SCALE_FACTOR = 131.0f;    // LSB/(°/s)
+// Full-scale codes live in bits 4:3 of ACCEL_CONFIG and GYRO_CONFIG
+#define MPU6050_FS_SEL_SHIFT 3
+#define MPU6050_DLPF_CFG_MAX MPU6050_DLPF_5HZ
 
 #define COMBINE_BYTES(msb, lsb) ((int16_t)(((msb) << 8) | (lsb)))
 
+/**
+ * @brief Subtract an offset from a raw reading, saturating at int16 limits.
+ */
+static inline int16_t remove_bias(int16_t value, int16_t bias) {
+  int32_t v = (int32_t)value - bias;
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+/**
+ * @brief Rescale an offset measured at one full-scale code to another.
+ */
+static int16_t rescale_bias(int16_t bias, int from_fs_sel, int to_fs_sel) {
+  int32_t v = bias;
+  if (to_fs_sel > from_fs_sel) {
+    return (int16_t)(v / (1 << (to_fs_sel - from_fs_sel)));
+  }
+  return (int16_t)(v * (1 << (from_fs_sel - to_fs_sel)));
+}
+
+// Register bit values
+#define MPU6050_INT_RD_CLEAR 0x10   ///< Clear INT_STATUS on any read
+#define MPU6050_DATA_RDY_EN 0x01    ///< Data-ready interrupt enable bit
+#define MPU6050_MOT_EN 0x40         ///< Motion interrupt enable bit
+#define MPU6050_LATCH_INT_EN 0x20   ///< Hold INT high until status is read
+#define MPU6050_ACCEL_HPF_5HZ 0x01  ///< Motion detection high-pass filter
+#define MPU6050_MOT_THR_MG_PER_LSB 2
+#define MPU6050_FIFO_OFLOW_INT 0x10 ///< FIFO overflow flag in INT_STATUS
+#define MPU6050_FIFO_SRC_ACCEL_GYRO 0x78 ///< XG, YG, ZG and ACCEL to FIFO
+#define MPU6050_USER_FIFO_EN 0x40   ///< USER_CTRL: enable FIFO
+#define MPU6050_USER_FIFO_RESET 0x04 ///< USER_CTRL: reset FIFO
+#define MPU6050_PWR_CYCLE 0x20      ///< PWR_MGMT_1: sleep between samples
+#define MPU6050_PWR_TEMP_DIS 0x08   ///< PWR_MGMT_1: temperature sensor off
+#define MPU6050_LP_WAKE_SHIFT 6     ///< PWR_MGMT_2: LP_WAKE_CTRL in bits 7:6
+#define MPU6050_STBY_GYRO 0x07      ///< PWR_MGMT_2: gyro X, Y, Z standby
+
+#define MPU6050_INTERNAL_RATE_HZ 1000      ///< Gyro rate with the DLPF on
+#define MPU6050_INTERNAL_RATE_NO_DLPF_HZ 8000 ///< Gyro rate with the DLPF off
+#define MPU6050_DEFAULT_RATE_HZ 8000 ///< SMPLRT_DIV=0, DLPF off after power-on
+
+// Configuration currently applied; power-on state until configured
+static mpu6050_config_t s_config = {
+    .accel_range = MPU6050_ACCEL_RANGE_2G,
+    .gyro_range = MPU6050_GYRO_RANGE_250DPS,
+    .dlpf = MPU6050_DLPF_260HZ,
+    .sample_rate_hz = MPU6050_DEFAULT_RATE_HZ,
+};
+// Scale factors derived from the full-scale ranges
+static uint16_t s_accel_lsb_per_g = 16384;
+static float s_accel_scale = 16384.0f; // LSB/g
+static float s_gyro_scale = 131.072f;  // LSB/(°/s)
+// Offsets subtracted from every sample, at the current ranges
+static mpu6050_bias_t s_bias = {0};
+// Current sample period, used to timestamp FIFO bursts
+static uint32_t s_sample_period_us = 1000000 / MPU6050_DEFAULT_RATE_HZ;
+static uint32_t s_fifo_overflows = 0;
+// Samples discarded by overflow recoveries, and the capture time of the
+// newest frame handed out (or of the last reset) to estimate them
+static uint32_t s_fifo_lost_frames = 0;
+static uint32_t s_fifo_drained_us = 0;
+// Burst buffer for FIFO drains, too large for the caller's stack
+static uint8_t s_fifo_buf[MPU6050_FIFO_MAX_FRAMES * MPU6050_FIFO_FRAME_SIZE];
+
+// Data-ready interrupt state
+static TaskHandle_t s_notify_task = NULL;
+static int s_int_gpio = -1;
+// INT is latched high for motion wake-up; the ISR masks the level interrupt
+static volatile bool s_motion_wakeup = false;
+
+/**
+ * @brief Data-ready ISR: hand one notification per sample to the reader.
+ */
+static void IRAM_ATTR mpu6050_int_isr(void *arg) {
+  BaseType_t higher_prio_woken = pdFALSE;
+  TaskHandle_t task = s_notify_task;
+
+  // A latched level would retrigger until the task reads INT_STATUS
+  if (s_motion_wakeup) {
+    gpio_intr_disable(s_int_gpio);
+  }
+
+  if (task != NULL) {
+    vTaskNotifyGiveFromISR(task, &higher_prio_woken);
+  }
+  if (higher_prio_woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
 /**
  * @brief Initialize MPU6050 by clearing the sleep bit.
  */
@@ -28,6 +125,12 @@ esp_err_t mpu6050_init(void) {
     return err;
   }
 
+  const mpu6050_config_t config = MPU6050_DEFAULT_CONFIG();
+  err = mpu6050_configure(&config);
+  if (err != ESP_OK) {
+    return err;
+  }
+
   DEBUGS_LOGI("MPU6050 initialized successfully.");
   return ESP_OK;
 }
@@ -49,6 +152,49 @@ esp_err_t mpu6050_deinit(void) {
   return ESP_OK;
 }
 
+/**
+ * @brief Read one unscaled accelerometer and gyroscope sample.
+ */
+esp_err_t mpu6050_read_raw(sensor_raw_t *raw) {
+  if (raw == NULL) {
+    DEBUGS_LOGE("Null pointer passed to mpu6050_read_raw");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint8_t buf[14] = {0};
+  esp_err_t err =
+      comm_i2c_read(MPU6050_ADDR, MPU6050_ACCEL_XOUT_H, buf, sizeof(buf));
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("MPU6050 I2C read failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  raw->timestamp_us = (uint32_t)esp_timer_get_time();
+  raw->accel_x = remove_bias(COMBINE_BYTES(buf[0], buf[1]), s_bias.accel[0]);
+  raw->accel_y = remove_bias(COMBINE_BYTES(buf[2], buf[3]), s_bias.accel[1]);
+  raw->accel_z = remove_bias(COMBINE_BYTES(buf[4], buf[5]), s_bias.accel[2]);
+
+  // buf[6..7] is the temperature sensor
+  raw->gyro_x = remove_bias(COMBINE_BYTES(buf[8], buf[9]), s_bias.gyro[0]);
+  raw->gyro_y = remove_bias(COMBINE_BYTES(buf[10], buf[11]), s_bias.gyro[1]);
+  raw->gyro_z = remove_bias(COMBINE_BYTES(buf[12], buf[13]), s_bias.gyro[2]);
+
+  return ESP_OK;
+}
+
+/**
+ * @brief Convert an unscaled sample to g and deg/s.
+ */
+void mpu6050_raw_to_data(const sensor_raw_t *raw, sensor_data_t *data) {
+  data->accel_x = raw->accel_x / s_accel_scale;
+  data->accel_y = raw->accel_y / s_accel_scale;
+  data->accel_z = raw->accel_z / s_accel_scale;
+
+  data->gyro_x = raw->gyro_x / s_gyro_scale;
+  data->gyro_y = raw->gyro_y / s_gyro_scale;
+  data->gyro_z = raw->gyro_z / s_gyro_scale;
+}
+
 /**
  * @brief Read scaled accelerometer and gyroscope values.
  */
@@ -58,21 +204,13 @@ esp_err_t mpu6050_read_data(sensor_data_t *data) {
     return ESP_ERR_INVALID_ARG;
   }
 
-  uint8_t raw[14] = {0};
-  esp_err_t err =
-      comm_i2c_read(MPU6050_ADDR, MPU6050_ACCEL_XOUT_H, raw, sizeof(raw));
+  sensor_raw_t raw;
+  esp_err_t err = mpu6050_read_raw(&raw);
   if (err != ESP_OK) {
-    DEBUGS_LOGE("MPU6050 I2C read failed: %s", esp_err_to_name(err));
     return err;
   }
 
-  data->accel_x = COMBINE_BYTES(raw[0], raw[1]) / ACCEL_SCALE_FACTOR;
-  data->accel_y = COMBINE_BYTES(raw[2], raw[3]) / ACCEL_SCALE_FACTOR;
-  data->accel_z = COMBINE_BYTES(raw[4], raw[5]) / ACCEL_SCALE_FACTOR;
-
-  data->gyro_x = COMBINE_BYTES(raw[8], raw[9]) / GYRO_SCALE_FACTOR;
-  data->gyro_y = COMBINE_BYTES(raw[10], raw[11]) / GYRO_SCALE_FACTOR;
-  data->gyro_z = COMBINE_BYTES(raw[12], raw[13]) / GYRO_SCALE_FACTOR;
+  mpu6050_raw_to_data(&raw, data);
 
   DEBUGS_LOGD("Accel [g] X=%.2f Y=%.2f Z=%.2f", data->accel_x, data->accel_y,
               data->accel_z);
@@ -81,3 +219,456 @@ esp_err_t mpu6050_read_data(sensor_data_t *data) {
 
   return ESP_OK;
 }
+
+/**
+ * @brief Write ranges, DLPF and SMPLRT_DIV, then derive the scale factors.
+ */
+esp_err_t mpu6050_configure(const mpu6050_config_t *config) {
+  if (config == NULL || config->accel_range > MPU6050_ACCEL_RANGE_16G ||
+      config->gyro_range > MPU6050_GYRO_RANGE_2000DPS ||
+      config->dlpf > MPU6050_DLPF_CFG_MAX) {
+    DEBUGS_LOGE("Invalid MPU6050 configuration");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t err =
+      comm_i2c_write_byte(MPU6050_ADDR, MPU6050_CONFIG, (uint8_t)config->dlpf);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(
+        MPU6050_ADDR, MPU6050_GYRO_CONFIG,
+        (uint8_t)(config->gyro_range << MPU6050_FS_SEL_SHIFT));
+  }
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(
+        MPU6050_ADDR, MPU6050_ACCEL_CONFIG,
+        (uint8_t)(config->accel_range << MPU6050_FS_SEL_SHIFT));
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to write MPU6050 configuration: %s",
+                esp_err_to_name(err));
+    return err;
+  }
+
+  s_config.accel_range = config->accel_range;
+  s_config.gyro_range = config->gyro_range;
+  s_config.dlpf = config->dlpf;
+
+  // Keep offsets valid at the new ranges
+  mpu6050_bias_t bias = s_bias;
+  mpu6050_set_bias(&bias);
+
+  // Full scale is ±(2 << AFS_SEL) g and ±(250 << FS_SEL) °/s over int16
+  s_accel_lsb_per_g = (uint16_t)(16384u >> config->accel_range);
+  s_accel_scale = (float)s_accel_lsb_per_g;
+  s_gyro_scale = 32768.0f / (float)(250u << config->gyro_range);
+
+  DEBUGS_LOGI("MPU6050 range ±%d g, ±%d dps, DLPF_CFG=%d",
+              2 << config->accel_range, 250 << config->gyro_range,
+              config->dlpf);
+
+  return mpu6050_set_sample_rate(config->sample_rate_hz);
+}
+
+void mpu6050_get_config(mpu6050_config_t *config) { *config = s_config; }
+
+void mpu6050_set_bias(const mpu6050_bias_t *bias) {
+  mpu6050_bias_t applied = {
+      .accel_range = s_config.accel_range,
+      .gyro_range = s_config.gyro_range,
+  };
+
+  if (bias != NULL) {
+    for (int i = 0; i < 3; i++) {
+      applied.accel[i] = rescale_bias(bias->accel[i], bias->accel_range,
+                                      s_config.accel_range);
+      applied.gyro[i] = rescale_bias(bias->gyro[i], bias->gyro_range,
+                                     s_config.gyro_range);
+    }
+  }
+  s_bias = applied;
+}
+
+void mpu6050_get_bias(mpu6050_bias_t *bias) { *bias = s_bias; }
+
+uint16_t mpu6050_get_accel_lsb_per_g(void) { return s_accel_lsb_per_g; }
+
+float mpu6050_get_gyro_lsb_per_dps(void) { return s_gyro_scale; }
+
+/**
+ * @brief Program SMPLRT_DIV for the requested output data rate.
+ */
+esp_err_t mpu6050_set_sample_rate(uint16_t rate_hz) {
+  uint32_t internal_hz = s_config.dlpf == MPU6050_DLPF_260HZ
+                             ? MPU6050_INTERNAL_RATE_NO_DLPF_HZ
+                             : MPU6050_INTERNAL_RATE_HZ;
+
+  // Sample Rate = Internal Rate / (1 + SMPLRT_DIV)
+  if (rate_hz < MPU6050_SAMPLE_RATE_MIN_HZ ||
+      rate_hz > MPU6050_SAMPLE_RATE_MAX_HZ ||
+      internal_hz / rate_hz - 1 > UINT8_MAX) {
+    DEBUGS_LOGE("Unsupported MPU6050 sample rate: %u Hz", rate_hz);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint8_t divider = (uint8_t)(internal_hz / rate_hz - 1);
+  esp_err_t err =
+      comm_i2c_write_byte(MPU6050_ADDR, MPU6050_SMPLRT_DIV, divider);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to write sample rate divider: %s",
+                esp_err_to_name(err));
+    return err;
+  }
+
+  uint32_t actual_hz = internal_hz / (divider + 1);
+  s_sample_period_us = 1000000 / actual_hz;
+  s_config.sample_rate_hz = (uint16_t)actual_hz;
+
+  DEBUGS_LOGI("MPU6050 sample rate set to %lu Hz (SMPLRT_DIV=%u)",
+              (unsigned long)actual_hz, divider);
+  return ESP_OK;
+}
+
+/**
+ * @brief Enable the data-ready interrupt and hook it to a task notification.
+ */
+esp_err_t mpu6050_enable_data_ready(int int_gpio, TaskHandle_t notify_task) {
+  if (notify_task == NULL) {
+    DEBUGS_LOGE("Null task passed to mpu6050_enable_data_ready");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  gpio_config_t io_conf = {
+      .pin_bit_mask = (1ULL << int_gpio),
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_DISABLE,
+      .pull_down_en = GPIO_PULLDOWN_ENABLE,
+      .intr_type = GPIO_INTR_POSEDGE,
+  };
+  esp_err_t err = gpio_config(&io_conf);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("MPU6050 INT GPIO config failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  // The ISR service may already be installed by another driver.
+  err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+    DEBUGS_LOGE("GPIO ISR service install failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  s_notify_task = notify_task;
+  s_int_gpio = int_gpio;
+
+  err = gpio_isr_handler_add(int_gpio, mpu6050_int_isr, NULL);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to add MPU6050 ISR: %s", esp_err_to_name(err));
+    s_notify_task = NULL;
+    s_int_gpio = -1;
+    return err;
+  }
+
+  // Active-high 50 us pulse, status cleared by any register read.
+  err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_PIN_CFG,
+                            MPU6050_INT_RD_CLEAR);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_ENABLE,
+                              MPU6050_DATA_RDY_EN);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to enable data-ready interrupt: %s",
+                esp_err_to_name(err));
+    mpu6050_disable_data_ready();
+    return err;
+  }
+
+  DEBUGS_LOGI("MPU6050 data-ready interrupt enabled on GPIO %d", int_gpio);
+  return ESP_OK;
+}
+
+/**
+ * @brief Disable the data-ready interrupt and release the GPIO ISR.
+ */
+esp_err_t mpu6050_disable_data_ready(void) {
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_ENABLE, 0x00);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to disable MPU6050 interrupts: %s",
+                esp_err_to_name(err));
+  }
+
+  if (s_int_gpio >= 0) {
+    gpio_isr_handler_remove(s_int_gpio);
+    s_int_gpio = -1;
+  }
+  s_notify_task = NULL;
+
+  return err;
+}
+
+/**
+ * @brief Program motion detection and arm the INT pin as a wake-up source.
+ */
+esp_err_t mpu6050_enable_motion_wakeup(uint16_t threshold_mg,
+                                       uint8_t duration_ms) {
+  if (s_int_gpio < 0 || s_notify_task == NULL) {
+    DEBUGS_LOGE("Motion wake-up needs the data-ready interrupt set up");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  uint32_t threshold = threshold_mg / MPU6050_MOT_THR_MG_PER_LSB;
+  if (threshold == 0) {
+    threshold = 1;
+  } else if (threshold > UINT8_MAX) {
+    threshold = UINT8_MAX;
+  }
+
+  // Stop data-ready pulses first so the pin settles low
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_ENABLE, 0x00);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(
+        MPU6050_ADDR, MPU6050_ACCEL_CONFIG,
+        (uint8_t)(s_config.accel_range << MPU6050_FS_SEL_SHIFT) |
+            MPU6050_ACCEL_HPF_5HZ);
+  }
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_MOT_THR,
+                              (uint8_t)threshold);
+  }
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_MOT_DUR,
+                              duration_ms ? duration_ms : 1);
+  }
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_PIN_CFG,
+                              MPU6050_LATCH_INT_EN | MPU6050_INT_RD_CLEAR);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to program motion detection: %s",
+                esp_err_to_name(err));
+    return err;
+  }
+
+  // A high level wakes the chip from light sleep and fires the ISR once
+  s_motion_wakeup = true;
+  gpio_wakeup_enable(s_int_gpio, GPIO_INTR_HIGH_LEVEL);
+
+  err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_ENABLE, MPU6050_MOT_EN);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to enable motion interrupt: %s",
+                esp_err_to_name(err));
+    mpu6050_disable_motion_wakeup();
+    return err;
+  }
+
+  DEBUGS_LOGI("MPU6050 motion wake-up armed (%lu mg, %u ms)",
+              (unsigned long)(threshold * MPU6050_MOT_THR_MG_PER_LSB),
+              duration_ms);
+  return ESP_OK;
+}
+
+/**
+ * @brief Restore data-ready pulses on the INT pin.
+ */
+esp_err_t mpu6050_disable_motion_wakeup(void) {
+  if (s_int_gpio < 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_ENABLE, 0x00);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(
+        MPU6050_ADDR, MPU6050_ACCEL_CONFIG,
+        (uint8_t)(s_config.accel_range << MPU6050_FS_SEL_SHIFT));
+  }
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_PIN_CFG,
+                              MPU6050_INT_RD_CLEAR);
+  }
+
+  // Reading INT_STATUS releases the latched pin
+  uint8_t status;
+  if (err == ESP_OK) {
+    err = comm_i2c_read_byte(MPU6050_ADDR, MPU6050_INT_STATUS, &status);
+  }
+
+  gpio_wakeup_disable(s_int_gpio);
+  gpio_set_intr_type(s_int_gpio, GPIO_INTR_POSEDGE);
+  s_motion_wakeup = false;
+  gpio_intr_enable(s_int_gpio);
+
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_INT_ENABLE,
+                              MPU6050_DATA_RDY_EN);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to restore data-ready interrupt: %s",
+                esp_err_to_name(err));
+  }
+  return err;
+}
+
+/**
+ * @brief Reset the FIFO contents while keeping it enabled.
+ */
+esp_err_t mpu6050_fifo_reset(void) {
+  // FIFO_RESET only takes effect while FIFO_EN is cleared.
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_USER_CTRL,
+                                      MPU6050_USER_FIFO_RESET);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_USER_CTRL,
+                              MPU6050_USER_FIFO_EN);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("MPU6050 FIFO reset failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  s_fifo_drained_us = (uint32_t)esp_timer_get_time();
+  return ESP_OK;
+}
+
+/**
+ * @brief Put the gyroscope in standby and the accelerometer in cycle mode.
+ */
+esp_err_t mpu6050_enable_cycle_mode(mpu6050_lp_wake_t rate) {
+  // Standby bits and wake-up rate first, then let the chip start cycling
+  esp_err_t err = comm_i2c_write_byte(
+      MPU6050_ADDR, MPU6050_PWR_MGMT_2,
+      (uint8_t)(rate << MPU6050_LP_WAKE_SHIFT) | MPU6050_STBY_GYRO);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_PWR_MGMT_1,
+                              MPU6050_PWR_CYCLE | MPU6050_PWR_TEMP_DIS);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to enter cycle mode: %s", esp_err_to_name(err));
+    mpu6050_disable_cycle_mode();
+    return err;
+  }
+  return ESP_OK;
+}
+
+/**
+ * @brief Wake the gyroscope and resume continuous sampling.
+ */
+esp_err_t mpu6050_disable_cycle_mode(void) {
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_PWR_MGMT_1, 0x00);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_PWR_MGMT_2, 0x00);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to leave cycle mode: %s", esp_err_to_name(err));
+  }
+  return err;
+}
+
+/**
+ * @brief Route accelerometer and gyroscope samples into the FIFO.
+ */
+esp_err_t mpu6050_fifo_enable(void) {
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_FIFO_EN,
+                                      MPU6050_FIFO_SRC_ACCEL_GYRO);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to select FIFO sources: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  err = mpu6050_fifo_reset();
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  DEBUGS_LOGI("MPU6050 FIFO enabled (%u-byte frames)",
+              MPU6050_FIFO_FRAME_SIZE);
+  return ESP_OK;
+}
+
+/**
+ * @brief Disable the FIFO and stop queueing samples.
+ */
+esp_err_t mpu6050_fifo_disable(void) {
+  esp_err_t err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_FIFO_EN, 0x00);
+  if (err == ESP_OK) {
+    err = comm_i2c_write_byte(MPU6050_ADDR, MPU6050_USER_CTRL, 0x00);
+  }
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to disable MPU6050 FIFO: %s", esp_err_to_name(err));
+  }
+  return err;
+}
+
+/**
+ * @brief Drain up to max_frames FIFO frames in one burst.
+ */
+esp_err_t mpu6050_fifo_read(sensor_raw_t *frames, size_t max_frames,
+                            size_t *out_count) {
+  if (frames == NULL || out_count == NULL || max_frames == 0) {
+    DEBUGS_LOGE("Invalid arguments passed to mpu6050_fifo_read");
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out_count = 0;
+
+  uint8_t count_buf[2] = {0};
+  esp_err_t err = comm_i2c_read(MPU6050_ADDR, MPU6050_FIFO_COUNTH, count_buf,
+                                sizeof(count_buf));
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("MPU6050 FIFO count read failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  uint32_t burst_time_us = (uint32_t)esp_timer_get_time();
+
+  uint16_t fifo_bytes = ((uint16_t)count_buf[0] << 8) | count_buf[1];
+
+  // A full FIFO has dropped samples; a partial frame means the frame
+  // boundary is lost. Either way the stream can only be resynchronised
+  // by a reset.
+  if (fifo_bytes >= MPU6050_FIFO_SIZE ||
+      fifo_bytes % MPU6050_FIFO_FRAME_SIZE != 0) {
+    // Every sample captured since the newest frame handed out is discarded,
+    // and a full FIFO held at least MPU6050_FIFO_MAX_FRAMES of them.
+    uint32_t lost = (burst_time_us - s_fifo_drained_us) / s_sample_period_us;
+    if (fifo_bytes >= MPU6050_FIFO_SIZE && lost < MPU6050_FIFO_MAX_FRAMES) {
+      lost = MPU6050_FIFO_MAX_FRAMES;
+    }
+    s_fifo_lost_frames += lost;
+    s_fifo_overflows++;
+    DEBUGS_LOGW("MPU6050 FIFO overflow (%u bytes, ~%lu samples), resetting",
+                fifo_bytes, (unsigned long)lost);
+    err = mpu6050_fifo_reset();
+    return err == ESP_OK ? ESP_ERR_INVALID_STATE : err;
+  }
+
+  size_t available = fifo_bytes / MPU6050_FIFO_FRAME_SIZE;
+  size_t count = available < max_frames ? available : max_frames;
+  if (count == 0) {
+    return ESP_OK;
+  }
+
+  err = comm_i2c_read(MPU6050_ADDR, MPU6050_FIFO_R_W, s_fifo_buf,
+                      count * MPU6050_FIFO_FRAME_SIZE);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("MPU6050 FIFO burst read failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  // The newest frame in the FIFO was captured at most one period ago.
+  uint32_t newest_us = burst_time_us -
+                       (uint32_t)(available - count) * s_sample_period_us;
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t *f = &s_fifo_buf[i * MPU6050_FIFO_FRAME_SIZE];
+    frames[i].timestamp_us =
+        newest_us - (uint32_t)(count - 1 - i) * s_sample_period_us;
+    frames[i].accel_x = remove_bias(COMBINE_BYTES(f[0], f[1]), s_bias.accel[0]);
+    frames[i].accel_y = remove_bias(COMBINE_BYTES(f[2], f[3]), s_bias.accel[1]);
+    frames[i].accel_z = remove_bias(COMBINE_BYTES(f[4], f[5]), s_bias.accel[2]);
+    frames[i].gyro_x = remove_bias(COMBINE_BYTES(f[6], f[7]), s_bias.gyro[0]);
+    frames[i].gyro_y = remove_bias(COMBINE_BYTES(f[8], f[9]), s_bias.gyro[1]);
+    frames[i].gyro_z = remove_bias(COMBINE_BYTES(f[10], f[11]), s_bias.gyro[2]);
+  }
+
+  s_fifo_drained_us = newest_us;
+  *out_count = count;
+  return ESP_OK;
+}
+
+uint32_t mpu6050_fifo_get_overflow_count(void) { return s_fifo_overflows; }
+
+uint32_t mpu6050_fifo_get_lost_frames(void) { return s_fifo_lost_frames; }
@@ -0,0 +1,199 @@
+/**
+ * @file mpu6050_calib.c
+ * @brief Zero-offset calibration for the MPU6050 and its NVS storage.
+ */
+
+#include "debugs.h"
+#include "mpu6050.h"
+#include "nvs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CALIB_NVS_NAMESPACE "mpu6050"
+#define CALIB_NVS_KEY "bias"
+#define CALIB_BLOB_VERSION 1
+#define CALIB_MIN_SAMPLES 16
+
+/**
+ * @brief Layout of the calibration blob in NVS.
+ */
+typedef struct {
+  uint8_t version;
+  uint8_t accel_range;
+  uint8_t gyro_range;
+  uint8_t reserved;
+  int16_t accel[3];
+  int16_t gyro[3];
+} calib_blob_t;
+
+esp_err_t mpu6050_calibrate(uint16_t sample_count, mpu6050_bias_t *bias) {
+  if (sample_count < CALIB_MIN_SAMPLES) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mpu6050_config_t config;
+  mpu6050_get_config(&config);
+  int32_t lsb_per_g = mpu6050_get_accel_lsb_per_g();
+  int32_t accel_tol =
+      (int32_t)CONFIG_MPU6050_CALIB_ACCEL_TOLERANCE_MG * lsb_per_g / 1000;
+  int32_t gyro_tol = (int32_t)((float)CONFIG_MPU6050_CALIB_GYRO_TOLERANCE_DPS *
+                               mpu6050_get_gyro_lsb_per_dps());
+  int32_t flat_tol =
+      (int32_t)CONFIG_MPU6050_CALIB_FLAT_TOLERANCE_MG * lsb_per_g / 1000;
+
+  // Measure with no offsets applied, restore them if the run fails
+  mpu6050_bias_t previous;
+  mpu6050_get_bias(&previous);
+  mpu6050_set_bias(NULL);
+
+  int32_t sum[6] = {0};
+  int16_t min[6], max[6];
+  TickType_t period = pdMS_TO_TICKS(1000 / config.sample_rate_hz);
+  if (period == 0) {
+    period = 1;
+  }
+
+  DEBUGS_LOGI("Calibrating MPU6050 over %u samples, keep still", sample_count);
+
+  esp_err_t err = ESP_OK;
+  for (uint16_t n = 0; n < sample_count; n++) {
+    sensor_raw_t raw;
+    err = mpu6050_read_raw(&raw);
+    if (err != ESP_OK) {
+      break;
+    }
+
+    const int16_t axes[6] = {raw.accel_x, raw.accel_y, raw.accel_z,
+                             raw.gyro_x,  raw.gyro_y,  raw.gyro_z};
+    for (int i = 0; i < 6; i++) {
+      if (n == 0 || axes[i] < min[i]) {
+        min[i] = axes[i];
+      }
+      if (n == 0 || axes[i] > max[i]) {
+        max[i] = axes[i];
+      }
+      sum[i] += axes[i];
+    }
+    vTaskDelay(period);
+  }
+
+  // Any axis swinging more than the tolerance means the device moved
+  for (int i = 0; err == ESP_OK && i < 6; i++) {
+    int32_t span = (int32_t)max[i] - min[i];
+    if (span > (i < 3 ? accel_tol : gyro_tol)) {
+      DEBUGS_LOGW("Motion during calibration (axis %d moved %ld LSB)", i,
+                  (long)span);
+      err = ESP_ERR_INVALID_STATE;
+    }
+  }
+
+  if (err != ESP_OK) {
+    mpu6050_set_bias(&previous);
+    return err;
+  }
+
+  mpu6050_bias_t measured = {
+      .accel_range = config.accel_range,
+      .gyro_range = config.gyro_range,
+  };
+  int gravity_axis = 0;
+  for (int i = 0; i < 3; i++) {
+    measured.accel[i] = (int16_t)(sum[i] / sample_count);
+    measured.gyro[i] = (int16_t)(sum[i + 3] / sample_count);
+    if (abs(measured.accel[i]) > abs(measured.accel[gravity_axis])) {
+      gravity_axis = i;
+    }
+  }
+  // Lying flat, gravity is on one axis and the others read their offset
+  // alone; tilted, the offsets cannot be told from gravity
+  for (int i = 0; i < 3; i++) {
+    int32_t off = i == gravity_axis ? abs(measured.accel[i]) - lsb_per_g
+                                    : measured.accel[i];
+    if (abs(off) > flat_tol) {
+      DEBUGS_LOGW("Device not flat during calibration (axis %d off by %ld "
+                  "LSB)",
+                  i, (long)off);
+      mpu6050_set_bias(&previous);
+      return ESP_ERR_INVALID_STATE;
+    }
+  }
+
+  // The axis carrying gravity should read ±1 g, not zero
+  measured.accel[gravity_axis] -= measured.accel[gravity_axis] > 0
+                                      ? (int16_t)lsb_per_g
+                                      : (int16_t)-lsb_per_g;
+
+  mpu6050_set_bias(&measured);
+  if (bias != NULL) {
+    *bias = measured;
+  }
+
+  DEBUGS_LOGI("MPU6050 bias accel=(%d, %d, %d) gyro=(%d, %d, %d) LSB",
+              measured.accel[0], measured.accel[1], measured.accel[2],
+              measured.gyro[0], measured.gyro[1], measured.gyro[2]);
+  return ESP_OK;
+}
+
+esp_err_t mpu6050_bias_load(void) {
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(CALIB_NVS_NAMESPACE, NVS_READONLY, &handle);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  calib_blob_t blob;
+  size_t size = sizeof(blob);
+  err = nvs_get_blob(handle, CALIB_NVS_KEY, &blob, &size);
+  nvs_close(handle);
+  if (err != ESP_OK) {
+    return err;
+  }
+  if (size != sizeof(blob) || blob.version != CALIB_BLOB_VERSION) {
+    DEBUGS_LOGW("Ignoring stored MPU6050 calibration (version %u)",
+                blob.version);
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+
+  mpu6050_bias_t bias = {
+      .accel_range = (mpu6050_accel_range_t)blob.accel_range,
+      .gyro_range = (mpu6050_gyro_range_t)blob.gyro_range,
+  };
+  memcpy(bias.accel, blob.accel, sizeof(bias.accel));
+  memcpy(bias.gyro, blob.gyro, sizeof(bias.gyro));
+  mpu6050_set_bias(&bias);
+
+  DEBUGS_LOGI("MPU6050 calibration loaded from NVS");
+  return ESP_OK;
+}
+
+esp_err_t mpu6050_bias_save(void) {
+  mpu6050_bias_t bias;
+  mpu6050_get_bias(&bias);
+
+  calib_blob_t blob = {
+      .version = CALIB_BLOB_VERSION,
+      .accel_range = (uint8_t)bias.accel_range,
+      .gyro_range = (uint8_t)bias.gyro_range,
+  };
+  memcpy(blob.accel, bias.accel, sizeof(blob.accel));
+  memcpy(blob.gyro, bias.gyro, sizeof(blob.gyro));
+
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(CALIB_NVS_NAMESPACE, NVS_READWRITE, &handle);
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to open NVS: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  err = nvs_set_blob(handle, CALIB_NVS_KEY, &blob, sizeof(blob));
+  if (err == ESP_OK) {
+    err = nvs_commit(handle);
+  }
+  nvs_close(handle);
+
+  if (err != ESP_OK) {
+    DEBUGS_LOGE("Failed to store MPU6050 calibration: %s",
+                esp_err_to_name(err));
+  }
+  return err;
+}
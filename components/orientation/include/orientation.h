@@ -0,0 +1,117 @@
+/**
+ * @file orientation.h
+ * @brief Gyro and accelerometer fusion into a tilt estimate.
+ *
+ * The filter tracks the "up" direction as a unit vector in the sensor
+ * frame. Each sample rotates the vector by the measured angular rate, then
+ * pulls it towards the accelerometer reading with a time constant
+ * (complementary filter). The accelerometer is only trusted while its
+ * magnitude is close to 1 g, so free-fall and impacts run on the gyro
+ * alone and the estimate follows the body through a fall.
+ *
+ * Yaw is not observable from gravity and is not tracked; tilt from the
+ * standing posture is all posture checks need. The arithmetic is float or
+ * Q24 fixed point (CONFIG_ORIENTATION_IMPL_FIXED) with the same API. The
+ * module has no FreeRTOS dependency.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _ORIENTATION_H_
+#define _ORIENTATION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mpu6050.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if CONFIG_ORIENTATION_IMPL_FIXED
+/// Fractional bits of the fixed-point up vector
+#define ORIENTATION_Q 24
+#endif
+
+/**
+ * @brief Filter parameters.
+ */
+typedef struct {
+  uint32_t accel_lsb_per_g;  ///< Sensitivity of the accel range
+  float gyro_lsb_per_dps;    ///< Sensitivity of the gyro range
+  uint32_t time_constant_ms; ///< Accelerometer correction time constant
+  uint32_t accel_gate_mg;    ///< Max ||a| - 1 g| for a correction
+} orientation_config_t;
+
+/**
+ * @brief Filter configuration from Kconfig.
+ */
+#define ORIENTATION_DEFAULT_CONFIG()                                           \
+  {                                                                            \
+    .accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G,                                \
+    .gyro_lsb_per_dps = MPU6050_GYRO_LSB_PER_DPS,                              \
+    .time_constant_ms = CONFIG_ORIENTATION_TIME_CONSTANT_MS,                   \
+    .accel_gate_mg = CONFIG_ORIENTATION_ACCEL_GATE_MG,                         \
+  }
+
+/**
+ * @brief Filter instance. Treat the fields as private.
+ */
+typedef struct {
+#if CONFIG_ORIENTATION_IMPL_FIXED
+  int32_t up[3];      ///< Unit up vector, Q24
+  int32_t gyro_scale; ///< rad per (LSB * us), Q56
+#else
+  float up[3];      ///< Unit up vector
+  float gyro_scale; ///< rad per (LSB * us)
+#endif
+  uint32_t gate_min_sq; ///< Accel correction window (LSB^2)
+  uint32_t gate_max_sq;
+  uint32_t time_constant_us;
+  uint32_t last_us; ///< Timestamp of the previous sample
+  bool primed;      ///< false until the first sample has been seen
+} orientation_t;
+
+/**
+ * @brief Initializes a filter in the standing posture.
+ *
+ * @param o Filter instance.
+ * @param config Parameters; not referenced after the call.
+ */
+void orientation_init(orientation_t *o, const orientation_config_t *config);
+
+/**
+ * @brief Restarts the estimate from the next accelerometer reading.
+ */
+void orientation_reset(orientation_t *o);
+
+/**
+ * @brief Feeds one sample to the filter.
+ *
+ * The time step is taken from the frame timestamps. A gap of more than
+ * 100 ms restarts the estimate from the accelerometer.
+ */
+void orientation_update(orientation_t *o, const sensor_raw_t *frame);
+
+/**
+ * @brief Returns the estimated up direction as a unit vector in the sensor
+ * frame.
+ */
+void orientation_get_up(const orientation_t *o, float up[3]);
+
+/**
+ * @brief Returns the angle between the estimated up direction and the
+ * sensor axis that points up when standing (CONFIG_ORIENTATION_UP_AXIS).
+ *
+ * Uses float; call it when a decision is needed, not per sample.
+ *
+ * @return Tilt in degrees, 0 standing upright, about 90 lying down.
+ */
+float orientation_tilt_deg(const orientation_t *o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ORIENTATION_H_
@@ -0,0 +1,260 @@
+/**
+ * @file orientation.c
+ * @brief Gyro and accelerometer fusion into a tilt estimate.
+ */
+
+#include "orientation.h"
+#include <math.h>
+#include <string.h>
+
+// Longer gaps between samples restart the estimate
+#define MAX_GAP_US 100000u
+
+#if CONFIG_ORIENTATION_UP_AXIS_X
+#define UP_AXIS 0
+#elif CONFIG_ORIENTATION_UP_AXIS_Y
+#define UP_AXIS 1
+#else
+#define UP_AXIS 2
+#endif
+
+#if CONFIG_ORIENTATION_UP_AXIS_INVERTED
+#define UP_SIGN (-1)
+#else
+#define UP_SIGN 1
+#endif
+
+#if CONFIG_ORIENTATION_IMPL_FIXED
+#define ONE ((int32_t)1 << ORIENTATION_Q)
+// Fractional bits of the correction gain
+#define ALPHA_Q 15
+#else
+#define ONE 1.0f
+#endif
+
+static inline uint32_t lsb_sq(uint32_t lsb) {
+  return lsb > UINT16_MAX ? UINT32_MAX : lsb * lsb;
+}
+
+static inline uint32_t mag_sq(const sensor_raw_t *frame) {
+  return (uint32_t)(frame->accel_x * frame->accel_x) +
+         (uint32_t)(frame->accel_y * frame->accel_y) +
+         (uint32_t)(frame->accel_z * frame->accel_z);
+}
+
+#if CONFIG_ORIENTATION_IMPL_FIXED
+/**
+ * @brief Integer square root, rounded down.
+ */
+static uint32_t isqrt32(uint32_t x) {
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+
+  while (bit > x) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+static inline int32_t mul_q(int32_t a, int32_t b) {
+  return (int32_t)(((int64_t)a * b) >> ORIENTATION_Q);
+}
+
+/**
+ * @brief Rotates the up vector by the angle turned in @p dt_us.
+ *
+ * A direction fixed in the world moves as du/dt = u x w in the sensor
+ * frame. The first-order step is exact enough at IMU rates; the length
+ * error it introduces is removed by normalize().
+ */
+static void rotate(orientation_t *o, const sensor_raw_t *frame,
+                   uint32_t dt_us) {
+  const int16_t gyro[3] = {frame->gyro_x, frame->gyro_y, frame->gyro_z};
+  int32_t angle[3]; // Q24 rad
+  for (int i = 0; i < 3; i++) {
+    angle[i] = (int32_t)(((int64_t)gyro[i] * dt_us * o->gyro_scale) >> 32);
+  }
+
+  int32_t *u = o->up;
+  int32_t dx = mul_q(u[1], angle[2]) - mul_q(u[2], angle[1]);
+  int32_t dy = mul_q(u[2], angle[0]) - mul_q(u[0], angle[2]);
+  int32_t dz = mul_q(u[0], angle[1]) - mul_q(u[1], angle[0]);
+  u[0] += dx;
+  u[1] += dy;
+  u[2] += dz;
+}
+
+/**
+ * @brief Pulls the up vector towards the accelerometer reading.
+ * @return false when the reading is outside the gate.
+ */
+static bool correct(orientation_t *o, const sensor_raw_t *frame,
+                    uint32_t dt_us) {
+  uint32_t sq = mag_sq(frame);
+  if (sq < o->gate_min_sq || sq > o->gate_max_sq) {
+    return false;
+  }
+  int32_t mag = (int32_t)isqrt32(sq);
+  if (mag == 0) {
+    return false;
+  }
+
+  // alpha = dt / (tau + dt), or 1 to restart from the accelerometer
+  int32_t alpha = 1 << ALPHA_Q;
+  if (dt_us > 0) {
+    alpha = (int32_t)((dt_us << ALPHA_Q) / (o->time_constant_us + dt_us));
+  }
+
+  const int16_t accel[3] = {frame->accel_x, frame->accel_y, frame->accel_z};
+  for (int i = 0; i < 3; i++) {
+    // Normalized in Q15 first, so the division stays 32-bit
+    int32_t target = accel[i] * 32768 / mag * (1 << (ORIENTATION_Q - 15));
+    o->up[i] += (int32_t)(((int64_t)(target - o->up[i]) * alpha) >> ALPHA_Q);
+  }
+  return true;
+}
+
+/**
+ * @brief One Newton step towards unit length; the vector is always close
+ * to unit length, so this is as good as a division by the norm.
+ */
+static void normalize(orientation_t *o) {
+  int32_t *u = o->up;
+  int64_t norm_sq =
+      ((int64_t)u[0] * u[0] + (int64_t)u[1] * u[1] + (int64_t)u[2] * u[2]) >>
+      ORIENTATION_Q;
+  int32_t factor = (int32_t)((3 * (int64_t)ONE - norm_sq) / 2);
+  for (int i = 0; i < 3; i++) {
+    u[i] = mul_q(u[i], factor);
+  }
+}
+
+#else // CONFIG_ORIENTATION_IMPL_FLOAT
+
+/**
+ * @brief Rotates the up vector by the angle turned in @p dt_us.
+ *
+ * A direction fixed in the world moves as du/dt = u x w in the sensor
+ * frame. The first-order step is exact enough at IMU rates; the length
+ * error it introduces is removed by normalize().
+ */
+static void rotate(orientation_t *o, const sensor_raw_t *frame,
+                   uint32_t dt_us) {
+  float k = o->gyro_scale * (float)dt_us;
+  float wx = frame->gyro_x * k;
+  float wy = frame->gyro_y * k;
+  float wz = frame->gyro_z * k;
+
+  float *u = o->up;
+  float dx = u[1] * wz - u[2] * wy;
+  float dy = u[2] * wx - u[0] * wz;
+  float dz = u[0] * wy - u[1] * wx;
+  u[0] += dx;
+  u[1] += dy;
+  u[2] += dz;
+}
+
+/**
+ * @brief Pulls the up vector towards the accelerometer reading.
+ * @return false when the reading is outside the gate.
+ */
+static bool correct(orientation_t *o, const sensor_raw_t *frame,
+                    uint32_t dt_us) {
+  uint32_t sq = mag_sq(frame);
+  if (sq < o->gate_min_sq || sq > o->gate_max_sq || sq == 0) {
+    return false;
+  }
+
+  // alpha = dt / (tau + dt), or 1 to restart from the accelerometer
+  float alpha = 1.0f;
+  if (dt_us > 0) {
+    alpha = (float)dt_us / (float)(o->time_constant_us + dt_us);
+  }
+
+  float inv_mag = 1.0f / sqrtf((float)sq);
+  const int16_t accel[3] = {frame->accel_x, frame->accel_y, frame->accel_z};
+  for (int i = 0; i < 3; i++) {
+    o->up[i] += (accel[i] * inv_mag - o->up[i]) * alpha;
+  }
+  return true;
+}
+
+static void normalize(orientation_t *o) {
+  float *u = o->up;
+  float inv_norm = 1.0f / sqrtf(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  u[0] *= inv_norm;
+  u[1] *= inv_norm;
+  u[2] *= inv_norm;
+}
+
+#endif // CONFIG_ORIENTATION_IMPL_FIXED
+
+void orientation_init(orientation_t *o, const orientation_config_t *config) {
+  memset(o, 0, sizeof(*o));
+
+  double rad_per_lsb_us =
+      M_PI / 180.0 / (double)config->gyro_lsb_per_dps / 1e6;
+#if CONFIG_ORIENTATION_IMPL_FIXED
+  o->gyro_scale = (int32_t)(rad_per_lsb_us * (double)(1ull << 56) + 0.5);
+#else
+  o->gyro_scale = (float)rad_per_lsb_us;
+#endif
+
+  uint32_t one_g = config->accel_lsb_per_g;
+  uint32_t gate = (uint32_t)(((uint64_t)config->accel_gate_mg * one_g + 500) /
+                             1000);
+  o->gate_min_sq = gate < one_g ? lsb_sq(one_g - gate) : 0;
+  o->gate_max_sq = lsb_sq(one_g + gate);
+  o->time_constant_us = config->time_constant_ms * 1000u;
+
+  orientation_reset(o);
+}
+
+void orientation_reset(orientation_t *o) {
+  // Standing until the accelerometer says otherwise
+  o->up[0] = 0;
+  o->up[1] = 0;
+  o->up[2] = 0;
+  o->up[UP_AXIS] = UP_SIGN * ONE;
+  o->primed = false;
+}
+
+void orientation_update(orientation_t *o, const sensor_raw_t *frame) {
+  uint32_t dt_us = frame->timestamp_us - o->last_us;
+  o->last_us = frame->timestamp_us;
+
+  if (!o->primed || dt_us > MAX_GAP_US) {
+    // Restart: without a valid reading keep the previous estimate
+    o->primed = correct(o, frame, 0);
+    return;
+  }
+
+  rotate(o, frame, dt_us);
+  correct(o, frame, dt_us);
+  normalize(o);
+}
+
+void orientation_get_up(const orientation_t *o, float up[3]) {
+  for (int i = 0; i < 3; i++) {
+    up[i] = (float)o->up[i] / (float)ONE;
+  }
+}
+
+float orientation_tilt_deg(const orientation_t *o) {
+  float cos_tilt = UP_SIGN * (float)o->up[UP_AXIS] / (float)ONE;
+  if (cos_tilt > 1.0f) {
+    cos_tilt = 1.0f;
+  } else if (cos_tilt < -1.0f) {
+    cos_tilt = -1.0f;
+  }
+  return acosf(cos_tilt) * 180.0f / (float)M_PI;
+}
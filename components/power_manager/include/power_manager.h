@@ -0,0 +1,108 @@
+/**
+ * @file power_manager.h
+ * @brief Automatic light sleep, power locks and sleep-time metrics.
+ *
+ * The power manager configures esp_pm so the chip enters light sleep
+ * whenever every task is blocked. Tasks that wait on events that cannot
+ * wake the chip keep it awake by holding a power lock. With
+ * CONFIG_POWER_MANAGER_ENABLE off, locks are no-ops.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _POWER_MANAGER_H_
+#define _POWER_MANAGER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_pm.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Handle of a lock that keeps the chip out of light sleep.
+ */
+typedef esp_pm_lock_handle_t power_lock_t;
+
+/**
+ * @brief Sleep statistics since power_manager_init().
+ */
+typedef struct {
+  uint64_t uptime_us;    ///< Time since the power manager started
+  uint64_t sleep_us;     ///< Time spent in light sleep
+  uint32_t sleep_count;  ///< Number of light sleep periods
+} power_manager_stats_t;
+
+#if CONFIG_POWER_MANAGER_ENABLE
+
+/**
+ * @brief Configures frequency scaling, light sleep and GPIO wake-up.
+ *
+ * @return ESP_OK on success, esp_err_t code from esp_pm otherwise.
+ */
+esp_err_t power_manager_init(void);
+
+/**
+ * @brief Creates a lock that keeps the chip awake while held.
+ *
+ * @param name Name shown in esp_pm_dump_locks().
+ * @param[out] lock Created lock.
+ * @return ESP_OK on success, esp_err_t code otherwise.
+ */
+esp_err_t power_manager_lock_create(const char *name, power_lock_t *lock);
+
+/**
+ * @brief Takes a lock; the chip stays awake until it is released.
+ */
+void power_manager_lock_acquire(power_lock_t lock);
+
+/**
+ * @brief Releases a lock taken with power_manager_lock_acquire().
+ */
+void power_manager_lock_release(power_lock_t lock);
+
+/**
+ * @brief Deletes a lock made with power_manager_lock_create(); it must be
+ * released. NULL is ignored.
+ */
+void power_manager_lock_delete(power_lock_t lock);
+
+/**
+ * @brief Returns sleep statistics.
+ *
+ * Sleep time is only counted when PM_LIGHT_SLEEP_CALLBACKS is enabled.
+ */
+void power_manager_get_stats(power_manager_stats_t *stats);
+
+#else
+// No-op fallbacks when power management is disabled
+static inline esp_err_t power_manager_init(void) { return ESP_OK; }
+static inline esp_err_t power_manager_lock_create(const char *name,
+                                                  power_lock_t *lock) {
+  (void)name;
+  *lock = NULL;
+  return ESP_OK;
+}
+static inline void power_manager_lock_acquire(power_lock_t lock) {
+  (void)lock;
+}
+static inline void power_manager_lock_release(power_lock_t lock) {
+  (void)lock;
+}
+static inline void power_manager_lock_delete(power_lock_t lock) {
+  (void)lock;
+}
+static inline void power_manager_get_stats(power_manager_stats_t *stats) {
+  *stats = (power_manager_stats_t){0};
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _POWER_MANAGER_H_
@@ -0,0 +1,117 @@
+/**
+ * @file power_manager.c
+ * @brief Automatic light sleep, power locks and sleep-time metrics.
+ */
+
+#include "power_manager.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#if CONFIG_POWER_MANAGER_ENABLE
+
+static const char *TAG = "POWER_MANAGER";
+
+static int64_t s_start_us = 0;
+// Updated from the light sleep exit callback
+static uint64_t s_sleep_us = 0;
+static uint32_t s_sleep_count = 0;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+/**
+ * @brief Accumulates the duration of each light sleep period.
+ */
+static esp_err_t IRAM_ATTR on_light_sleep_exit(int64_t sleep_time_us,
+                                                void *arg) {
+  portENTER_CRITICAL_ISR(&s_stats_mux);
+  s_sleep_us += (uint64_t)sleep_time_us;
+  s_sleep_count++;
+  portEXIT_CRITICAL_ISR(&s_stats_mux);
+  return ESP_OK;
+}
+#endif
+
+esp_err_t power_manager_init(void) {
+  const esp_pm_config_t pm_config = {
+      .max_freq_mhz = CONFIG_POWER_MANAGER_MAX_FREQ_MHZ,
+      .min_freq_mhz = CONFIG_POWER_MANAGER_MIN_FREQ_MHZ,
+      .light_sleep_enable = true,
+  };
+  esp_err_t err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  // GPIO wake-up sources (e.g. the MPU6050 INT pin) are armed per pin
+  // with gpio_wakeup_enable(); this enables the source as a whole.
+  err = esp_sleep_enable_gpio_wakeup();
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to enable GPIO wake-up: %s", esp_err_to_name(err));
+    return err;
+  }
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+  esp_pm_sleep_cbs_register_config_t cbs = {
+      .exit_cb = on_light_sleep_exit,
+  };
+  err = esp_pm_light_sleep_register_cbs(&cbs);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Sleep time metric unavailable: %s", esp_err_to_name(err));
+  }
+#else
+  ESP_LOGW(TAG, "PM_LIGHT_SLEEP_CALLBACKS disabled, sleep time not counted");
+#endif
+
+  s_start_us = esp_timer_get_time();
+  ESP_LOGI(TAG, "Automatic light sleep enabled (%d-%d MHz)",
+           CONFIG_POWER_MANAGER_MIN_FREQ_MHZ,
+           CONFIG_POWER_MANAGER_MAX_FREQ_MHZ);
+  return ESP_OK;
+}
+
+esp_err_t power_manager_lock_create(const char *name, power_lock_t *lock) {
+  esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, name, lock);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create power lock %s: %s", name,
+             esp_err_to_name(err));
+    *lock = NULL;
+  }
+  return err;
+}
+
+void power_manager_lock_acquire(power_lock_t lock) {
+  if (lock != NULL) {
+    esp_pm_lock_acquire(lock);
+  }
+}
+
+void power_manager_lock_release(power_lock_t lock) {
+  if (lock != NULL) {
+    esp_pm_lock_release(lock);
+  }
+}
+
+void power_manager_lock_delete(power_lock_t lock) {
+  if (lock == NULL) {
+    return;
+  }
+  esp_err_t err = esp_pm_lock_delete(lock);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to delete power lock: %s", esp_err_to_name(err));
+  }
+}
+
+void power_manager_get_stats(power_manager_stats_t *stats) {
+  stats->uptime_us = (uint64_t)(esp_timer_get_time() - s_start_us);
+
+  portENTER_CRITICAL(&s_stats_mux);
+  stats->sleep_us = s_sleep_us;
+  stats->sleep_count = s_sleep_count;
+  portEXIT_CRITICAL(&s_stats_mux);
+}
+
+#endif // CONFIG_POWER_MANAGER_ENABLE
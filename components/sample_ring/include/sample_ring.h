@@ -0,0 +1,130 @@
+/**
+ * @file sample_ring.h
+ * @brief Lock-free single-producer, multi-reader ring of raw IMU frames.
+ *
+ * The acquisition path pushes every sensor_raw_t into the ring. Any number
+ * of consumers (fall logic, recorders, telemetry) attach a reader with its
+ * own cursor and read frames in place, without copying and without locks.
+ *
+ * The producer never blocks: a reader that falls more than one ring length
+ * behind loses the oldest frames, and the loss is counted in its overrun
+ * counters. Because reads are zero-copy, a reader must validate its span
+ * with sample_ring_consume() after processing it; if the producer lapped
+ * the reader in the meantime the span is reported as overwritten.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Ring state shared between the producer and all readers.
+ *
+ * Storage is provided by the owner so the ring can live in static memory.
+ */
+typedef struct {
+  sensor_raw_t *frames;  ///< Frame storage, @ref capacity entries
+  uint32_t capacity;     ///< Number of frames, power of two
+  uint32_t mask;         ///< capacity - 1
+  _Atomic uint32_t head; ///< Sequence number of the next frame to write
+} sample_ring_t;
+
+/**
+ * @brief Per-consumer read position and loss statistics.
+ */
+typedef struct {
+  sample_ring_t *ring;     ///< Ring this reader is attached to
+  const char *name;        ///< Consumer name for diagnostics
+  uint32_t cursor;         ///< Sequence number of the next frame to read
+  uint32_t overrun_frames; ///< Frames lost because the reader fell behind
+  uint32_t overrun_events; ///< Number of times frames were lost
+} sample_ring_reader_t;
+
+/**
+ * @brief Initializes a ring over caller-provided storage.
+ *
+ * @param ring Ring to initialize.
+ * @param storage Array of @p capacity frames.
+ * @param capacity Number of frames; must be a power of two.
+ * @return
+ * - ESP_OK on success.
+ * - ESP_ERR_INVALID_ARG if a pointer is NULL or capacity is not a power of
+ * two.
+ */
+esp_err_t sample_ring_init(sample_ring_t *ring, sensor_raw_t *storage,
+                           uint32_t capacity);
+
+/**
+ * @brief Appends one frame. Must only be called from the producer task.
+ */
+void sample_ring_push(sample_ring_t *ring, const sensor_raw_t *frame);
+
+/**
+ * @brief Appends @p count frames. Must only be called from the producer task.
+ */
+void sample_ring_push_batch(sample_ring_t *ring, const sensor_raw_t *frames,
+                            size_t count);
+
+/**
+ * @brief Attaches a reader to a ring.
+ *
+ * The reader starts at the current head and only sees frames pushed after
+ * this call.
+ *
+ * @param reader Reader to initialize.
+ * @param ring Ring to read from.
+ * @param name Consumer name for diagnostics (kept by reference).
+ */
+void sample_ring_reader_init(sample_ring_reader_t *reader, sample_ring_t *ring,
+                             const char *name);
+
+/**
+ * @brief Returns the frames available to a reader without copying them.
+ *
+ * The span is contiguous, so at most the frames up to the end of the
+ * storage are returned; call again after consuming to get the rest. If the
+ * reader has been lapped, its cursor is moved forward first and the lost
+ * frames are added to its overrun counters.
+ *
+ * @param reader Reader to query.
+ * @param[out] frames Pointer to the first available frame.
+ * @return Number of frames available at @p frames (0 if none).
+ */
+size_t sample_ring_peek(sample_ring_reader_t *reader,
+                        const sensor_raw_t **frames);
+
+/**
+ * @brief Releases frames obtained with sample_ring_peek().
+ *
+ * Advances the cursor by @p count and checks that the producer did not
+ * overwrite the span while it was being read.
+ *
+ * @param reader Reader that peeked the frames.
+ * @param count Number of frames processed.
+ * @return true if the frames were intact, false if they were overwritten
+ * (the loss is added to the overrun counters).
+ */
+bool sample_ring_consume(sample_ring_reader_t *reader, size_t count);
+
+/**
+ * @brief Number of frames written but not yet read by @p reader.
+ */
+uint32_t sample_ring_available(const sample_ring_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLE_RING_H
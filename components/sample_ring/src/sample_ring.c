@@ -0,0 +1,121 @@
+/**
+ * @file sample_ring.c
+ * @brief Lock-free single-producer, multi-reader ring of raw IMU frames.
+ *
+ * The producer writes a slot and then publishes it by advancing @c head with
+ * release semantics. Readers load @c head with acquire semantics, so every
+ * frame below it is fully written. Sequence numbers are free-running 32-bit
+ * counters; all comparisons use unsigned differences and survive wrap.
+ */
+
+#include "sample_ring.h"
+#include "esp_log.h"
+
+static const char *TAG = "SAMPLE_RING";
+
+// When a reader is lapped it resumes this far behind the head, leaving the
+// producer some room before it overwrites the frames again.
+#define RESYNC_SLACK_DIV 4
+
+esp_err_t sample_ring_init(sample_ring_t *ring, sensor_raw_t *storage,
+                           uint32_t capacity) {
+  if (ring == NULL || storage == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+    ESP_LOGE(TAG, "Capacity %lu is not a power of two",
+             (unsigned long)capacity);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  ring->frames = storage;
+  ring->capacity = capacity;
+  ring->mask = capacity - 1;
+  atomic_init(&ring->head, 0);
+
+  ESP_LOGI(TAG, "Sample ring initialized with %lu frames",
+           (unsigned long)capacity);
+  return ESP_OK;
+}
+
+void sample_ring_push(sample_ring_t *ring, const sensor_raw_t *frame) {
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  ring->frames[head & ring->mask] = *frame;
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void sample_ring_push_batch(sample_ring_t *ring, const sensor_raw_t *frames,
+                            size_t count) {
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  for (size_t i = 0; i < count; i++) {
+    ring->frames[(head + i) & ring->mask] = frames[i];
+  }
+  atomic_store_explicit(&ring->head, head + (uint32_t)count,
+                        memory_order_release);
+}
+
+void sample_ring_reader_init(sample_ring_reader_t *reader, sample_ring_t *ring,
+                             const char *name) {
+  reader->ring = ring;
+  reader->name = name;
+  reader->cursor = atomic_load_explicit(&ring->head, memory_order_acquire);
+  reader->overrun_frames = 0;
+  reader->overrun_events = 0;
+}
+
+/**
+ * @brief Records frames skipped by a reader.
+ */
+static void reader_add_overrun(sample_ring_reader_t *reader, uint32_t lost) {
+  reader->overrun_frames += lost;
+  reader->overrun_events++;
+  ESP_LOGW(TAG, "Reader '%s' overrun, %lu frames lost", reader->name,
+           (unsigned long)lost);
+}
+
+size_t sample_ring_peek(sample_ring_reader_t *reader,
+                        const sensor_raw_t **frames) {
+  sample_ring_t *ring = reader->ring;
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint32_t pending = head - reader->cursor;
+
+  // The oldest slot is the next one the producer writes, so a reader that
+  // is a full ring behind can no longer trust its cursor.
+  if (pending >= ring->capacity) {
+    uint32_t resume = head - (ring->capacity - ring->capacity / RESYNC_SLACK_DIV);
+    reader_add_overrun(reader, resume - reader->cursor);
+    reader->cursor = resume;
+    pending = head - resume;
+  }
+
+  uint32_t index = reader->cursor & ring->mask;
+  uint32_t contiguous = ring->capacity - index;
+
+  *frames = &ring->frames[index];
+  return pending < contiguous ? pending : contiguous;
+}
+
+bool sample_ring_consume(sample_ring_reader_t *reader, size_t count) {
+  sample_ring_t *ring = reader->ring;
+  uint32_t start = reader->cursor;
+
+  reader->cursor += (uint32_t)count;
+
+  // Slot 'start' is reused by the write of sequence start + capacity, which
+  // may already be in progress once head has reached that value.
+  atomic_thread_fence(memory_order_acquire);
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  if (head - start >= ring->capacity) {
+    uint32_t overwritten = head - start - ring->capacity + 1;
+    reader_add_overrun(reader, overwritten < count ? overwritten
+                                                   : (uint32_t)count);
+    return false;
+  }
+  return true;
+}
+
+uint32_t sample_ring_available(const sample_ring_reader_t *reader) {
+  uint32_t head =
+      atomic_load_explicit(&reader->ring->head, memory_order_acquire);
+  return head - reader->cursor;
+}
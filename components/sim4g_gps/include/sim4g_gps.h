@@ -13,6 +13,20 @@ extern "C" {
  * @brief High-level GPS + SMS + MQTT public interface for EC800K/4G module.
  */
 
+/**
+ * @brief Callback invoked once the SMS and MQTT alert attempts are done.
+ */
+typedef void (*sim4g_alert_sent_cb_t)(void);
+
+/**
+ * @brief Kind of alert, selects the SMS text and the MQTT payload.
+ */
+typedef enum {
+  SIM4G_ALERT_FALL = 0,  ///< Fall detected
+  SIM4G_ALERT_LONG_LIE,  ///< Wearer has not got up after the fall
+  SIM4G_ALERT_RECOVERED, ///< Wearer got up after a long-lie alert
+} sim4g_alert_kind_t;
+
 /**
  * @brief Initialize SIM4G GPS subsystem.
  *
@@ -37,15 +51,47 @@ void sim4g_gps_set_phone_number(const char *number);
 esp_err_t sim4g_gps_is_enabled(bool *enabled);
 
 /**
- * @brief Starts a task to handle a fall alert.
+ * @brief Queues a fall alert.
  *
- * This function creates a new, non-blocking task that will send both an SMS
- * and an MQTT message.
+ * The alert worker sends both an SMS and an MQTT message; this call does
+ * not wait for either.
  *
  * @param gps_data A pointer to the latest GPS data at the time of the fall.
- * @return ESP_OK on success, ESP_FAIL on failure.
+ * @param alert_id alert_trace ID of the fall; the worker marks the SMS and
+ * MQTT stages of that trace. 0 if untraced.
+ * @return ESP_OK on success, ESP_FAIL if the alert could not be queued.
+ */
+esp_err_t sim4g_gps_start_fall_alert(const gps_data_t *gps_data,
+                                     uint32_t alert_id);
+
+/**
+ * @brief Queues an alert of the given kind for the alert worker.
+ *
+ * Same delivery as sim4g_gps_start_fall_alert(): one SMS and one MQTT
+ * message on CONFIG_MQTT_ALERT_TOPIC, whose payload names the event. The
+ * worker and its queue are created by sim4g_gps_init() in static memory,
+ * so queuing an alert performs no heap operation and never blocks.
+ *
+ * @param kind Alert kind.
+ * @param gps_data Latest GPS data.
+ * @param lying_s Time the wearer stayed motionless after the fall, reported
+ * by the long-lie and recovery alerts.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before sim4g_gps_init(),
+ * ESP_FAIL if the queue is full.
+ */
+esp_err_t sim4g_gps_start_alert(sim4g_alert_kind_t kind,
+                                const gps_data_t *gps_data, uint32_t lying_s);
+
+/**
+ * @brief Registers a callback run by the alert worker once a fall alert
+ * (SIM4G_ALERT_FALL only) has been sent.
+ *
+ * Lets lower-priority work (e.g. the fall capture upload) wait until the
+ * urgent alert has gone out.
+ *
+ * @param cb Callback, or NULL to remove it.
  */
-esp_err_t sim4g_gps_start_fall_alert(const gps_data_t *gps_data);
+void sim4g_gps_set_alert_sent_cb(sim4g_alert_sent_cb_t cb);
 
 /**
  * @brief Updates the GPS location by communicating with the SIM4G module.
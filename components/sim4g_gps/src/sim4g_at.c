@@ -11,6 +11,9 @@
 
 static const char *TAG = "SIM4G_AT";
 
+// Longest SMS text sent, the size of the alert texts of sim4g_gps.c
+#define SMS_TEXT_MAX_LEN 255
+
 // AT Command table
 const at_command_t at_command_table[AT_CMD_MAX_COUNT] = {
     [AT_CMD_TEST_ID] = {AT_CMD_TEST_ID, "AT\r\n", 300},
@@ -178,8 +181,14 @@ esp_err_t sim4g_at_send_sms(const char *phone, const char *message) {
   }
 
   char cmd[64];
+  // Text and Ctrl-Z: a cut body loses the Ctrl-Z and is never sent
+  char body[SMS_TEXT_MAX_LEN + 2];
   char response[128] = {0};
 
+  if (strlen(message) > SMS_TEXT_MAX_LEN) {
+    ESP_LOGW(TAG, "SMS text longer than %d bytes", SMS_TEXT_MAX_LEN);
+    return ESP_ERR_INVALID_SIZE;
+  }
   ESP_LOGI(TAG, "Attempting to send SMS to: %s", phone);
 
   esp_err_t err =
@@ -199,9 +208,9 @@ esp_err_t sim4g_at_send_sms(const char *phone, const char *message) {
     return ESP_FAIL;
   }
 
-  snprintf(cmd, sizeof(cmd), "%s\x1A", message);
+  snprintf(body, sizeof(body), "%s\x1A", message);
   res =
-      comm_uart_send_command(cmd, response, sizeof(response),
+      comm_uart_send_command(body, response, sizeof(response),
                              at_command_table[AT_CMD_SMS_CTRL_Z_ID].timeout_ms);
 
   if (res == COMM_SUCCESS && strstr(response, "+CMGS")) {
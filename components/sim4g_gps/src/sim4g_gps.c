@@ -2,17 +2,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alert_trace.h"
 #include "data_manager.h"
 #include "data_manager_types.h"
+#include "debugs.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "json_wrapper.h" // Provides json_wrapper_* functions
 #include "mqtt_client.h"  // Provides esp_mqtt_client_publish
+#include "power_manager.h"
 #include "sdkconfig.h"
 #include "sim4g_at.h" // Provides sim4g_at_get_gps
 #include "sim4g_gps.h"
+#include "task_topology.h"
 #include "user_mqtt.h" // Provides user_mqtt_get_client
 
 static const char *TAG = "SIM4G_GPS";
@@ -23,68 +28,172 @@ static char s_phone_number[16] = ""; // Phone number for SMS
 // A mutex to protect access to the SIM4G AT module for GPS queries
 static SemaphoreHandle_t s_gps_at_mutex;
 
+// Keeps the chip awake while talking to the modem; UART RX cannot wake it
+static power_lock_t s_power_lock;
+
+// Notified when a fall alert has been sent
+static sim4g_alert_sent_cb_t s_alert_sent_cb = NULL;
+
 #define MQTT_TASK_STACK_SIZE CONFIG_MQTT_TASK_STACK_SIZE
-#define MQTT_TASK_PRIORITY CONFIG_MQTT_TASK_PRIORITY
 #define ALERT_TASK_STACK_SIZE CONFIG_ALERT_TASK_STACK_SIZE
-#define ALERT_TASK_PRIORITY CONFIG_ALERT_TASK_PRIORITY
+// Alerts waiting for the worker; a fall, its long lie and the recovery fit
+#define ALERT_QUEUE_LENGTH 4
+#define ALERT_PAYLOAD_SIZE 256
+
+/**
+ * @brief Alert queued for the alert worker, copied by value.
+ */
+typedef struct {
+  sim4g_alert_kind_t kind;
+  uint32_t lying_s;  ///< Motionless time after the fall (long lie, recovery)
+  uint32_t alert_id; ///< alert_trace ID, 0 if untraced
+  gps_data_t loc;    ///< Location when the alert was raised
+} alert_request_t;
+
+// Alert worker and its queue live in static memory, so raising an alert
+// never depends on the heap
+static StaticQueue_t s_alert_queue_buf;
+static uint8_t s_alert_queue_storage[ALERT_QUEUE_LENGTH *
+                                     sizeof(alert_request_t)];
+static QueueHandle_t s_alert_queue = NULL;
+static StackType_t s_alert_stack[ALERT_TASK_STACK_SIZE];
+static StaticTask_t s_alert_tcb;
 
 // -----------------------------------------------------------------------------
 // New Task for Fall Alert
 // -----------------------------------------------------------------------------
 
 /**
- * @brief FreeRTOS task to handle both SMS and MQTT alerts for a fall event.
- *
- * @param param A pointer to the gps_data_t struct from the moment of the fall.
+ * @brief Formats the SMS text of an alert.
  */
-static void fall_alert_task(void *param) {
-  gps_data_t *loc = (gps_data_t *)param;
-  char msg[256];
+static void format_sms(const alert_request_t *req, char *msg, size_t size) {
+  const gps_data_t *loc = &req->loc;
+  int len;
+
+  switch (req->kind) {
+  case SIM4G_ALERT_LONG_LIE:
+    len = snprintf(msg, size, "URGENT: no movement for %lu s after a fall!",
+                   (unsigned long)req->lying_s);
+    break;
+  case SIM4G_ALERT_RECOVERED:
+    len = snprintf(msg, size, "Update: moving again after the fall.");
+    break;
+  default:
+    len = snprintf(msg, size, "Fall detected!");
+    break;
+  }
+  if (len < 0 || (size_t)len >= size) {
+    return;
+  }
 
   if (loc->has_gps_fix) {
-    snprintf(msg, sizeof(msg), "Fall detected!\nLat: %.6f\nLon: %.6f\nTime: %s",
+    snprintf(msg + len, size - len, "\nLat: %.6f\nLon: %.6f\nTime: %s",
              loc->latitude, loc->longitude, loc->timestamp);
-  } else {
-    snprintf(msg, sizeof(msg), "Fall detected! GPS data unavailable.");
+  } else if (req->kind != SIM4G_ALERT_RECOVERED) {
+    snprintf(msg + len, size - len, " GPS data unavailable.");
   }
+}
+
+/**
+ * @brief Sends the SMS and the MQTT message of one alert.
+ *
+ * Runs on the alert worker. Nothing here touches the heap except the MQTT
+ * client, which queues QoS 1 messages in its outbox.
+ */
+static void send_alert(const alert_request_t *req) {
+  const gps_data_t *loc = &req->loc;
+  // Static: only the alert worker formats alerts
+  static char msg[256];
+  static char payload[ALERT_PAYLOAD_SIZE];
+
+  alert_trace_mark(req->alert_id, ALERT_STAGE_WORKER);
+  power_manager_lock_acquire(s_power_lock);
+
+  format_sms(req, msg, sizeof(msg));
 
   if (strlen(s_phone_number) > 0) {
     ESP_LOGI(TAG, "Sending SMS to %s:\n%s", s_phone_number, msg);
     esp_err_t sms_err = sim4g_at_send_sms(s_phone_number, msg);
     if (sms_err != ESP_OK) {
       ESP_LOGE(TAG, "SMS send failed: %s", esp_err_to_name(sms_err));
+      alert_trace_skip(req->alert_id, ALERT_STAGE_SMS_ACCEPTED);
     } else {
+      // Returns on +CMGS: the modem has accepted the message
+      alert_trace_mark(req->alert_id, ALERT_STAGE_SMS_ACCEPTED);
       ESP_LOGI(TAG, "SMS sent successfully");
     }
   } else {
     ESP_LOGW(TAG, "SMS not sent, phone number is not set.");
+    alert_trace_skip(req->alert_id, ALERT_STAGE_SMS_ACCEPTED);
   }
 
   // Update the data_manager with fall event and GPS data
   device_state_t current_state;
   data_manager_get_device_state(&current_state);
   current_state.gps_data = *loc;
-  current_state.fall_detected = true;
+  current_state.fall_detected = req->kind != SIM4G_ALERT_RECOVERED;
   data_manager_set_device_state(&current_state);
 
   ESP_LOGI(TAG, "Publishing fall alert to MQTT...");
-  char *json_payload = json_wrapper_create_alert_payload();
-  if (json_payload) {
-    int msg_id = esp_mqtt_client_publish(
-        user_mqtt_get_client(), CONFIG_MQTT_ALERT_TOPIC, json_payload, 0, 1, 0);
-    free(json_payload);
+  int len;
+  switch (req->kind) {
+  case SIM4G_ALERT_LONG_LIE:
+    len = json_wrapper_write_long_lie_payload(payload, sizeof(payload),
+                                              req->lying_s);
+    break;
+  case SIM4G_ALERT_RECOVERED:
+    len = json_wrapper_write_recovery_payload(payload, sizeof(payload),
+                                              req->lying_s);
+    break;
+  default:
+    len = json_wrapper_write_alert_payload(payload, sizeof(payload));
+    break;
+  }
+  int msg_id = -1;
+  if (len > 0) {
+    debugs_heap_watch_exempt(true);
+    msg_id = esp_mqtt_client_publish(user_mqtt_get_client(),
+                                     CONFIG_MQTT_ALERT_TOPIC, payload, len, 1,
+                                     0);
+    debugs_heap_watch_exempt(false);
     if (msg_id == -1) {
       ESP_LOGE(TAG, "MQTT publish failed.");
     } else {
+      alert_trace_mark_mqtt(req->alert_id, msg_id);
       ESP_LOGI(TAG, "MQTT alert published successfully, msg_id=%d", msg_id);
     }
   } else {
     ESP_LOGE(TAG, "Failed to create JSON alert payload.");
   }
+  if (msg_id == -1) {
+    alert_trace_skip(req->alert_id, ALERT_STAGE_MQTT_QUEUED);
+    alert_trace_skip(req->alert_id, ALERT_STAGE_MQTT_ACKED);
+  }
 
-  free(loc);
-  vTaskDelete(NULL);
+  if (req->kind == SIM4G_ALERT_FALL && s_alert_sent_cb != NULL) {
+    s_alert_sent_cb();
+  }
+  power_manager_lock_release(s_power_lock);
 }
+
+/**
+ * @brief Persistent worker sending the alerts queued by
+ * sim4g_gps_start_alert(), one at a time.
+ */
+static void alert_worker_task(void *param) {
+  // newlib allocates the big integers of float formatting on first use in
+  // each task and keeps them; do it now rather than during the first alert
+  char warm_up[16];
+  snprintf(warm_up, sizeof(warm_up), "%.6f", 105.854202);
+
+  alert_request_t req;
+  while (1) {
+    if (xQueueReceive(s_alert_queue, &req, portMAX_DELAY) == pdTRUE) {
+      send_alert(&req);
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Existing Tasks and Functions (with some modifications)
 // -----------------------------------------------------------------------------
@@ -108,6 +217,7 @@ void sim4g_gps_update_location(void) {
 static void mqtt_monitoring_task(void *param) {
   ESP_LOGI(TAG, "MQTT monitoring task started");
   while (1) {
+    power_manager_lock_acquire(s_power_lock);
     sim4g_gps_update_location();
 
     if (data_manager_get_mqtt_status()) {
@@ -127,37 +237,74 @@ static void mqtt_monitoring_task(void *param) {
     } else {
       ESP_LOGW(TAG, "MQTT not connected, skipping periodic publish.");
     }
+    power_manager_lock_release(s_power_lock);
 
     vTaskDelay(pdMS_TO_TICKS(CONFIG_MQTT_PERIODIC_PUBLISH_INTERVAL_MS));
   }
 }
 
 /**
- * @brief Starts a task to handle a fall alert.
- * @param gps_data A pointer to the latest GPS data.
+ * @brief Hands an alert to the alert worker without blocking.
  */
-esp_err_t sim4g_gps_start_fall_alert(const gps_data_t *gps_data) {
-  gps_data_t *task_param = (gps_data_t *)malloc(sizeof(gps_data_t));
-  if (task_param == NULL) {
-    ESP_LOGE(TAG, "Failed to allocate memory for fall alert task parameter.");
-    return ESP_FAIL;
+static esp_err_t queue_alert(const alert_request_t *req) {
+  if (s_alert_queue == NULL) {
+    ESP_LOGE(TAG, "Alert worker not running");
+    return ESP_ERR_INVALID_STATE;
   }
-  memcpy(task_param, gps_data, sizeof(gps_data_t));
-
-  BaseType_t result =
-      xTaskCreate(fall_alert_task, "fall_alert_task", ALERT_TASK_STACK_SIZE,
-                  task_param, ALERT_TASK_PRIORITY, NULL);
-
-  if (result != pdPASS) {
-    ESP_LOGE(TAG, "Failed to create fall_alert_task");
-    free(task_param);
+  if (xQueueSend(s_alert_queue, req, 0) != pdTRUE) {
+    ESP_LOGE(TAG, "Alert queue full, alert dropped");
     return ESP_FAIL;
   }
 
-  ESP_LOGI(TAG, "Fall alert task created successfully");
+  ESP_LOGI(TAG, "Alert queued");
   return ESP_OK;
 }
 
+/**
+ * @brief Queues a fall alert for the alert worker.
+ * @param gps_data A pointer to the latest GPS data.
+ * @param alert_id alert_trace ID of the fall.
+ */
+esp_err_t sim4g_gps_start_fall_alert(const gps_data_t *gps_data,
+                                     uint32_t alert_id) {
+  alert_request_t req = {
+      .kind = SIM4G_ALERT_FALL,
+      .alert_id = alert_id,
+      .loc = *gps_data,
+  };
+  return queue_alert(&req);
+}
+
+/**
+ * @brief Queues an alert of the given kind for the alert worker.
+ */
+esp_err_t sim4g_gps_start_alert(sim4g_alert_kind_t kind,
+                                const gps_data_t *gps_data, uint32_t lying_s) {
+  alert_request_t req = {
+      .kind = kind,
+      .lying_s = lying_s,
+      .loc = *gps_data,
+  };
+  return queue_alert(&req);
+}
+
+/**
+ * @brief Creates the alert queue and its worker.
+ */
+static esp_err_t start_alert_worker(void) {
+  s_alert_queue =
+      xQueueCreateStatic(ALERT_QUEUE_LENGTH, sizeof(alert_request_t),
+                         s_alert_queue_storage, &s_alert_queue_buf);
+  esp_err_t err = task_topology_create_static(
+      TASK_TOPOLOGY_ALERT, alert_worker_task, sizeof(s_alert_stack), NULL,
+      s_alert_stack, &s_alert_tcb, NULL);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create the alert worker");
+    s_alert_queue = NULL;
+  }
+  return err;
+}
+
 /**
  * @brief Initializes the SIM4G GPS module and starts the monitoring task.
  */
@@ -165,8 +312,19 @@ esp_err_t sim4g_gps_start_fall_alert(const gps_data_t *gps_data) {
  * @brief Initializes the SIM4G GPS module and starts the monitoring task.
  */
 esp_err_t sim4g_gps_init(void) {
+  esp_err_t err = power_manager_lock_create("sim4g", &s_power_lock);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "No power lock, modem I/O may be cut by light sleep");
+  }
+
+  // Before the modem: MQTT alerts still go out if it does not answer
+  err = start_alert_worker();
+  if (err != ESP_OK) {
+    return err;
+  }
+
   ESP_LOGI(TAG, "Initializing SIM4G AT module...");
-  esp_err_t err = sim4g_at_init();
+  err = sim4g_at_init();
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "SIM4G AT initialization failed: %s", esp_err_to_name(err));
     return err;
@@ -189,12 +347,20 @@ esp_err_t sim4g_gps_init(void) {
     return ESP_FAIL;
   }
 
-  xTaskCreate(mqtt_monitoring_task, "mqtt_mon_task", MQTT_TASK_STACK_SIZE, NULL,
-              MQTT_TASK_PRIORITY, NULL);
+  err = task_topology_create(TASK_TOPOLOGY_MQTT, mqtt_monitoring_task,
+                             MQTT_TASK_STACK_SIZE, NULL, NULL);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create mqtt_mon_task");
+    return err;
+  }
 
   return ESP_OK;
 }
 
+void sim4g_gps_set_alert_sent_cb(sim4g_alert_sent_cb_t cb) {
+  s_alert_sent_cb = cb;
+}
+
 void sim4g_gps_set_phone_number(const char *number) {
   if (number) {
     strncpy(s_phone_number, number, sizeof(s_phone_number) - 1);
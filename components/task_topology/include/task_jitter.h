@@ -0,0 +1,84 @@
+/**
+ * @file task_jitter.h
+ * @brief Wake-up period statistics of a periodic task.
+ *
+ * The task calls task_jitter_tick() each time it wakes up; every interval
+ * since the previous wake-up is compared with the nominal period. Callers
+ * restart the measurement across intended breaks (light sleep, rate
+ * changes) with task_jitter_set_period() so only scheduling delays are
+ * counted. The module has no FreeRTOS dependency.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _TASK_JITTER_H_
+#define _TASK_JITTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Interval statistics since the last reset.
+ */
+typedef struct {
+  uint32_t period_us;  ///< Nominal period
+  uint32_t intervals;  ///< Intervals measured
+  int32_t min_dev_us;  ///< Most negative deviation (early wake-up)
+  int32_t max_dev_us;  ///< Largest deviation (late wake-up)
+  uint64_t sum_sq_us2; ///< Sum of squared deviations
+} task_jitter_stats_t;
+
+/**
+ * @brief Jitter meter instance. Treat the fields as private.
+ */
+typedef struct {
+  task_jitter_stats_t stats;
+  bool started;     ///< last_us is valid
+  uint32_t last_us; ///< Previous wake-up
+} task_jitter_t;
+
+/**
+ * @brief Initializes a meter with empty statistics.
+ */
+void task_jitter_init(task_jitter_t *j, uint32_t period_us);
+
+/**
+ * @brief Changes the nominal period. The next tick starts a new interval;
+ * the statistics are kept.
+ */
+void task_jitter_set_period(task_jitter_t *j, uint32_t period_us);
+
+/**
+ * @brief Forgets the previous wake-up, e.g. after light sleep.
+ */
+void task_jitter_restart(task_jitter_t *j);
+
+/**
+ * @brief Clears the statistics and restarts the measurement.
+ */
+void task_jitter_reset(task_jitter_t *j);
+
+/**
+ * @brief Records a wake-up at @p now_us.
+ */
+void task_jitter_tick(task_jitter_t *j, uint32_t now_us);
+
+/**
+ * @brief Root mean square deviation in microseconds.
+ */
+uint32_t task_jitter_rms_us(const task_jitter_stats_t *stats);
+
+/**
+ * @brief Returns the statistics since init or the last reset.
+ */
+const task_jitter_stats_t *task_jitter_get_stats(const task_jitter_t *j);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _TASK_JITTER_H_
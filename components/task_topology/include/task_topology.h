@@ -0,0 +1,109 @@
+/**
+ * @file task_topology.h
+ * @brief Core and priority of every application task, in one table.
+ *
+ * Tasks fall into three domains, each pinned to a core from Kconfig:
+ *
+ *  - Sensing (fall_task, activity_task): APP_CPU by default, with the fall
+ *    task at the highest application priority.
+ *  - Network (alerts, MQTT, capture upload): PRO_CPU, next to the Wi-Fi and
+ *    lwIP tasks, where UART AT waits and socket work cannot delay sampling.
+ *  - Control (event handler and worker, alarms, LED, debug): PRO_CPU.
+ *
+ * Components create their tasks with task_topology_create(), or
+ * task_topology_create_static() for workers that must exist before they
+ * are needed, and keep only the stack size. Single-core builds place every
+ * task on core 0.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _TASK_TOPOLOGY_H_
+#define _TASK_TOPOLOGY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+
+/**
+ * @brief Application tasks.
+ */
+typedef enum {
+  TASK_TOPOLOGY_FALL,         ///< Sensor acquisition and fall detection
+  TASK_TOPOLOGY_ACTIVITY,     ///< Step and active-minute counting
+  TASK_TOPOLOGY_EVENT,        ///< System event dispatch
+  TASK_TOPOLOGY_EVENT_WORKER, ///< Event subscribers that may block
+  TASK_TOPOLOGY_ALERT,        ///< SMS and MQTT alert
+  TASK_TOPOLOGY_ALARM,        ///< Buzzer and LED after a fall or long lie
+  TASK_TOPOLOGY_MQTT,         ///< GPS polling and periodic MQTT status
+  TASK_TOPOLOGY_CAPTURE,      ///< Fall capture upload
+  TASK_TOPOLOGY_LED,          ///< LED indicator patterns
+  TASK_TOPOLOGY_DEBUGS,       ///< Periodic debug log
+  TASK_TOPOLOGY_SELF_TEST,    ///< Startup tests
+  TASK_TOPOLOGY_COUNT
+} task_topology_id_t;
+
+/**
+ * @brief Placement of one task.
+ */
+typedef struct {
+  const char *name;
+  UBaseType_t priority;
+  BaseType_t core;
+} task_topology_entry_t;
+
+/**
+ * @brief Returns the placement of a task.
+ */
+const task_topology_entry_t *task_topology_get(task_topology_id_t id);
+
+/**
+ * @brief Creates a task pinned to the core of its domain.
+ *
+ * @param id Task to create.
+ * @param fn Task function.
+ * @param stack_size Stack size in bytes.
+ * @param arg Argument passed to @p fn.
+ * @param[out] handle Handle of the new task, may be NULL.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown @p id,
+ * ESP_ERR_NO_MEM if the task could not be created.
+ */
+esp_err_t task_topology_create(task_topology_id_t id, TaskFunction_t fn,
+                               uint32_t stack_size, void *arg,
+                               TaskHandle_t *handle);
+
+/**
+ * @brief Creates a task pinned to the core of its domain, on caller-owned
+ * memory.
+ *
+ * @param id Task to create.
+ * @param fn Task function.
+ * @param stack_size Size of @p stack in bytes.
+ * @param arg Argument passed to @p fn.
+ * @param stack Stack of the task, usually a static array.
+ * @param tcb Task control block, usually static.
+ * @param[out] handle Handle of the new task, may be NULL.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown @p id or
+ * missing buffers.
+ */
+esp_err_t task_topology_create_static(task_topology_id_t id, TaskFunction_t fn,
+                                      uint32_t stack_size, void *arg,
+                                      StackType_t *stack, StaticTask_t *tcb,
+                                      TaskHandle_t *handle);
+
+/**
+ * @brief Logs the table, one task per line.
+ */
+void task_topology_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _TASK_TOPOLOGY_H_
@@ -0,0 +1,75 @@
+/**
+ * @file task_jitter.c
+ * @brief Wake-up period statistics of a periodic task.
+ */
+
+#include "task_jitter.h"
+#include <string.h>
+
+void task_jitter_init(task_jitter_t *j, uint32_t period_us) {
+  memset(j, 0, sizeof(*j));
+  j->stats.period_us = period_us;
+}
+
+void task_jitter_set_period(task_jitter_t *j, uint32_t period_us) {
+  j->stats.period_us = period_us;
+  j->started = false;
+}
+
+void task_jitter_restart(task_jitter_t *j) { j->started = false; }
+
+void task_jitter_reset(task_jitter_t *j) {
+  task_jitter_init(j, j->stats.period_us);
+}
+
+void task_jitter_tick(task_jitter_t *j, uint32_t now_us) {
+  if (!j->started) {
+    j->started = true;
+    j->last_us = now_us;
+    return;
+  }
+
+  int64_t dev = (int64_t)(uint32_t)(now_us - j->last_us) - j->stats.period_us;
+  j->last_us = now_us;
+  if (dev > INT32_MAX) {
+    dev = INT32_MAX;
+  }
+
+  task_jitter_stats_t *s = &j->stats;
+  if (s->intervals == 0 || dev < s->min_dev_us) {
+    s->min_dev_us = (int32_t)dev;
+  }
+  if (s->intervals == 0 || dev > s->max_dev_us) {
+    s->max_dev_us = (int32_t)dev;
+  }
+  s->sum_sq_us2 += (uint64_t)(dev * dev);
+  s->intervals++;
+}
+
+uint32_t task_jitter_rms_us(const task_jitter_stats_t *stats) {
+  if (stats->intervals == 0) {
+    return 0;
+  }
+  uint64_t mean_sq = stats->sum_sq_us2 / stats->intervals;
+
+  // Integer square root, one bit at a time
+  uint64_t root = 0;
+  uint64_t bit = 1ull << 62;
+  while (bit > mean_sq) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (mean_sq >= root + bit) {
+      mean_sq -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+const task_jitter_stats_t *task_jitter_get_stats(const task_jitter_t *j) {
+  return &j->stats;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file task_topology.c
+ * @brief Core and priority of every application task, in one table.
+ */
+
+#include "task_topology.h"
+#include "esp_log.h"
+
+static const char *TAG = "TASK_TOPOLOGY";
+
+#if CONFIG_FREERTOS_UNICORE
+#define SENSING_CORE 0
+#define NETWORK_CORE 0
+#define CONTROL_CORE 0
+#else
+#define SENSING_CORE CONFIG_TASK_TOPOLOGY_SENSING_CORE
+#define NETWORK_CORE CONFIG_TASK_TOPOLOGY_NETWORK_CORE
+#define CONTROL_CORE CONFIG_TASK_TOPOLOGY_CONTROL_CORE
+#endif
+
+// Names stay within CONFIG_FREERTOS_MAX_TASK_NAME_LEN - 1 characters:
+// FreeRTOS truncates longer ones and xTaskGetHandle() then misses them
+static const task_topology_entry_t s_table[TASK_TOPOLOGY_COUNT] = {
+    [TASK_TOPOLOGY_FALL] = {"fall_task", CONFIG_TASK_TOPOLOGY_FALL_PRIORITY,
+                            SENSING_CORE},
+    [TASK_TOPOLOGY_ACTIVITY] = {"activity_task",
+                                CONFIG_TASK_TOPOLOGY_ACTIVITY_PRIORITY,
+                                SENSING_CORE},
+    [TASK_TOPOLOGY_EVENT] = {"event_task", CONFIG_TASK_TOPOLOGY_EVENT_PRIORITY,
+                             CONTROL_CORE},
+    [TASK_TOPOLOGY_EVENT_WORKER] = {"event_worker",
+                                    CONFIG_TASK_TOPOLOGY_EVENT_WORKER_PRIORITY,
+                                    CONTROL_CORE},
+    [TASK_TOPOLOGY_ALERT] = {"fall_alert_task",
+                             CONFIG_TASK_TOPOLOGY_ALERT_PRIORITY, NETWORK_CORE},
+    [TASK_TOPOLOGY_ALARM] = {"alarm_task",
+                             CONFIG_TASK_TOPOLOGY_LOCAL_ALERT_PRIORITY,
+                             CONTROL_CORE},
+    [TASK_TOPOLOGY_MQTT] = {"mqtt_mon_task", CONFIG_TASK_TOPOLOGY_MQTT_PRIORITY,
+                            NETWORK_CORE},
+    [TASK_TOPOLOGY_CAPTURE] = {"capture_task",
+                               CONFIG_TASK_TOPOLOGY_CAPTURE_PRIORITY,
+                               NETWORK_CORE},
+    [TASK_TOPOLOGY_LED] = {"led_task", CONFIG_TASK_TOPOLOGY_LED_PRIORITY,
+                           CONTROL_CORE},
+    [TASK_TOPOLOGY_DEBUGS] = {"debugs_task",
+                              CONFIG_TASK_TOPOLOGY_DEBUGS_PRIORITY,
+                              CONTROL_CORE},
+    // Load the modem like the periodic MQTT task does
+    [TASK_TOPOLOGY_SELF_TEST] = {"self_test",
+                                 CONFIG_TASK_TOPOLOGY_MQTT_PRIORITY,
+                                 NETWORK_CORE},
+};
+
+const task_topology_entry_t *task_topology_get(task_topology_id_t id) {
+  if ((unsigned)id >= TASK_TOPOLOGY_COUNT) {
+    return NULL;
+  }
+  return &s_table[id];
+}
+
+esp_err_t task_topology_create(task_topology_id_t id, TaskFunction_t fn,
+                               uint32_t stack_size, void *arg,
+                               TaskHandle_t *handle) {
+  const task_topology_entry_t *entry = task_topology_get(id);
+  if (entry == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  BaseType_t result =
+      xTaskCreatePinnedToCore(fn, entry->name, stack_size, arg,
+                              entry->priority, handle, entry->core);
+  if (result != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create %s", entry->name);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t task_topology_create_static(task_topology_id_t id, TaskFunction_t fn,
+                                      uint32_t stack_size, void *arg,
+                                      StackType_t *stack, StaticTask_t *tcb,
+                                      TaskHandle_t *handle) {
+  const task_topology_entry_t *entry = task_topology_get(id);
+  if (entry == NULL || stack == NULL || tcb == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  TaskHandle_t task =
+      xTaskCreateStaticPinnedToCore(fn, entry->name, stack_size, arg,
+                                    entry->priority, stack, tcb, entry->core);
+  if (task == NULL) {
+    ESP_LOGE(TAG, "Failed to create %s", entry->name);
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (handle != NULL) {
+    *handle = task;
+  }
+  return ESP_OK;
+}
+
+void task_topology_log(void) {
+  for (int i = 0; i < TASK_TOPOLOGY_COUNT; i++) {
+    ESP_LOGI(TAG, "%-15s core %d, priority %u", s_table[i].name,
+             (int)s_table[i].core, (unsigned)s_table[i].priority);
+  }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file alert_heap_test.c
+ * @brief Startup test that the fall alert path runs without the heap.
+ */
+#include "alert_heap_test.h"
+
+#if CONFIG_DEBUGS_ALERT_HEAP_TEST
+
+#include "debugs.h"
+#include "esp_log.h"
+#include "event_handler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "task_topology.h"
+
+static const char *TAG = "ALERT_HEAP_TEST";
+
+#define WAIT_MS (CONFIG_DEBUGS_ALERT_HEAP_TEST_WAIT_S * 1000)
+#define SETTLE_MS 5000
+#define TEST_TASK_STACK_SIZE 3072
+
+// Tasks on the alert path, watched while the fall is handled
+static const task_topology_id_t s_watched[] = {
+    TASK_TOPOLOGY_EVENT,
+    TASK_TOPOLOGY_ALERT,
+    TASK_TOPOLOGY_ALARM,
+};
+
+#define WATCHED_COUNT (sizeof(s_watched) / sizeof(s_watched[0]))
+
+static void alert_heap_test_task(void *param) {
+  vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+
+  TaskHandle_t tasks[WATCHED_COUNT];
+  for (size_t i = 0; i < WATCHED_COUNT; i++) {
+    const char *name = task_topology_get(s_watched[i])->name;
+    tasks[i] = xTaskGetHandle(name);
+    if (tasks[i] == NULL) {
+      ESP_LOGE(TAG, "FAIL: %s is not running", name);
+      vTaskDelete(NULL);
+    }
+  }
+
+  esp_err_t err = debugs_heap_watch_start(tasks, WATCHED_COUNT);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "FAIL: heap watch not started: %s", esp_err_to_name(err));
+    vTaskDelete(NULL);
+  }
+
+  ESP_LOGW(TAG, "Injecting a fall, a real alert will be sent");
+  event_handler_send_event(EVENT_FALL_DETECTED);
+  vTaskDelay(pdMS_TO_TICKS(WAIT_MS));
+
+  debugs_heap_watch_stats_t stats;
+  debugs_heap_watch_stop(&stats);
+
+  if (stats.allocs == 0 && stats.frees == 0) {
+    ESP_LOGI(TAG, "PASS: no heap use on the alert path (%lu exempt)",
+             (unsigned long)stats.exempt);
+  } else {
+    ESP_LOGE(TAG, "FAIL: %lu allocations and %lu frees on the alert path "
+                  "(%lu exempt)",
+             (unsigned long)stats.allocs, (unsigned long)stats.frees,
+             (unsigned long)stats.exempt);
+  }
+  vTaskDelete(NULL);
+}
+
+esp_err_t alert_heap_test_start(void) {
+  return task_topology_create(TASK_TOPOLOGY_SELF_TEST, alert_heap_test_task,
+                              TEST_TASK_STACK_SIZE, NULL, NULL);
+}
+
+#endif // CONFIG_DEBUGS_ALERT_HEAP_TEST
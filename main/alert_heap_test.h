@@ -0,0 +1,45 @@
+/**
+ * @file alert_heap_test.h
+ * @brief Startup test that the fall alert path runs without the heap.
+ *
+ * With CONFIG_DEBUGS_ALERT_HEAP_TEST enabled, a task injects one
+ * EVENT_FALL_DETECTED and counts, for CONFIG_DEBUGS_ALERT_HEAP_TEST_WAIT_S
+ * seconds, every allocation and free made by the event handler, alert and
+ * alarm tasks. The test passes when there are none outside the calls
+ * marked with debugs_heap_watch_exempt(). The injected fall sends a real
+ * alert.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef ALERT_HEAP_TEST_H_
+#define ALERT_HEAP_TEST_H_
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_DEBUGS_ALERT_HEAP_TEST
+
+/**
+ * @brief Starts the test task. Call after the event handler has started.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be
+ * created.
+ */
+esp_err_t alert_heap_test_start(void);
+
+#else
+
+#define alert_heap_test_start() (ESP_OK)
+
+#endif // CONFIG_DEBUGS_ALERT_HEAP_TEST
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALERT_HEAP_TEST_H_
@@ -8,16 +8,26 @@
  */
 #include "app_main.h"
 #include "esp_log.h"
+#include "activity.h"
+#include "alert_heap_test.h"
+#include "alert_trace.h"
 #include "buzzer.h"
 #include "comm.h"
 #include "data_manager.h"
+#include "esp_event.h"
+#include "esp_netif.h"
 #include "event_handler.h"
 #include "fall_logic.h"
+#include "jitter_test.h"
 #include "led_indicator.h"
+#include "nvs_flash.h"
+#include "power_manager.h"
 #include "sdkconfig.h"
 #include "sim4g_gps.h"
+#include "task_topology.h"
 #include "wifi_connect.h"
 #include "user_mqtt.h"
+#include "mqtt_client.h"
 
 static const char *TAG = "APP_MAIN";
 
@@ -31,6 +41,56 @@ static bool application_started = false;
 // Local Functions
 // ─────────────────────────────────────────────────────────────────────────────
 
+/**
+ * @brief Reports a Wi-Fi connection to the event handler.
+ */
+static void send_wifi_connected(uint32_t ip4_addr) {
+  system_event_msg_t event = {
+      .type = EVENT_WIFI_CONNECTED,
+      .data.connection =
+          {
+              .ip4_addr = ip4_addr,
+              .rssi = (int8_t)wifi_get_rssi(),
+          },
+  };
+  event_handler_send_msg(&event);
+}
+
+static void on_got_ip(void *arg, esp_event_base_t base, int32_t id,
+                      void *data) {
+  const ip_event_got_ip_t *event = data;
+  send_wifi_connected(event->ip_info.ip.addr);
+}
+
+static void on_mqtt_connected(void *arg, esp_event_base_t base, int32_t id,
+                              void *data) {
+  const esp_mqtt_event_t *mqtt = data;
+  system_event_msg_t event = {
+      .type = EVENT_MQTT_CONNECTED,
+      .data.connection.session_present = mqtt->session_present != 0,
+  };
+  event_handler_send_msg(&event);
+}
+
+/**
+ * @brief Forwards Wi-Fi and MQTT (re)connections to the event handler.
+ *
+ * Call once both are initialized. The first Wi-Fi connection happened in
+ * wifi_connect_sta(), so it is reported here.
+ */
+static void forward_connection_events(void) {
+  esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, on_got_ip, NULL);
+  if (wifi_is_connected()) {
+    esp_netif_ip_info_t ip_info = {0};
+    esp_netif_get_ip_info(esp_netif_get_handle_from_ifkey("WIFI_STA_DEF"),
+                          &ip_info);
+    send_wifi_connected(ip_info.ip.addr);
+  }
+
+  esp_mqtt_client_register_event(user_mqtt_get_client(), MQTT_EVENT_CONNECTED,
+                                 on_mqtt_connected, NULL);
+}
+
 /**
  * @brief Initializes all system components and drivers.
  * @return ESP_OK on success, ESP_FAIL on failure.
@@ -38,6 +98,25 @@ static bool application_started = false;
 static esp_err_t init_components(void) {
     esp_err_t ret;
 
+    // 0. NVS - Lưu hiệu chuẩn cảm biến và cấu hình Wi-Fi
+    ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
+        ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize NVS");
+        return ret;
+    }
+    ESP_LOGI(TAG, "NVS initialized");
+
+    // Power manager - Bật light sleep tự động trước khi tạo các task
+    ret = power_manager_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Power manager init failed, staying at full power");
+    }
+
     // 1. Data Manager - Cần phải chạy để các module khác ghi log
     ret = data_manager_init();
     if (ret != ESP_OK) {
@@ -76,6 +155,14 @@ static esp_err_t init_components(void) {
         return ret; // Lỗi nghiêm trọng
     }
     ESP_LOGI(TAG, "Fall Logic initialized");
+
+    // Activity metrics read the same samples as the fall logic
+    ret = activity_init(fall_logic_get_sample_ring());
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Activity metrics unavailable: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "Activity metrics initialized");
+    }
     
     // 6. WiFi và MQTT - Có thể bị lỗi nhưng hệ thống vẫn chạy
     ret = wifi_connect_sta(0);
@@ -95,6 +182,9 @@ static esp_err_t init_components(void) {
         return ret;
     }
     ESP_LOGI(TAG, "MQTT initialized");
+    forward_connection_events();
+    // Before the first alert: traces are published on this client
+    alert_trace_init();
     
     // 7. SIM4G và GPS - Không quan trọng bằng WiFi/MQTT
     ret = sim4g_gps_init();
@@ -171,6 +261,19 @@ esp_err_t app_start_application(void) {
     return ret;
   }
 
+  // Activity metrics are not critical, the device works without them
+  if (activity_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to start activity metrics");
+  }
+
+  task_topology_log();
+  if (jitter_test_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to start the jitter test");
+  }
+  if (alert_heap_test_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to start the alert heap test");
+  }
+
   application_started = true;
   ESP_LOGI(TAG, "Application started successfully");
   return ESP_OK;
@@ -0,0 +1,89 @@
+/**
+ * @file jitter_test.c
+ * @brief Startup test of the sampling period under modem load.
+ */
+#include "jitter_test.h"
+
+#if CONFIG_TASK_TOPOLOGY_JITTER_TEST
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "fall_logic.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sim4g_gps.h"
+#include "task_topology.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+static const char *TAG = "JITTER_TEST";
+
+#define PHASE_US ((int64_t)CONFIG_TASK_TOPOLOGY_JITTER_TEST_S * 1000000LL)
+#define MAX_DEV_US CONFIG_TASK_TOPOLOGY_JITTER_MAX_US
+#define SETTLE_MS 2000
+#define TEST_TASK_STACK_SIZE 4096
+
+/**
+ * @brief Measures the fall task's period for one phase.
+ *
+ * @param name Phase name for the log.
+ * @param load_modem Query the modem back to back during the phase.
+ * @return true if the phase stayed within MAX_DEV_US without lost samples.
+ */
+static bool run_phase(const char *name, bool load_modem) {
+  uint32_t missed = fall_logic_get_missed_samples();
+  uint32_t queries = 0;
+  fall_logic_reset_jitter_stats();
+
+  int64_t end_us = esp_timer_get_time() + PHASE_US;
+  while (esp_timer_get_time() < end_us) {
+    if (load_modem) {
+      sim4g_gps_update_location();
+      queries++;
+    }
+    // Let the idle task run so the task watchdog stays quiet
+    vTaskDelay(load_modem ? 1 : pdMS_TO_TICKS(100));
+  }
+
+  task_jitter_stats_t stats;
+  fall_logic_get_jitter_stats(&stats);
+  missed = fall_logic_get_missed_samples() - missed;
+
+  int32_t worst = abs(stats.min_dev_us) > abs(stats.max_dev_us)
+                      ? abs(stats.min_dev_us)
+                      : abs(stats.max_dev_us);
+  bool pass = stats.intervals > 0 && worst <= MAX_DEV_US && missed == 0;
+  ESP_LOGI(TAG,
+           "%s: %lu periods of %lu us, deviation %ld..%ld us, rms %lu us, "
+           "%lu samples lost, %lu modem queries",
+           name, (unsigned long)stats.intervals,
+           (unsigned long)stats.period_us, (long)stats.min_dev_us,
+           (long)stats.max_dev_us,
+           (unsigned long)task_jitter_rms_us(&stats), (unsigned long)missed,
+           (unsigned long)queries);
+  return pass;
+}
+
+static void jitter_test_task(void *param) {
+  vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+
+  bool idle_pass = run_phase("Modem idle", false);
+  bool busy_pass = run_phase("Modem busy", true);
+
+  if (busy_pass) {
+    ESP_LOGI(TAG, "PASS: sampling period within %d us while the modem is "
+                  "busy", MAX_DEV_US);
+  } else {
+    ESP_LOGE(TAG, "FAIL: sampling period off by more than %d us or samples "
+                  "lost while the modem is busy%s",
+             MAX_DEV_US, idle_pass ? "" : " (and while idle)");
+  }
+  vTaskDelete(NULL);
+}
+
+esp_err_t jitter_test_start(void) {
+  return task_topology_create(TASK_TOPOLOGY_SELF_TEST, jitter_test_task,
+                              TEST_TASK_STACK_SIZE, NULL, NULL);
+}
+
+#endif // CONFIG_TASK_TOPOLOGY_JITTER_TEST
@@ -0,0 +1,46 @@
+/**
+ * @file jitter_test.h
+ * @brief Startup test of the sampling period under modem load.
+ *
+ * With CONFIG_TASK_TOPOLOGY_JITTER_TEST enabled, a task on the network
+ * core measures the fall task's wake-up period for
+ * CONFIG_TASK_TOPOLOGY_JITTER_TEST_S seconds with the modem idle, then as
+ * long again while it queries the modem back to back, and logs the result
+ * of each phase. The test passes when no period of the loaded phase
+ * deviates by more than CONFIG_TASK_TOPOLOGY_JITTER_MAX_US and no sample
+ * was lost.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef JITTER_TEST_H_
+#define JITTER_TEST_H_
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_TASK_TOPOLOGY_JITTER_TEST
+
+/**
+ * @brief Starts the test task. Call after the fall task has started.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be
+ * created.
+ */
+esp_err_t jitter_test_start(void);
+
+#else
+
+#define jitter_test_start() (ESP_OK)
+
+#endif // CONFIG_TASK_TOPOLOGY_JITTER_TEST
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JITTER_TEST_H_
@@ -0,0 +1,253 @@
+/**
+ * @file acq_check.c
+ * @brief Data-ready acquisition against a fake sensor, on a virtual clock.
+ *
+ * The fake MPU6050 latches sample k into its data registers at k periods
+ * and, like the ISR, gives the task notification each time. The fake task
+ * wakes a seeded random latency after the first notification it has not
+ * taken yet, takes them all, and runs the step fall_task() runs:
+ * fall_acq_data_ready() with the notification count and a register read
+ * that returns the newest latched sample, then the sample ring through the
+ * fall pipeline. Every few wake-ups the task can be held off for whole
+ * periods, as a higher-priority task would, so the sensor overwrites
+ * samples before they are read.
+ *
+ * Every sample carries its sequence number in its timestamp, so the check
+ * counts the samples actually lost or read twice and requires the missed
+ * samples fall_acq reports to match them exactly. Time is simulated, so
+ * the outcome depends only on the options and the seed. Exit status 1 on
+ * any mismatch.
+ */
+
+#include "fall_acq.h"
+#include "fall_pipeline.h"
+#include "sample_ring.h"
+#include "sdkconfig.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SAMPLE_RING_SIZE CONFIG_FALL_LOGIC_SAMPLE_RING_SIZE
+
+static uint32_t s_period_us;
+static uint32_t s_samples;
+static uint64_t s_now_us; ///< Virtual time at which the task reads
+static uint64_t s_rng = 0x9e3779b97f4a7c15ull;
+
+static sensor_raw_t s_ring_storage[SAMPLE_RING_SIZE];
+static sample_ring_t s_ring;
+static sample_ring_reader_t s_reader;
+static fall_pipeline_t s_pipeline;
+
+static uint32_t rand_below(uint32_t n) {
+  // xorshift64
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 7;
+  s_rng ^= s_rng << 17;
+  return n ? (uint32_t)(s_rng % n) : 0;
+}
+
+/**
+ * @brief Still sensor lying flat, with a little noise so the feature
+ * window sees varying input.
+ */
+static void make_sample(uint32_t seq, sensor_raw_t *sample) {
+  sample->timestamp_us = seq * s_period_us;
+  sample->accel_x = (int16_t)((seq * 7) % 41 - 20);
+  sample->accel_y = (int16_t)((seq * 13) % 41 - 20);
+  sample->accel_z = (int16_t)(MPU6050_ACCEL_LSB_PER_G + (seq * 3) % 21 - 10);
+  sample->gyro_x = (int16_t)((seq * 5) % 9 - 4);
+  sample->gyro_y = (int16_t)((seq * 11) % 9 - 4);
+  sample->gyro_z = 0;
+}
+
+/**
+ * @brief Number of samples latched up to virtual time @p t_us.
+ */
+static uint32_t latched_at(uint64_t t_us) {
+  uint64_t n = t_us / s_period_us + 1;
+  return n < s_samples ? (uint32_t)n : s_samples;
+}
+
+/**
+ * @brief mpu6050_read_raw() stand-in: the data registers hold the newest
+ * latched sample.
+ */
+static esp_err_t fake_read_raw(sensor_raw_t *raw) {
+  make_sample(latched_at(s_now_us) - 1, raw);
+  return ESP_OK;
+}
+
+typedef struct {
+  uint32_t stalls;     ///< Wake-ups held off by whole periods
+  uint32_t lost;       ///< Sequence numbers never read
+  uint32_t duplicates; ///< Samples read more than once
+  uint32_t processed;  ///< Frames the pipeline consumed from the ring
+  uint32_t falls;
+  uint32_t max_wake_us;
+} acq_check_stats_t;
+
+/**
+ * @brief Runs the ring through the pipeline like fall_task() and checks
+ * the sequence of the frames it sees.
+ */
+static void drain_ring(acq_check_stats_t *st, uint32_t *expected) {
+  const sensor_raw_t *frames;
+  size_t count;
+  while ((count = sample_ring_peek(&s_reader, &frames)) > 0) {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t seq = frames[i].timestamp_us / s_period_us;
+      if (seq < *expected) {
+        st->duplicates++;
+      } else {
+        st->lost += seq - *expected;
+        *expected = seq + 1;
+      }
+    }
+    size_t done = 0;
+    while (done < count) {
+      size_t fall =
+          fall_pipeline_process(&s_pipeline, frames + done, count - done);
+      if (fall < count - done) {
+        st->falls++;
+        done += fall + 1;
+      } else {
+        done = count;
+      }
+    }
+    if (sample_ring_consume(&s_reader, count)) {
+      st->processed += (uint32_t)count;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  static const struct option options[] = {
+      {"rate", required_argument, NULL, 'r'},
+      {"seconds", required_argument, NULL, 's'},
+      {"jitter-us", required_argument, NULL, 'j'},
+      {"stall-every", required_argument, NULL, 'e'},
+      {"stall-periods", required_argument, NULL, 'p'},
+      {"seed", required_argument, NULL, 'S'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  uint32_t rate_hz = 500;
+  double seconds = 60.0;
+  long jitter_us = -1;
+  uint32_t stall_every = 0;
+  uint32_t stall_periods = 3;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "r:s:j:e:p:S:h", options, NULL)) !=
+         -1) {
+    switch (opt) {
+    case 'r':
+      rate_hz = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    case 's':
+      seconds = atof(optarg);
+      break;
+    case 'j':
+      jitter_us = strtol(optarg, NULL, 10);
+      break;
+    case 'e':
+      stall_every = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      stall_periods = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    case 'S':
+      s_rng = strtoull(optarg, NULL, 0) | 1;
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [options]\n"
+              "  -r, --rate HZ           output data rate (default 500)\n"
+              "  -s, --seconds S         simulated time (default 60)\n"
+              "  -j, --jitter-us US      max wake-up latency (default: "
+              "period - 1)\n"
+              "  -e, --stall-every N     hold the task off every N "
+              "wake-ups (default 0, never)\n"
+              "  -p, --stall-periods K   periods per hold-off (default 3)\n"
+              "      --seed S            latency generator seed\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (rate_hz == 0 || rate_hz > 1000 || seconds <= 0.0) {
+    fprintf(stderr, "rate must be 1-1000 Hz and the run time positive\n");
+    return 2;
+  }
+  s_period_us = 1000000u / rate_hz;
+  s_samples = (uint32_t)(seconds * rate_hz);
+  if (jitter_us < 0) {
+    jitter_us = s_period_us - 1;
+  }
+
+  sample_ring_init(&s_ring, s_ring_storage, SAMPLE_RING_SIZE);
+  sample_ring_reader_init(&s_reader, &s_ring, "acq_check");
+
+  fall_detector_config_t config = FALL_DETECTOR_DEFAULT_CONFIG();
+  config.accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G;
+  config.gyro_lsb_per_dps = MPU6050_GYRO_LSB_PER_DPS;
+  uint32_t window = CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS * rate_hz / 1000;
+  if (window > FALL_FEATURES_MAX_WINDOW) {
+    window = FALL_FEATURES_MAX_WINDOW;
+  }
+  fall_pipeline_init(&s_pipeline, window, &config);
+
+  fall_acq_stats_t acq = {0};
+  acq_check_stats_t st = {0};
+  uint32_t taken = 0;    // Notifications given and taken so far
+  uint32_t expected = 0; // Next sequence number the pipeline should see
+  while (taken < s_samples) {
+    // Blocked in ulTaskNotifyTake() until the next latch gives it
+    uint64_t given_us = (uint64_t)taken * s_period_us;
+    if (s_now_us < given_us) {
+      s_now_us = given_us;
+    }
+    uint32_t wake_us = rand_below((uint32_t)jitter_us + 1);
+    if (stall_every && (acq.wakeups + 1) % stall_every == 0) {
+      wake_us += stall_periods * s_period_us;
+      st.stalls++;
+    }
+    if (wake_us > st.max_wake_us) {
+      st.max_wake_us = wake_us;
+    }
+    s_now_us += wake_us;
+
+    uint32_t latched = latched_at(s_now_us);
+    uint32_t pending = latched - taken;
+    taken = latched;
+    fall_acq_data_ready(&acq, pending, fake_read_raw, &s_ring);
+    drain_ring(&st, &expected);
+  }
+  st.lost += s_samples - expected;
+
+  printf("data-ready at %u Hz for %.1f s: %u samples\n", rate_hz, seconds,
+         s_samples);
+  printf("wake-ups %u, timeouts %u, stalls %u, max wake latency %u us\n",
+         acq.wakeups, acq.timeouts, st.stalls, st.max_wake_us);
+  printf("read %u, missed %u, lost %u, duplicates %u\n", acq.pushed,
+         acq.missed, st.lost, st.duplicates);
+  printf("pipeline %u frames, ring overruns %u, falls %u\n", st.processed,
+         s_reader.overrun_frames, st.falls);
+
+  int status = 0;
+  if (acq.missed != st.lost) {
+    fprintf(stderr, "FAIL: %u samples missed but %u lost\n", acq.missed,
+            st.lost);
+    status = 1;
+  }
+  if (jitter_us < (long)s_period_us && st.stalls == 0 && st.lost != 0) {
+    fprintf(stderr, "FAIL: samples lost with every wake-up in time\n");
+    status = 1;
+  }
+  if (st.duplicates != 0 || s_reader.overrun_frames != 0 ||
+      st.processed != acq.pushed) {
+    fprintf(stderr, "FAIL: samples dropped between sensor and pipeline\n");
+    status = 1;
+  }
+  return status;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file classifier_check.c
+ * @brief Checks the firmware classifier against the training script.
+ *
+ * Reads the reference file written by train_classifier.py --reference
+ * (model inputs and expected score per row), runs fall_classifier_score()
+ * as compiled into the firmware and requires every score to match
+ * exactly. Also reports the host cost per inference. Exit status 1 on any
+ * mismatch, 2 on usage or load errors.
+ */
+
+#include "fall_classifier.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LINE 1024
+
+typedef struct {
+  int32_t inputs[FALL_CLASSIFIER_INPUTS];
+  int32_t score;
+} reference_row_t;
+
+/**
+ * @brief Checks that the reference columns match the firmware inputs.
+ */
+static int check_header(char *line) {
+  char *save = NULL;
+  char *name = strtok_r(line, ",\r\n", &save);
+  for (int i = 0; i < FALL_CLASSIFIER_INPUTS; i++) {
+    if (name == NULL || strcmp(name, fall_classifier_input_names[i]) != 0) {
+      fprintf(stderr, "input %d is %s, firmware expects %s\n", i,
+              name ? name : "(missing)", fall_classifier_input_names[i]);
+      return -1;
+    }
+    name = strtok_r(NULL, ",\r\n", &save);
+  }
+  return 0;
+}
+
+static int parse_row(const char *line, reference_row_t *row) {
+  const char *p = line;
+  char *end;
+  for (int i = 0; i <= FALL_CLASSIFIER_INPUTS; i++) {
+    long value = strtol(p, &end, 10);
+    if (end == p) {
+      return -1;
+    }
+    if (i < FALL_CLASSIFIER_INPUTS) {
+      row->inputs[i] = (int32_t)value;
+    } else {
+      row->score = (int32_t)value;
+    }
+    p = *end == ',' ? end + 1 : end;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <reference.csv>\n", argv[0]);
+    return 2;
+  }
+  FILE *in = fopen(argv[1], "r");
+  if (in == NULL) {
+    perror(argv[1]);
+    return 2;
+  }
+
+  char line[MAX_LINE];
+  if (fgets(line, sizeof(line), in) == NULL || check_header(line) != 0) {
+    fclose(in);
+    return 2;
+  }
+
+  size_t count = 0, capacity = 0;
+  reference_row_t *rows = NULL;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 256;
+      reference_row_t *grown = realloc(rows, capacity * sizeof(*grown));
+      if (grown == NULL) {
+        free(rows);
+        fclose(in);
+        return 2;
+      }
+      rows = grown;
+    }
+    if (parse_row(line, &rows[count]) != 0) {
+      fprintf(stderr, "%s: malformed row %zu\n", argv[1], count + 1);
+      free(rows);
+      fclose(in);
+      return 2;
+    }
+    count++;
+  }
+  fclose(in);
+  if (count == 0) {
+    fprintf(stderr, "%s: no rows\n", argv[1]);
+    free(rows);
+    return 2;
+  }
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < count; i++) {
+    int32_t score = fall_classifier_score(rows[i].inputs);
+    if (score != rows[i].score) {
+      if (mismatches < 10) {
+        fprintf(stderr, "row %zu: firmware %" PRId32 ", reference %" PRId32
+                        "\n",
+                i + 1, score, rows[i].score);
+      }
+      mismatches++;
+    }
+  }
+
+  // Cost per inference, cycling over the reference rows
+  const size_t runs = 2000000;
+  int64_t sink = 0;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = 0; i < runs; i++) {
+    sink += fall_classifier_score(rows[i % count].inputs);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double ns = ((end.tv_sec - start.tv_sec) * 1e9 +
+               (end.tv_nsec - start.tv_nsec)) /
+              (double)runs;
+
+  printf("%zu rows, %zu mismatches, %.1f ns per inference (checksum %" PRId64
+         ")\n",
+         count, mismatches, ns, sink);
+  free(rows);
+  return mismatches ? 1 : 0;
+}
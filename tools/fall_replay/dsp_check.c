@@ -0,0 +1,294 @@
+/**
+ * @file dsp_check.c
+ * @brief fall_dsp kernels against naive references, and their cost.
+ *
+ * Each kernel is compared with a straightforward 64-bit or reverse-scan
+ * reference on random data and on the int16 extremes; the square root is
+ * checked over every input below 2^20 and around every perfect square.
+ * The benchmark then times the batch threshold test (squared magnitude
+ * and a squared limit) against the per-sample float sqrtf it replaced.
+ *
+ * Exit status 1 on any disagreement.
+ */
+
+#include "fall_dsp.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#define CHUNK 32
+#define CHECK_FRAMES 100000
+
+static uint32_t s_seed = 12345;
+
+static uint32_t next_random(void) {
+  s_seed ^= s_seed << 13;
+  s_seed ^= s_seed >> 17;
+  s_seed ^= s_seed << 5;
+  return s_seed;
+}
+
+static int16_t random_axis(void) {
+  // One in eight values is an extreme, the rest spread over the range
+  switch (next_random() % 8) {
+  case 0:
+    return next_random() & 1 ? INT16_MIN : INT16_MAX;
+  default:
+    return (int16_t)next_random();
+  }
+}
+
+static uint32_t check_mag_sq(void) {
+  static sensor_raw_t frames[CHECK_FRAMES];
+  static uint32_t out[CHECK_FRAMES];
+  for (size_t i = 0; i < CHECK_FRAMES; i++) {
+    frames[i].accel_x = random_axis();
+    frames[i].accel_y = random_axis();
+    frames[i].accel_z = random_axis();
+  }
+  frames[0].accel_x = frames[0].accel_y = frames[0].accel_z = INT16_MIN;
+  fall_dsp_mag_sq_s16(frames, CHECK_FRAMES, out);
+
+  uint32_t errors = 0;
+  for (size_t i = 0; i < CHECK_FRAMES; i++) {
+    int64_t x = frames[i].accel_x, y = frames[i].accel_y,
+            z = frames[i].accel_z;
+    uint64_t want = (uint64_t)(x * x + y * y + z * z);
+    if (want > UINT32_MAX || out[i] != want) {
+      if (errors++ < 5) {
+        fprintf(stderr, "FAIL: mag_sq(%d, %d, %d) = %u, want %llu\n",
+                frames[i].accel_x, frames[i].accel_y, frames[i].accel_z,
+                out[i], (unsigned long long)want);
+      }
+    }
+  }
+  return errors;
+}
+
+/**
+ * @brief First index matching, found by scanning backwards.
+ */
+static size_t ref_find(const uint32_t *values, size_t n, uint32_t threshold,
+                       bool above) {
+  size_t first = n;
+  for (size_t i = n; i-- > 0;) {
+    if (above ? values[i] > threshold : values[i] < threshold) {
+      first = i;
+    }
+  }
+  return first;
+}
+
+static uint32_t check_find(void) {
+  uint32_t values[64];
+  uint32_t errors = 0;
+  for (int round = 0; round < 100000; round++) {
+    size_t n = next_random() % 65;
+    // Narrow ranges so matches land anywhere, including nowhere
+    uint32_t span = 1u << (next_random() % 32);
+    uint32_t base = next_random();
+    for (size_t i = 0; i < n; i++) {
+      values[i] = base + next_random() % span;
+    }
+    uint32_t threshold;
+    switch (round % 4) {
+    case 0:
+      threshold = 0;
+      break;
+    case 1:
+      threshold = UINT32_MAX;
+      break;
+    default:
+      threshold = n > 0 ? values[next_random() % n] : next_random();
+      break;
+    }
+
+    size_t below = fall_dsp_find_below_u32(values, n, threshold);
+    size_t above = fall_dsp_find_above_u32(values, n, threshold);
+    size_t want_below = ref_find(values, n, threshold, false);
+    size_t want_above = ref_find(values, n, threshold, true);
+    if (below != want_below || above != want_above) {
+      if (errors++ < 5) {
+        fprintf(stderr, "FAIL: find n=%zu t=%u: below %zu/%zu above "
+                "%zu/%zu\n", n, threshold, below, want_below, above,
+                want_above);
+      }
+    }
+  }
+  return errors;
+}
+
+static bool isqrt_ok(uint32_t x) {
+  uint64_t r = fall_dsp_isqrt_u32(x);
+  return r * r <= x && (r + 1) * (r + 1) > x;
+}
+
+static uint32_t check_isqrt(void) {
+  uint32_t errors = 0;
+  for (uint32_t x = 0; x < (1u << 20); x++) {
+    if (!isqrt_ok(x) && errors++ < 5) {
+      fprintf(stderr, "FAIL: isqrt(%u) = %u\n", x, fall_dsp_isqrt_u32(x));
+    }
+  }
+  for (uint32_t k = 1; k <= 65535; k++) {
+    uint32_t sq = k * k;
+    uint32_t around[3] = {sq - 1, sq, sq + 1};
+    for (int i = 0; i < 3; i++) {
+      if (!isqrt_ok(around[i]) && errors++ < 5) {
+        fprintf(stderr, "FAIL: isqrt(%u) = %u\n", around[i],
+                fall_dsp_isqrt_u32(around[i]));
+      }
+    }
+  }
+  if (!isqrt_ok(UINT32_MAX) && errors++ < 5) {
+    fprintf(stderr, "FAIL: isqrt(UINT32_MAX) = %u\n",
+            fall_dsp_isqrt_u32(UINT32_MAX));
+  }
+  return errors;
+}
+
+typedef struct {
+  double ns;
+  double ticks;
+} cost_t;
+
+static uint64_t ticks_now(void) {
+#if HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Threshold test as the pipeline does it: one squared-magnitude
+ * kernel call per chunk, then a search against the squared limit.
+ */
+static size_t batch_hits(const sensor_raw_t *frames, size_t n,
+                         uint32_t limit_sq) {
+  uint32_t mag_sq[CHUNK];
+  size_t hits = 0;
+  for (size_t done = 0; done < n; done += CHUNK) {
+    size_t len = n - done < CHUNK ? n - done : CHUNK;
+    fall_dsp_mag_sq_s16(frames + done, len, mag_sq);
+    size_t at = 0;
+    while ((at += fall_dsp_find_below_u32(mag_sq + at, len - at, limit_sq)) <
+           len) {
+      hits++;
+      at++;
+    }
+  }
+  return hits;
+}
+
+/**
+ * @brief The per-sample version it replaced: scale to g, sqrtf, compare.
+ */
+static size_t float_hits(const sensor_raw_t *frames, size_t n,
+                         float lsb_per_g, float limit_g) {
+  size_t hits = 0;
+  for (size_t i = 0; i < n; i++) {
+    float x = frames[i].accel_x / lsb_per_g;
+    float y = frames[i].accel_y / lsb_per_g;
+    float z = frames[i].accel_z / lsb_per_g;
+    if (sqrtf(x * x + y * y + z * z) < limit_g) {
+      hits++;
+    }
+  }
+  return hits;
+}
+
+int main(int argc, char **argv) {
+  static const struct option options[] = {
+      {"samples", required_argument, NULL, 'n'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  size_t samples = 20000000;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "n:h", options, NULL)) != -1) {
+    switch (opt) {
+    case 'n':
+      samples = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-n samples]\n"
+              "  -n, --samples N   samples timed (default 20000000)\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  uint32_t mag_errors = check_mag_sq();
+  uint32_t find_errors = check_find();
+  uint32_t isqrt_errors = check_isqrt();
+  printf("mag_sq_s16: %u errors\nfind_below/above_u32: %u errors\n"
+         "isqrt_u32: %u errors\n",
+         mag_errors, find_errors, isqrt_errors);
+  int status = mag_errors + find_errors + isqrt_errors != 0;
+
+  if (samples > 0) {
+    // Half a second at 500 Hz of a still sensor, reused for every pass
+    enum { BENCH_FRAMES = 256 };
+    static sensor_raw_t frames[BENCH_FRAMES];
+    const float lsb_per_g = MPU6050_ACCEL_LSB_PER_G;
+    for (size_t i = 0; i < BENCH_FRAMES; i++) {
+      frames[i].accel_x = (int16_t)(next_random() % 401 - 200);
+      frames[i].accel_y = (int16_t)(next_random() % 401 - 200);
+      frames[i].accel_z = (int16_t)(lsb_per_g + next_random() % 401 - 200);
+    }
+    const float limit_g = CONFIG_FALL_LOGIC_THRESHOLD_G / 1000.0f;
+    uint32_t limit = (uint32_t)(limit_g * lsb_per_g);
+    size_t passes = samples / BENCH_FRAMES + 1;
+
+    cost_t batch, scalar;
+    size_t hits_batch = 0, hits_float = 0;
+    double t0 = now_ns();
+    uint64_t c0 = ticks_now();
+    for (size_t p = 0; p < passes; p++) {
+      hits_batch += batch_hits(frames, BENCH_FRAMES, limit * limit);
+    }
+    batch.ticks = (double)(ticks_now() - c0) / (passes * BENCH_FRAMES);
+    batch.ns = (now_ns() - t0) / (passes * BENCH_FRAMES);
+
+    t0 = now_ns();
+    c0 = ticks_now();
+    for (size_t p = 0; p < passes; p++) {
+      hits_float += float_hits(frames, BENCH_FRAMES, lsb_per_g, limit_g);
+    }
+    scalar.ticks = (double)(ticks_now() - c0) / (passes * BENCH_FRAMES);
+    scalar.ns = (now_ns() - t0) / (passes * BENCH_FRAMES);
+
+    printf("threshold test over %zu samples (%u mg)\n", passes * BENCH_FRAMES,
+           CONFIG_FALL_LOGIC_THRESHOLD_G);
+    printf("  batch squared: %6.2f ns/sample", batch.ns);
+#if HAVE_TSC
+    printf(", %6.2f TSC ticks/sample", batch.ticks);
+#endif
+    printf("\n  float sqrtf:   %6.2f ns/sample", scalar.ns);
+#if HAVE_TSC
+    printf(", %6.2f TSC ticks/sample", scalar.ticks);
+#endif
+    printf("\n");
+    if (hits_batch != hits_float) {
+      // Float rounding at the limit may differ; report it, do not fail
+      printf("  note: %zu vs %zu samples below the limit\n", hits_batch,
+             hits_float);
+    }
+  }
+  return status;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file fall_replay.c
+ * @brief Replays recorded IMU traces through the firmware fall pipeline.
+ *
+ * Reports detections, latency from labelled fall onsets and false
+ * positives per hour over a corpus of traces. Exit status 1 when a CI
+ * limit (--max-fp-per-hour, --min-sensitivity) is not met, 2 on usage or
+ * load errors.
+ */
+
+#include "replay_core.h"
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define US_PER_HOUR 3600000000.0
+
+static bool s_verbose = false;
+static FILE *s_dump = NULL;
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [options] <trace|directory>...\n"
+          "  -s, --set name=value        override a parameter\n"
+          "  -v, --verbose               print every detection\n"
+          "      --csv                   print one CSV line per trace\n"
+          "      --max-fp-per-hour X     fail if false positives/h exceed X\n"
+          "      --min-sensitivity X     fail if detected/labelled is below X\n"
+          "      --dump-features FILE    write the classifier inputs of every\n"
+          "                              candidate (implies classifier=0)\n"
+          "  -h, --help                  show this help\n"
+          "\nparameters:\n",
+          prog);
+  replay_params_print_names(stderr);
+}
+
+static void dump_header(void) {
+  fprintf(s_dump, "trace,time_us,label");
+  for (int i = 0; i < FALL_CLASSIFIER_INPUTS; i++) {
+    fprintf(s_dump, ",%s", fall_classifier_input_names[i]);
+  }
+  fprintf(s_dump, "\n");
+}
+
+static void on_detection(const replay_trace_t *trace, uint64_t time_us,
+                         int64_t latency_us,
+                         const fall_classifier_result_t *candidate,
+                         void *arg) {
+  (void)arg;
+  if (s_dump != NULL) {
+    fprintf(s_dump, "%s,%llu,%d", trace->path, (unsigned long long)time_us,
+            latency_us >= 0);
+    for (int i = 0; i < FALL_CLASSIFIER_INPUTS; i++) {
+      fprintf(s_dump, ",%ld", (long)candidate->inputs[i]);
+    }
+    fprintf(s_dump, "\n");
+  }
+  if (!s_verbose) {
+    return;
+  }
+  if (latency_us < 0) {
+    printf("%s: false positive at %.3f s\n", trace->path, time_us / 1e6);
+  } else {
+    printf("%s: fall detected at %.3f s, latency %.0f ms\n", trace->path,
+           time_us / 1e6, latency_us / 1e3);
+  }
+  printf("  classifier score %ld\n", (long)candidate->score);
+}
+
+static void print_summary(const replay_result_t *total, double elapsed_s) {
+  double hours = total->duration_us / US_PER_HOUR;
+
+  printf("traces:          %u (%.2f h) in %.2f s, %.0f traces/s\n",
+         total->traces, hours, elapsed_s,
+         elapsed_s > 0 ? total->traces / elapsed_s : 0.0);
+  printf("labelled falls:  %u\n", total->falls);
+  if (total->falls > 0) {
+    printf("detected:        %u (sensitivity %.1f%%)\n", total->detected,
+           100.0 * replay_result_sensitivity(total));
+  }
+  if (total->negatives > 0) {
+    printf("fall-free:       %u traces, %u without detection "
+           "(specificity %.1f%%)\n",
+           total->negatives, total->true_negatives,
+           100.0 * replay_result_specificity(total));
+  }
+  if (total->detected > 0) {
+    printf("latency:         mean %.0f ms, max %.0f ms\n",
+           total->latency_sum_us / 1e3 / total->detected,
+           total->latency_max_us / 1e3);
+  }
+  printf("false positives: %u (%.2f per hour)\n", total->false_positives,
+         replay_result_fp_per_hour(total));
+
+  uint64_t rate_total_us = 0;
+  for (int i = 0; i < FALL_RATE_TIERS; i++) {
+    rate_total_us += total->rate_time_us[i];
+  }
+  if (rate_total_us > 0) {
+    printf("sample rate:     ");
+    for (int i = FALL_RATE_TIERS - 1; i >= 0; i--) {
+      printf("%s %.1f%%, ", fall_rate_tier_names[i],
+             100.0 * total->rate_time_us[i] / rate_total_us);
+    }
+    printf("%u switches\n", total->rate_switches);
+  }
+
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  printf("shadow (%s reported, match %d ms):\n",
+         fall_variant_names[total->authoritative],
+         CONFIG_FALL_LOGIC_SHADOW_MATCH_MS);
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    const fall_shadow_stats_t *s = &total->shadow[v];
+    if (v == (int)total->authoritative) {
+      printf("  %-12s %u events\n", fall_variant_names[v], s->events);
+    } else {
+      printf("  %-12s %u events, %u agreed, %u extra, %u missed\n",
+             fall_variant_names[v], s->events, s->agreed, s->shadow_only,
+             s->missed);
+    }
+  }
+#endif
+}
+
+int main(int argc, char **argv) {
+  enum { OPT_CSV = 256, OPT_MAX_FP, OPT_MIN_SENS, OPT_DUMP };
+  static const struct option options[] = {
+      {"set", required_argument, NULL, 's'},
+      {"verbose", no_argument, NULL, 'v'},
+      {"csv", no_argument, NULL, OPT_CSV},
+      {"max-fp-per-hour", required_argument, NULL, OPT_MAX_FP},
+      {"min-sensitivity", required_argument, NULL, OPT_MIN_SENS},
+      {"dump-features", required_argument, NULL, OPT_DUMP},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  replay_params_t params;
+  replay_params_default(&params);
+  bool csv = false;
+  double max_fp_per_hour = -1.0;
+  double min_sensitivity = -1.0;
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "s:vh", options, NULL)) != -1) {
+    switch (opt) {
+    case 's':
+      if (replay_params_set(&params, optarg) != 0) {
+        fprintf(stderr, "invalid parameter: %s\n", optarg);
+        return 2;
+      }
+      break;
+    case 'v':
+      s_verbose = true;
+      break;
+    case OPT_CSV:
+      csv = true;
+      break;
+    case OPT_MAX_FP:
+      max_fp_per_hour = atof(optarg);
+      break;
+    case OPT_MIN_SENS:
+      min_sensitivity = atof(optarg);
+      break;
+    case OPT_DUMP:
+      s_dump = fopen(optarg, "w");
+      if (s_dump == NULL) {
+        perror(optarg);
+        return 2;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (s_dump != NULL) {
+    // Every candidate, including those the model would reject
+    params.classifier = 0;
+    dump_header();
+  }
+
+  replay_path_list_t paths = {0};
+  for (int i = optind; i < argc; i++) {
+    if (replay_path_list_collect(&paths, argv[i]) != 0) {
+      return 2;
+    }
+  }
+
+  if (csv) {
+    printf("trace,frames,duration_s,falls,detected,false_positives,"
+           "latency_max_ms\n");
+  }
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  replay_result_t total = {0};
+  int load_errors = 0;
+  for (size_t i = 0; i < paths.count; i++) {
+    replay_trace_t trace;
+    if (replay_trace_load(paths.items[i], &trace) != 0) {
+      load_errors++;
+      continue;
+    }
+    replay_result_t result;
+    replay_run(&trace, &params, on_detection, NULL, &result);
+    replay_result_add(&total, &result);
+
+    if (csv) {
+      printf("%s,%zu,%.3f,%u,%u,%u,%.0f\n", trace.path, trace.count,
+             result.duration_us / 1e6, result.falls, result.detected,
+             result.false_positives, result.latency_max_us / 1e3);
+    }
+    replay_trace_free(&trace);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double elapsed =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  replay_path_list_free(&paths);
+  if (s_dump != NULL) {
+    fclose(s_dump);
+  }
+
+  if (!csv) {
+    print_summary(&total, elapsed);
+  }
+  if (load_errors > 0) {
+    fprintf(stderr, "%d trace(s) could not be loaded\n", load_errors);
+    return 2;
+  }
+
+  int status = 0;
+  double fp_per_hour = replay_result_fp_per_hour(&total);
+  if (max_fp_per_hour >= 0 && fp_per_hour > max_fp_per_hour) {
+    fprintf(stderr, "FAIL: %.2f false positives per hour > %.2f\n",
+            fp_per_hour, max_fp_per_hour);
+    status = 1;
+  }
+  double sensitivity = replay_result_sensitivity(&total);
+  if (min_sensitivity >= 0 && sensitivity >= 0 &&
+      sensitivity < min_sensitivity) {
+    fprintf(stderr, "FAIL: sensitivity %.3f < %.3f\n", sensitivity,
+            min_sensitivity);
+    status = 1;
+  }
+  return status;
+}
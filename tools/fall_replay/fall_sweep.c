@@ -0,0 +1,460 @@
+/**
+ * @file fall_sweep.c
+ * @brief Grid or random search of detector parameters over a trace corpus.
+ *
+ * Every parameter point is replayed over every trace through the firmware
+ * fall pipeline. Work is split into (point, block of traces) items that a
+ * pool of threads pulls from a shared counter, so both large grids and
+ * large corpora keep all cores busy. The output is a ROC-style CSV table,
+ * best points first, that maps back to Kconfig options with --kconfig.
+ */
+
+#include "replay_core.h"
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_DIMS 16
+#define MAX_VALUES 4096
+#define MAX_GRID_POINTS 1000000ull
+// Work items per thread, so uneven traces still balance
+#define ITEMS_PER_JOB 4
+
+typedef struct {
+  char name[32];
+  uint32_t values[MAX_VALUES];
+  size_t count;
+} sweep_dim_t;
+
+typedef struct {
+  sweep_dim_t dims[MAX_DIMS];
+  size_t dim_count;
+  replay_params_t base;
+
+  uint32_t *points; ///< point_count x dim_count values
+  size_t point_count;
+
+  replay_trace_t *traces;
+  size_t trace_count;
+  int *load_status;
+  char **paths;
+
+  size_t blocks;             ///< Trace blocks per point
+  replay_result_t *partials; ///< point_count x blocks
+  atomic_size_t next_item;
+} sweep_t;
+
+typedef struct {
+  const replay_result_t *result;
+  const uint32_t *values;
+  double sensitivity;
+  double specificity;
+  double fp_per_hour;
+  double score;
+} sweep_row_t;
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [options] <trace|directory>...\n"
+          "  -g, --grid name=SPEC    sweep a parameter; SPEC is v1,v2,...\n"
+          "                          or lo:hi:step\n"
+          "  -r, --random N          evaluate N random points of the grid\n"
+          "      --seed S            random seed (default 1)\n"
+          "  -s, --set name=value    fixed parameter\n"
+          "  -j, --jobs N            worker threads (default: all cores)\n"
+          "  -n, --top K             print only the K best points\n"
+          "      --kconfig           print Kconfig values of the best point\n"
+          "  -h, --help              show this help\n"
+          "\nparameters:\n",
+          prog);
+  replay_params_print_names(stderr);
+}
+
+// ---------------------------------------------------------------------------
+// Parameter space
+// ---------------------------------------------------------------------------
+
+static int parse_dim(sweep_t *sweep, const char *spec) {
+  const char *eq = strchr(spec, '=');
+  if (eq == NULL || sweep->dim_count == MAX_DIMS ||
+      (size_t)(eq - spec) >= sizeof(sweep->dims[0].name)) {
+    return -1;
+  }
+  sweep_dim_t *dim = &sweep->dims[sweep->dim_count];
+  memset(dim, 0, sizeof(*dim));
+  memcpy(dim->name, spec, (size_t)(eq - spec));
+
+  // Validate the name against the parameter table
+  char probe[64];
+  snprintf(probe, sizeof(probe), "%s=0", dim->name);
+  replay_params_t scratch = sweep->base;
+  if (replay_params_set(&scratch, probe) != 0) {
+    return -1;
+  }
+
+  const char *p = eq + 1;
+  char *end;
+  unsigned long lo = strtoul(p, &end, 10);
+  if (end == p) {
+    return -1;
+  }
+  if (*end == ':') {
+    unsigned long hi = strtoul(end + 1, &end, 10);
+    unsigned long step = 1;
+    if (*end == ':') {
+      step = strtoul(end + 1, &end, 10);
+    }
+    if (*end != '\0' || step == 0 || hi < lo ||
+        (hi - lo) / step + 1 > MAX_VALUES) {
+      return -1;
+    }
+    for (unsigned long v = lo; v <= hi; v += step) {
+      dim->values[dim->count++] = (uint32_t)v;
+    }
+  } else {
+    dim->values[dim->count++] = (uint32_t)lo;
+    while (*end == ',') {
+      if (dim->count == MAX_VALUES) {
+        return -1;
+      }
+      p = end + 1;
+      dim->values[dim->count++] = (uint32_t)strtoul(p, &end, 10);
+      if (end == p) {
+        return -1;
+      }
+    }
+    if (*end != '\0') {
+      return -1;
+    }
+  }
+
+  sweep->dim_count++;
+  return 0;
+}
+
+static int build_points(sweep_t *sweep, size_t random_points,
+                        unsigned int seed) {
+  size_t dims = sweep->dim_count;
+  unsigned long long grid = 1;
+  for (size_t d = 0; d < dims; d++) {
+    grid *= sweep->dims[d].count;
+    if (grid > MAX_GRID_POINTS && random_points == 0) {
+      fprintf(stderr, "grid exceeds %llu points, use --random\n",
+              MAX_GRID_POINTS);
+      return -1;
+    }
+  }
+
+  sweep->point_count = random_points ? random_points : (size_t)grid;
+  sweep->points =
+      calloc(sweep->point_count * (dims ? dims : 1), sizeof(uint32_t));
+  if (sweep->points == NULL) {
+    return -1;
+  }
+
+  for (size_t p = 0; p < sweep->point_count; p++) {
+    uint32_t *values = &sweep->points[p * dims];
+    size_t index = p;
+    for (size_t d = 0; d < dims; d++) {
+      const sweep_dim_t *dim = &sweep->dims[d];
+      size_t pick;
+      if (random_points) {
+        pick = (size_t)rand_r(&seed) % dim->count;
+      } else {
+        // Mixed-radix decomposition of the point index
+        pick = index % dim->count;
+        index /= dim->count;
+      }
+      values[d] = dim->values[pick];
+    }
+  }
+  return 0;
+}
+
+static void point_params(const sweep_t *sweep, size_t point,
+                         replay_params_t *params) {
+  *params = sweep->base;
+  for (size_t d = 0; d < sweep->dim_count; d++) {
+    char assignment[64];
+    snprintf(assignment, sizeof(assignment), "%s=%u", sweep->dims[d].name,
+             sweep->points[point * sweep->dim_count + d]);
+    replay_params_set(params, assignment);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Thread pool
+// ---------------------------------------------------------------------------
+
+typedef void (*work_fn_t)(sweep_t *sweep, size_t item);
+
+typedef struct {
+  sweep_t *sweep;
+  work_fn_t fn;
+  size_t items;
+} pool_job_t;
+
+static void *pool_worker(void *arg) {
+  pool_job_t *job = arg;
+  while (1) {
+    size_t item = atomic_fetch_add(&job->sweep->next_item, 1);
+    if (item >= job->items) {
+      return NULL;
+    }
+    job->fn(job->sweep, item);
+  }
+}
+
+/**
+ * @brief Runs fn(sweep, 0..items-1) on @p jobs threads.
+ */
+static void run_parallel(sweep_t *sweep, work_fn_t fn, size_t items,
+                         int jobs) {
+  pthread_t threads[256];
+  pool_job_t job = {.sweep = sweep, .fn = fn, .items = items};
+  atomic_store(&sweep->next_item, 0);
+
+  if (jobs > 256) {
+    jobs = 256;
+  }
+  int started = 0;
+  for (; started < jobs; started++) {
+    if (pthread_create(&threads[started], NULL, pool_worker, &job) != 0) {
+      break;
+    }
+  }
+  if (started == 0) {
+    pool_worker(&job);
+  }
+  for (int i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+static void load_item(sweep_t *sweep, size_t item) {
+  sweep->load_status[item] =
+      replay_trace_load(sweep->paths[item], &sweep->traces[item]);
+}
+
+static void replay_item(sweep_t *sweep, size_t item) {
+  size_t point = item / sweep->blocks;
+  size_t block = item % sweep->blocks;
+  size_t first = block * sweep->trace_count / sweep->blocks;
+  size_t last = (block + 1) * sweep->trace_count / sweep->blocks;
+
+  replay_params_t params;
+  point_params(sweep, point, &params);
+
+  replay_result_t *partial = &sweep->partials[item];
+  for (size_t t = first; t < last; t++) {
+    if (sweep->load_status[t] != 0) {
+      continue;
+    }
+    replay_result_t result;
+    replay_run(&sweep->traces[t], &params, NULL, NULL, &result);
+    replay_result_add(partial, &result);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+
+static int compare_rows(const void *a, const void *b) {
+  const sweep_row_t *ra = a, *rb = b;
+  if (ra->score != rb->score) {
+    return ra->score > rb->score ? -1 : 1;
+  }
+  if (ra->fp_per_hour != rb->fp_per_hour) {
+    return ra->fp_per_hour < rb->fp_per_hour ? -1 : 1;
+  }
+  return 0;
+}
+
+static void print_table(const sweep_t *sweep, sweep_row_t *rows, size_t top) {
+  for (size_t d = 0; d < sweep->dim_count; d++) {
+    printf("%s,", sweep->dims[d].name);
+  }
+  printf("sensitivity,specificity,fp_per_hour,latency_mean_ms,"
+         "latency_max_ms,score\n");
+
+  for (size_t i = 0; i < top; i++) {
+    const sweep_row_t *row = &rows[i];
+    for (size_t d = 0; d < sweep->dim_count; d++) {
+      printf("%u,", row->values[d]);
+    }
+    const replay_result_t *r = row->result;
+    double latency_mean =
+        r->detected ? r->latency_sum_us / 1e3 / r->detected : 0.0;
+    printf("%.4f,%.4f,%.3f,%.0f,%.0f,%.4f\n", row->sensitivity,
+           row->specificity, row->fp_per_hour, latency_mean,
+           r->latency_max_us / 1e3, row->score);
+  }
+}
+
+static void print_kconfig(const sweep_t *sweep, const sweep_row_t *best) {
+  fprintf(stderr, "\nbest point as Kconfig values:\n");
+  for (size_t d = 0; d < sweep->dim_count; d++) {
+    const char *kconfig = replay_params_kconfig_name(sweep->dims[d].name);
+    if (kconfig != NULL) {
+      fprintf(stderr, "%s=%u\n", kconfig, best->values[d]);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  enum { OPT_SEED = 256, OPT_KCONFIG };
+  static const struct option options[] = {
+      {"grid", required_argument, NULL, 'g'},
+      {"random", required_argument, NULL, 'r'},
+      {"seed", required_argument, NULL, OPT_SEED},
+      {"set", required_argument, NULL, 's'},
+      {"jobs", required_argument, NULL, 'j'},
+      {"top", required_argument, NULL, 'n'},
+      {"kconfig", no_argument, NULL, OPT_KCONFIG},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  static sweep_t sweep;
+  replay_params_default(&sweep.base);
+  size_t random_points = 0;
+  unsigned int seed = 1;
+  int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  size_t top = 0;
+  bool kconfig = false;
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "g:r:s:j:n:h", options, NULL)) !=
+         -1) {
+    switch (opt) {
+    case 'g':
+      if (parse_dim(&sweep, optarg) != 0) {
+        fprintf(stderr, "invalid sweep dimension: %s\n", optarg);
+        return 2;
+      }
+      break;
+    case 'r':
+      random_points = strtoul(optarg, NULL, 10);
+      break;
+    case OPT_SEED:
+      seed = (unsigned int)strtoul(optarg, NULL, 10);
+      break;
+    case 's':
+      if (replay_params_set(&sweep.base, optarg) != 0) {
+        fprintf(stderr, "invalid parameter: %s\n", optarg);
+        return 2;
+      }
+      break;
+    case 'j':
+      jobs = atoi(optarg);
+      break;
+    case 'n':
+      top = strtoul(optarg, NULL, 10);
+      break;
+    case OPT_KCONFIG:
+      kconfig = true;
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 2;
+  }
+  if (jobs < 1) {
+    jobs = 1;
+  }
+
+  replay_path_list_t paths = {0};
+  for (int i = optind; i < argc; i++) {
+    if (replay_path_list_collect(&paths, argv[i]) != 0) {
+      return 2;
+    }
+  }
+  if (paths.count == 0 || build_points(&sweep, random_points, seed) != 0) {
+    fprintf(stderr, "nothing to sweep\n");
+    return 2;
+  }
+
+  sweep.paths = paths.items;
+  sweep.trace_count = paths.count;
+  sweep.traces = calloc(paths.count, sizeof(replay_trace_t));
+  sweep.load_status = calloc(paths.count, sizeof(int));
+  if (sweep.traces == NULL || sweep.load_status == NULL) {
+    return 2;
+  }
+  run_parallel(&sweep, load_item, paths.count, jobs);
+
+  int load_errors = 0;
+  for (size_t t = 0; t < paths.count; t++) {
+    load_errors += sweep.load_status[t] != 0;
+  }
+  if (load_errors > 0) {
+    fprintf(stderr, "%d trace(s) could not be loaded\n", load_errors);
+    return 2;
+  }
+
+  // Split traces into blocks only when there are too few points to share
+  size_t wanted = (size_t)jobs * ITEMS_PER_JOB;
+  sweep.blocks = (wanted + sweep.point_count - 1) / sweep.point_count;
+  if (sweep.blocks > sweep.trace_count) {
+    sweep.blocks = sweep.trace_count;
+  }
+  sweep.partials =
+      calloc(sweep.point_count * sweep.blocks, sizeof(replay_result_t));
+  if (sweep.partials == NULL) {
+    return 2;
+  }
+  fprintf(stderr, "%zu points x %zu traces on %d threads\n",
+          sweep.point_count, sweep.trace_count, jobs);
+  run_parallel(&sweep, replay_item, sweep.point_count * sweep.blocks, jobs);
+
+  // Reduce the blocks of each point into its first partial
+  sweep_row_t *rows = calloc(sweep.point_count, sizeof(sweep_row_t));
+  if (rows == NULL) {
+    return 2;
+  }
+  for (size_t p = 0; p < sweep.point_count; p++) {
+    replay_result_t *total = &sweep.partials[p * sweep.blocks];
+    for (size_t b = 1; b < sweep.blocks; b++) {
+      replay_result_add(total, &sweep.partials[p * sweep.blocks + b]);
+    }
+
+    sweep_row_t *row = &rows[p];
+    row->result = total;
+    row->values = &sweep.points[p * sweep.dim_count];
+    row->sensitivity = replay_result_sensitivity(total);
+    row->specificity = replay_result_specificity(total);
+    row->fp_per_hour = replay_result_fp_per_hour(total);
+    // Youden index; a side without data neither helps nor hurts
+    row->score = (row->sensitivity >= 0 ? row->sensitivity : 1.0) +
+                 (row->specificity >= 0 ? row->specificity : 1.0) - 1.0;
+  }
+  qsort(rows, sweep.point_count, sizeof(sweep_row_t), compare_rows);
+
+  if (top == 0 || top > sweep.point_count) {
+    top = sweep.point_count;
+  }
+  print_table(&sweep, rows, top);
+  if (kconfig) {
+    print_kconfig(&sweep, &rows[0]);
+  }
+
+  for (size_t t = 0; t < sweep.trace_count; t++) {
+    replay_trace_free(&sweep.traces[t]);
+  }
+  replay_path_list_free(&paths);
+  free(sweep.traces);
+  free(sweep.load_status);
+  free(sweep.partials);
+  free(sweep.points);
+  free(rows);
+  return 0;
+}
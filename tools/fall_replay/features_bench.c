@@ -0,0 +1,250 @@
+/**
+ * @file features_bench.c
+ * @brief Cost and exactness of the incremental feature window.
+ *
+ * Synthesizes a walking-like stream with a jittered sample period, runs it
+ * through fall_features_update() and through a naive version that
+ * recomputes every feature from the raw frames in the window, and checks
+ * that both agree on every sample. The jerk is also compared with a
+ * double-precision computation, which catches time bases rounded too
+ * coarsely for the sample period. Then both are timed per sample.
+ *
+ * Exit status 1 on any disagreement.
+ */
+
+#include "fall_dsp.h"
+#include "fall_features.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Relative jerk error allowed against the double-precision reference
+#define JERK_TOLERANCE 0.001
+
+typedef struct {
+  fall_features_t features;
+  double jerk; ///< LSB/s, in double precision
+} naive_result_t;
+
+static int16_t to_lsb(double value) {
+  double lsb = round(value);
+  if (lsb > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (lsb < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)lsb;
+}
+
+/**
+ * @brief Walking sway with noise at @p rate_hz, the period jittered by up
+ * to +-2%.
+ */
+static void synthesize(sensor_raw_t *frames, size_t count, uint32_t rate_hz) {
+  const double g = MPU6050_ACCEL_LSB_PER_G;
+  const double period_us = 1e6 / rate_hz;
+  unsigned int seed = 1;
+  double t_us = 0.0;
+  for (size_t n = 0; n < count; n++) {
+    double jitter = (rand_r(&seed) / (double)RAND_MAX - 0.5) * 0.04;
+    t_us += period_us * (1.0 + jitter);
+    double t = t_us / 1e6;
+    double noise = (rand_r(&seed) / (double)RAND_MAX - 0.5) * 0.02;
+    sensor_raw_t *f = &frames[n];
+    f->timestamp_us = (uint32_t)t_us;
+    f->accel_x = to_lsb((0.1 * cos(2.0 * M_PI * t) + noise) * g);
+    f->accel_y = to_lsb((0.05 * sin(2.0 * M_PI * 2.0 * t) - noise) * g);
+    f->accel_z = to_lsb((1.0 + 0.3 * sin(2.0 * M_PI * 2.0 * t)) * g);
+    f->gyro_x = to_lsb(40.0 * sin(2.0 * M_PI * t) * 32.8);
+    f->gyro_y = to_lsb(25.0 * cos(2.0 * M_PI * 2.0 * t) * 32.8);
+    f->gyro_z = to_lsb(15.0 * sin(M_PI * t) * 32.8);
+  }
+}
+
+/**
+ * @brief Features of the @p count frames ending at @p frames[last], from
+ * scratch. @p frames[last - count] is the previous frame for the jerk of
+ * the oldest one, when it exists.
+ */
+static void naive_features(const sensor_raw_t *frames, size_t last,
+                           uint32_t count, naive_result_t *out) {
+  uint64_t sum_mag = 0, sum_mag_sq = 0, sum_sma = 0, sum_gyro = 0;
+  uint64_t sum_jerk = 0, sum_dt_us = 0;
+  uint32_t mag_min = UINT32_MAX, mag_max = 0;
+
+  for (size_t i = last + 1 - count; i <= last; i++) {
+    const sensor_raw_t *f = &frames[i];
+    uint32_t mag_sq;
+    fall_dsp_mag_sq_s16(f, 1, &mag_sq);
+    uint32_t mag = fall_dsp_isqrt_u32(mag_sq);
+    sum_mag += mag;
+    sum_mag_sq += (uint64_t)mag * mag;
+    mag_min = mag < mag_min ? mag : mag_min;
+    mag_max = mag > mag_max ? mag : mag_max;
+    sum_sma += (uint32_t)(abs(f->accel_x) + abs(f->accel_y) + abs(f->accel_z));
+    sum_gyro += (uint64_t)((int32_t)f->gyro_x * f->gyro_x) +
+                (uint64_t)((int32_t)f->gyro_y * f->gyro_y) +
+                (uint64_t)((int32_t)f->gyro_z * f->gyro_z);
+    if (i > 0) {
+      const sensor_raw_t *p = &frames[i - 1];
+      sum_jerk += (uint32_t)(abs(f->accel_x - p->accel_x) +
+                             abs(f->accel_y - p->accel_y) +
+                             abs(f->accel_z - p->accel_z));
+      sum_dt_us += f->timestamp_us - p->timestamp_us;
+    }
+  }
+
+  fall_features_t *r = &out->features;
+  memset(r, 0, sizeof(*r));
+  r->last = frames[last];
+  fall_dsp_mag_sq_s16(&frames[last], 1, &r->last_mag_sq);
+  r->count = count;
+  r->mag_mean = (uint32_t)(sum_mag / count);
+  uint64_t mean_sq = sum_mag_sq / count;
+  uint64_t mean = r->mag_mean;
+  r->mag_var = mean_sq > mean * mean ? (uint32_t)(mean_sq - mean * mean) : 0;
+  r->mag_min = mag_min;
+  r->mag_max = mag_max;
+  r->sma = (uint32_t)(sum_sma / count);
+  r->jerk = sum_dt_us > 0 ? (uint32_t)(sum_jerk * 1000000u / sum_dt_us) : 0;
+  r->gyro_energy = (uint32_t)(sum_gyro / count);
+  out->jerk = sum_dt_us > 0 ? sum_jerk * 1e6 / (double)sum_dt_us : 0.0;
+}
+
+static bool same_features(const fall_features_t *a, const fall_features_t *b) {
+  return a->last_mag_sq == b->last_mag_sq && a->count == b->count &&
+         a->mag_mean == b->mag_mean && a->mag_var == b->mag_var &&
+         a->mag_min == b->mag_min && a->mag_max == b->mag_max &&
+         a->sma == b->sma && a->jerk == b->jerk &&
+         a->gyro_energy == b->gyro_energy &&
+         a->last.timestamp_us == b->last.timestamp_us;
+}
+
+static double elapsed_ns(const struct timespec *start,
+                         const struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char **argv) {
+  static const struct option options[] = {
+      {"samples", required_argument, NULL, 'n'},
+      {"rate", required_argument, NULL, 'r'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  size_t samples = 200000;
+  uint32_t rate_hz = 500;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "n:r:h", options, NULL)) != -1) {
+    switch (opt) {
+    case 'n':
+      samples = strtoul(optarg, NULL, 10);
+      break;
+    case 'r':
+      rate_hz = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-n samples] [-r rate_hz]\n"
+              "  -n, --samples N   stream length (default 200000)\n"
+              "  -r, --rate HZ     sample rate (default 500)\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (samples == 0 || rate_hz == 0) {
+    fprintf(stderr, "samples and rate must be positive\n");
+    return 2;
+  }
+
+  uint32_t window = CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS * rate_hz / 1000;
+  if (window == 0) {
+    window = 1;
+  } else if (window > FALL_FEATURES_MAX_WINDOW) {
+    window = FALL_FEATURES_MAX_WINDOW;
+  }
+
+  sensor_raw_t *frames = calloc(samples, sizeof(*frames));
+  uint32_t *mag_sq = calloc(samples, sizeof(*mag_sq));
+  fall_feature_window_t *fw = malloc(sizeof(*fw));
+  if (frames == NULL || mag_sq == NULL || fw == NULL) {
+    return 2;
+  }
+  synthesize(frames, samples, rate_hz);
+  fall_dsp_mag_sq_s16(frames, samples, mag_sq);
+  printf("feature window: %u samples at %u Hz, %zu samples\n", window,
+         rate_hz, samples);
+
+  // Agreement, sample by sample
+  int status = 0;
+  uint32_t mismatches = 0;
+  double worst_jerk = 0.0;
+  fall_features_init(fw, window);
+  for (size_t n = 0; n < samples; n++) {
+    const fall_features_t *inc = fall_features_update(fw, &frames[n],
+                                                      mag_sq[n]);
+    naive_result_t ref;
+    naive_features(frames, n, n + 1 < window ? (uint32_t)(n + 1) : window,
+                   &ref);
+    if (!same_features(inc, &ref.features) && mismatches++ < 5) {
+      fprintf(stderr, "FAIL: sample %zu: mean %u/%u var %u/%u min %u/%u "
+              "max %u/%u jerk %u/%u\n", n, inc->mag_mean,
+              ref.features.mag_mean, inc->mag_var, ref.features.mag_var,
+              inc->mag_min, ref.features.mag_min, inc->mag_max,
+              ref.features.mag_max, inc->jerk, ref.features.jerk);
+    }
+    if (ref.jerk > 1.0) {
+      double err = fabs(inc->jerk - ref.jerk) / ref.jerk;
+      worst_jerk = err > worst_jerk ? err : worst_jerk;
+    }
+  }
+  printf("agreement: %u mismatches, worst jerk error %.4f%%\n", mismatches,
+         worst_jerk * 100.0);
+  if (mismatches != 0) {
+    status = 1;
+  }
+  if (worst_jerk > JERK_TOLERANCE) {
+    fprintf(stderr, "FAIL: jerk off by %.3f%% (limit %.3f%%)\n",
+            worst_jerk * 100.0, JERK_TOLERANCE * 100.0);
+    status = 1;
+  }
+
+  // Cost per sample
+  struct timespec start, end;
+  fall_features_init(fw, window);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  uint64_t sink = 0;
+  for (size_t n = 0; n < samples; n++) {
+    sink += fall_features_update(fw, &frames[n], mag_sq[n])->mag_var;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double inc_ns = elapsed_ns(&start, &end) / samples;
+
+  // The naive version is O(window); time a slice of the stream
+  size_t naive_samples = samples < 20000 ? samples : 20000;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t n = 0; n < naive_samples; n++) {
+    naive_result_t ref;
+    naive_features(frames, n, n + 1 < window ? (uint32_t)(n + 1) : window,
+                   &ref);
+    sink += ref.features.mag_var;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double naive_ns = elapsed_ns(&start, &end) / naive_samples;
+
+  printf("incremental: %.1f ns/sample\n", inc_ns);
+  printf("naive:       %.1f ns/sample (%.0fx)\n", naive_ns, naive_ns / inc_ns);
+  if (sink == 1) {
+    printf("unreachable\n");
+  }
+
+  free(fw);
+  free(mag_sq);
+  free(frames);
+  return status;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file comm.h
+ * @brief Host stand-in for the comm component: only the I2C calls made by
+ * the MPU6050 driver, implemented by the fake bus of the test that links
+ * the driver (see mpu6050_check.c).
+ */
+#ifndef _HOST_COMM_H_
+#define _HOST_COMM_H_
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+esp_err_t comm_i2c_write_byte(uint8_t addr, uint8_t reg, uint8_t data);
+esp_err_t comm_i2c_read(uint8_t device_addr, uint8_t reg, uint8_t *data,
+                        size_t len);
+esp_err_t comm_i2c_read_byte(uint8_t addr, uint8_t reg, uint8_t *data);
+
+#endif // _HOST_COMM_H_
@@ -0,0 +1,15 @@
+/**
+ * @file debugs.h
+ * @brief Host stand-in: driver logging goes through the esp_log shim.
+ */
+#ifndef _HOST_DEBUGS_H_
+#define _HOST_DEBUGS_H_
+
+#include "esp_log.h"
+
+#define DEBUGS_LOGD(fmt, ...) ESP_LOGD("DEBUGS", fmt, ##__VA_ARGS__)
+#define DEBUGS_LOGI(fmt, ...) ESP_LOGI("DEBUGS", fmt, ##__VA_ARGS__)
+#define DEBUGS_LOGW(fmt, ...) ESP_LOGW("DEBUGS", fmt, ##__VA_ARGS__)
+#define DEBUGS_LOGE(fmt, ...) ESP_LOGE("DEBUGS", fmt, ##__VA_ARGS__)
+
+#endif // _HOST_DEBUGS_H_
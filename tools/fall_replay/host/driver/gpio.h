@@ -0,0 +1,74 @@
+/**
+ * @file gpio.h
+ * @brief Host stand-in: the data-ready and wake-up pin calls succeed and
+ * do nothing, as no interrupt is ever raised on the host.
+ */
+#ifndef _HOST_DRIVER_GPIO_H_
+#define _HOST_DRIVER_GPIO_H_
+
+#include "esp_err.h"
+#include <stdint.h>
+
+typedef enum {
+  GPIO_INTR_DISABLE,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+typedef enum { GPIO_MODE_INPUT } gpio_mode_t;
+typedef enum { GPIO_PULLUP_DISABLE, GPIO_PULLUP_ENABLE } gpio_pullup_t;
+typedef enum { GPIO_PULLDOWN_DISABLE, GPIO_PULLDOWN_ENABLE } gpio_pulldown_t;
+
+typedef struct {
+  uint64_t pin_bit_mask;
+  gpio_mode_t mode;
+  gpio_pullup_t pull_up_en;
+  gpio_pulldown_t pull_down_en;
+  gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void *arg);
+
+static inline esp_err_t gpio_config(const gpio_config_t *config) {
+  (void)config;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_install_isr_service(int flags) {
+  (void)flags;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_isr_handler_add(int gpio, gpio_isr_t isr,
+                                             void *arg) {
+  (void)gpio;
+  (void)isr;
+  (void)arg;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_isr_handler_remove(int gpio) {
+  (void)gpio;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_intr_enable(int gpio) {
+  (void)gpio;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_intr_disable(int gpio) {
+  (void)gpio;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_set_intr_type(int gpio, gpio_int_type_t type) {
+  (void)gpio;
+  (void)type;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_wakeup_enable(int gpio, gpio_int_type_t type) {
+  (void)gpio;
+  (void)type;
+  return ESP_OK;
+}
+static inline esp_err_t gpio_wakeup_disable(int gpio) {
+  (void)gpio;
+  return ESP_OK;
+}
+
+#endif // _HOST_DRIVER_GPIO_H_
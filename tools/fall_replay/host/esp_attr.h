@@ -0,0 +1,11 @@
+/**
+ * @file esp_attr.h
+ * @brief Host stand-in: memory placement attributes are no-ops.
+ */
+#ifndef _HOST_ESP_ATTR_H_
+#define _HOST_ESP_ATTR_H_
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif // _HOST_ESP_ATTR_H_
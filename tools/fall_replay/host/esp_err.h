@@ -0,0 +1,20 @@
+/**
+ * @file esp_err.h
+ * @brief Host stand-in for the ESP-IDF error type.
+ */
+#ifndef _HOST_ESP_ERR_H_
+#define _HOST_ESP_ERR_H_
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_FOUND 0x105
+
+static inline const char *esp_err_to_name(esp_err_t err) {
+  return err == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+#endif // _HOST_ESP_ERR_H_
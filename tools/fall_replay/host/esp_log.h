@@ -0,0 +1,20 @@
+/**
+ * @file esp_log.h
+ * @brief Host stand-in for ESP-IDF logging: messages are checked by the
+ * compiler and dropped, so stress runs are not slowed down by output.
+ */
+#ifndef _HOST_ESP_LOG_H_
+#define _HOST_ESP_LOG_H_
+
+__attribute__((format(printf, 2, 3))) static inline void
+host_log_drop(const char *tag, const char *format, ...) {
+  (void)tag;
+  (void)format;
+}
+
+#define ESP_LOGE(tag, format, ...) host_log_drop(tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) host_log_drop(tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) host_log_drop(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) host_log_drop(tag, format, ##__VA_ARGS__)
+
+#endif // _HOST_ESP_LOG_H_
@@ -0,0 +1,13 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stand-in: the time source is provided by the test that links
+ * the code under test, so it can be stepped.
+ */
+#ifndef _HOST_ESP_TIMER_H_
+#define _HOST_ESP_TIMER_H_
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // _HOST_ESP_TIMER_H_
@@ -0,0 +1,20 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in: only the types and macros named by driver code.
+ */
+#ifndef _HOST_FREERTOS_H_
+#define _HOST_FREERTOS_H_
+
+#include <stdint.h>
+
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+
+#define portYIELD_FROM_ISR(...) ((void)0)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif // _HOST_FREERTOS_H_
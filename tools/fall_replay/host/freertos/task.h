@@ -0,0 +1,15 @@
+/**
+ * @file task.h
+ * @brief Host stand-in: no task is ever notified on the host; a test that
+ * links code which delays provides vTaskDelay() (1 tick = 1 ms).
+ */
+#ifndef _HOST_FREERTOS_TASK_H_
+#define _HOST_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+#define vTaskNotifyGiveFromISR(task, woken) ((void)(task), (void)(woken))
+
+void vTaskDelay(TickType_t ticks);
+
+#endif // _HOST_FREERTOS_TASK_H_
@@ -0,0 +1,32 @@
+/**
+ * @file nvs.h
+ * @brief Host stand-in for NVS: only the calls made by the MPU6050
+ * calibration storage, implemented by the test that links it (see
+ * mpu6050_check.c).
+ */
+#ifndef _HOST_NVS_H_
+#define _HOST_NVS_H_
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+  NVS_READONLY,
+  NVS_READWRITE,
+} nvs_open_mode_t;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode,
+                   nvs_handle_t *handle);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *value,
+                       size_t *length);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key,
+                       const void *value, size_t length);
+esp_err_t nvs_commit(nvs_handle_t handle);
+void nvs_close(nvs_handle_t handle);
+
+#endif // _HOST_NVS_H_
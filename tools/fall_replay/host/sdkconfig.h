@@ -0,0 +1,123 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host build configuration.
+ *
+ * Mirrors the Kconfig defaults of fall_logic, orientation and mpu6050 so
+ * the host build runs the same code paths as a default firmware build.
+ * Every value can be overridden with -D at build time; detector thresholds
+ * can also be changed per run from the command line.
+ */
+#ifndef _HOST_SDKCONFIG_H_
+#define _HOST_SDKCONFIG_H_
+
+// Algorithm: multi-stage unless the host build asks for the threshold one
+#ifndef CONFIG_FALL_LOGIC_ALGO_THRESHOLD
+#define CONFIG_FALL_LOGIC_ALGO_MULTI_STAGE 1
+#endif
+
+#ifndef CONFIG_FALL_LOGIC_THRESHOLD_G
+#define CONFIG_FALL_LOGIC_THRESHOLD_G 400
+#endif
+#ifndef CONFIG_FALL_LOGIC_FREEFALL_MIN_MS
+#define CONFIG_FALL_LOGIC_FREEFALL_MIN_MS 60
+#endif
+#ifndef CONFIG_FALL_LOGIC_IMPACT_THRESHOLD_MG
+#define CONFIG_FALL_LOGIC_IMPACT_THRESHOLD_MG 2500
+#endif
+#ifndef CONFIG_FALL_LOGIC_IMPACT_WINDOW_MS
+#define CONFIG_FALL_LOGIC_IMPACT_WINDOW_MS 500
+#endif
+#ifndef CONFIG_FALL_LOGIC_IMPACT_ONLY_THRESHOLD_MG
+#define CONFIG_FALL_LOGIC_IMPACT_ONLY_THRESHOLD_MG 0
+#endif
+#ifndef CONFIG_FALL_LOGIC_SETTLE_MS
+#define CONFIG_FALL_LOGIC_SETTLE_MS 500
+#endif
+#ifndef CONFIG_FALL_LOGIC_INACTIVITY_MS
+#define CONFIG_FALL_LOGIC_INACTIVITY_MS 2000
+#endif
+#ifndef CONFIG_FALL_LOGIC_INACTIVITY_TOLERANCE_MG
+#define CONFIG_FALL_LOGIC_INACTIVITY_TOLERANCE_MG 300
+#endif
+#ifndef CONFIG_FALL_LOGIC_ORIENTATION_CHANGE_DEG
+#define CONFIG_FALL_LOGIC_ORIENTATION_CHANGE_DEG 60
+#endif
+#ifndef CONFIG_FALL_LOGIC_HORIZONTAL_MIN_DEG
+#define CONFIG_FALL_LOGIC_HORIZONTAL_MIN_DEG 45
+#endif
+#ifndef CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS
+#define CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS 500
+#endif
+#ifndef CONFIG_FALL_LOGIC_FEATURE_MAX_SAMPLES
+#define CONFIG_FALL_LOGIC_FEATURE_MAX_SAMPLES 256
+#endif
+// Shadow detectors are off unless the host build asks for them
+#ifndef CONFIG_FALL_LOGIC_SHADOW_MATCH_MS
+#define CONFIG_FALL_LOGIC_SHADOW_MATCH_MS 5000
+#endif
+// Acquisition: data-ready interrupt, as in the default firmware
+#ifndef CONFIG_FALL_LOGIC_DATA_READY_TIMEOUT_MS
+#define CONFIG_FALL_LOGIC_DATA_READY_TIMEOUT_MS 100
+#endif
+#ifndef CONFIG_FALL_LOGIC_SAMPLE_RING_SIZE
+#define CONFIG_FALL_LOGIC_SAMPLE_RING_SIZE 512
+#endif
+// Adaptive rate policy; replay_run() applies it when the run asks for it
+#ifndef CONFIG_FALL_LOGIC_RATE_MEDIUM_HZ
+#define CONFIG_FALL_LOGIC_RATE_MEDIUM_HZ 100
+#endif
+#ifndef CONFIG_FALL_LOGIC_RATE_LOW_HZ
+#define CONFIG_FALL_LOGIC_RATE_LOW_HZ 20
+#endif
+#ifndef CONFIG_FALL_LOGIC_RATE_ACTIVE_STD_MG
+#define CONFIG_FALL_LOGIC_RATE_ACTIVE_STD_MG 250
+#endif
+#ifndef CONFIG_FALL_LOGIC_RATE_STILL_BAND_MG
+#define CONFIG_FALL_LOGIC_RATE_STILL_BAND_MG 50
+#endif
+#ifndef CONFIG_FALL_LOGIC_RATE_HIGH_HOLD_MS
+#define CONFIG_FALL_LOGIC_RATE_HIGH_HOLD_MS 3000
+#endif
+#ifndef CONFIG_FALL_LOGIC_RATE_STILL_MS
+#define CONFIG_FALL_LOGIC_RATE_STILL_MS 5000
+#endif
+
+// Orientation filter: float unless the host build asks for fixed point
+#ifndef CONFIG_ORIENTATION_IMPL_FIXED
+#define CONFIG_ORIENTATION_IMPL_FLOAT 1
+#endif
+#ifndef CONFIG_ORIENTATION_TIME_CONSTANT_MS
+#define CONFIG_ORIENTATION_TIME_CONSTANT_MS 500
+#endif
+#ifndef CONFIG_ORIENTATION_ACCEL_GATE_MG
+#define CONFIG_ORIENTATION_ACCEL_GATE_MG 200
+#endif
+#if !defined(CONFIG_ORIENTATION_UP_AXIS_X) &&                                  \
+    !defined(CONFIG_ORIENTATION_UP_AXIS_Y)
+#define CONFIG_ORIENTATION_UP_AXIS_Z 1
+#endif
+
+// +-8 g and +-1000 deg/s, as in the default firmware
+#ifndef CONFIG_MPU6050_ACCEL_FS_SEL
+#define CONFIG_MPU6050_ACCEL_FS_SEL 2
+#endif
+#ifndef CONFIG_MPU6050_GYRO_FS_SEL
+#define CONFIG_MPU6050_GYRO_FS_SEL 2
+#endif
+#ifndef CONFIG_MPU6050_DLPF_CFG
+#define CONFIG_MPU6050_DLPF_CFG 2
+#endif
+#ifndef CONFIG_MPU6050_SAMPLE_RATE_HZ
+#define CONFIG_MPU6050_SAMPLE_RATE_HZ 200
+#endif
+#ifndef CONFIG_MPU6050_CALIB_ACCEL_TOLERANCE_MG
+#define CONFIG_MPU6050_CALIB_ACCEL_TOLERANCE_MG 60
+#endif
+#ifndef CONFIG_MPU6050_CALIB_GYRO_TOLERANCE_DPS
+#define CONFIG_MPU6050_CALIB_GYRO_TOLERANCE_DPS 5
+#endif
+#ifndef CONFIG_MPU6050_CALIB_FLAT_TOLERANCE_MG
+#define CONFIG_MPU6050_CALIB_FLAT_TOLERANCE_MG 150
+#endif
+
+#endif // _HOST_SDKCONFIG_H_
@@ -0,0 +1,354 @@
+/**
+ * @file mpu6050_check.c
+ * @brief MPU6050 driver against a fake I2C register file.
+ *
+ * mpu6050.c is compiled unchanged; the comm_i2c_* calls it makes land in
+ * a 128-byte register file with a write log, and esp_timer_get_time()
+ * returns a time the test steps. The checks cover:
+ *
+ * - mpu6050_configure() for every range, DLPF and a set of output rates:
+ *   CONFIG, GYRO_CONFIG, ACCEL_CONFIG and SMPLRT_DIV as the datasheet
+ *   defines them, the rate actually reached, and the LSB per g and per
+ *   deg/s the driver reports and applies in mpu6050_read_data();
+ * - rejected configurations, which must not touch the bus, and a failed
+ *   register write, which must leave the scales alone;
+ * - the samples counted lost when the FIFO overflows, from the time since
+ *   the last drained frame;
+ * - mpu6050_calibrate() on a device lying flat, which it must accept, and
+ *   tilted, which it must reject instead of storing gravity as offset.
+ *
+ * Exit status 1 on any failure.
+ */
+
+#include "comm.h"
+#include "esp_timer.h"
+#include "mpu6050.h"
+#include "nvs.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_WRITES 64
+
+typedef struct {
+  uint8_t reg;
+  uint8_t value;
+} reg_write_t;
+
+static uint8_t s_regs[128];
+static reg_write_t s_writes[MAX_WRITES];
+static size_t s_write_count;
+static int s_fail_reg = -1; ///< Register whose next write fails
+static uint8_t s_fifo[MPU6050_FIFO_SIZE];
+static size_t s_fifo_pos;
+static int64_t s_now_us;
+static int s_failures;
+
+// ---------------------------------------------------------------------------
+// Fake bus
+// ---------------------------------------------------------------------------
+
+esp_err_t comm_i2c_write_byte(uint8_t addr, uint8_t reg, uint8_t data) {
+  if (addr != MPU6050_ADDR || reg >= sizeof(s_regs)) {
+    return ESP_FAIL;
+  }
+  if (reg == s_fail_reg) {
+    s_fail_reg = -1;
+    return ESP_FAIL;
+  }
+  if (s_write_count < MAX_WRITES) {
+    s_writes[s_write_count++] = (reg_write_t){reg, data};
+  }
+  s_regs[reg] = data;
+  return ESP_OK;
+}
+
+esp_err_t comm_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data,
+                        size_t len) {
+  if (addr != MPU6050_ADDR) {
+    return ESP_FAIL;
+  }
+  if (reg == MPU6050_FIFO_R_W) {
+    // Burst reads of FIFO_R_W stream out of the FIFO
+    for (size_t i = 0; i < len; i++) {
+      data[i] = s_fifo_pos < sizeof(s_fifo) ? s_fifo[s_fifo_pos++] : 0;
+    }
+    return ESP_OK;
+  }
+  if (reg + len > sizeof(s_regs)) {
+    return ESP_FAIL;
+  }
+  memcpy(data, &s_regs[reg], len);
+  return ESP_OK;
+}
+
+esp_err_t comm_i2c_read_byte(uint8_t addr, uint8_t reg, uint8_t *data) {
+  return comm_i2c_read(addr, reg, data, 1);
+}
+
+int64_t esp_timer_get_time(void) { return s_now_us; }
+
+void vTaskDelay(TickType_t ticks) { s_now_us += (int64_t)ticks * 1000; }
+
+// Calibration storage is not exercised; NVS is always empty
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode,
+                   nvs_handle_t *handle) {
+  return ESP_ERR_NVS_NOT_FOUND;
+}
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *value,
+                       size_t *length) {
+  return ESP_ERR_NVS_NOT_FOUND;
+}
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key,
+                       const void *value, size_t length) {
+  return ESP_FAIL;
+}
+esp_err_t nvs_commit(nvs_handle_t handle) { return ESP_FAIL; }
+void nvs_close(nvs_handle_t handle) {}
+
+static void bus_reset(void) {
+  memset(s_regs, 0, sizeof(s_regs));
+  s_write_count = 0;
+  s_fail_reg = -1;
+}
+
+static void set_raw(const int16_t raw[7]) {
+  for (int i = 0; i < 7; i++) {
+    s_regs[MPU6050_ACCEL_XOUT_H + 2 * i] = (uint8_t)((uint16_t)raw[i] >> 8);
+    s_regs[MPU6050_ACCEL_XOUT_H + 2 * i + 1] = (uint8_t)raw[i];
+  }
+}
+
+static void set_fifo_count(uint16_t bytes) {
+  s_regs[MPU6050_FIFO_COUNTH] = (uint8_t)(bytes >> 8);
+  s_regs[MPU6050_FIFO_COUNTH + 1] = (uint8_t)bytes;
+  s_fifo_pos = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Checks
+// ---------------------------------------------------------------------------
+
+#define EXPECT(cond, ...)                                                      \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      if (s_failures++ < 20) {                                                 \
+        fprintf(stderr, "FAIL: " __VA_ARGS__);                                 \
+        fprintf(stderr, "\n");                                                 \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+static const uint16_t s_rates[] = {4, 5, 31, 50, 100, 125, 200,
+                                   333, 500, 1000};
+#define RATE_COUNT (sizeof(s_rates) / sizeof(s_rates[0]))
+
+/**
+ * @brief One configuration: registers, reached rate and scales.
+ */
+static void check_configuration(mpu6050_accel_range_t accel,
+                                mpu6050_gyro_range_t gyro, mpu6050_dlpf_t dlpf,
+                                uint16_t rate_hz) {
+  // Datasheet: gyro runs at 8 kHz with the DLPF off (DLPF_CFG 0), else
+  // 1 kHz; sample rate = gyro rate / (1 + SMPLRT_DIV), an 8-bit divider
+  const uint32_t internal = dlpf == MPU6050_DLPF_260HZ ? 8000 : 1000;
+  const uint32_t divider = internal / rate_hz - 1;
+  const bool valid = divider <= 255;
+  const float full_scale_g = 2 << accel;
+  const float full_scale_dps = 250 << gyro;
+
+  bus_reset();
+  mpu6050_config_t config = {accel, gyro, dlpf, rate_hz};
+  esp_err_t err = mpu6050_configure(&config);
+
+  EXPECT((err == ESP_OK) == valid,
+         "a%d g%d dlpf%d %u Hz: returned %d, divider %u", accel, gyro, dlpf,
+         rate_hz, err, divider);
+  EXPECT(s_regs[MPU6050_CONFIG] == dlpf, "a%d g%d dlpf%d: CONFIG=0x%02x",
+         accel, gyro, dlpf, s_regs[MPU6050_CONFIG]);
+  EXPECT(s_regs[MPU6050_GYRO_CONFIG] == (gyro << 3),
+         "gyro %d: GYRO_CONFIG=0x%02x", gyro, s_regs[MPU6050_GYRO_CONFIG]);
+  EXPECT(s_regs[MPU6050_ACCEL_CONFIG] == (accel << 3),
+         "accel %d: ACCEL_CONFIG=0x%02x", accel,
+         s_regs[MPU6050_ACCEL_CONFIG]);
+  EXPECT(mpu6050_get_accel_lsb_per_g() == 32768 / full_scale_g,
+         "accel %d: %u LSB/g", accel, mpu6050_get_accel_lsb_per_g());
+  EXPECT(fabsf(mpu6050_get_gyro_lsb_per_dps() - 32768 / full_scale_dps) <
+             1e-4f,
+         "gyro %d: %f LSB/dps", gyro, mpu6050_get_gyro_lsb_per_dps());
+  if (!valid) {
+    return;
+  }
+
+  mpu6050_config_t applied;
+  mpu6050_get_config(&applied);
+  EXPECT(s_regs[MPU6050_SMPLRT_DIV] == divider, "dlpf%d %u Hz: SMPLRT_DIV=%u",
+         dlpf, rate_hz, s_regs[MPU6050_SMPLRT_DIV]);
+  EXPECT(applied.sample_rate_hz == internal / (divider + 1),
+         "dlpf%d %u Hz: reached %u Hz", dlpf, rate_hz, applied.sample_rate_hz);
+  EXPECT(applied.accel_range == accel && applied.gyro_range == gyro &&
+             applied.dlpf == dlpf,
+         "a%d g%d dlpf%d: get_config disagrees", accel, gyro, dlpf);
+
+  // Half of full scale on X, minus a quarter on Y, 1 LSB on Z
+  const int16_t raw[7] = {16384, -8192, 1, 0, 16384, -8192, 1};
+  set_raw(raw);
+  sensor_data_t data;
+  EXPECT(mpu6050_read_data(&data) == ESP_OK, "read_data failed");
+  EXPECT(fabsf(data.accel_x - full_scale_g / 2) < 1e-4f &&
+             fabsf(data.accel_y + full_scale_g / 4) < 1e-4f &&
+             fabsf(data.accel_z - full_scale_g / 32768) < 1e-6f,
+         "accel %d: read %f %f %f g", accel, data.accel_x, data.accel_y,
+         data.accel_z);
+  EXPECT(fabsf(data.gyro_x - full_scale_dps / 2) < 1e-2f &&
+             fabsf(data.gyro_y + full_scale_dps / 4) < 1e-2f &&
+             fabsf(data.gyro_z - full_scale_dps / 32768) < 1e-4f,
+         "gyro %d: read %f %f %f dps", gyro, data.gyro_x, data.gyro_y,
+         data.gyro_z);
+}
+
+static void check_rejected(void) {
+  const mpu6050_config_t bad[] = {
+      {MPU6050_ACCEL_RANGE_16G + 1, MPU6050_GYRO_RANGE_250DPS,
+       MPU6050_DLPF_94HZ, 200},
+      {MPU6050_ACCEL_RANGE_2G, MPU6050_GYRO_RANGE_2000DPS + 1,
+       MPU6050_DLPF_94HZ, 200},
+      {MPU6050_ACCEL_RANGE_2G, MPU6050_GYRO_RANGE_250DPS,
+       MPU6050_DLPF_5HZ + 1, 200},
+  };
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    bus_reset();
+    EXPECT(mpu6050_configure(&bad[i]) == ESP_ERR_INVALID_ARG,
+           "bad config %zu accepted", i);
+    EXPECT(s_write_count == 0, "bad config %zu wrote %zu registers", i,
+           s_write_count);
+  }
+  bus_reset();
+  EXPECT(mpu6050_configure(NULL) == ESP_ERR_INVALID_ARG, "NULL accepted");
+
+  // A write that fails half-way keeps the previous scales
+  const mpu6050_config_t before = {MPU6050_ACCEL_RANGE_8G,
+                                   MPU6050_GYRO_RANGE_1000DPS,
+                                   MPU6050_DLPF_94HZ, 200};
+  const mpu6050_config_t after = {MPU6050_ACCEL_RANGE_2G,
+                                  MPU6050_GYRO_RANGE_250DPS,
+                                  MPU6050_DLPF_94HZ, 200};
+  bus_reset();
+  mpu6050_configure(&before);
+  s_fail_reg = MPU6050_ACCEL_CONFIG;
+  EXPECT(mpu6050_configure(&after) != ESP_OK, "failed write not reported");
+  EXPECT(mpu6050_get_accel_lsb_per_g() == 4096, "scale changed: %u LSB/g",
+         mpu6050_get_accel_lsb_per_g());
+}
+
+static void check_fifo_overflow(void) {
+  const mpu6050_config_t config = {MPU6050_ACCEL_RANGE_8G,
+                                   MPU6050_GYRO_RANGE_1000DPS,
+                                   MPU6050_DLPF_94HZ, 500};
+  const uint32_t period_us = 2000;
+  sensor_raw_t frames[MPU6050_FIFO_MAX_FRAMES];
+  size_t count;
+
+  bus_reset();
+  s_now_us = 1000000;
+  mpu6050_configure(&config);
+  mpu6050_fifo_enable();
+  uint32_t lost = mpu6050_fifo_get_lost_frames();
+
+  // Ten frames drained 20 ms after the reset; the newest is "now"
+  s_now_us += 20000;
+  set_fifo_count(10 * MPU6050_FIFO_FRAME_SIZE);
+  EXPECT(mpu6050_fifo_read(frames, MPU6050_FIFO_MAX_FRAMES, &count) ==
+                 ESP_OK &&
+             count == 10,
+         "FIFO drain returned %zu frames", count);
+
+  // Then 300 ms without a drain: 150 periods are gone
+  s_now_us += 300000;
+  set_fifo_count(MPU6050_FIFO_SIZE);
+  EXPECT(mpu6050_fifo_read(frames, MPU6050_FIFO_MAX_FRAMES, &count) ==
+             ESP_ERR_INVALID_STATE,
+         "full FIFO not reported");
+  uint32_t gap = mpu6050_fifo_get_lost_frames() - lost;
+  EXPECT(gap == 300000 / period_us, "overflow after 300 ms lost %u", gap);
+
+  // Full again soon after the reset: at least the FIFO contents are lost
+  lost = mpu6050_fifo_get_lost_frames();
+  s_now_us += 50000;
+  set_fifo_count(MPU6050_FIFO_SIZE);
+  mpu6050_fifo_read(frames, MPU6050_FIFO_MAX_FRAMES, &count);
+  gap = mpu6050_fifo_get_lost_frames() - lost;
+  EXPECT(gap == MPU6050_FIFO_MAX_FRAMES, "overflow after 50 ms lost %u", gap);
+  EXPECT(mpu6050_fifo_get_overflow_count() == 2, "%u overflows counted",
+         mpu6050_fifo_get_overflow_count());
+}
+
+static void check_calibration(void) {
+  const mpu6050_config_t config = {MPU6050_ACCEL_RANGE_8G,
+                                   MPU6050_GYRO_RANGE_1000DPS,
+                                   MPU6050_DLPF_94HZ, 200};
+  const int16_t g = 4096;
+  mpu6050_bias_t bias;
+
+  bus_reset();
+  mpu6050_configure(&config);
+  mpu6050_set_bias(NULL);
+
+  // Flat on its back with the zero-g offsets of a typical part
+  const int16_t flat[7] = {120, -200, g + 160, 0, 30, -15, 8};
+  set_raw(flat);
+  EXPECT(mpu6050_calibrate(32, &bias) == ESP_OK, "flat calibration refused");
+  EXPECT(bias.accel[0] == 120 && bias.accel[1] == -200 &&
+             bias.accel[2] == 160 && bias.gyro[0] == 30,
+         "flat: bias accel (%d, %d, %d) gyro %d", bias.accel[0],
+         bias.accel[1], bias.accel[2], bias.gyro[0]);
+
+  // Upside down, gravity is -1 g
+  const int16_t flipped[7] = {-40, 60, -g + 100, 0, 0, 0, 0};
+  set_raw(flipped);
+  EXPECT(mpu6050_calibrate(32, &bias) == ESP_OK &&
+             bias.accel[2] == 100,
+         "upside down: accel z bias %d", bias.accel[2]);
+
+  // Tilted 45 degrees about X: 0.7 g on Y and Z is not an offset
+  const mpu6050_bias_t kept = bias;
+  const int16_t tilted[7] = {0, 2896, 2896, 0, 0, 0, 0};
+  set_raw(tilted);
+  EXPECT(mpu6050_calibrate(32, NULL) == ESP_ERR_INVALID_STATE,
+         "45 degree tilt accepted");
+  mpu6050_get_bias(&bias);
+  EXPECT(memcmp(bias.accel, kept.accel, sizeof(bias.accel)) == 0,
+         "tilted run changed the bias");
+
+  // Flat but 0.3 g short of gravity: the sensor or the range is wrong
+  const int16_t weak[7] = {0, 0, g - 1229, 0, 0, 0, 0};
+  set_raw(weak);
+  EXPECT(mpu6050_calibrate(32, NULL) == ESP_ERR_INVALID_STATE,
+         "0.7 g gravity accepted");
+  mpu6050_set_bias(NULL);
+}
+
+int main(void) {
+  uint32_t configurations = 0;
+  for (int a = MPU6050_ACCEL_RANGE_2G; a <= MPU6050_ACCEL_RANGE_16G; a++) {
+    for (int g = MPU6050_GYRO_RANGE_250DPS; g <= MPU6050_GYRO_RANGE_2000DPS;
+         g++) {
+      for (int d = MPU6050_DLPF_260HZ; d <= MPU6050_DLPF_5HZ; d++) {
+        for (size_t r = 0; r < RATE_COUNT; r++) {
+          check_configuration((mpu6050_accel_range_t)a,
+                              (mpu6050_gyro_range_t)g, (mpu6050_dlpf_t)d,
+                              s_rates[r]);
+          configurations++;
+        }
+      }
+    }
+  }
+  check_rejected();
+  check_fifo_overflow();
+  check_calibration();
+
+  printf("%u configurations, rejections, FIFO overflow and calibration: "
+         "%d failures\n",
+         configurations, s_failures);
+  return s_failures != 0;
+}
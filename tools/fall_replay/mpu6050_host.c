@@ -0,0 +1,27 @@
+/**
+ * @file mpu6050_host.c
+ * @brief Host mocks for the MPU6050 driver calls reached by fall_logic.
+ *
+ * The pipeline itself never touches the bus; only fall_features_scale()
+ * asks the driver for the active sensitivity and conversion. The host
+ * build fixes both to the Kconfig range.
+ */
+
+#include "mpu6050.h"
+
+uint16_t mpu6050_get_accel_lsb_per_g(void) { return MPU6050_ACCEL_LSB_PER_G; }
+
+float mpu6050_get_gyro_lsb_per_dps(void) { return MPU6050_GYRO_LSB_PER_DPS; }
+
+void mpu6050_raw_to_data(const sensor_raw_t *raw, sensor_data_t *data) {
+  const float accel_scale = MPU6050_ACCEL_LSB_PER_G;
+  const float gyro_scale = MPU6050_GYRO_LSB_PER_DPS;
+
+  data->accel_x = raw->accel_x / accel_scale;
+  data->accel_y = raw->accel_y / accel_scale;
+  data->accel_z = raw->accel_z / accel_scale;
+
+  data->gyro_x = raw->gyro_x / gyro_scale;
+  data->gyro_y = raw->gyro_y / gyro_scale;
+  data->gyro_z = raw->gyro_z / gyro_scale;
+}
@@ -0,0 +1,355 @@
+/**
+ * @file orientation_bench.c
+ * @brief Accuracy and cost of the orientation filter on synthetic motion.
+ *
+ * Each scenario integrates an exact body rotation, synthesizes the IMU
+ * frames the MPU6050 would report (gravity, linear acceleration, noise,
+ * gyro bias, int16 quantization) and compares the filter's up vector with
+ * the true one. The cost benchmark then runs the filter over the frames
+ * repeatedly. The same source is built against the float and the fixed-
+ * point filter (orientation_bench, orientation_bench_fixed).
+ *
+ * Exit status 1 when a scenario's final error exceeds --max-error-deg.
+ */
+
+#include "orientation.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RATE_HZ 200
+#define PERIOD_US (1000000 / RATE_HZ)
+#define DEG (M_PI / 180.0)
+// Error at the end of a scenario is averaged over its last 100 ms
+#define FINAL_SAMPLES (RATE_HZ / 10)
+
+#if CONFIG_ORIENTATION_IMPL_FIXED
+#define IMPL_NAME "fixed point Q24"
+#else
+#define IMPL_NAME "float"
+#endif
+
+/**
+ * @brief Motion at time t: body rate (deg/s) and linear acceleration (g),
+ * both in the sensor frame.
+ * @return Fraction of gravity the sensor feels (about 0 in free-fall).
+ */
+typedef double (*motion_fn_t)(double t, double rate_dps[3], double lin_g[3]);
+
+typedef struct {
+  const char *name;
+  double duration_s;
+  double tilt_deg;       ///< Initial tilt about the X axis
+  double gyro_bias_dps;  ///< Bias added to every gyro axis
+  motion_fn_t motion;
+} scenario_t;
+
+typedef struct {
+  double rms_deg;
+  double max_deg;
+  double final_deg;
+} accuracy_t;
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+
+static double still(double t, double rate[3], double lin[3]) {
+  (void)t;
+  memset(rate, 0, 3 * sizeof(double));
+  memset(lin, 0, 3 * sizeof(double));
+  return 1.0;
+}
+
+/// Sideways roll onto the floor, 90 degrees in 0.5 s, accel valid throughout
+static double slow_roll(double t, double rate[3], double lin[3]) {
+  still(t, rate, lin);
+  if (t >= 1.0 && t < 1.5) {
+    rate[0] = 180.0;
+  }
+  return 1.0;
+}
+
+/// Forward fall: pitch through a free-fall, hit the floor, lie still
+static double forward_fall(double t, double rate[3], double lin[3]) {
+  still(t, rate, lin);
+  if (t >= 1.0 && t < 1.4) {
+    rate[1] = 225.0;
+    // Free-fall hides gravity; the filter must run on the gyro alone
+    return 0.1;
+  }
+  if (t >= 1.4 && t < 1.43) {
+    lin[2] = 3.0; // Impact
+    rate[0] = 120.0 * sin(t * 200.0);
+  }
+  return 1.0;
+}
+
+/// Spinning about the vertical axis; tilt must not change
+static double yaw_spin(double t, double rate[3], double lin[3]) {
+  still(t, rate, lin);
+  rate[2] = 360.0;
+  return 1.0;
+}
+
+/// Walking-like sway with bouncing vertical acceleration
+static double walking(double t, double rate[3], double lin[3]) {
+  still(t, rate, lin);
+  rate[0] = 40.0 * sin(2.0 * M_PI * 1.0 * t);
+  rate[1] = 25.0 * cos(2.0 * M_PI * 2.0 * t);
+  rate[2] = 15.0 * sin(2.0 * M_PI * 0.5 * t);
+  lin[2] = 0.3 * sin(2.0 * M_PI * 2.0 * t);
+  lin[0] = 0.1 * cos(2.0 * M_PI * 1.0 * t);
+  return 1.0;
+}
+
+static const scenario_t s_scenarios[] = {
+    {"still_tilted_bias", 20.0, 30.0, 2.0, still},
+    {"slow_roll", 4.0, 0.0, 0.0, slow_roll},
+    {"forward_fall", 4.0, 0.0, 0.5, forward_fall},
+    {"yaw_spin", 5.0, 10.0, 0.0, yaw_spin},
+    {"walking", 30.0, 0.0, 0.5, walking},
+};
+
+#define SCENARIO_COUNT (sizeof(s_scenarios) / sizeof(s_scenarios[0]))
+
+// ---------------------------------------------------------------------------
+// Synthesis
+// ---------------------------------------------------------------------------
+
+static double gaussian(unsigned int *seed) {
+  double u1 = (rand_r(seed) + 1.0) / ((double)RAND_MAX + 2.0);
+  double u2 = (rand_r(seed) + 1.0) / ((double)RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int16_t to_lsb(double value) {
+  double lsb = round(value);
+  if (lsb > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (lsb < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)lsb;
+}
+
+/**
+ * @brief Rotates @p u as a world-fixed vector seen from a body turning at
+ * @p rate_dps for @p dt seconds (Rodrigues, exact for a constant rate).
+ */
+static void rotate_exact(double u[3], const double rate_dps[3], double dt) {
+  double w = sqrt(rate_dps[0] * rate_dps[0] + rate_dps[1] * rate_dps[1] +
+                  rate_dps[2] * rate_dps[2]);
+  if (w == 0.0) {
+    return;
+  }
+  double k[3] = {rate_dps[0] / w, rate_dps[1] / w, rate_dps[2] / w};
+  double angle = -w * DEG * dt;
+  double c = cos(angle), s = sin(angle);
+  double kxu[3] = {k[1] * u[2] - k[2] * u[1], k[2] * u[0] - k[0] * u[2],
+                   k[0] * u[1] - k[1] * u[0]};
+  double kdu = k[0] * u[0] + k[1] * u[1] + k[2] * u[2];
+  for (int i = 0; i < 3; i++) {
+    u[i] = u[i] * c + kxu[i] * s + k[i] * kdu * (1.0 - c);
+  }
+}
+
+/**
+ * @brief Generates the frames of a scenario and the true up vector of each.
+ */
+static size_t synthesize(const scenario_t *sc, unsigned int seed,
+                         sensor_raw_t **frames_out, double **truth_out) {
+  const orientation_config_t config = ORIENTATION_DEFAULT_CONFIG();
+  const double accel_lsb = config.accel_lsb_per_g;
+  const double gyro_lsb = config.gyro_lsb_per_dps;
+
+  size_t count = (size_t)(sc->duration_s * RATE_HZ);
+  sensor_raw_t *frames = calloc(count, sizeof(*frames));
+  double *truth = calloc(count * 3, sizeof(double));
+  if (frames == NULL || truth == NULL) {
+    free(frames);
+    free(truth);
+    return 0;
+  }
+
+  double up[3] = {0.0, sin(sc->tilt_deg * DEG), cos(sc->tilt_deg * DEG)};
+  for (size_t n = 0; n < count; n++) {
+    double t = (double)n / RATE_HZ;
+    double rate[3], lin[3];
+    double gravity = sc->motion(t, rate, lin);
+    if (n > 0) {
+      // Rate held at its mid-step value over the step
+      double mid[3], unused[3];
+      sc->motion(t - 0.5 / RATE_HZ, mid, unused);
+      rotate_exact(up, mid, 1.0 / RATE_HZ);
+    }
+
+    sensor_raw_t *f = &frames[n];
+    f->timestamp_us = (uint32_t)(n * PERIOD_US);
+    f->accel_x = to_lsb((up[0] * gravity + lin[0] + 0.01 * gaussian(&seed)) *
+                        accel_lsb);
+    f->accel_y = to_lsb((up[1] * gravity + lin[1] + 0.01 * gaussian(&seed)) *
+                        accel_lsb);
+    f->accel_z = to_lsb((up[2] * gravity + lin[2] + 0.01 * gaussian(&seed)) *
+                        accel_lsb);
+    f->gyro_x = to_lsb((rate[0] + sc->gyro_bias_dps + 0.1 * gaussian(&seed)) *
+                       gyro_lsb);
+    f->gyro_y = to_lsb((rate[1] + sc->gyro_bias_dps + 0.1 * gaussian(&seed)) *
+                       gyro_lsb);
+    f->gyro_z = to_lsb((rate[2] + sc->gyro_bias_dps + 0.1 * gaussian(&seed)) *
+                       gyro_lsb);
+    memcpy(&truth[n * 3], up, sizeof(up));
+  }
+
+  *frames_out = frames;
+  *truth_out = truth;
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+// Measurements
+// ---------------------------------------------------------------------------
+
+static double angle_between_deg(const float est[3], const double truth[3]) {
+  double dot = est[0] * truth[0] + est[1] * truth[1] + est[2] * truth[2];
+  double norm = sqrt(est[0] * est[0] + est[1] * est[1] + est[2] * est[2]);
+  double c = dot / norm;
+  if (c > 1.0) {
+    c = 1.0;
+  } else if (c < -1.0) {
+    c = -1.0;
+  }
+  return acos(c) / DEG;
+}
+
+static accuracy_t measure_accuracy(const sensor_raw_t *frames,
+                                   const double *truth, size_t count) {
+  const orientation_config_t config = ORIENTATION_DEFAULT_CONFIG();
+  orientation_t filter;
+  orientation_init(&filter, &config);
+
+  accuracy_t acc = {0};
+  double sum_sq = 0.0, final_sum = 0.0;
+  for (size_t n = 0; n < count; n++) {
+    orientation_update(&filter, &frames[n]);
+    float est[3];
+    orientation_get_up(&filter, est);
+    double err = angle_between_deg(est, &truth[n * 3]);
+    sum_sq += err * err;
+    if (err > acc.max_deg) {
+      acc.max_deg = err;
+    }
+    if (n + FINAL_SAMPLES >= count) {
+      final_sum += err;
+    }
+  }
+  acc.rms_deg = sqrt(sum_sq / count);
+  acc.final_deg = final_sum / (count < FINAL_SAMPLES ? count : FINAL_SAMPLES);
+  return acc;
+}
+
+static double measure_cost_ns(const sensor_raw_t *frames, size_t count,
+                              size_t updates) {
+  const orientation_config_t config = ORIENTATION_DEFAULT_CONFIG();
+  orientation_t filter;
+  orientation_init(&filter, &config);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t done = 0; done < updates; done++) {
+    orientation_update(&filter, &frames[done % count]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  // Keep the result live so the loop is not optimized away
+  float up[3];
+  orientation_get_up(&filter, up);
+  if (up[0] > 2.0f) {
+    printf("unreachable\n");
+  }
+
+  double elapsed_ns =
+      (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+  return elapsed_ns / (double)updates;
+}
+
+int main(int argc, char **argv) {
+  enum { OPT_MAX_ERROR = 256 };
+  static const struct option options[] = {
+      {"updates", required_argument, NULL, 'n'},
+      {"max-error-deg", required_argument, NULL, OPT_MAX_ERROR},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  size_t updates = 10000000;
+  double max_error = -1.0;
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "n:h", options, NULL)) != -1) {
+    switch (opt) {
+    case 'n':
+      updates = strtoul(optarg, NULL, 10);
+      break;
+    case OPT_MAX_ERROR:
+      max_error = atof(optarg);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-n updates] [--max-error-deg X]\n"
+              "  -n, --updates N       filter updates timed (default "
+              "10000000)\n"
+              "      --max-error-deg X fail if a final error exceeds X\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  printf("orientation filter: %s, tau %d ms, gate %d mg\n", IMPL_NAME,
+         CONFIG_ORIENTATION_TIME_CONSTANT_MS, CONFIG_ORIENTATION_ACCEL_GATE_MG);
+  printf("%-18s %8s %8s %8s\n", "scenario", "rms_deg", "max_deg",
+         "final_deg");
+
+  int status = 0;
+  sensor_raw_t *bench_frames = NULL;
+  size_t bench_count = 0;
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    const scenario_t *sc = &s_scenarios[i];
+    sensor_raw_t *frames;
+    double *truth;
+    size_t count = synthesize(sc, (unsigned int)(i + 1), &frames, &truth);
+    if (count == 0) {
+      return 2;
+    }
+
+    accuracy_t acc = measure_accuracy(frames, truth, count);
+    printf("%-18s %8.2f %8.2f %8.2f\n", sc->name, acc.rms_deg, acc.max_deg,
+           acc.final_deg);
+    if (max_error >= 0 && acc.final_deg > max_error) {
+      fprintf(stderr, "FAIL: %s final error %.2f > %.2f deg\n", sc->name,
+              acc.final_deg, max_error);
+      status = 1;
+    }
+
+    free(truth);
+    // Time the filter on the most varied motion
+    if (sc->motion == walking) {
+      bench_frames = frames;
+      bench_count = count;
+    } else {
+      free(frames);
+    }
+  }
+
+  if (bench_frames != NULL && updates > 0) {
+    printf("cost: %.1f ns per update (%zu updates)\n",
+           measure_cost_ns(bench_frames, bench_count, updates), updates);
+  }
+  free(bench_frames);
+  return status;
+}
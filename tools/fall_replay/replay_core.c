@@ -0,0 +1,651 @@
+/**
+ * @file replay_core.c
+ * @brief Trace loading and replay through the firmware fall pipeline.
+ */
+
+#include "replay_core.h"
+#include "fall_capture.h"
+#include "fall_pipeline.h"
+#include <ctype.h>
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MS_TO_US(ms) ((uint64_t)(ms) * 1000u)
+
+// Alert sequence length in event_handler; falls are latched meanwhile
+#define DEFAULT_HOLDOFF_MS 8000
+#define DEFAULT_MATCH_MS 10000
+
+#define US_PER_HOUR 3600000000.0
+
+// ---------------------------------------------------------------------------
+// Trace lists
+// ---------------------------------------------------------------------------
+
+static int path_list_add(replay_path_list_t *list, const char *path) {
+  if (list->count == list->capacity) {
+    size_t cap = list->capacity ? list->capacity * 2 : 64;
+    char **items = realloc(list->items, cap * sizeof(*items));
+    if (items == NULL) {
+      return -1;
+    }
+    list->items = items;
+    list->capacity = cap;
+  }
+  list->items[list->count] = strdup(path);
+  return list->items[list->count++] != NULL ? 0 : -1;
+}
+
+static int compare_paths(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static bool is_trace_name(const char *name) {
+  const char *dot = strrchr(name, '.');
+  return dot != NULL && (strcmp(dot, ".csv") == 0 || strcmp(dot, ".bin") == 0);
+}
+
+int replay_path_list_collect(replay_path_list_t *list, const char *path) {
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    perror(path);
+    return -1;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    return path_list_add(list, path);
+  }
+
+  DIR *dir = opendir(path);
+  if (dir == NULL) {
+    perror(path);
+    return -1;
+  }
+  size_t first = list->count;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (!is_trace_name(entry->d_name)) {
+      continue;
+    }
+    char full[4096];
+    snprintf(full, sizeof(full), "%s/%s", path, entry->d_name);
+    if (path_list_add(list, full) != 0) {
+      closedir(dir);
+      return -1;
+    }
+  }
+  closedir(dir);
+
+  // Directory order is arbitrary; keep runs reproducible
+  qsort(&list->items[first], list->count - first, sizeof(char *),
+        compare_paths);
+  return 0;
+}
+
+void replay_path_list_free(replay_path_list_t *list) {
+  for (size_t i = 0; i < list->count; i++) {
+    free(list->items[i]);
+  }
+  free(list->items);
+  memset(list, 0, sizeof(*list));
+}
+
+// ---------------------------------------------------------------------------
+// Trace loading
+// ---------------------------------------------------------------------------
+
+static int read_file(const char *path, char **data, size_t *size) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    perror(path);
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (len < 0) {
+    fclose(f);
+    return -1;
+  }
+
+  *data = malloc((size_t)len + 1);
+  if (*data == NULL || fread(*data, 1, (size_t)len, f) != (size_t)len) {
+    fprintf(stderr, "%s: read failed\n", path);
+    free(*data);
+    fclose(f);
+    return -1;
+  }
+  (*data)[len] = '\0';
+  *size = (size_t)len;
+  fclose(f);
+  return 0;
+}
+
+static int reserve_frames(replay_trace_t *trace, size_t *capacity) {
+  if (trace->count < *capacity) {
+    return 0;
+  }
+  size_t cap = *capacity ? *capacity * 2 : 4096;
+  sensor_raw_t *frames = realloc(trace->frames, cap * sizeof(*frames));
+  if (frames == NULL) {
+    return -1;
+  }
+  trace->frames = frames;
+  uint64_t *time_us = realloc(trace->time_us, cap * sizeof(*time_us));
+  if (time_us == NULL) {
+    return -1;
+  }
+  trace->time_us = time_us;
+  *capacity = cap;
+  return 0;
+}
+
+static int add_onset(replay_trace_t *trace, uint64_t onset_us) {
+  uint64_t *onsets = realloc(trace->onsets_us, (trace->onset_count + 1) *
+                                                   sizeof(*onsets));
+  if (onsets == NULL) {
+    return -1;
+  }
+  onsets[trace->onset_count++] = onset_us;
+  trace->onsets_us = onsets;
+  return 0;
+}
+
+static bool key_is(const char *key, size_t key_len, const char *name) {
+  return strlen(name) == key_len && strncmp(key, name, key_len) == 0;
+}
+
+static int parse_comment(replay_trace_t *trace, const char *line) {
+  while (*line == '#' || *line == ' ') {
+    line++;
+  }
+  const char *eq = strchr(line, '=');
+  if (eq == NULL) {
+    return 0;
+  }
+  size_t key_len = (size_t)(eq - line);
+  const char *value = eq + 1;
+
+  if (key_is(line, key_len, "fall_onset_us")) {
+    return add_onset(trace, strtoull(value, NULL, 10));
+  } else if (key_is(line, key_len, "accel_lsb_per_g")) {
+    trace->accel_lsb_per_g = (uint32_t)strtoul(value, NULL, 10);
+  } else if (key_is(line, key_len, "gyro_lsb_per_dps")) {
+    trace->gyro_lsb_per_dps = strtof(value, NULL);
+  } else if (key_is(line, key_len, "sample_rate_hz")) {
+    trace->sample_rate_hz = (uint32_t)strtoul(value, NULL, 10);
+  }
+  return 0;
+}
+
+static int parse_csv(replay_trace_t *trace, char *text) {
+  size_t capacity = 0;
+  int line_no = 0;
+
+  char *next = text;
+  while (*next != '\0') {
+    // Split in place; strtok is not reentrant and loaders run in threads
+    char *line = next;
+    next += strcspn(next, "\n");
+    if (*next == '\n') {
+      *next++ = '\0';
+    }
+    line[strcspn(line, "\r")] = '\0';
+    line_no++;
+    while (*line == ' ' || *line == '\t') {
+      line++;
+    }
+    if (*line == '#') {
+      if (parse_comment(trace, line) != 0) {
+        return -1;
+      }
+      continue;
+    }
+    if (*line == '\0' || isalpha((unsigned char)*line)) {
+      continue; // Blank line or column header
+    }
+
+    char *p = line;
+    uint64_t t_us = strtoull(p, &p, 10);
+    long v[6];
+    for (int i = 0; i < 6; i++) {
+      if (*p != ',') {
+        fprintf(stderr, "%s:%d: expected 7 columns\n", trace->path, line_no);
+        return -1;
+      }
+      v[i] = strtol(p + 1, &p, 10);
+      if (v[i] < INT16_MIN || v[i] > INT16_MAX) {
+        fprintf(stderr, "%s:%d: value out of int16 range\n", trace->path,
+                line_no);
+        return -1;
+      }
+    }
+
+    if (reserve_frames(trace, &capacity) != 0) {
+      return -1;
+    }
+    trace->time_us[trace->count] = t_us;
+    trace->frames[trace->count++] = (sensor_raw_t){
+        .timestamp_us = (uint32_t)t_us,
+        .accel_x = (int16_t)v[0],
+        .accel_y = (int16_t)v[1],
+        .accel_z = (int16_t)v[2],
+        .gyro_x = (int16_t)v[3],
+        .gyro_y = (int16_t)v[4],
+        .gyro_z = (int16_t)v[5],
+    };
+  }
+  return 0;
+}
+
+static int parse_capture(replay_trace_t *trace, const char *data,
+                         size_t size) {
+  fall_capture_header_t header;
+  memcpy(&header, data, sizeof(header));
+  if (header.version != FALL_CAPTURE_VERSION ||
+      header.frame_size != sizeof(sensor_raw_t)) {
+    fprintf(stderr, "%s: unsupported capture version %u\n", trace->path,
+            header.version);
+    return -1;
+  }
+
+  size_t count = (size_t)header.pre_frames + header.post_frames;
+  if (size < sizeof(header) + count * sizeof(sensor_raw_t)) {
+    fprintf(stderr, "%s: truncated capture\n", trace->path);
+    return -1;
+  }
+
+  trace->frames = malloc(count * sizeof(sensor_raw_t));
+  trace->time_us = malloc(count * sizeof(uint64_t));
+  if (trace->frames == NULL || trace->time_us == NULL) {
+    return -1;
+  }
+  memcpy(trace->frames, data + sizeof(header), count * sizeof(sensor_raw_t));
+  trace->count = count;
+  trace->accel_lsb_per_g = header.accel_lsb_per_g;
+  trace->gyro_lsb_per_dps = header.gyro_lsb_per_dps_x10 / 10.0f;
+  trace->sample_rate_hz = header.sample_rate_hz;
+
+  // Unwrap the 32-bit sensor timestamps
+  uint64_t t = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) {
+      t += (uint32_t)(trace->frames[i].timestamp_us -
+                      trace->frames[i - 1].timestamp_us);
+    } else {
+      t = trace->frames[0].timestamp_us;
+    }
+    trace->time_us[i] = t;
+  }
+  return 0;
+}
+
+int replay_trace_load(const char *path, replay_trace_t *trace) {
+  memset(trace, 0, sizeof(*trace));
+  trace->path = strdup(path);
+  trace->accel_lsb_per_g = MPU6050_ACCEL_LSB_PER_G;
+  trace->gyro_lsb_per_dps = MPU6050_GYRO_LSB_PER_DPS;
+
+  char *data = NULL;
+  size_t size = 0;
+  if (trace->path == NULL || read_file(path, &data, &size) != 0) {
+    replay_trace_free(trace);
+    return -1;
+  }
+
+  uint32_t magic = 0;
+  if (size >= sizeof(magic)) {
+    memcpy(&magic, data, sizeof(magic));
+  }
+  int err = (magic == FALL_CAPTURE_MAGIC &&
+             size >= sizeof(fall_capture_header_t))
+                ? parse_capture(trace, data, size)
+                : parse_csv(trace, data);
+  free(data);
+
+  if (err == 0 && trace->count < 2) {
+    fprintf(stderr, "%s: fewer than two frames\n", path);
+    err = -1;
+  }
+  if (err != 0) {
+    replay_trace_free(trace);
+    return -1;
+  }
+
+  if (trace->sample_rate_hz == 0) {
+    uint64_t span = trace->time_us[trace->count - 1] - trace->time_us[0];
+    trace->sample_rate_hz =
+        span ? (uint32_t)((trace->count - 1) * 1000000ull / span) : 1;
+  }
+  return 0;
+}
+
+void replay_trace_free(replay_trace_t *trace) {
+  free(trace->path);
+  free(trace->frames);
+  free(trace->time_us);
+  free(trace->onsets_us);
+  memset(trace, 0, sizeof(*trace));
+}
+
+// ---------------------------------------------------------------------------
+// Parameters
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  const char *name;
+  size_t offset;
+  const char *kconfig; ///< Firmware option, NULL for replay-only settings
+} param_field_t;
+
+#define DETECTOR_FIELD(name, field, kconfig)                                   \
+  {name,                                                                       \
+   offsetof(replay_params_t, detector) +                                       \
+       offsetof(fall_detector_config_t, field),                                \
+   kconfig}
+#define RUN_FIELD(name, field, kconfig)                                        \
+  {name, offsetof(replay_params_t, field), kconfig}
+#define RATE_FIELD(name, field, kconfig)                                       \
+  {name,                                                                       \
+   offsetof(replay_params_t, rate) + offsetof(fall_rate_config_t, field),      \
+   kconfig}
+
+static const param_field_t s_fields[] = {
+    DETECTOR_FIELD("freefall_mg", freefall_threshold_mg,
+                   "CONFIG_FALL_LOGIC_THRESHOLD_G"),
+    DETECTOR_FIELD("freefall_min_ms", freefall_min_ms,
+                   "CONFIG_FALL_LOGIC_FREEFALL_MIN_MS"),
+    DETECTOR_FIELD("impact_mg", impact_threshold_mg,
+                   "CONFIG_FALL_LOGIC_IMPACT_THRESHOLD_MG"),
+    DETECTOR_FIELD("impact_window_ms", impact_window_ms,
+                   "CONFIG_FALL_LOGIC_IMPACT_WINDOW_MS"),
+    DETECTOR_FIELD("impact_only_mg", impact_only_mg,
+                   "CONFIG_FALL_LOGIC_IMPACT_ONLY_THRESHOLD_MG"),
+    DETECTOR_FIELD("settle_ms", settle_ms, "CONFIG_FALL_LOGIC_SETTLE_MS"),
+    DETECTOR_FIELD("inactivity_ms", inactivity_ms,
+                   "CONFIG_FALL_LOGIC_INACTIVITY_MS"),
+    DETECTOR_FIELD("inactivity_tolerance_mg", inactivity_tolerance_mg,
+                   "CONFIG_FALL_LOGIC_INACTIVITY_TOLERANCE_MG"),
+    DETECTOR_FIELD("orientation_deg", orientation_change_deg,
+                   "CONFIG_FALL_LOGIC_ORIENTATION_CHANGE_DEG"),
+    DETECTOR_FIELD("horizontal_deg", horizontal_min_deg,
+                   "CONFIG_FALL_LOGIC_HORIZONTAL_MIN_DEG"),
+    RUN_FIELD("window_ms", window_ms, "CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS"),
+    RUN_FIELD("holdoff_ms", holdoff_ms, NULL),
+    RUN_FIELD("match_ms", match_ms, NULL),
+    RUN_FIELD("classifier", classifier, "CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE"),
+    RUN_FIELD("adaptive", adaptive, "CONFIG_FALL_LOGIC_ADAPTIVE_RATE"),
+    RUN_FIELD("rate_medium_hz", rate_medium_hz,
+              "CONFIG_FALL_LOGIC_RATE_MEDIUM_HZ"),
+    RUN_FIELD("rate_low_hz", rate_low_hz, "CONFIG_FALL_LOGIC_RATE_LOW_HZ"),
+    RATE_FIELD("rate_active_std_mg", active_std_mg,
+               "CONFIG_FALL_LOGIC_RATE_ACTIVE_STD_MG"),
+    RATE_FIELD("rate_still_band_mg", still_band_mg,
+               "CONFIG_FALL_LOGIC_RATE_STILL_BAND_MG"),
+    RATE_FIELD("rate_high_hold_ms", high_hold_ms,
+               "CONFIG_FALL_LOGIC_RATE_HIGH_HOLD_MS"),
+    RATE_FIELD("rate_still_ms", still_ms, "CONFIG_FALL_LOGIC_RATE_STILL_MS"),
+};
+
+static const param_field_t *find_field(const char *name, size_t name_len) {
+  for (size_t i = 0; i < sizeof(s_fields) / sizeof(s_fields[0]); i++) {
+    if (strlen(s_fields[i].name) == name_len &&
+        strncmp(s_fields[i].name, name, name_len) == 0) {
+      return &s_fields[i];
+    }
+  }
+  return NULL;
+}
+
+void replay_params_default(replay_params_t *params) {
+  *params = (replay_params_t){
+      .detector = FALL_DETECTOR_DEFAULT_CONFIG(),
+      .window_ms = CONFIG_FALL_LOGIC_FEATURE_WINDOW_MS,
+      .holdoff_ms = DEFAULT_HOLDOFF_MS,
+      .match_ms = DEFAULT_MATCH_MS,
+#if CONFIG_FALL_LOGIC_CLASSIFIER_ENABLE
+      .classifier = 1,
+#endif
+#if CONFIG_FALL_LOGIC_ADAPTIVE_RATE
+      .adaptive = 1,
+#endif
+      .rate_medium_hz = CONFIG_FALL_LOGIC_RATE_MEDIUM_HZ,
+      .rate_low_hz = CONFIG_FALL_LOGIC_RATE_LOW_HZ,
+      .rate = FALL_RATE_DEFAULT_CONFIG(),
+  };
+}
+
+int replay_params_set(replay_params_t *params, const char *assignment) {
+  const char *eq = strchr(assignment, '=');
+  if (eq == NULL) {
+    return -1;
+  }
+  size_t name_len = (size_t)(eq - assignment);
+  char *end;
+  unsigned long value = strtoul(eq + 1, &end, 10);
+  if (end == eq + 1 || *end != '\0' || value > UINT32_MAX) {
+    return -1;
+  }
+
+  const param_field_t *field = find_field(assignment, name_len);
+  if (field == NULL) {
+    return -1;
+  }
+  *(uint32_t *)((char *)params + field->offset) = (uint32_t)value;
+  return 0;
+}
+
+const char *replay_params_kconfig_name(const char *name) {
+  const param_field_t *field = find_field(name, strlen(name));
+  return field != NULL ? field->kconfig : NULL;
+}
+
+void replay_params_print_names(FILE *out) {
+  replay_params_t defaults;
+  replay_params_default(&defaults);
+  for (size_t i = 0; i < sizeof(s_fields) / sizeof(s_fields[0]); i++) {
+    uint32_t value = 0;
+    memcpy(&value, (const char *)&defaults + s_fields[i].offset,
+           sizeof(value));
+    fprintf(out, "  %-24s (default %u)\n", s_fields[i].name, value);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Replay
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Matches a detection to the first pending onset before it.
+ * @return Latency in microseconds, or -1 if no onset matches.
+ */
+static int64_t match_onset(const replay_trace_t *trace, bool *matched,
+                           uint64_t time_us, uint64_t match_us) {
+  for (size_t i = 0; i < trace->onset_count; i++) {
+    uint64_t onset = trace->onsets_us[i];
+    if (!matched[i] && onset <= time_us && time_us - onset <= match_us) {
+      matched[i] = true;
+      return (int64_t)(time_us - onset);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Frame period of a rate tier, 0 to keep every frame.
+ */
+static uint64_t tier_period_us(const replay_params_t *params,
+                               fall_rate_tier_t tier) {
+  uint32_t hz = 0;
+  if (tier == FALL_RATE_MEDIUM) {
+    hz = params->rate_medium_hz;
+  } else if (tier == FALL_RATE_LOW) {
+    hz = params->rate_low_hz;
+  }
+  return hz ? 1000000u / hz : 0;
+}
+
+void replay_run(const replay_trace_t *trace, const replay_params_t *params,
+                replay_detection_cb_t cb, void *arg, replay_result_t *result) {
+  memset(result, 0, sizeof(*result));
+  result->traces = 1;
+  result->duration_us = trace->time_us[trace->count - 1] - trace->time_us[0];
+  result->falls = (uint32_t)trace->onset_count;
+  result->negatives = trace->onset_count == 0;
+
+  fall_detector_config_t config = params->detector;
+  config.accel_lsb_per_g = trace->accel_lsb_per_g;
+  config.gyro_lsb_per_dps = trace->gyro_lsb_per_dps;
+
+  uint64_t window = (uint64_t)params->window_ms * trace->sample_rate_hz / 1000;
+  if (window < 1) {
+    window = 1;
+  } else if (window > FALL_FEATURES_MAX_WINDOW) {
+    window = FALL_FEATURES_MAX_WINDOW;
+  }
+
+  // Large (window storage), keep it off small thread stacks
+  fall_pipeline_t *pipeline = malloc(sizeof(*pipeline));
+  bool *matched = calloc(trace->onset_count + 1, sizeof(bool));
+  if (pipeline == NULL || matched == NULL) {
+    free(pipeline);
+    free(matched);
+    return;
+  }
+  fall_pipeline_init(pipeline, (uint32_t)window, &config);
+  fall_pipeline_set_classifier(pipeline, params->classifier != 0);
+
+  fall_rate_config_t rate_config = params->rate;
+  rate_config.freefall_mg = config.freefall_threshold_mg;
+  rate_config.accel_lsb_per_g = config.accel_lsb_per_g;
+  fall_rate_t rate;
+  fall_rate_init(&rate, &rate_config);
+  // Frames closer than half a trace period to the tier period still count
+  uint64_t slack_us = 500000u / trace->sample_rate_hz;
+  uint64_t last_kept_us = 0;
+
+  bool latched = false;
+  uint64_t latched_until = 0;
+  size_t pos = 0;
+  while (pos < trace->count) {
+    // Adaptive runs feed the frames the sensor would produce one at a time
+    const sensor_raw_t *frames = &trace->frames[pos];
+    size_t n = trace->count - pos;
+    sensor_raw_t frame;
+    if (params->adaptive) {
+      fall_rate_tier_t tier = fall_rate_get_tier(&rate);
+      uint64_t t = trace->time_us[pos];
+      uint64_t period_us = tier_period_us(params, tier);
+      if (pos > 0 && t - last_kept_us + slack_us < period_us) {
+        pos++;
+        continue;
+      }
+      last_kept_us = t;
+      frame = trace->frames[pos];
+      if (tier == FALL_RATE_LOW) {
+        frame.gyro_x = frame.gyro_y = frame.gyro_z = 0;
+      }
+      frames = &frame;
+      n = 1;
+    }
+
+    size_t hit = fall_pipeline_process(pipeline, frames, n);
+    if (params->adaptive) {
+      fall_rate_update(&rate, fall_pipeline_features(pipeline),
+                       fall_pipeline_is_idle(pipeline));
+    }
+    if (hit == n) {
+      pos += n;
+      continue;
+    }
+    size_t index = pos + hit;
+    pos = index + 1;
+
+    // The firmware ignores detections while the alert sequence runs
+    uint64_t t = trace->time_us[index];
+    if (latched && t < latched_until) {
+      continue;
+    }
+    latched = true;
+    latched_until = t + MS_TO_US(params->holdoff_ms);
+
+    int64_t latency = match_onset(trace, matched, t, MS_TO_US(params->match_ms));
+    if (latency < 0) {
+      result->false_positives++;
+    } else {
+      result->detected++;
+      result->latency_sum_us += (uint64_t)latency;
+      if ((uint64_t)latency > result->latency_max_us) {
+        result->latency_max_us = (uint64_t)latency;
+      }
+    }
+    if (cb != NULL) {
+      cb(trace, t, latency, fall_pipeline_candidate(pipeline), arg);
+    }
+  }
+
+  result->true_negatives =
+      result->negatives && result->false_positives == 0;
+  if (params->adaptive) {
+    const fall_rate_stats_t *stats = fall_rate_get_stats(&rate);
+    memcpy(result->rate_time_us, stats->time_us, sizeof(stats->time_us));
+    result->rate_switches = stats->switches;
+  }
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  fall_pipeline_shadow_flush(pipeline);
+  const fall_shadow_t *shadow = fall_pipeline_shadow(pipeline);
+  result->authoritative = fall_shadow_get_authoritative(shadow);
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    result->shadow[v] = *fall_shadow_get_stats(shadow, v);
+  }
+#endif
+  free(matched);
+  free(pipeline);
+}
+
+void replay_result_add(replay_result_t *dst, const replay_result_t *src) {
+  dst->traces += src->traces;
+  dst->duration_us += src->duration_us;
+  dst->negatives += src->negatives;
+  dst->true_negatives += src->true_negatives;
+  dst->falls += src->falls;
+  dst->detected += src->detected;
+  dst->false_positives += src->false_positives;
+  dst->latency_sum_us += src->latency_sum_us;
+  if (src->latency_max_us > dst->latency_max_us) {
+    dst->latency_max_us = src->latency_max_us;
+  }
+  for (int i = 0; i < FALL_RATE_TIERS; i++) {
+    dst->rate_time_us[i] += src->rate_time_us[i];
+  }
+  dst->rate_switches += src->rate_switches;
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  dst->authoritative = src->authoritative;
+  for (int v = 0; v < FALL_VARIANTS; v++) {
+    fall_shadow_stats_t *d = &dst->shadow[v];
+    const fall_shadow_stats_t *s = &src->shadow[v];
+    d->events += s->events;
+    d->agreed += s->agreed;
+    d->shadow_only += s->shadow_only;
+    d->missed += s->missed;
+    d->cycles += s->cycles;
+  }
+#endif
+}
+
+double replay_result_sensitivity(const replay_result_t *result) {
+  return result->falls ? (double)result->detected / result->falls : -1.0;
+}
+
+double replay_result_specificity(const replay_result_t *result) {
+  return result->negatives
+             ? (double)result->true_negatives / result->negatives
+             : -1.0;
+}
+
+double replay_result_fp_per_hour(const replay_result_t *result) {
+  double hours = result->duration_us / US_PER_HOUR;
+  return hours > 0 ? result->false_positives / hours : 0.0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file replay_core.h
+ * @brief Trace loading and replay through the firmware fall pipeline.
+ *
+ * Traces are replayed through fall_pipeline, the same code the fall task
+ * runs, and detections are matched against labelled fall onsets. Replay
+ * functions are reentrant, so several threads may replay traces at once.
+ *
+ * Trace formats:
+ *  - CSV: one frame per line, "t_us,ax,ay,az,gx,gy,gz" in raw sensor LSB.
+ *    Lines starting with a letter are headers and skipped. Comment lines
+ *    carry metadata: "# accel_lsb_per_g=4096", "# gyro_lsb_per_dps=32.8",
+ *    "# sample_rate_hz=200" and one "# fall_onset_us=<t>" per labelled fall.
+ *  - Binary: a blob published by the fall_capture component. Captures
+ *    carry no labels; use them for false-positive runs.
+ *
+ * @author Hao Tran
+ * @date 2025
+ */
+#ifndef _REPLAY_CORE_H_
+#define _REPLAY_CORE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fall_classifier.h"
+#include "fall_detector.h"
+#include "fall_rate.h"
+#include "fall_shadow.h"
+#include "mpu6050.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief A trace loaded in memory.
+ */
+typedef struct {
+  char *path;
+  sensor_raw_t *frames;     ///< Frames; timestamps truncated to 32 bits
+  uint64_t *time_us;        ///< Full timestamp of each frame
+  size_t count;             ///< Number of frames
+  uint64_t *onsets_us;      ///< Labelled fall onsets
+  size_t onset_count;       ///< Number of labelled falls
+  uint32_t accel_lsb_per_g; ///< Accelerometer scale
+  float gyro_lsb_per_dps;   ///< Gyroscope scale
+  uint32_t sample_rate_hz;  ///< Declared or estimated sample rate
+} replay_trace_t;
+
+/**
+ * @brief Parameters of one replay run.
+ */
+typedef struct {
+  fall_detector_config_t detector; ///< Sensor scales are taken per trace
+  uint32_t window_ms;              ///< Feature window length
+  uint32_t holdoff_ms;             ///< Alert latch after a detection
+  uint32_t match_ms;               ///< Max delay from onset to detection
+  uint32_t classifier;             ///< Candidates need the model's vote
+  uint32_t adaptive;               ///< Decimate frames as the rate policy says
+  uint32_t rate_medium_hz;         ///< Rate of the medium tier
+  uint32_t rate_low_hz;            ///< Rate of the low (cycle mode) tier
+  fall_rate_config_t rate;         ///< Free-fall and scale taken per trace
+} replay_params_t;
+
+/**
+ * @brief Outcome of a replay, summed over traces with replay_result_add().
+ *
+ * Traces without labelled falls are the negatives: one counts as a true
+ * negative when it produced no detection at all. The rate fields are only
+ * filled by adaptive runs.
+ */
+typedef struct {
+  uint32_t traces;
+  uint64_t duration_us;
+  uint32_t negatives;       ///< Traces without labelled falls
+  uint32_t true_negatives;  ///< Negatives without any detection
+  uint32_t falls;           ///< Labelled onsets
+  uint32_t detected;        ///< Onsets followed by a detection in time
+  uint32_t false_positives; ///< Detections not matched to an onset
+  uint64_t latency_sum_us;  ///< Over detected onsets
+  uint64_t latency_max_us;
+  uint64_t rate_time_us[FALL_RATE_TIERS]; ///< Time spent in each tier
+  uint32_t rate_switches;                 ///< Tier changes
+#if CONFIG_FALL_LOGIC_SHADOW_ENABLE
+  fall_variant_t authoritative;              ///< Variant that was reported
+  fall_shadow_stats_t shadow[FALL_VARIANTS]; ///< Per-variant agreement
+#endif
+} replay_result_t;
+
+/**
+ * @brief List of trace paths.
+ */
+typedef struct {
+  char **items;
+  size_t count;
+  size_t capacity;
+} replay_path_list_t;
+
+/**
+ * @brief Called for each detection during a replay.
+ *
+ * @param time_us Timestamp of the frame on which the fall was confirmed.
+ * @param latency_us Delay from the matched onset, or -1 for a false
+ * positive.
+ * @param candidate Classifier inputs and score of the detection.
+ */
+typedef void (*replay_detection_cb_t)(
+    const replay_trace_t *trace, uint64_t time_us, int64_t latency_us,
+    const fall_classifier_result_t *candidate, void *arg);
+
+/**
+ * @brief Adds a trace, or every *.csv / *.bin file of a directory in name
+ * order.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int replay_path_list_collect(replay_path_list_t *list, const char *path);
+
+/**
+ * @brief Frees the paths held by a list.
+ */
+void replay_path_list_free(replay_path_list_t *list);
+
+/**
+ * @brief Loads a CSV trace or a fall_capture blob.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int replay_trace_load(const char *path, replay_trace_t *trace);
+
+/**
+ * @brief Frees memory held by a trace.
+ */
+void replay_trace_free(replay_trace_t *trace);
+
+/**
+ * @brief Fills @p params with the Kconfig defaults of the host build.
+ */
+void replay_params_default(replay_params_t *params);
+
+/**
+ * @brief Sets one parameter from a "name=value" assignment.
+ * @return 0 on success, -1 if the name is unknown or the value invalid.
+ */
+int replay_params_set(replay_params_t *params, const char *assignment);
+
+/**
+ * @brief Writes the parameter names accepted by replay_params_set().
+ */
+void replay_params_print_names(FILE *out);
+
+/**
+ * @brief Kconfig option that sets a parameter's firmware default.
+ * @return Option name, or NULL for replay-only parameters.
+ */
+const char *replay_params_kconfig_name(const char *name);
+
+/**
+ * @brief Replays one trace.
+ *
+ * Adaptive runs emulate the firmware's rate tiers by dropping frames: the
+ * high tier keeps every frame of the trace, the others keep one frame per
+ * tier period, and frames taken in the low tier have no gyro data, as in
+ * cycle mode.
+ *
+ * @param trace Trace to replay.
+ * @param params Run parameters.
+ * @param cb Optional detection callback.
+ * @param arg Passed to @p cb.
+ * @param[out] result Result of this trace alone.
+ */
+void replay_run(const replay_trace_t *trace, const replay_params_t *params,
+                replay_detection_cb_t cb, void *arg, replay_result_t *result);
+
+/**
+ * @brief Adds @p src into @p dst.
+ */
+void replay_result_add(replay_result_t *dst, const replay_result_t *src);
+
+/**
+ * @brief Detected labelled falls / labelled falls, or -1 without falls.
+ */
+double replay_result_sensitivity(const replay_result_t *result);
+
+/**
+ * @brief True negatives / negatives, or -1 without negative traces.
+ */
+double replay_result_specificity(const replay_result_t *result);
+
+/**
+ * @brief False positives per hour of replayed data.
+ */
+double replay_result_fp_per_hour(const replay_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _REPLAY_CORE_H_
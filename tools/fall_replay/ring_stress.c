@@ -0,0 +1,270 @@
+/**
+ * @file ring_stress.c
+ * @brief Sample ring under one producer thread and several reader threads.
+ *
+ * The producer pushes frames whose fields are all derived from their
+ * sequence number, in single pushes and batches of random size, as fast
+ * as it can. Each reader peeks spans, checks every frame against the
+ * sequence number its cursor predicts and validates the span with
+ * sample_ring_consume(), at its own pace so some readers are lapped and
+ * some spans are overwritten while they are read. The head starts just
+ * below the 32-bit wrap so the run crosses it.
+ *
+ * A reader fails when consume accepts a span holding a torn or wrong
+ * frame, when it reports fewer overwritten frames than the reader saw,
+ * when a skip is missing from the overrun counters, or when the frames
+ * consumed and skipped do not add up to the frames pushed.
+ * Exit status 1 on any failure.
+ */
+
+#include "sample_ring.h"
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_READERS 16
+#define MAX_BATCH 32
+
+typedef struct {
+  sample_ring_reader_t reader;
+  uint32_t seed;
+  uint32_t spin;  ///< Busy work per frame, to make the reader slow
+  uint32_t pause; ///< 1 in pause frames yields mid-span, 0 never
+  uint64_t consumed;     ///< Frames released with consume, intact or not
+  uint64_t skipped;      ///< Frames a lapped peek jumped over
+  uint64_t intact;       ///< Frames in spans consume accepted
+  uint64_t bad_accepted; ///< Torn or wrong frames in accepted spans
+  uint64_t bad_rejected; ///< Torn or wrong frames in rejected spans
+  uint64_t under_reported; ///< Rejected spans with more bad frames than lost
+  uint64_t rejected;     ///< Spans consume reported as overwritten
+} reader_ctx_t;
+
+static sample_ring_t s_ring;
+static sensor_raw_t *s_storage;
+static uint32_t s_start;
+static uint64_t s_pushes = 4000000;
+static atomic_bool s_producer_done;
+static volatile uint32_t s_sink;
+
+static uint32_t xorshift(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static void make_frame(uint32_t seq, sensor_raw_t *f) {
+  f->timestamp_us = seq;
+  f->accel_x = (int16_t)seq;
+  f->accel_y = (int16_t)(seq >> 16);
+  f->accel_z = (int16_t)(seq * 2654435761u >> 16);
+  f->gyro_x = (int16_t)~seq;
+  f->gyro_y = (int16_t)~(seq >> 16);
+  f->gyro_z = (int16_t)(seq ^ 0x5a5a);
+}
+
+static bool frame_is(const sensor_raw_t *f, uint32_t seq) {
+  sensor_raw_t want;
+  make_frame(seq, &want);
+  return f->timestamp_us == want.timestamp_us && f->accel_x == want.accel_x &&
+         f->accel_y == want.accel_y && f->accel_z == want.accel_z &&
+         f->gyro_x == want.gyro_x && f->gyro_y == want.gyro_y &&
+         f->gyro_z == want.gyro_z;
+}
+
+static void *producer_thread(void *arg) {
+  (void)arg;
+  uint32_t seed = 0x9e3779b9u;
+  sensor_raw_t batch[MAX_BATCH];
+  uint32_t seq = s_start;
+  for (uint64_t pushed = 0; pushed < s_pushes;) {
+    uint32_t count = xorshift(&seed) % MAX_BATCH + 1;
+    if (count > s_pushes - pushed) {
+      count = (uint32_t)(s_pushes - pushed);
+    }
+    if (count == 1) {
+      make_frame(seq, &batch[0]);
+      sample_ring_push(&s_ring, &batch[0]);
+    } else {
+      for (uint32_t i = 0; i < count; i++) {
+        make_frame(seq + i, &batch[i]);
+      }
+      sample_ring_push_batch(&s_ring, batch, count);
+    }
+    seq += count;
+    pushed += count;
+    // Let the readers in now and then, as the fall task would
+    if ((xorshift(&seed) & 15) == 0) {
+      sched_yield();
+    }
+  }
+  atomic_store(&s_producer_done, true);
+  return NULL;
+}
+
+static void *reader_thread(void *arg) {
+  reader_ctx_t *ctx = arg;
+  sample_ring_reader_t *r = &ctx->reader;
+  while (true) {
+    const sensor_raw_t *frames;
+    uint32_t cursor = r->cursor;
+    size_t available = sample_ring_peek(r, &frames);
+    ctx->skipped += r->cursor - cursor;
+    if (available == 0) {
+      if (atomic_load(&s_producer_done) && sample_ring_available(r) == 0) {
+        break;
+      }
+      sched_yield();
+      continue;
+    }
+
+    size_t count = xorshift(&ctx->seed) % available + 1;
+    uint32_t first = r->cursor;
+    uint32_t bad = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (!frame_is(&frames[i], first + (uint32_t)i)) {
+        bad++;
+      }
+      for (uint32_t n = 0; n < ctx->spin; n++) {
+        s_sink += n;
+      }
+      // Give the producer a chance to overwrite the rest of the span
+      if (ctx->pause != 0 && xorshift(&ctx->seed) % ctx->pause == 0) {
+        sched_yield();
+      }
+    }
+
+    uint32_t lost_before = r->overrun_frames;
+    ctx->consumed += count;
+    if (sample_ring_consume(r, count)) {
+      ctx->intact += count;
+      ctx->bad_accepted += bad;
+    } else {
+      ctx->rejected++;
+      ctx->bad_rejected += bad;
+      if (bad > r->overrun_frames - lost_before) {
+        ctx->under_reported++;
+      }
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  static const struct option options[] = {
+      {"pushes", required_argument, NULL, 'n'},
+      {"readers", required_argument, NULL, 'r'},
+      {"capacity", required_argument, NULL, 'c'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  uint32_t readers = 4;
+  uint32_t capacity = 256;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "n:r:c:h", options, NULL)) != -1) {
+    switch (opt) {
+    case 'n':
+      s_pushes = strtoull(optarg, NULL, 10);
+      break;
+    case 'r':
+      readers = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    case 'c':
+      capacity = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-n pushes] [-r readers] [-c capacity]\n"
+              "  -n, --pushes N     frames pushed (default 4000000)\n"
+              "  -r, --readers N    reader threads, 1-%d (default 4)\n"
+              "  -c, --capacity N   ring frames, power of two (default 256)\n",
+              argv[0], MAX_READERS);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (readers == 0 || readers > MAX_READERS) {
+    fprintf(stderr, "readers must be 1-%d\n", MAX_READERS);
+    return 2;
+  }
+
+  s_storage = calloc(capacity, sizeof(*s_storage));
+  if (s_storage == NULL ||
+      sample_ring_init(&s_ring, s_storage, capacity) != ESP_OK) {
+    fprintf(stderr, "cannot create a ring of %u frames\n", capacity);
+    return 2;
+  }
+  // Cross the 32-bit sequence wrap halfway through the run
+  s_start = (uint32_t)(0u - (uint32_t)(s_pushes / 2));
+  atomic_store(&s_ring.head, s_start);
+
+  reader_ctx_t ctx[MAX_READERS] = {0};
+  pthread_t threads[MAX_READERS + 1];
+  for (uint32_t i = 0; i < readers; i++) {
+    sample_ring_reader_init(&ctx[i].reader, &s_ring, "stress");
+    ctx[i].seed = 0x2545f491u * (i + 1);
+    // Reader 0 runs flat out, the others are slower and are preempted
+    // inside their spans more and more often
+    ctx[i].spin = i * 16;
+    ctx[i].pause = i == 0 ? 0 : 256 >> i;
+  }
+  for (uint32_t i = 0; i < readers; i++) {
+    pthread_create(&threads[i + 1], NULL, reader_thread, &ctx[i]);
+  }
+  pthread_create(&threads[0], NULL, producer_thread, NULL);
+  for (uint32_t i = 0; i <= readers; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  printf("%llu pushes, ring of %u frames, %u readers\n",
+         (unsigned long long)s_pushes, capacity, readers);
+  printf("%-7s %10s %10s %9s %8s %9s %9s\n", "reader", "intact", "overrun",
+         "events", "rejected", "bad_seen", "bad_kept");
+
+  int status = 0;
+  for (uint32_t i = 0; i < readers; i++) {
+    const reader_ctx_t *c = &ctx[i];
+    const sample_ring_reader_t *r = &c->reader;
+    printf("%-7u %10llu %10u %9u %8llu %9llu %9llu\n", i,
+           (unsigned long long)c->intact, r->overrun_frames,
+           r->overrun_events, (unsigned long long)c->rejected,
+           (unsigned long long)(c->bad_accepted + c->bad_rejected),
+           (unsigned long long)c->bad_accepted);
+
+    if (c->bad_accepted != 0) {
+      fprintf(stderr, "FAIL: reader %u accepted %llu torn frames\n", i,
+              (unsigned long long)c->bad_accepted);
+      status = 1;
+    }
+    if (c->under_reported != 0) {
+      fprintf(stderr, "FAIL: reader %u: %llu spans under-reported\n", i,
+              (unsigned long long)c->under_reported);
+      status = 1;
+    }
+    if (r->cursor != s_start + (uint32_t)s_pushes) {
+      fprintf(stderr, "FAIL: reader %u stopped at %u, head %u\n", i,
+              r->cursor, s_start + (uint32_t)s_pushes);
+      status = 1;
+    }
+    if (c->consumed + c->skipped != s_pushes) {
+      fprintf(stderr, "FAIL: reader %u accounted %llu of %llu frames\n", i,
+              (unsigned long long)(c->consumed + c->skipped),
+              (unsigned long long)s_pushes);
+      status = 1;
+    }
+    // Every skipped frame is an overrun; rejected spans add at most their
+    // own length
+    if (r->overrun_frames < c->skipped ||
+        r->overrun_frames - c->skipped > c->consumed - c->intact) {
+      fprintf(stderr, "FAIL: reader %u overrun %u, skipped %llu\n", i,
+              r->overrun_frames, (unsigned long long)c->skipped);
+      status = 1;
+    }
+  }
+  free(s_storage);
+  return status;
+}
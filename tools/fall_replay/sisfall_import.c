@@ -0,0 +1,265 @@
+/**
+ * @file sisfall_import.c
+ * @brief Converts SisFall recordings into fall_replay CSV traces.
+ *
+ * SisFall trials are text files named like F05_SA01_R01.txt (F = fall,
+ * D = activity of daily living), sampled at 200 Hz. Each line holds nine
+ * raw readings ending in ';': ADXL345 accel (+-16 g, 13 bit), ITG3200 gyro
+ * (+-2000 deg/s, 16 bit) and MMA8451Q accel. The first two sensors are
+ * converted to MPU6050 LSB at the chosen ranges, clipped to int16.
+ *
+ * SisFall does not label the fall instant. For F trials the onset is
+ * estimated as the start of the low-g phase before the largest impact, or
+ * 300 ms before the impact if there is none; latency figures on imported
+ * data are relative to that estimate.
+ */
+
+#include <dirent.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define SISFALL_RATE_HZ 200
+#define SISFALL_PERIOD_US (1000000 / SISFALL_RATE_HZ)
+#define ADXL345_G_PER_LSB (32.0 / 8192.0)
+#define ITG3200_DPS_PER_LSB (4000.0 / 65536.0)
+
+// Onset estimation
+#define LOW_G 0.6
+#define LOW_G_SEARCH_US 1000000
+#define FALLBACK_LEAD_US 300000
+
+typedef struct {
+  double accel_g[3];
+  double gyro_dps[3];
+} sisfall_sample_t;
+
+static uint32_t s_accel_lsb_per_g = 4096; // +-8 g
+static double s_gyro_lsb_per_dps = 32.8;  // +-1000 deg/s
+
+static int16_t to_lsb(double value, double scale) {
+  double lsb = round(value * scale);
+  if (lsb > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (lsb < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)lsb;
+}
+
+static double magnitude(const sisfall_sample_t *s) {
+  return sqrt(s->accel_g[0] * s->accel_g[0] + s->accel_g[1] * s->accel_g[1] +
+              s->accel_g[2] * s->accel_g[2]);
+}
+
+static size_t read_samples(FILE *in, sisfall_sample_t **out) {
+  size_t count = 0, capacity = 0;
+  sisfall_sample_t *samples = NULL;
+  char line[256];
+
+  while (fgets(line, sizeof(line), in) != NULL) {
+    long v[6];
+    if (sscanf(line, " %ld , %ld , %ld , %ld , %ld , %ld", &v[0], &v[1],
+               &v[2], &v[3], &v[4], &v[5]) != 6) {
+      continue;
+    }
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 4096;
+      sisfall_sample_t *grown = realloc(samples, capacity * sizeof(*grown));
+      if (grown == NULL) {
+        free(samples);
+        return 0;
+      }
+      samples = grown;
+    }
+    for (int i = 0; i < 3; i++) {
+      samples[count].accel_g[i] = v[i] * ADXL345_G_PER_LSB;
+      samples[count].gyro_dps[i] = v[3 + i] * ITG3200_DPS_PER_LSB;
+    }
+    count++;
+  }
+  *out = samples;
+  return count;
+}
+
+/**
+ * @brief Estimates the fall onset from the impact and the low-g phase.
+ */
+static uint64_t estimate_onset(const sisfall_sample_t *samples,
+                               size_t count) {
+  size_t peak = 0;
+  double peak_mag = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    double mag = magnitude(&samples[i]);
+    if (mag > peak_mag) {
+      peak_mag = mag;
+      peak = i;
+    }
+  }
+
+  size_t window = LOW_G_SEARCH_US / SISFALL_PERIOD_US;
+  size_t start = peak > window ? peak - window : 0;
+  size_t i = peak;
+  // Latest low-g sample before the impact...
+  while (i > start && magnitude(&samples[i]) >= LOW_G) {
+    i--;
+  }
+  if (magnitude(&samples[i]) >= LOW_G) {
+    uint64_t t = (uint64_t)peak * SISFALL_PERIOD_US;
+    return t > FALLBACK_LEAD_US ? t - FALLBACK_LEAD_US : 0;
+  }
+  // ...then back to the start of that low-g run
+  while (i > 0 && magnitude(&samples[i - 1]) < LOW_G) {
+    i--;
+  }
+  return (uint64_t)i * SISFALL_PERIOD_US;
+}
+
+static int convert(const char *path, const char *out_dir) {
+  const char *name = strrchr(path, '/');
+  name = name ? name + 1 : path;
+  bool is_fall = name[0] == 'F';
+
+  FILE *in = fopen(path, "r");
+  if (in == NULL) {
+    perror(path);
+    return -1;
+  }
+  sisfall_sample_t *samples = NULL;
+  size_t count = read_samples(in, &samples);
+  fclose(in);
+  if (count < 2) {
+    fprintf(stderr, "%s: no samples\n", path);
+    free(samples);
+    return -1;
+  }
+
+  char out_path[4096];
+  snprintf(out_path, sizeof(out_path), "%s/%.*s.csv", out_dir,
+           (int)(strrchr(name, '.') ? strrchr(name, '.') - name
+                                    : (long)strlen(name)),
+           name);
+  FILE *out = fopen(out_path, "w");
+  if (out == NULL) {
+    perror(out_path);
+    free(samples);
+    return -1;
+  }
+
+  fprintf(out, "# source=SisFall %s\n", name);
+  fprintf(out, "# accel_lsb_per_g=%u\n", s_accel_lsb_per_g);
+  fprintf(out, "# gyro_lsb_per_dps=%.1f\n", s_gyro_lsb_per_dps);
+  fprintf(out, "# sample_rate_hz=%d\n", SISFALL_RATE_HZ);
+  if (is_fall) {
+    fprintf(out, "# fall_onset_us=%llu\n",
+            (unsigned long long)estimate_onset(samples, count));
+  }
+  fprintf(out, "t_us,ax,ay,az,gx,gy,gz\n");
+  for (size_t i = 0; i < count; i++) {
+    const sisfall_sample_t *s = &samples[i];
+    fprintf(out, "%llu,%d,%d,%d,%d,%d,%d\n",
+            (unsigned long long)i * SISFALL_PERIOD_US,
+            to_lsb(s->accel_g[0], s_accel_lsb_per_g),
+            to_lsb(s->accel_g[1], s_accel_lsb_per_g),
+            to_lsb(s->accel_g[2], s_accel_lsb_per_g),
+            to_lsb(s->gyro_dps[0], s_gyro_lsb_per_dps),
+            to_lsb(s->gyro_dps[1], s_gyro_lsb_per_dps),
+            to_lsb(s->gyro_dps[2], s_gyro_lsb_per_dps));
+  }
+  fclose(out);
+  free(samples);
+  return 0;
+}
+
+static bool is_sisfall_name(const char *name) {
+  size_t len = strlen(name);
+  return (name[0] == 'D' || name[0] == 'F') && len > 4 &&
+         strcmp(name + len - 4, ".txt") == 0;
+}
+
+/**
+ * @brief Converts a file, or every SisFall trial below a directory.
+ * @return Number of failed conversions.
+ */
+static int import_path(const char *path, const char *out_dir, int *done) {
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    perror(path);
+    return 1;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    int err = convert(path, out_dir) != 0;
+    *done += !err;
+    return err;
+  }
+
+  DIR *dir = opendir(path);
+  if (dir == NULL) {
+    perror(path);
+    return 1;
+  }
+  int errors = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    char full[4096];
+    snprintf(full, sizeof(full), "%s/%s", path, entry->d_name);
+    if (stat(full, &st) == 0 && S_ISDIR(st.st_mode)) {
+      errors += import_path(full, out_dir, done);
+    } else if (is_sisfall_name(entry->d_name)) {
+      errors += import_path(full, out_dir, done);
+    }
+  }
+  closedir(dir);
+  return errors;
+}
+
+int main(int argc, char **argv) {
+  static const struct option options[] = {
+      {"accel-range-g", required_argument, NULL, 'a'},
+      {"gyro-range-dps", required_argument, NULL, 'g'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "a:g:h", options, NULL)) != -1) {
+    switch (opt) {
+    case 'a':
+      s_accel_lsb_per_g = 32768u / (uint32_t)atoi(optarg);
+      break;
+    case 'g':
+      s_gyro_lsb_per_dps = 32768.0 / atof(optarg);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [--accel-range-g 8] [--gyro-range-dps 1000] "
+              "<out_dir> <SisFall file|directory>...\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (argc - optind < 2) {
+    fprintf(stderr, "missing output directory or input\n");
+    return 2;
+  }
+
+  const char *out_dir = argv[optind];
+  mkdir(out_dir, 0755);
+
+  int done = 0, errors = 0;
+  for (int i = optind + 1; i < argc; i++) {
+    errors += import_path(argv[i], out_dir, &done);
+  }
+  fprintf(stderr, "%d trace(s) written to %s, %d failed\n", done, out_dir,
+          errors);
+  return errors ? 1 : 0;
+}
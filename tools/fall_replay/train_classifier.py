@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""Trains the fall classifier and generates its firmware tables.
+
+Input is a candidate dump from `fall_replay --dump-features FILE`: one row
+per detector candidate with its label (1 = matched a labelled fall) and the
+integer model inputs. The model is a gradient-boosted ensemble of complete
+binary trees of fixed depth with integer split thresholds. Leaf values are
+quantized to int16 (log-odds x 256) while training, so the score computed
+here is exactly what fall_classifier_score() computes on the device.
+
+Outputs:
+  components/fall_logic/src/fall_classifier_model.h   model tables
+  --reference FILE    inputs and expected score of every row, for
+                      classifier_check (bit-exact agreement)
+
+Pure Python 3, no third-party packages.
+"""
+
+import argparse
+import csv
+import math
+import os
+import sys
+import textwrap
+
+SCALE = 256  # Score units per unit of log-odds
+INT16_MIN, INT16_MAX = -32768, 32767
+INT32_MAX = 2**31 - 1
+
+REPO_ROOT = os.path.normpath(
+    os.path.join(os.path.dirname(__file__), "..", "..")
+)
+DEFAULT_HEADER = os.path.join(
+    REPO_ROOT, "components", "fall_logic", "src", "fall_classifier_model.h"
+)
+
+
+def load(path):
+    with open(path, newline="") as f:
+        reader = csv.reader(f)
+        header = next(reader)
+        names = header[3:]
+        traces, labels, rows = [], [], []
+        for rec in reader:
+            if not rec:
+                continue
+            traces.append(rec[0])
+            labels.append(int(rec[2]))
+            rows.append([int(v) for v in rec[3:]])
+    return names, traces, labels, rows
+
+
+class Tree:
+    """Complete binary tree in heap layout, as in fall_classifier.c."""
+
+    def __init__(self, depth):
+        internal = (1 << depth) - 1
+        self.depth = depth
+        self.feature = [0] * internal
+        self.threshold = [INT32_MAX] * internal
+        self.leaf = [0] * (1 << depth)
+
+    def predict(self, x):
+        node = 0
+        for _ in range(self.depth):
+            node = 2 * node + 1 + (x[self.feature[node]] > self.threshold[node])
+        return self.leaf[node - len(self.feature)]
+
+
+def best_split(rows, idx, grad, hess, lam, min_hess):
+    g_total = sum(grad[i] for i in idx)
+    h_total = sum(hess[i] for i in idx)
+    parent = g_total * g_total / (h_total + lam)
+    best = None  # (gain, feature, threshold)
+    for f in range(len(rows[0])):
+        order = sorted(idx, key=lambda i: rows[i][f])
+        g_left = h_left = 0.0
+        for k in range(len(order) - 1):
+            i = order[k]
+            g_left += grad[i]
+            h_left += hess[i]
+            value, next_value = rows[i][f], rows[order[k + 1]][f]
+            if value == next_value:
+                continue
+            h_right = h_total - h_left
+            if h_left < min_hess or h_right < min_hess:
+                continue
+            g_right = g_total - g_left
+            gain = (
+                g_left * g_left / (h_left + lam)
+                + g_right * g_right / (h_right + lam)
+                - parent
+            )
+            if best is None or gain > best[0]:
+                best = (gain, f, value)
+    return best
+
+
+def build_tree(rows, grad, hess, depth, lam, lr, min_hess):
+    tree = Tree(depth)
+    internal = len(tree.feature)
+
+    def leaf_value(idx):
+        g = sum(grad[i] for i in idx)
+        h = sum(hess[i] for i in idx)
+        w = -g / (h + lam) * lr if idx else 0.0
+        return max(INT16_MIN, min(INT16_MAX, round(w * SCALE)))
+
+    def grow(node, idx):
+        if node >= internal:
+            tree.leaf[node - internal] = leaf_value(idx)
+            return
+        split = None
+        if idx:
+            split = best_split(rows, idx, grad, hess, lam, min_hess)
+        if split is None or split[0] <= 0:
+            # No useful split: everything goes left, both sides share a value
+            tree.feature[node] = 0
+            tree.threshold[node] = INT32_MAX
+            grow(2 * node + 1, idx)
+            grow(2 * node + 2, idx)
+            return
+        _, f, t = split
+        tree.feature[node] = f
+        tree.threshold[node] = t
+        grow(2 * node + 1, [i for i in idx if rows[i][f] <= t])
+        grow(2 * node + 2, [i for i in idx if rows[i][f] > t])
+
+    grow(0, list(range(len(rows))))
+    return tree
+
+
+def train(rows, labels, args):
+    weights = [args.fall_weight if y else 1.0 for y in labels]
+    positive = sum(w for w, y in zip(weights, labels) if y)
+    total = sum(weights)
+    p0 = min(max(positive / total, 1e-3), 1 - 1e-3)
+    base = round(math.log(p0 / (1 - p0)) * SCALE)
+
+    # Scores are tracked in device units so training sees the quantization
+    scores = [base] * len(rows)
+    trees = []
+    for _ in range(args.trees):
+        grad, hess = [], []
+        for s, y, w in zip(scores, labels, weights):
+            p = 1.0 / (1.0 + math.exp(-s / SCALE))
+            grad.append((p - y) * w)
+            hess.append(max(p * (1 - p), 1e-6) * w)
+        tree = build_tree(
+            rows, grad, hess, args.depth, args.l2, args.learning_rate,
+            args.min_child_weight,
+        )
+        trees.append(tree)
+        scores = [s + tree.predict(x) for s, x in zip(scores, rows)]
+    return base, trees
+
+
+def score(base, trees, x):
+    return base + sum(t.predict(x) for t in trees)
+
+
+def report(tag, base, trees, rows, labels):
+    tp = fp = tn = fn = 0
+    for x, y in zip(rows, labels):
+        accept = score(base, trees, x) >= 0
+        tp += accept and y
+        fn += (not accept) and y
+        fp += accept and not y
+        tn += (not accept) and not y
+    falls, others = tp + fn, fp + tn
+    print(
+        f"{tag}: {falls} falls kept {tp} ({100.0 * tp / max(falls, 1):.1f}%), "
+        f"{others} non-falls rejected {tn} ({100.0 * tn / max(others, 1):.1f}%)"
+    )
+
+
+def c_table(rows, width=80):
+    """Formats rows of ints as C initializers wrapped at @p width columns."""
+    lines = []
+    for r, row in enumerate(rows):
+        items = ["INT32_MAX" if v == INT32_MAX else str(v) for v in row]
+        line = "    {"
+        for k, item in enumerate(items):
+            text = item + (", " if k + 1 < len(items) else "}")
+            if len(line) + len(text.rstrip()) > width:
+                lines.append(line.rstrip())
+                line = "     "
+            line += text
+        lines.append(line + ("," if r + 1 < len(rows) else ""))
+    return "\n".join(lines)
+
+
+def write_header(path, names, base, trees, args, count):
+    internal = len(trees[0].feature)
+    inputs = textwrap.fill(
+        ", ".join(names), width=77, initial_indent="// Inputs: ",
+        subsequent_indent="//   ",
+    )
+    about = textwrap.fill(
+        f"Training data: {args.description or os.path.basename(args.dump)} "
+        f"({count} candidates). {len(trees)} trees of depth {args.depth}, "
+        f"learning rate {args.learning_rate}, fall weight {args.fall_weight}.",
+        width=77, initial_indent=" * ", subsequent_indent=" * ",
+    )
+    features = [t.feature for t in trees]
+    thresholds = [t.threshold for t in trees]
+    leaves = [t.leaf for t in trees]
+
+    with open(path, "w") as f:
+        f.write(
+            f"""/**
+ * @file fall_classifier_model.h
+ * @brief Fall classifier tables. Generated by
+ * tools/fall_replay/train_classifier.py, do not edit.
+ *
+{about}
+ */
+#ifndef _FALL_CLASSIFIER_MODEL_H_
+#define _FALL_CLASSIFIER_MODEL_H_
+
+#define FALL_MODEL_INPUTS {len(names)}
+#define FALL_MODEL_TREES {len(trees)}
+#define FALL_MODEL_DEPTH {args.depth}
+#define FALL_MODEL_BASE_SCORE ({base})
+
+{inputs}
+DRAM_ATTR static const uint8_t
+    s_model_feature[FALL_MODEL_TREES][{internal}] = {{
+{c_table(features)}}};
+
+DRAM_ATTR static const int32_t
+    s_model_threshold[FALL_MODEL_TREES][{internal}] = {{
+{c_table(thresholds)}}};
+
+DRAM_ATTR static const int16_t
+    s_model_leaf[FALL_MODEL_TREES][{internal + 1}] = {{
+{c_table(leaves)}}};
+
+#endif // _FALL_CLASSIFIER_MODEL_H_
+"""
+        )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("dump", help="candidate dump from fall_replay")
+    parser.add_argument("--header", default=DEFAULT_HEADER)
+    parser.add_argument("--reference", help="write inputs and expected scores")
+    parser.add_argument(
+        "--description", help="training data description for the header"
+    )
+    parser.add_argument("--trees", type=int, default=16)
+    parser.add_argument("--depth", type=int, default=3)
+    parser.add_argument("--learning-rate", type=float, default=0.3)
+    parser.add_argument("--l2", type=float, default=1.0)
+    parser.add_argument("--min-child-weight", type=float, default=1.0)
+    parser.add_argument(
+        "--fall-weight", type=float, default=2.0,
+        help="weight of a fall relative to a non-fall (missed falls cost more)",
+    )
+    args = parser.parse_args()
+
+    names, traces, labels, rows = load(args.dump)
+    if not rows or len(set(labels)) < 2:
+        sys.exit("need both fall and non-fall candidates")
+
+    # Hold out every fifth trace to estimate generalization
+    trace_ids = sorted(set(traces))
+    held = {t for k, t in enumerate(trace_ids) if k % 5 == 4}
+    train_idx = [i for i, t in enumerate(traces) if t not in held]
+    test_idx = [i for i, t in enumerate(traces) if t in held]
+    if train_idx and test_idx:
+        base, trees = train([rows[i] for i in train_idx],
+                            [labels[i] for i in train_idx], args)
+        report("held-out traces", base, trees, [rows[i] for i in test_idx],
+               [labels[i] for i in test_idx])
+
+    base, trees = train(rows, labels, args)
+    report("all candidates", base, trees, rows, labels)
+
+    write_header(args.header, names, base, trees, args, len(rows))
+    print(f"wrote {args.header}")
+
+    if args.reference:
+        with open(args.reference, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(names + ["score"])
+            for x in rows:
+                writer.writerow(x + [score(base, trees, x)])
+        print(f"wrote {args.reference}")
+
+
+if __name__ == "__main__":
+    main()